@@ -8,6 +8,9 @@
 #include <string.h> /* for memcpy */
 #include <math.h>
 #include "video_gr.h"
+#include "trace.h"
+#include "framearena.h"
+#include "region.h"
 
 //Since PI was not found in math.h's defines we define it here (at the highest precision possible with native C types)
 #define PI 3.14159265358979323846
@@ -17,6 +20,20 @@
 #define IGNORE_COLOR 0xf81f
 //Color a pixel has when it is empty
 #define EMPTY_PIXEL 0x0000
+//Mask of every color component without its least significant bit, so that halving two colors and adding them does not carry between components
+#define HALF_COLOR_MASK 0xf7de
+//Rotated bitmaps kept to be drawn again (a sprite is usually drawn at the same angle for many frames in a row)
+#define ROTATION_CACHE_SIZE 8
+
+typedef struct {
+  Bitmap * source;
+  double angle;
+  Bitmap * rotated;
+  unsigned long last_used;
+} RotationCacheEntry;
+
+static RotationCacheEntry rotation_cache[ROTATION_CACHE_SIZE];
+static unsigned long rotation_cache_uses = 0;
 
 ///Helper private functions
 
@@ -36,14 +53,58 @@ static double get_rot_y(double angle, double x, double y) {
   return x * sine + y * cossine;
 }
 
-//Performs pixel calculations and returns a rotated Bitmap, based on the passed one and the passed angle
-static Bitmap * rotateBitmap(Bitmap * bmp, double angle) {
+//Allocates a bitmap with room for the passed bytes of pixels (its info header is left to be filled), in the frame arena if in_frame is true
+//(to be deleted with deleteFrameBitmap then)
+static Bitmap * allocBitmap(unsigned int image_size, bool in_frame) {
+  Bitmap * bmp = in_frame ? framearena_alloc(sizeof *bmp) : malloc(sizeof *bmp);
+  if(bmp == NULL) {
+    return NULL;
+  }
+
+  bmp->bitmapData = in_frame ? framearena_alloc(image_size) : malloc(image_size);
+  if(bmp->bitmapData == NULL) {
+    if(in_frame) {
+      framearena_free(bmp);
+    } else {
+      free(bmp);
+    }
+    return NULL;
+  }
+
+  return bmp;
+}
+
+//Returns a deep copy of the passed Bitmap, in the frame arena if in_frame is true
+static Bitmap * copyBitmap_aux(Bitmap * bmp, bool in_frame) {
+  //If passed bitmap is null, do nothing
+  if(bmp == NULL) {
+    return NULL;
+  }
+
+  Bitmap * newbmp = allocBitmap(bmp->bitmapInfoHeader.imageSize, in_frame);
+  if(newbmp == NULL) {
+    //Couldn't allocate memory
+    return NULL;
+  }
+
+  //Copying bitmap data using memcpy (to allow changing bitmaps independently)
+  memcpy(newbmp->bitmapData, bmp->bitmapData, bmp->bitmapInfoHeader.imageSize);
+
+  //Finally, copying info header
+  newbmp->bitmapInfoHeader = bmp->bitmapInfoHeader;
+
+  //Returning copied bitmap
+  return newbmp;
+}
+
+//Performs pixel calculations and returns a rotated Bitmap, based on the passed one and the passed angle (in the frame arena if in_frame is true)
+static Bitmap * rotateBitmap(Bitmap * bmp, double angle, bool in_frame) {
   //TODO: It is not necessary to fully copy the bitmap, only allocate space, since we are copying in the nested for loop. Change that maybe?
   //We are using memcpy to copy so it should not be a problem for it is very efficient...
 
   //Change that in the future, after it is working
   //Copying the passed bitmap into a new one, since we will be changing pixels
-  Bitmap * result = copyBitmap(bmp);
+  Bitmap * result = copyBitmap_aux(bmp, in_frame);
 
   //If there was a problem in copying, return NULL
   if(result == NULL){
@@ -159,6 +220,57 @@ static bool check_if_already_drawn(Bitmap * bmp, int x, int y, unsigned short *
   return false;
 }
 
+//Gets the passed bitmap rotated by the passed angle from the cache, rotating it and replacing the least recently used entry if not there
+//The bitmap returned belongs to the cache, and is only valid until the next call
+static Bitmap * getRotatedBitmap(Bitmap * bmp, double angle) {
+  rotation_cache_uses++;
+
+  int i;
+  int oldest = 0;
+  for(i = 0; i < ROTATION_CACHE_SIZE; i++) {
+    RotationCacheEntry * entry = &rotation_cache[i];
+    if(entry->rotated != NULL && entry->source == bmp && entry->angle == angle) {
+      entry->last_used = rotation_cache_uses;
+      return entry->rotated;
+    }
+    if(entry->last_used < rotation_cache[oldest].last_used) {
+      oldest = i;
+    }
+  }
+
+  Bitmap * rotated = rotateBitmap(bmp, angle, false);
+  if(rotated == NULL) {
+    return NULL;
+  }
+
+  RotationCacheEntry * entry = &rotation_cache[oldest];
+  //Not deleteBitmap, since it would look for the rotated bitmap in the cache
+  if(entry->rotated != NULL) {
+    free(entry->rotated->bitmapData);
+    free(entry->rotated);
+  }
+  entry->source = bmp;
+  entry->angle = angle;
+  entry->rotated = rotated;
+  entry->last_used = rotation_cache_uses;
+  return rotated;
+}
+
+//Discards the rotations of the passed bitmap, so that another one allocated at the same address is not mistaken for it
+static void forgetRotations(Bitmap * bmp) {
+  int i;
+  for(i = 0; i < ROTATION_CACHE_SIZE; i++) {
+    RotationCacheEntry * entry = &rotation_cache[i];
+    if(entry->rotated != NULL && entry->source == bmp) {
+      free(entry->rotated->bitmapData);
+      free(entry->rotated);
+      entry->rotated = NULL;
+      entry->source = NULL;
+      entry->last_used = 0;
+    }
+  }
+}
+
 //Draws the passed bitmap in the passed positions in the passed buffer, not considering transparency (IGNORE_COLOR)
 static void drawBitmapWithoutTransparency_aux(Bitmap* bmp, int x, int y, unsigned short * buffer) {
   if (bmp == NULL)
@@ -205,7 +317,8 @@ static void drawBitmapWithoutTransparency_aux(Bitmap* bmp, int x, int y, unsigne
 }
 
 //Draws the passed bitmap in the passed positions in the passed buffer, considering transparency (IGNORE_COLOR)
-static void drawBitmap_aux(Bitmap* bmp, int x, int y, unsigned short * buffer) {
+//If translucent is true, each pixel drawn is the average of the bitmap's and the one already in the buffer
+static void drawBitmap_aux(Bitmap* bmp, int x, int y, unsigned short * buffer, bool translucent) {
   if (bmp == NULL)
       return;
 
@@ -250,7 +363,11 @@ static void drawBitmap_aux(Bitmap* bmp, int x, int y, unsigned short * buffer) {
     for(j = 0; j < drawWidth; j++){
       if(imgStartPos[j] != IGNORE_COLOR) {
         //printf("colors at i=%d j=%d\tvalue:%x\n", i, j, imgStartPos[j]);
-        bufferStartPos[j] = imgStartPos[j];
+        if(translucent) {
+          bufferStartPos[j] = ((imgStartPos[j] & HALF_COLOR_MASK) >> 1) + ((bufferStartPos[j] & HALF_COLOR_MASK) >> 1);
+        } else {
+          bufferStartPos[j] = imgStartPos[j];
+        }
       }
     }
   }
@@ -259,9 +376,10 @@ static void drawBitmap_aux(Bitmap* bmp, int x, int y, unsigned short * buffer) {
 
 ////Public functions
 
-Bitmap* loadBitmap(const char* filename) {
+//Loads a bitmap into memory from malloc, or into the passed region if not NULL (then nothing is freed if loading fails, the region has it)
+static Bitmap* loadBitmapFile(const char* filename, Region * region) {
     // allocating necessary size
-    Bitmap* bmp = (Bitmap*) malloc(sizeof(Bitmap));
+    Bitmap* bmp = region != NULL ? region_alloc(region, sizeof(Bitmap)) : (Bitmap*) malloc(sizeof(Bitmap));
 
     // If memory could not be allocated
     if(bmp == NULL) {
@@ -272,7 +390,8 @@ Bitmap* loadBitmap(const char* filename) {
     FILE *filePtr;
     filePtr = fopen(filename, "rb");
     if (filePtr == NULL){
-      free(bmp);
+      if (region == NULL)
+        free(bmp);
       return NULL;
     }
 
@@ -283,7 +402,8 @@ Bitmap* loadBitmap(const char* filename) {
     // verify that this is a bmp file by check bitmap id
     if (bitmapFileHeader.type != 0x4D42) {
         fclose(filePtr);
-        free(bmp);
+        if (region == NULL)
+          free(bmp);
         return NULL;
     }
 
@@ -310,13 +430,13 @@ Bitmap* loadBitmap(const char* filename) {
     fseek(filePtr, bitmapFileHeader.offset, SEEK_SET);
 
     // allocate enough memory for the bitmap image data
-    unsigned short* bitmapImage = malloc(bitmapInfoHeader.imageSize);
+    unsigned short* bitmapImage = region != NULL ? region_alloc_bulk(region, bitmapInfoHeader.imageSize) : malloc(bitmapInfoHeader.imageSize);
 
     // verify memory allocation
     if (!bitmapImage) {
-        free(bitmapImage);
         fclose(filePtr);
-        free(bmp);
+        if (region == NULL)
+          free(bmp);
         return NULL;
     }
 
@@ -325,9 +445,9 @@ Bitmap* loadBitmap(const char* filename) {
 
     // make sure bitmap image data was read
     if (bitmapImage == NULL) {
-        free(bitmapImage);
         fclose(filePtr);
-        free(bmp);
+        if (region == NULL)
+          free(bmp);
         return NULL;
     }
 
@@ -340,8 +460,27 @@ Bitmap* loadBitmap(const char* filename) {
     return bmp;
 }
 
+Bitmap* loadBitmap(const char* filename) {
+  //Traced, since loading from disk is the slowest thing that can happen in a frame
+  trace_begin("load bitmap", TRACE_CAT_ASSET);
+  Bitmap* bmp = loadBitmapFile(filename, NULL);
+  trace_end("load bitmap", TRACE_CAT_ASSET);
+  return bmp;
+}
+
+Bitmap * loadBitmapInRegion(const char * filename, Region * region) {
+  if(region == NULL) {
+    return NULL;
+  }
+
+  trace_begin("load bitmap", TRACE_CAT_ASSET);
+  Bitmap * bmp = loadBitmapFile(filename, region);
+  trace_end("load bitmap", TRACE_CAT_ASSET);
+  return bmp;
+}
+
 void drawBitmap(Bitmap* bmp, int x, int y) {
-  drawBitmap_aux(bmp, x, y, getBackBuffer());
+  drawBitmap_aux(bmp, x, y, getBackBuffer(), false);
 }
 
 void drawBitmapWithoutTransparency(Bitmap* bmp, int x, int y) {
@@ -352,8 +491,8 @@ void drawBitmapWithRotation(Bitmap* oldbmp, int x, int y, double angle) {
   if (oldbmp == NULL)
       return;
 
-  //Getting the new, rotated bitmap
-  Bitmap * bmp = rotateBitmap(oldbmp, angle);
+  //Getting the rotated bitmap (owned by the cache, so it is not deleted here)
+  Bitmap * bmp = getRotatedBitmap(oldbmp, angle);
 
   //If it could not be correctly calculated or allocated
   if(bmp == NULL){
@@ -362,9 +501,178 @@ void drawBitmapWithRotation(Bitmap* oldbmp, int x, int y, double angle) {
 
   //Now just drawing the transformed bitmap normally
   drawBitmap(bmp, x, y);
+}
 
-  //Before returning, destroying the newly created sprite for this rotation to avoid memory leaks
-  deleteBitmap(bmp);
+void drawBitmapTranslucentWithRotation(Bitmap* oldbmp, int x, int y, double angle) {
+  if (oldbmp == NULL)
+      return;
+
+  Bitmap * bmp = getRotatedBitmap(oldbmp, angle);
+
+  if(bmp == NULL){
+    return;
+  }
+
+  drawBitmap_aux(bmp, x, y, getBackBuffer(), true);
+}
+
+void drawBitmapTranslucent(Bitmap* bmp, int x, int y) {
+  drawBitmap_aux(bmp, x, y, getBackBuffer(), true);
+}
+
+Bitmap * captureBitmap(int x, int y, int width, int height) {
+  Bitmap * bmp = malloc(sizeof *bmp);
+  if(bmp == NULL) {
+    return NULL;
+  }
+
+  bmp->bitmapData = malloc(width * height * 2);
+  if(bmp->bitmapData == NULL) {
+    free(bmp);
+    return NULL;
+  }
+
+  memset(&bmp->bitmapInfoHeader, 0, sizeof bmp->bitmapInfoHeader);
+  bmp->bitmapInfoHeader.width = width;
+  bmp->bitmapInfoHeader.height = height;
+  bmp->bitmapInfoHeader.imageSize = width * height * 2;
+
+  //Rows stored bottom up, like the ones loaded, pixels outside of the screen as transparent
+  unsigned short * buffer = getBackBuffer();
+  int i, j;
+  for(i = 0; i < height; i++) {
+    int pos = y + height - 1 - i;
+    unsigned short * row = bmp->bitmapData + i * width;
+    for(j = 0; j < width; j++) {
+      if(pos < 0 || pos >= getVerResolution() || x + j < 0 || x + j >= getHorResolution()) {
+        row[j] = IGNORE_COLOR;
+      } else {
+        row[j] = buffer[x + j + pos * getHorResolution()];
+      }
+    }
+  }
+
+  return bmp;
+}
+
+void keepDrawnOverCapture(Bitmap * bmp, int x, int y) {
+  if(bmp == NULL) {
+    return;
+  }
+
+  int width = bmp->bitmapInfoHeader.width;
+  int height = bmp->bitmapInfoHeader.height;
+  unsigned short * buffer = getBackBuffer();
+  int i, j;
+  for(i = 0; i < height; i++) {
+    int pos = y + height - 1 - i;
+    unsigned short * row = bmp->bitmapData + i * width;
+    for(j = 0; j < width; j++) {
+      if(pos < 0 || pos >= getVerResolution() || x + j < 0 || x + j >= getHorResolution()) {
+        continue;
+      }
+      //A pixel left as it was when captured was not drawn over, so it becomes transparent
+      unsigned short drawn = buffer[x + j + pos * getHorResolution()];
+      row[j] = drawn == row[j] ? IGNORE_COLOR : drawn;
+    }
+  }
+}
+
+//Creates a bitmap with every pixel transparent, in the frame arena if in_frame is true
+static Bitmap * createTransparentBitmap_aux(int width, int height, bool in_frame) {
+  if(width <= 0 || height <= 0) {
+    return NULL;
+  }
+
+  Bitmap * bmp = allocBitmap(width * height * 2, in_frame);
+  if(bmp == NULL) {
+    return NULL;
+  }
+
+  memset(&bmp->bitmapInfoHeader, 0, sizeof bmp->bitmapInfoHeader);
+  bmp->bitmapInfoHeader.width = width;
+  bmp->bitmapInfoHeader.height = height;
+  bmp->bitmapInfoHeader.imageSize = width * height * 2;
+
+  int i;
+  for(i = 0; i < width * height; i++) {
+    bmp->bitmapData[i] = IGNORE_COLOR;
+  }
+
+  return bmp;
+}
+
+Bitmap * createTransparentBitmap(int width, int height) {
+  return createTransparentBitmap_aux(width, height, false);
+}
+
+Bitmap * createFrameBitmap(int width, int height) {
+  return createTransparentBitmap_aux(width, height, true);
+}
+
+void drawBitmapIntoBitmap(Bitmap * dest, Bitmap * bmp, int x, int y) {
+  if(dest == NULL || bmp == NULL) {
+    return;
+  }
+
+  int dest_width = dest->bitmapInfoHeader.width;
+  int dest_height = dest->bitmapInfoHeader.height;
+  int width = bmp->bitmapInfoHeader.width;
+  int height = bmp->bitmapInfoHeader.height;
+
+  //Both stored bottom up, so row i of bmp (counting from its bottom) goes in the row of dest that is as far from y
+  int i, j;
+  for(i = 0; i < height; i++) {
+    int dest_row = dest_height - 1 - (y + height - 1 - i);
+    if(dest_row < 0 || dest_row >= dest_height) {
+      continue;
+    }
+    unsigned short * src = bmp->bitmapData + i * width;
+    unsigned short * row = dest->bitmapData + dest_row * dest_width;
+    for(j = 0; j < width; j++) {
+      if(x + j >= 0 && x + j < dest_width && src[j] != IGNORE_COLOR) {
+        row[x + j] = src[j];
+      }
+    }
+  }
+}
+
+void copyBitmapRegion(Bitmap * dest, Bitmap * src, int x, int y, int width, int height) {
+  if(dest == NULL || src == NULL) {
+    return;
+  }
+
+  int dest_width = dest->bitmapInfoHeader.width;
+  int dest_height = dest->bitmapInfoHeader.height;
+  if(src->bitmapInfoHeader.width != dest_width || src->bitmapInfoHeader.height != dest_height) {
+    return;
+  }
+
+  //Clipping the region to the bitmaps
+  if(x < 0) {
+    width += x;
+    x = 0;
+  }
+  if(y < 0) {
+    height += y;
+    y = 0;
+  }
+  if(x + width > dest_width) {
+    width = dest_width - x;
+  }
+  if(y + height > dest_height) {
+    height = dest_height - y;
+  }
+  if(width <= 0 || height <= 0) {
+    return;
+  }
+
+  //Rows are stored bottom up, but the region is the same in both, so each of its rows is a single memcpy
+  int i;
+  for(i = y; i < y + height; i++) {
+    int row = dest_height - 1 - i;
+    memcpy(dest->bitmapData + row * dest_width + x, src->bitmapData + row * dest_width + x, width * 2);
+  }
 }
 
 void drawFullscreenBitmap(Bitmap * bmp) {
@@ -391,9 +699,8 @@ bool check_if_bitmaps_collided(Bitmap * bmp1, int b1x, int b1y, Bitmap * bmp2, i
     return false;
   }
 
-  //Using calloc to zero-initialize the temporary buffer
-  //(calloc receves nelements, size_of_element so we just tell it that the vram size is in bytes)
-  unsigned short * tempbuffer = calloc(getVramSize(), 1);
+  //Zero-initializing the temporary buffer, taken from the frame arena since it is only needed until the end of the check
+  unsigned short * tempbuffer = framearena_calloc(getVramSize());
 
   //Verifying if the temporary buffer could be correctly allocated
   if(tempbuffer == NULL) {
@@ -413,8 +720,8 @@ bool check_if_bitmaps_collided(Bitmap * bmp1, int b1x, int b1y, Bitmap * bmp2, i
     result = check_if_already_drawn(bmp1, b1x, b1y, tempbuffer);
   }
 
-  //Never forget to free allocated memory...
-  free(tempbuffer);
+  //Never forget to free allocated memory... (it being on top of the arena, the arena gets all of it back straight away)
+  framearena_free(tempbuffer);
   //That is the reason the result is stored in a temporary variable, we could not return from the function result directly otherwise we could not free the temp buffer
   return result;
 }
@@ -426,7 +733,7 @@ bool check_if_bitmaps_collided_rotated_w_non_rotated(Bitmap * bmp1, int b1x, int
   }
 
   //Getting the new, rotated bitmap
-  Bitmap * newbmp1 = rotateBitmap(bmp1, angleb1);
+  Bitmap * newbmp1 = rotateBitmap(bmp1, angleb1, true);
 
   //If it could not be correctly calculated or allocated
   if(newbmp1 == NULL){
@@ -438,47 +745,40 @@ bool check_if_bitmaps_collided_rotated_w_non_rotated(Bitmap * bmp1, int b1x, int
   bool result = check_if_bitmaps_collided(newbmp1, b1x, b1y, bmp2, b2x, b2y);
 
   //Before returning, destroying the newly created sprite for this rotation to avoid memory leaks
-  deleteBitmap(newbmp1);
+  deleteFrameBitmap(newbmp1);
   return result;
 }
 
 Bitmap * copyBitmap(Bitmap * bmp){
-  //If passed bitmap is null, do nothing
-  if(bmp == NULL) {
-    return NULL;
-  }
-
-  //Allocating memory for the new bmp
-  Bitmap * newbmp = malloc(sizeof *bmp);
-  if(newbmp == NULL) {
-    //Couldn't allocate memory
-    return NULL;
-  }
-
-
-  //Allocating space for the new bitmap data
-  newbmp->bitmapData = malloc(bmp->bitmapInfoHeader.imageSize);
+  return copyBitmap_aux(bmp, false);
+}
 
-  //if space couldn't be allocated free allocated memory and return NULL
-  if(newbmp->bitmapData == NULL){
-    free(newbmp);
-    return NULL;
+void forgetRegionRotations(Region * region) {
+  int i;
+  for(i = 0; i < ROTATION_CACHE_SIZE; i++) {
+    RotationCacheEntry * entry = &rotation_cache[i];
+    if(entry->rotated != NULL && region_contains(region, entry->source)) {
+      forgetRotations(entry->source);
+    }
   }
-
-  //Otherwise, copy bitmap data using memcpy (to allow changing bitmaps independently)
-  memcpy(newbmp->bitmapData, bmp->bitmapData, bmp->bitmapInfoHeader.imageSize);
-
-  //Finally, copying info header
-  newbmp->bitmapInfoHeader = bmp->bitmapInfoHeader;
-
-  //Returning copied bitmap
-  return newbmp;
 }
 
 void deleteBitmap(Bitmap* bmp) {
     if (bmp == NULL)
         return;
 
+    forgetRotations(bmp);
+
     free(bmp->bitmapData);
     free(bmp);
 }
+
+void deleteFrameBitmap(Bitmap * bmp) {
+  if(bmp == NULL) {
+    return;
+  }
+
+  //Never in the rotation cache, so there are no rotations to forget
+  framearena_free(bmp->bitmapData);
+  framearena_free(bmp);
+}
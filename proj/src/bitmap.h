@@ -5,6 +5,7 @@
 //drawBitmapWithoutTransparency, drawFullscreenBitmap, drawBitmapWithRotation, get_rot_x, get_rot_y, copyBitmap and collision functions were all implemented by ourselves
 
 #include <stdbool.h>
+#include "region.h"
 
 /** @defgroup Bitmap Bitmap
  * @{
@@ -46,6 +47,14 @@ typedef struct {
  */
 Bitmap* loadBitmap(const char* filename);
 
+/**
+ * @brief Loads a bmp image into a region, so that it is freed with the region (and not with deleteBitmap)
+ * @param  filename Path of the image to load
+ * @param  region   Region to load it into
+ * @return          The loaded Bitmap, or NULL if it could not be loaded
+ */
+Bitmap * loadBitmapInRegion(const char * filename, Region * region);
+
 /**
  * @brief Draws an unscaled, unrotated bitmap at the given position, in the back buffer, considering transparency
  *
@@ -64,7 +73,7 @@ void drawBitmap(Bitmap* bitmap, int x, int y);
 void drawBitmapWithoutTransparency(Bitmap* bmp, int x, int y);
 
 /**
-* @brief Draws a bitmap with rotation given by the passed angle
+* @brief Draws a bitmap with rotation given by the passed angle (the last bitmaps rotated are kept, so drawing one again at the same angle does not rotate it again)
 * @param oldbmp The original Bitmap to draw, from which a new, rotated one will be generated
 * @param x      The x at which to draw the rotated Bitmap
 * @param y      The y at which to draw the rotated Bitmap
@@ -72,6 +81,78 @@ void drawBitmapWithoutTransparency(Bitmap* bmp, int x, int y);
 */
 void drawBitmapWithRotation(Bitmap* oldbmp, int x, int y, double angle);
 
+/**
+* @brief Draws a bitmap with rotation given by the passed angle, blended half and half with what is already in the back buffer
+* @param oldbmp The original Bitmap to draw, from which a new, rotated one will be generated
+* @param x      The x at which to draw the rotated Bitmap
+* @param y      The y at which to draw the rotated Bitmap
+* @param angle  The angle to draw the Bitmap with
+*/
+void drawBitmapTranslucentWithRotation(Bitmap* oldbmp, int x, int y, double angle);
+
+/**
+ * @brief Draws an unscaled, unrotated bitmap at the given position, in the back buffer, considering transparency, blended half and half with what is already there
+ * @param bmp Bitmap to draw
+ * @param x   The x at which to draw the Bitmap
+ * @param y   The y at which to draw the Bitmap
+ */
+void drawBitmapTranslucent(Bitmap* bmp, int x, int y);
+
+/**
+ * @brief Copies a region of the back buffer into a new bitmap, to be passed to keepDrawnOverCapture after drawing over that region
+ * @param  x      The x of the region
+ * @param  y      The y of the region
+ * @param  width  Width of the region
+ * @param  height Height of the region
+ * @return        Bitmap with the region, or NULL if it could not be allocated
+ */
+Bitmap * captureBitmap(int x, int y, int width, int height);
+
+/**
+ * @brief Turns a bitmap from captureBitmap into what was drawn over its region since: the pixels that changed are kept and the rest become transparent
+ * (so that drawing the bitmap redraws just that, a pixel drawn with the color it already had is lost but that makes no difference when drawn over the same background)
+ * @param bmp Bitmap returned by captureBitmap
+ * @param x   The x of the region captured
+ * @param y   The y of the region captured
+ */
+void keepDrawnOverCapture(Bitmap * bmp, int x, int y);
+
+/**
+ * @brief Creates a bitmap with every pixel transparent, to draw other bitmaps into (see drawBitmapIntoBitmap)
+ * @param  width  Width of the bitmap
+ * @param  height Height of the bitmap
+ * @return        The new Bitmap, or NULL if it could not be allocated
+ */
+Bitmap * createTransparentBitmap(int width, int height);
+
+/**
+ * @brief Creates a bitmap like createTransparentBitmap, in the frame arena: only for something drawn and deleted (see deleteFrameBitmap) within a tick
+ * @param  width  Width of the bitmap
+ * @param  height Height of the bitmap
+ * @return        The new Bitmap, or NULL if it could not be allocated
+ */
+Bitmap * createFrameBitmap(int width, int height);
+
+/**
+ * @brief Draws a bitmap into another one instead of the back buffer, considering transparency
+ * @param dest Bitmap to draw into
+ * @param bmp  Bitmap to draw
+ * @param x    The x in dest at which to draw bmp
+ * @param y    The y in dest at which to draw bmp (from the top, like in the screen)
+ */
+void drawBitmapIntoBitmap(Bitmap * dest, Bitmap * bmp, int x, int y);
+
+/**
+ * @brief Copies a region of a bitmap into the same region of another one of the same size, transparency included (to restore what was under something drawn into it)
+ * @param dest   Bitmap to copy into
+ * @param src    Bitmap to copy from
+ * @param x      The x of the region
+ * @param y      The y of the region (from the top, like in the screen)
+ * @param width  Width of the region
+ * @param height Height of the region
+ */
+void copyBitmapRegion(Bitmap * dest, Bitmap * src, int x, int y, int width, int height);
+
 /**
  * @brief Draws a fullscreen bitmap by copying it entirely to the video buffer
  * @param bmp Fullscreen bitmap to draw
@@ -85,6 +166,19 @@ void drawFullscreenBitmap(Bitmap * bmp);
  */
 void deleteBitmap(Bitmap* bmp);
 
+/**
+ * @brief Discards the cached rotations of every bitmap in the passed region, to be called before destroying it
+ * (its bitmaps are not deleted with deleteBitmap, and another one allocated at the same address must not be mistaken for them)
+ * @param region Region whose bitmaps are about to be freed
+ */
+void forgetRegionRotations(Region * region);
+
+/**
+ * @brief Destroys a bitmap created by createFrameBitmap
+ * @param bmp Bitmap to destroy
+ */
+void deleteFrameBitmap(Bitmap * bmp);
+
 /**
  * @brief Returns a deep copy of the passed Bitmap
  * @param  bmp Bitmap to copy
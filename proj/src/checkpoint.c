@@ -2,10 +2,10 @@
 #include "checkpoint.h"
 #include "bitmap.h"
 
-Checkpoint * create_checkpoint(long x, long y, short speed) {
+Checkpoint * create_checkpoint(long x, long y, short speed, Region * region) {
 
     //Allocating and checking if allocation was successful
-    Checkpoint * checkpoint_ptr = malloc(sizeof *checkpoint_ptr);
+    Checkpoint * checkpoint_ptr = region_alloc(region, sizeof *checkpoint_ptr);
 
     if(checkpoint_ptr == NULL){
       return NULL;
@@ -18,9 +18,3 @@ Checkpoint * create_checkpoint(long x, long y, short speed) {
     //Returning created checkpoint
     return checkpoint_ptr;
 }
-
-void destroy_checkpoint(Checkpoint ** checkpoint_ptr) {
-
-  free(*checkpoint_ptr);
-  *checkpoint_ptr = NULL;
-}
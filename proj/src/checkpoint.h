@@ -1,6 +1,8 @@
 #ifndef _CHECKPOINT_H
 #define _CHECKPOINT_H
 
+#include "region.h"
+
 /** @defgroup checkpoint checkpoint
  * @{
  *
@@ -16,17 +18,12 @@ typedef struct {
 
 /**
  * @brief Creates a checkpoint based on the passed in arguments
- * @param  x     X of the checkpoint to be created
- * @param  y     Y of the checkpoint to be created
- * @param  speed Speed from this checkpoint to the next one
- * @return       Returns a pointer to a valid checkpoint or NULL in case of failure
- */
-Checkpoint * create_checkpoint(long x, long y, short speed);
-
-/**
- * @brief Destroys the passed in checkpoint, deallocating the memory and setting the passed pointer to NULL
- * @param checkpoint_ptr Checkpoint to destroy
+ * @param  x      X of the checkpoint to be created
+ * @param  y      Y of the checkpoint to be created
+ * @param  speed  Speed from this checkpoint to the next one
+ * @param  region Region to create it in (it is freed with the region)
+ * @return        Returns a pointer to a valid checkpoint or NULL in case of failure
  */
-void destroy_checkpoint(Checkpoint ** checkpoint_ptr);
+Checkpoint * create_checkpoint(long x, long y, short speed, Region * region);
 
 #endif /* __CHECKPOINT_H */
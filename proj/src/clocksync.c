@@ -0,0 +1,165 @@
+#include "clocksync.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "uart.h"
+#include "serialframe.h"
+
+typedef struct {
+  double offset;
+  double bound;
+} ClockSyncSample;
+
+//Last samples taken (circular)
+static ClockSyncSample samples[CLOCKSYNC_WINDOW_SIZE];
+static unsigned int n_samples = 0;
+
+void clocksync_reset() {
+  n_samples = 0;
+}
+
+double clocksync_wire_ticks(unsigned int n_bytes) {
+  return (double) n_bytes * UART_BITS_PER_CHAR * CLOCKSYNC_TICKS_PER_SECOND / UART_GAME_RATE;
+}
+
+void clocksync_add_sample(unsigned long long t1, unsigned long long t2, unsigned long long t3, unsigned long long t4, double probe_wire, double reply_wire) {
+  //Ticks are converted to signed values since the host and client counters can be anywhere relative to each other
+  double d_t1 = (double) t1, d_t2 = (double) t2, d_t3 = (double) t3, d_t4 = (double) t4;
+
+  ClockSyncSample sample;
+  //Time each way that is not explained by the frames being on the wire
+  double forward = d_t2 - d_t1 - probe_wire;
+  double backward = d_t4 - d_t3 - reply_wire;
+  sample.offset = (forward - backward) / 2;
+  //Whatever the split of the residual delay between both ways, the error is at most half of it
+  double residual_delay = (d_t4 - d_t1) - (d_t3 - d_t2) - probe_wire - reply_wire;
+  sample.bound = residual_delay > 0 ? residual_delay / 2 : 0;
+
+  samples[n_samples % CLOCKSYNC_WINDOW_SIZE] = sample;
+  n_samples++;
+}
+
+//Gets the sample with the smallest bound in the window, NULL if there are none
+static const ClockSyncSample * best_sample() {
+  if(n_samples == 0) {
+    return NULL;
+  }
+
+  unsigned int n_in_window = n_samples < CLOCKSYNC_WINDOW_SIZE ? n_samples : CLOCKSYNC_WINDOW_SIZE;
+  const ClockSyncSample * best = &samples[0];
+  unsigned int i;
+  for(i = 1; i < n_in_window; i++) {
+    if(samples[i].bound < best->bound) {
+      best = &samples[i];
+    }
+  }
+
+  return best;
+}
+
+bool clocksync_is_synced() {
+  const ClockSyncSample * best = best_sample();
+  if(best == NULL) {
+    return false;
+  }
+
+  return best->bound < CLOCKSYNC_MAX_BOUND || n_samples >= CLOCKSYNC_MAX_SAMPLES;
+}
+
+long long clocksync_get_offset() {
+  const ClockSyncSample * best = best_sample();
+  if(best == NULL) {
+    return 0;
+  }
+
+  return (long long) floor(best->offset + 0.5);
+}
+
+double clocksync_get_bound() {
+  const ClockSyncSample * best = best_sample();
+  if(best == NULL) {
+    return -1;
+  }
+
+  return best->bound;
+}
+
+unsigned int clocksync_get_n_samples() {
+  return n_samples;
+}
+
+//Random value in [0, 1)
+static double random_unit() {
+  return rand() / (RAND_MAX + 1.0);
+}
+
+//Size of a frame carrying the passed varints
+static unsigned int frame_size(unsigned long long v1, unsigned long long v2, unsigned int n_values) {
+  unsigned char temp[VARINT_MAX_SIZE];
+  unsigned int size = SERIALFRAME_OVERHEAD + varint_encode(v1, temp);
+  if(n_values > 1) {
+    size += varint_encode(v2, temp);
+  }
+  return size;
+}
+
+void clocksync_simulate(double latency, double jitter, unsigned int n_runs) {
+  //Model: host ticks happen at integer times, client ticks at integer times shifted by a phase, the host started counting earlier (as in the game)
+  //Messages are sent in the tick they are produced and processed in the first tick after they fully arrive (like the events in the game)
+  double total_time = 0, max_time = 0;
+  double total_skew = 0, max_skew = 0;
+  double total_samples = 0;
+  unsigned int n_forced = 0;
+  unsigned int run;
+
+  for(run = 0; run < n_runs; run++) {
+    clocksync_reset();
+    long long offset_ticks = 100 + rand() % 300;
+    double phase = random_unit();
+    double true_offset = offset_ticks - phase;
+
+    //Time of the first client tick
+    double start = 1 - phase;
+    double probe_time = start;
+    double synced_time = start;
+
+    while(!clocksync_is_synced()) {
+      unsigned long long t1 = (unsigned long long) floor(probe_time + phase + 0.5);
+      double probe_wire = clocksync_wire_ticks(frame_size(t1, 0, 1));
+      double probe_arrival = probe_time + probe_wire + latency + jitter * random_unit();
+      unsigned long long t2 = (unsigned long long) (ceil(probe_arrival) + offset_ticks);
+      unsigned long long t3 = t2;
+
+      double reply_wire = clocksync_wire_ticks(frame_size(t1, t2, 2));
+      double reply_arrival = (t3 - offset_ticks) + reply_wire + latency + jitter * random_unit();
+      double reply_processed = ceil(reply_arrival + phase) - phase;
+      unsigned long long t4 = (unsigned long long) floor(reply_processed + phase + 0.5);
+
+      clocksync_add_sample(t1, t2, t3, t4, probe_wire, reply_wire);
+      synced_time = reply_processed;
+      probe_time += CLOCKSYNC_PROBE_INTERVAL;
+    }
+
+    if(clocksync_get_bound() >= CLOCKSYNC_MAX_BOUND) {
+      n_forced++;
+    }
+
+    double time_to_sync = synced_time - start;
+    double skew = fabs(clocksync_get_offset() - true_offset);
+    total_time += time_to_sync;
+    total_skew += skew;
+    total_samples += clocksync_get_n_samples();
+    if(time_to_sync > max_time) {
+      max_time = time_to_sync;
+    }
+    if(skew > max_skew) {
+      max_skew = skew;
+    }
+  }
+
+  //Since printf might not support floating point values, printing in hundredths of a tick
+  printf("clocksync_simulate::latency %d/100, jitter %d/100 ticks, %u runs\n", (int) (latency * 100), (int) (jitter * 100), n_runs);
+  printf("clocksync_simulate::time to sync avg %d/100 max %d/100 ticks, samples avg %d/100\n", (int) (total_time * 100 / n_runs), (int) (max_time * 100), (int) (total_samples * 100 / n_runs));
+  printf("clocksync_simulate::residual skew avg %d/100 max %d/100 ticks, %u runs agreed without reaching the bound\n", (int) (total_skew * 100 / n_runs), (int) (max_skew * 100), n_forced);
+}
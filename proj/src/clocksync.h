@@ -0,0 +1,84 @@
+#ifndef __CLOCKSYNC_H
+#define __CLOCKSYNC_H
+
+#include <stdbool.h>
+
+/** @defgroup clocksync clocksync
+ * @{
+ *
+ * NTP-style estimation of the offset between the tick counters of both players, from timestamped probe and reply pairs
+ */
+
+/*
+ * The client sends a probe at its tick t1, the host receives it at its tick t2 and replies at its tick t3, the client receives the reply at its tick t4.
+ * Knowing how long each frame takes on the wire (wire_ticks, both frames together), then:
+ *   residual delay = (t4 - t1) - (t3 - t2) - wire_ticks
+ *   offset         = ((t2 - t1) + (t3 - t4)) / 2    (corrected by the difference in wire time of each frame)
+ * and the error of the offset is at most half of the residual delay, which is what we use as the confidence bound.
+ * The sample with the smallest bound of the last CLOCKSYNC_WINDOW_SIZE is used.
+ */
+
+#define CLOCKSYNC_TICKS_PER_SECOND  60
+#define CLOCKSYNC_WINDOW_SIZE       8
+#define CLOCKSYNC_PROBE_INTERVAL    10 /* Ticks between probes sent by the client */
+#define CLOCKSYNC_MAX_BOUND         1.0 /* Offset is agreed on when the bound is under one tick */
+#define CLOCKSYNC_MAX_SAMPLES       8 /* After this many samples, the best one is agreed on regardless of its bound */
+
+/**
+ * @brief Resets the synchronization, discarding every sample
+ */
+void clocksync_reset();
+
+/**
+ * @brief Calculates how many ticks a frame takes to be transmitted through the Serial Port at the rate used in the game
+ * @param  n_bytes Size of the frame in bytes
+ * @return         Time in ticks (fractional)
+ */
+double clocksync_wire_ticks(unsigned int n_bytes);
+
+/**
+ * @brief Adds a sample from a probe and reply pair
+ * @param t1          Client tick when the probe was sent
+ * @param t2          Host tick when the probe was received
+ * @param t3          Host tick when the reply was sent
+ * @param t4          Client tick when the reply was received
+ * @param probe_wire  Ticks the probe frame takes on the wire
+ * @param reply_wire  Ticks the reply frame takes on the wire
+ */
+void clocksync_add_sample(unsigned long long t1, unsigned long long t2, unsigned long long t3, unsigned long long t4, double probe_wire, double reply_wire);
+
+/**
+ * @brief Checks if the offset is known precisely enough to agree on a starting tick
+ * @return true if the best sample has a bound under CLOCKSYNC_MAX_BOUND or if CLOCKSYNC_MAX_SAMPLES samples were taken, false otherwise
+ */
+bool clocksync_is_synced();
+
+/**
+ * @brief Gets the estimated offset, rounded to the nearest tick
+ * @return Ticks to add to the client tick counter to match the host one
+ */
+long long clocksync_get_offset();
+
+/**
+ * @brief Gets the confidence bound of the estimated offset
+ * @return Bound in ticks, negative if there are no samples
+ */
+double clocksync_get_bound();
+
+/**
+ * @brief Gets the number of samples added since the last reset
+ * @return Number of samples
+ */
+unsigned int clocksync_get_n_samples();
+
+/**
+ * @brief Simulates the synchronization between two players over a link with the passed latency and jitter, printing time to sync and residual skew
+ * @param latency Fixed one way latency in ticks, on top of the wire time
+ * @param jitter  Maximum random extra one way latency in ticks (uniformly distributed)
+ * @param n_runs  Number of synchronizations to simulate (each with a random offset and phase between both clocks)
+ */
+void clocksync_simulate(double latency, double jitter, unsigned int n_runs);
+
+/** @} */
+
+#endif /* __CLOCKSYNC_H */
@@ -0,0 +1,317 @@
+#include "commlink.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "telemetry.h"
+#include "utilities.h"
+
+//A message sent reliably and not yet acknowledged
+typedef struct {
+  bool in_use;
+  unsigned char seq;
+  unsigned char opcode;
+  //Payload as sent, already including the sequence number as the first byte
+  unsigned char length;
+  unsigned char payload[SERIALFRAME_MAX_PAYLOAD];
+  unsigned long first_sent_tick;
+  unsigned long last_sent_tick;
+  unsigned int retries;
+  //Timeout for this message, doubled on every retransmit (exponential backoff)
+  unsigned int rto;
+  //To only fast retransmit once per hole reported by the other side
+  bool fast_retransmitted;
+} InFlightMsg;
+
+static InFlightMsg in_flight[COMMLINK_WINDOW_SIZE];
+//Sender state
+static unsigned char tx_next_seq = 0;
+//Receiver state: next sequence number expected in order and which of the following ones were already received
+static unsigned char rx_expected = 0;
+static unsigned char rx_sack = 0;
+static bool ack_pending = false;
+//Link clock, in ticks
+static unsigned long link_ticks = 0;
+//RTT estimation (RFC 6298 style), in ticks
+static bool rtt_measured = false;
+static double srtt = 0;
+static double rttvar = 0;
+static unsigned int rto = COMMLINK_INITIAL_RTO;
+
+static CommLinkStats stats;
+
+//Sequence numbers wrap around, so "a is not after b" means b is at most half the sequence space ahead of a
+static bool seq_not_after(unsigned char a, unsigned char b) {
+  return (unsigned char) (b - a) < 128;
+}
+
+void commlink_reset() {
+  memset(in_flight, 0, sizeof in_flight);
+  tx_next_seq = 0;
+  rx_expected = 0;
+  rx_sack = 0;
+  ack_pending = false;
+  link_ticks = 0;
+  rtt_measured = false;
+  srtt = 0;
+  rttvar = 0;
+  rto = COMMLINK_INITIAL_RTO;
+  memset(&stats, 0, sizeof stats);
+  //Only the latest ack matters, and the sooner it arrives the less is retransmitted
+  transport_set_opcode_class(COMMLINK_OP_ACK, TRANSPORT_PRIORITY_CRITICAL, true);
+}
+
+void commlink_set_opcode_class(unsigned char opcode, transport_priority_enum priority, bool coalesce) {
+  transport_set_opcode_class(opcode, priority, coalesce);
+  //Each reliable message has its own sequence number, so none replaces another
+  transport_set_opcode_class(opcode | COMMLINK_RELIABLE_FLAG, priority, false);
+}
+
+void commlink_send(unsigned char opcode, const unsigned char * payload, unsigned int len) {
+  transport_send_frame(opcode, payload, len);
+}
+
+static void transmit(InFlightMsg * msg) {
+  transport_send_frame(msg->opcode | COMMLINK_RELIABLE_FLAG, msg->payload, msg->length);
+  msg->last_sent_tick = link_ticks;
+}
+
+int commlink_send_reliable(unsigned char opcode, const unsigned char * payload, unsigned int len) {
+  if((opcode & COMMLINK_RELIABLE_FLAG) || opcode == COMMLINK_OP_ACK || len > COMMLINK_MAX_PAYLOAD || (payload == NULL && len != 0)) {
+    printf("commlink_send_reliable::Invalid message, opcode %u and length %u\n", opcode, len);
+    return -1;
+  }
+
+  //Looking for a free slot in the window
+  InFlightMsg * msg = NULL;
+  int i;
+  for(i = 0; i < COMMLINK_WINDOW_SIZE; i++) {
+    if(!in_flight[i].in_use) {
+      msg = &in_flight[i];
+      break;
+    }
+  }
+
+  if(msg == NULL) {
+    printf("commlink_send_reliable::Window full, dropping message with opcode %u\n", opcode);
+    stats.window_full_drops++;
+    return -2;
+  }
+
+  msg->in_use = true;
+  msg->seq = tx_next_seq++;
+  msg->opcode = opcode;
+  msg->length = len + 1;
+  msg->payload[0] = msg->seq;
+  if(len > 0) {
+    memcpy(msg->payload + 1, payload, len);
+  }
+  msg->first_sent_tick = link_ticks;
+  msg->retries = 0;
+  msg->rto = rto;
+  msg->fast_retransmitted = false;
+
+  transmit(msg);
+  stats.messages_sent++;
+  return 0;
+}
+
+//Updates the RTT estimates with a new sample and recalculates the retransmit timeout
+static void add_rtt_sample(unsigned long sample) {
+  if(!rtt_measured) {
+    srtt = sample;
+    rttvar = sample / 2.0;
+    rtt_measured = true;
+  } else {
+    double delta = srtt - sample;
+    if(delta < 0) {
+      delta = -delta;
+    }
+    rttvar = 0.75 * rttvar + 0.25 * delta;
+    srtt = 0.875 * srtt + 0.125 * sample;
+  }
+  stats.rtt_samples++;
+  telemetry_rtt_sample(sample);
+
+  //Variance term is at least 1 tick, that is the granularity of our clock
+  double new_rto = srtt + MAX_VAL(1.0, 4 * rttvar);
+  rto = (unsigned int) (new_rto + 0.5);
+  rto = MAX_VAL(rto, COMMLINK_MIN_RTO);
+  rto = MIN_VAL(rto, COMMLINK_MAX_RTO);
+}
+
+static void handle_ack(const SerialFrameView * frame) {
+  if(frame->length < 2) {
+    return;
+  }
+
+  unsigned char cum_ack = frame->payload[0];
+  unsigned char sack = frame->payload[1];
+  bool newest_acked_valid = false;
+  unsigned char newest_acked = 0;
+
+  int i;
+  for(i = 0; i < COMMLINK_WINDOW_SIZE; i++) {
+    InFlightMsg * msg = &in_flight[i];
+    if(!msg->in_use) {
+      continue;
+    }
+
+    bool acked = seq_not_after(msg->seq, cum_ack);
+    if(!acked) {
+      unsigned char offset = (unsigned char) (msg->seq - cum_ack - 2);
+      acked = offset < 8 && (sack & BIT(offset));
+    }
+
+    if(acked) {
+      //Karn's algorithm: retransmitted messages give ambiguous RTT samples, so they are not used
+      if(msg->retries == 0) {
+        add_rtt_sample(link_ticks - msg->first_sent_tick);
+      }
+      if(!newest_acked_valid || seq_not_after(newest_acked, msg->seq)) {
+        newest_acked = msg->seq;
+        newest_acked_valid = true;
+      }
+      msg->in_use = false;
+    }
+  }
+
+  //If something sent after a message got acked but the message itself did not, it was most likely lost
+  //Retransmitting it straight away instead of waiting for its timeout (once, further losses are handled by the timeout)
+  if(!newest_acked_valid) {
+    return;
+  }
+  for(i = 0; i < COMMLINK_WINDOW_SIZE; i++) {
+    InFlightMsg * msg = &in_flight[i];
+    if(msg->in_use && !msg->fast_retransmitted && seq_not_after(msg->seq, newest_acked) && link_ticks - msg->last_sent_tick >= (unsigned long) srtt) {
+      msg->fast_retransmitted = true;
+      msg->retries++;
+      transmit(msg);
+      stats.fast_retransmits++;
+      telemetry_retransmit();
+    }
+  }
+}
+
+//Registers a received sequence number, returns true if it was not received before
+static bool register_received_seq(unsigned char seq) {
+  unsigned char distance = (unsigned char) (seq - rx_expected);
+
+  if(distance >= 128) {
+    //Older than what we already have in order, duplicate
+    return false;
+  }
+
+  if(distance == 0) {
+    //The one we were waiting for, advancing past it and past every following one that was already received
+    bool has_next;
+    do {
+      rx_expected++;
+      has_next = rx_sack & BIT(0);
+      rx_sack >>= 1;
+    } while(has_next);
+    return true;
+  }
+
+  if(distance > COMMLINK_WINDOW_SIZE) {
+    //Too far ahead to be tracked, the sender will retransmit it later
+    stats.out_of_window_drops++;
+    return false;
+  }
+
+  if(rx_sack & BIT(distance - 1)) {
+    return false;
+  }
+  rx_sack |= BIT(distance - 1);
+  return true;
+}
+
+bool commlink_receive(SerialFrameView * frame) {
+  if(frame == NULL) {
+    return false;
+  }
+
+  if(frame->opcode == COMMLINK_OP_ACK) {
+    handle_ack(frame);
+    return false;
+  }
+
+  if((frame->opcode & COMMLINK_RELIABLE_FLAG) == 0) {
+    //Unreliable message, delivered as is
+    return true;
+  }
+
+  if(frame->length < 1) {
+    return false;
+  }
+
+  //Every reliable message is acknowledged (even duplicates, since our previous ack may have been lost)
+  ack_pending = true;
+
+  if(!register_received_seq(frame->payload[0])) {
+    stats.duplicates_dropped++;
+    return false;
+  }
+
+  //Stripping the reliability header so that the game sees an ordinary message
+  frame->opcode &= ~COMMLINK_RELIABLE_FLAG;
+  frame->length--;
+  frame->payload++;
+  return true;
+}
+
+void commlink_tick() {
+  link_ticks++;
+
+  if(ack_pending) {
+    //Bit i of rx_sack is rx_expected + 1 + i, which is exactly (last in order + 2 + i) as the ack format expects
+    unsigned char ack_payload[2] = {(unsigned char) (rx_expected - 1), rx_sack};
+    transport_send_frame(COMMLINK_OP_ACK, ack_payload, 2);
+    ack_pending = false;
+    stats.acks_sent++;
+  }
+
+  int i;
+  for(i = 0; i < COMMLINK_WINDOW_SIZE; i++) {
+    InFlightMsg * msg = &in_flight[i];
+    if(!msg->in_use || link_ticks - msg->last_sent_tick < msg->rto) {
+      continue;
+    }
+
+    if(msg->retries >= COMMLINK_MAX_RETRIES) {
+      printf("commlink_tick::Giving up on message with opcode %u (seq %u)\n", msg->opcode, msg->seq);
+      msg->in_use = false;
+      stats.messages_given_up++;
+      continue;
+    }
+
+    msg->retries++;
+    msg->rto = MIN_VAL(msg->rto * 2, COMMLINK_MAX_RTO);
+    msg->fast_retransmitted = false;
+    transmit(msg);
+    stats.retransmits++;
+    telemetry_retransmit();
+  }
+}
+
+unsigned int commlink_get_in_flight() {
+  unsigned int n = 0;
+  int i;
+  for(i = 0; i < COMMLINK_WINDOW_SIZE; i++) {
+    if(in_flight[i].in_use) {
+      n++;
+    }
+  }
+  return n;
+}
+
+double commlink_get_srtt() {
+  return srtt;
+}
+
+unsigned int commlink_get_rto() {
+  return rto;
+}
+
+const CommLinkStats * commlink_get_stats() {
+  return &stats;
+}
@@ -0,0 +1,112 @@
+#ifndef __COMMLINK_H
+#define __COMMLINK_H
+
+#include <stdbool.h>
+#include "serialframe.h"
+#include "transport.h"
+
+/** @defgroup commlink commlink
+ * @{
+ *
+ * Reliable delivery of messages over the Serial Port: sequence numbers, cumulative and selective acks, duplicate suppression and retransmission with RTT-adaptive timeouts
+ */
+
+/*
+ * Reliable messages are sent with COMMLINK_RELIABLE_FLAG set in the opcode and the sequence number as the first payload byte.
+ * The receiver answers (at most once per tick) with a COMMLINK_OP_ACK frame whose payload is:
+ *   | last sequence number received in order | selective ack bitmask |
+ * where bit i of the bitmask means that sequence number (last in order + 2 + i) was also received.
+ * Messages are delivered as soon as they arrive (not necessarily in order), duplicates are dropped.
+ * Acks are sent with the highest priority and coalesced (only the latest one queued in a tick is sent, see transport.h).
+ */
+
+#define COMMLINK_RELIABLE_FLAG        0x80
+#define COMMLINK_OP_ACK               0x7F
+#define COMMLINK_MAX_PAYLOAD          (SERIALFRAME_MAX_PAYLOAD - 1) /* One byte is used by the sequence number */
+#define COMMLINK_WINDOW_SIZE          8 /* Maximum number of unacknowledged messages in flight (and size of the selective ack bitmask) */
+#define COMMLINK_INITIAL_RTO          30 /* Retransmit timeout (in ticks) before any RTT is measured */
+#define COMMLINK_MIN_RTO              8 /* A frame plus its ack take around 6 ticks at 1200 baud */
+#define COMMLINK_MAX_RTO              120
+#define COMMLINK_MAX_RETRIES          12 /* After this many retransmits the message is given up on */
+
+typedef struct {
+  unsigned long messages_sent;
+  unsigned long retransmits;
+  unsigned long fast_retransmits;
+  unsigned long messages_given_up;
+  unsigned long window_full_drops;
+  unsigned long acks_sent;
+  unsigned long duplicates_dropped;
+  unsigned long out_of_window_drops;
+  unsigned long rtt_samples;
+} CommLinkStats;
+
+/**
+ * @brief Resets the state of the link (sequence numbers, messages in flight, RTT estimates). To be called when starting a new multiplayer session
+ */
+void commlink_reset();
+
+/**
+ * @brief Sets how the messages with an opcode are scheduled by the transport, sent with or without delivery guarantees
+ * @param opcode   Opcode of the messages, must not have COMMLINK_RELIABLE_FLAG set
+ * @param priority Priority of the messages
+ * @param coalesce If a message sent without delivery guarantees replaces the one with the same opcode queued in the tick (reliable ones never do)
+ */
+void commlink_set_opcode_class(unsigned char opcode, transport_priority_enum priority, bool coalesce);
+
+/**
+ * @brief Sends a message without delivery guarantees (for periodic messages such as beacons and sync ticks)
+ * @param opcode  Opcode of the message, must not have COMMLINK_RELIABLE_FLAG set
+ * @param payload Payload of the message (can be NULL if len is 0)
+ * @param len     Length of the payload
+ */
+void commlink_send(unsigned char opcode, const unsigned char * payload, unsigned int len);
+
+/**
+ * @brief Sends a message that is retransmitted until acknowledged by the other side
+ * @param  opcode  Opcode of the message, must not have COMMLINK_RELIABLE_FLAG set
+ * @param  payload Payload of the message (can be NULL if len is 0)
+ * @param  len     Length of the payload, at most COMMLINK_MAX_PAYLOAD
+ * @return         0 if the message was sent, not 0 if it could not be (window full or invalid arguments)
+ */
+int commlink_send_reliable(unsigned char opcode, const unsigned char * payload, unsigned int len);
+
+/**
+ * @brief Processes a received frame: handles acks, suppresses duplicates and strips the reliability header
+ * @param  frame View of the received frame, narrowed so that reliable messages look like ordinary ones (the frame itself is not modified)
+ * @return       true if the frame should be delivered to the game, false if it was consumed by the link (acks and duplicates)
+ */
+bool commlink_receive(SerialFrameView * frame);
+
+/**
+ * @brief Advances the link clock by one tick: sends pending acks and retransmits timed out messages. To be called once per timer tick
+ */
+void commlink_tick();
+
+/**
+ * @brief Gets the number of messages sent reliably that were not yet acknowledged
+ * @return Number of messages in flight
+ */
+unsigned int commlink_get_in_flight();
+
+/**
+ * @brief Gets the smoothed round trip time
+ * @return Smoothed RTT in ticks, 0 if no RTT was measured yet
+ */
+double commlink_get_srtt();
+
+/**
+ * @brief Gets the current retransmit timeout
+ * @return Retransmit timeout in ticks
+ */
+unsigned int commlink_get_rto();
+
+/**
+ * @brief Gets the statistics of the link
+ * @return Pointer to the (read only) statistics
+ */
+const CommLinkStats * commlink_get_stats();
+
+/** @} */
+
+#endif /* __COMMLINK_H */
@@ -0,0 +1,220 @@
+#include "epoch.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+//Days from 0000/03/01 to 2000/01/01, counted in the same way as the days of a date
+#define DAYS_TO_2000 730425
+#define DAYS_PER_ERA 146097 /* Days in 400 years, after which the calendar repeats */
+//Prints at most these mismatches, the rest are only counted
+#define SELFTEST_MAX_PRINTED 20
+
+//Date formatted the last time, reused while the day does not change
+static unsigned long formatted_day = EPOCH_INVALID_DAY;
+static char formatted_date[EPOCH_DATE_STRING_LENGTH];
+
+static unsigned long days_from_civil(unsigned long year, unsigned long month, unsigned long day) {
+  //Counting years from March, so that the leap day is the last day of the year
+  year -= month <= 2;
+  unsigned long era = year / 400;
+  unsigned long year_of_era = year - era * 400;
+  unsigned long day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  unsigned long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * DAYS_PER_ERA + day_of_era - DAYS_TO_2000;
+}
+
+void epoch_civil_from_days(unsigned long days, unsigned long * year, unsigned long * month, unsigned long * day) {
+  unsigned long z = days + DAYS_TO_2000;
+  unsigned long era = z / DAYS_PER_ERA;
+  unsigned long day_of_era = z - era * DAYS_PER_ERA;
+  unsigned long year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+  unsigned long day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  //Month counted from March
+  unsigned long mp = (5 * day_of_year + 2) / 153;
+  *day = day_of_year - (153 * mp + 2) / 5 + 1;
+  *month = mp < 10 ? mp + 3 : mp - 9;
+  *year = year_of_era + era * 400 + (*month <= 2);
+}
+
+unsigned long epoch_days_from_civil(unsigned long year, unsigned long month, unsigned long day) {
+  if(year < 100) {
+    year += 2000;
+  }
+  if(year < 2000 || month < 1 || month > 12 || day < 1 || day > 31) {
+    return EPOCH_INVALID_DAY;
+  }
+
+  //A day past the end of its month (such as 2018/02/30) comes back as a day of the next one
+  unsigned long days = days_from_civil(year, month, day);
+  unsigned long y, m, d;
+  epoch_civil_from_days(days, &y, &m, &d);
+  if(d != day) {
+    return EPOCH_INVALID_DAY;
+  }
+
+  return days;
+}
+
+unsigned long epoch_from_civil(unsigned long year, unsigned long month, unsigned long day, unsigned long hour, unsigned long minute, unsigned long second) {
+  unsigned long days = epoch_days_from_civil(year, month, day);
+  if(days == EPOCH_INVALID_DAY || days >= EPOCH_DAYS || hour > 23 || minute > 59 || second > 59) {
+    return EPOCH_INVALID_TIME;
+  }
+
+  return days * EPOCH_SECONDS_PER_DAY + hour * 3600 + minute * 60 + second;
+}
+
+void epoch_format_date(unsigned long t, char * str) {
+  unsigned long days = t / EPOCH_SECONDS_PER_DAY;
+  if(days != formatted_day) {
+    unsigned long year, month, day;
+    epoch_civil_from_days(days, &year, &month, &day);
+    sprintf(formatted_date, "%04lu/%02lu/%02lu", year % 10000, month, day);
+    formatted_day = days;
+  }
+
+  strcpy(str, formatted_date);
+}
+
+void epoch_format_time(unsigned long t, char * str) {
+  epoch_format_duration(t % EPOCH_SECONDS_PER_DAY, str);
+}
+
+void epoch_format(unsigned long t, char * str) {
+  epoch_format_date(t, str);
+  str[EPOCH_DATE_STRING_LENGTH - 1] = ' ';
+  epoch_format_time(t, str + EPOCH_DATE_STRING_LENGTH);
+}
+
+void epoch_format_duration(unsigned long seconds, char * str) {
+  //Up to 999 hours, more than that is shown as 999:59:59 (the string has room for 3 digits of hours)
+  if(seconds > 999 * 3600UL + 3599) {
+    seconds = 999 * 3600UL + 3599;
+  }
+  sprintf(str, "%02lu:%02lu:%02lu", seconds / 3600, seconds / 60 % 60, seconds % 60);
+}
+
+///Reference implementation, only used by the selftest
+
+static bool reference_is_leap(unsigned long year) {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static unsigned long reference_days_in_month(unsigned long year, unsigned long month) {
+  static const unsigned long days_in_month[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  return days_in_month[month - 1] + (month == 2 && reference_is_leap(year));
+}
+
+//Walks whole years and then whole months from 2000/01/01
+static void reference_civil_from_days(unsigned long days, unsigned long * year, unsigned long * month, unsigned long * day) {
+  *year = 2000;
+  while(days >= (reference_is_leap(*year) ? 366 : 365)) {
+    days -= reference_is_leap(*year) ? 366 : 365;
+    (*year)++;
+  }
+  *month = 1;
+  while(days >= reference_days_in_month(*year, *month)) {
+    days -= reference_days_in_month(*year, *month);
+    (*month)++;
+  }
+  *day = days + 1;
+}
+
+static void reference_format(unsigned long t, char * str) {
+  unsigned long year, month, day;
+  reference_civil_from_days(t / EPOCH_SECONDS_PER_DAY, &year, &month, &day);
+  unsigned long second_of_day = t % EPOCH_SECONDS_PER_DAY;
+  sprintf(str, "%04lu/%02lu/%02lu %02lu:%02lu:%02lu", year, month, day, second_of_day / 3600, second_of_day / 60 % 60, second_of_day % 60);
+}
+
+static unsigned long mismatches;
+
+static void report_mismatch(const char * what, unsigned long value, const char * got, const char * expected) {
+  if(mismatches < SELFTEST_MAX_PRINTED) {
+    printf("epoch_selftest::%s of %lu is %s, should be %s\n", what, value, got, expected);
+  }
+  mismatches++;
+}
+
+//Checks formatting a time, and converting the date and time it formats to back to it
+static void check_time(unsigned long t) {
+  char got[EPOCH_STRING_LENGTH];
+  char expected[EPOCH_STRING_LENGTH];
+  epoch_format(t, got);
+  reference_format(t, expected);
+  if(strcmp(got, expected) != 0) {
+    report_mismatch("Formatting", t, got, expected);
+    return;
+  }
+
+  unsigned long year, month, day, hour, minute, second;
+  sscanf(expected, "%lu/%lu/%lu %lu:%lu:%lu", &year, &month, &day, &hour, &minute, &second);
+  unsigned long back = epoch_from_civil(year, month, day, hour, minute, second);
+  if(back != t) {
+    char back_str[EPOCH_STRING_LENGTH];
+    sprintf(back_str, "%lu", back);
+    report_mismatch("Converting back", t, back_str, "the same");
+  }
+}
+
+unsigned long epoch_selftest(unsigned long n_random) {
+  mismatches = 0;
+  char got[EPOCH_STRING_LENGTH];
+  char expected[EPOCH_STRING_LENGTH];
+
+  //Every day, walking the calendar one day at a time
+  unsigned long year = 2000, month = 1, day = 1;
+  unsigned long days;
+  for(days = 0; days < EPOCH_DAYS; days++) {
+    unsigned long y, m, d;
+    epoch_civil_from_days(days, &y, &m, &d);
+    if(y != year || m != month || d != day) {
+      sprintf(got, "%lu/%lu/%lu", y, m, d);
+      sprintf(expected, "%lu/%lu/%lu", year, month, day);
+      report_mismatch("Date of day", days, got, expected);
+    }
+    if(epoch_days_from_civil(year, month, day) != days) {
+      sprintf(got, "%lu", epoch_days_from_civil(year, month, day));
+      sprintf(expected, "%lu", days);
+      report_mismatch("Day of date", days, got, expected);
+    }
+
+    //The seconds around midnight, where the day (and month and year) changes
+    if(days > 0) {
+      check_time(days * EPOCH_SECONDS_PER_DAY - 1);
+    }
+    check_time(days * EPOCH_SECONDS_PER_DAY);
+
+    day++;
+    if(day > reference_days_in_month(year, month)) {
+      //The day after the last of the month is not a valid date
+      if(epoch_days_from_civil(year, month, day) != EPOCH_INVALID_DAY) {
+        sprintf(got, "%lu", epoch_days_from_civil(year, month, day));
+        report_mismatch("Day of a day past the end of its month, on day", days, got, "not valid");
+      }
+      day = 1;
+      month++;
+      if(month > 12) {
+        month = 1;
+        year++;
+      }
+    }
+  }
+
+  //Random times, with 32 random bits each (rand may only give 15)
+  unsigned long i;
+  for(i = 0; i < n_random; i++) {
+    unsigned long t = (((unsigned long) rand() << 30) ^ ((unsigned long) rand() << 15) ^ (unsigned long) rand()) & 0xFFFFFFFF;
+    check_time(t % (EPOCH_DAYS * EPOCH_SECONDS_PER_DAY));
+  }
+
+  //Durations keep counting hours past a day
+  epoch_format_duration(EPOCH_SECONDS_PER_DAY + 1, got);
+  if(strcmp(got, "24:00:01") != 0) {
+    report_mismatch("Formatting the duration", EPOCH_SECONDS_PER_DAY + 1, got, "24:00:01");
+  }
+
+  printf("epoch_selftest::%lu days and %lu random times checked, %lu mismatches\n", (unsigned long) EPOCH_DAYS, n_random, mismatches);
+  return mismatches;
+}
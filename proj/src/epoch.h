@@ -0,0 +1,95 @@
+#ifndef __EPOCH_H
+#define __EPOCH_H
+
+/** @defgroup epoch epoch
+ * @{
+ *
+ * Time as a count of seconds since 2000/01/01 00:00:00, converted to and from calendar fields without walking months or years
+ */
+
+/*
+ * The RTC only keeps the last 2 digits of the year, so no date it gives is before 2000: the seconds since then fit in 32 bits until 2136.
+ * Durations (such as the time taken to finish a level) are counted in the same way, from 0, so adding a second is just adding 1
+ * and the time between two dates is just a subtraction.
+ * Days are converted with days_from_civil and civil_from_days (by Howard Hinnant): years are counted from March, so that the leap day is the
+ * last day of the year, and every step is a fixed number of divisions, whatever the date.
+ * Formatting a date only converts the day if it is not the one formatted the last time (the date shown changes once a day, the time every second).
+ */
+
+#define EPOCH_SECONDS_PER_DAY     86400UL
+#define EPOCH_INVALID_DAY         0xFFFFFFFF /* Day of a date that is not valid (or before 2000) */
+#define EPOCH_INVALID_TIME        0xFFFFFFFF
+#define EPOCH_DAYS                49710 /* Days up to 2136/02/06, the last whose seconds fit in 32 bits */
+#define EPOCH_DATE_STRING_LENGTH  11 /* YYYY/MM/DD and the null terminator */
+#define EPOCH_TIME_STRING_LENGTH  12 /* HH:MM:SS and the null terminator, with room for durations of 100 hours or more */
+#define EPOCH_STRING_LENGTH       (EPOCH_DATE_STRING_LENGTH + EPOCH_TIME_STRING_LENGTH)
+
+/**
+ * @brief Converts a date to the number of days since 2000/01/01
+ * @param  year  Year, either full (2018) or since 2000 (18)
+ * @param  month Month, from 1 to 12
+ * @param  day   Day of the month, from 1
+ * @return       Days since 2000/01/01, or EPOCH_INVALID_DAY if the date is not valid (or before 2000)
+ */
+unsigned long epoch_days_from_civil(unsigned long year, unsigned long month, unsigned long day);
+
+/**
+ * @brief Converts a number of days since 2000/01/01 to a date
+ * @param days  Days since 2000/01/01
+ * @param year  Where to return the full year
+ * @param month Where to return the month, from 1 to 12
+ * @param day   Where to return the day of the month, from 1
+ */
+void epoch_civil_from_days(unsigned long days, unsigned long * year, unsigned long * month, unsigned long * day);
+
+/**
+ * @brief Converts a date and time to seconds since 2000/01/01 00:00:00
+ * @param  year   Year, either full or since 2000
+ * @param  month  Month, from 1 to 12
+ * @param  day    Day of the month, from 1
+ * @param  hour   Hour, from 0 to 23
+ * @param  minute Minute, from 0 to 59
+ * @param  second Second, from 0 to 59
+ * @return        Seconds since 2000/01/01 00:00:00, EPOCH_INVALID_TIME if the date or time is not valid
+ */
+unsigned long epoch_from_civil(unsigned long year, unsigned long month, unsigned long day, unsigned long hour, unsigned long minute, unsigned long second);
+
+/**
+ * @brief Formats the date of a time as YYYY/MM/DD
+ * @param t   Seconds since 2000/01/01 00:00:00
+ * @param str Where to write the date, with room for EPOCH_DATE_STRING_LENGTH characters
+ */
+void epoch_format_date(unsigned long t, char * str);
+
+/**
+ * @brief Formats the time of the day of a time as HH:MM:SS
+ * @param t   Seconds since 2000/01/01 00:00:00
+ * @param str Where to write the time, with room for EPOCH_TIME_STRING_LENGTH characters
+ */
+void epoch_format_time(unsigned long t, char * str);
+
+/**
+ * @brief Formats a time as YYYY/MM/DD HH:MM:SS
+ * @param t   Seconds since 2000/01/01 00:00:00
+ * @param str Where to write the date and time, with room for EPOCH_STRING_LENGTH characters
+ */
+void epoch_format(unsigned long t, char * str);
+
+/**
+ * @brief Formats a duration as HH:MM:SS (the hours are not wrapped around to a day)
+ * @param seconds Duration in seconds
+ * @param str     Where to write the duration, with room for EPOCH_TIME_STRING_LENGTH characters
+ */
+void epoch_format_duration(unsigned long seconds, char * str);
+
+/**
+ * @brief Checks the conversions and formatting against a straightforward implementation (that walks the calendar a year and a month at a time): every day
+ * until EPOCH_DAYS, the days after the last of each month (not valid), the seconds around midnight of each day, and random times, printing every mismatch found
+ * @param  n_random Number of random times to check
+ * @return          Number of mismatches found (0 if everything matched)
+ */
+unsigned long epoch_selftest(unsigned long n_random);
+
+/** @} */
+
+#endif /* __EPOCH_H */
@@ -4,18 +4,60 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h> /* for tolower */
+#include <stdbool.h>
 #include "bitmap.h"
+#include "utilities.h"
 
-void string_to_screen (char * text, char * font , int x , int y) {
+#define FONT_MAX_CHARACTERS 64 /* Characters of a string drawn at once, the rest are left out */
+
+//Writes the path of the bitmap of a character of a font to address (a character with no file, like '?', gets a path that does not exist, so the question mark is used)
+static void glyph_address(char * address, const char * font, char c) {
+  //Base address
+  strcpy(address, "/home/Robinix/res/img/fonts/");
+
+  //Concatenating passed font
+  strcat(address, font);
+  strcat(address, "/");
+
+  //Because we need to consider special symbols (they have no representation in file names)
+  if(c == '/') {
+    strcat(address, "slash");
+  } else if(c == ':') {
+    strcat(address, "colon");
+  } else if(c == '.'){
+    strcat(address, "dot");
+  } else if(c == '?') {
+    //The case where no matching bmp is found is the one where ? is drawn so there is no need to allocate a special bitmap just for that
+    //Just pass in a random filename
+    strcat(address, "random_string");
+  } else {
+    //If letter is uppercase
+    if(c >= 'A' && c <= 'Z') {
+      c = tolower((unsigned char)c);
+      //Because strcat must receive a null terimanted string, we generate one temporarily in order to concatenate the symbol
+      strcat(address, (char[2]) { c, '\0' });
+      strcat(address, "_caps");
+    } else {
+      //If letter is lowercase
+      //Because strcat must receive a null terimanted string, we generate one temporarily in order to concatenate the symbol
+      strcat(address, (char[2]) { c, '\0' });
+    }
+  }
+  //Adding file termination
+  strcat(address, ".bmp");
+}
+
+//Composes the bitmap of a string, in the frame arena if in_frame is true (see createFrameBitmap)
+static Bitmap * compose_string(const char * text, const char * font, bool in_frame) {
   if(text == NULL || strlen(text) == 0 || font == NULL || strlen(font) == 0) {
-    return;
+    return NULL;
   }
 
   //Failsafe for strcat'ing question mark address (to avoid writing off the limit of the char array)
   //(46 is the size of the base address in which the font name is inserted)
   if(strlen(font) + 46 > 70) {
     printf("Debug: Font exceeds question mark address character limit\n");
-    return;
+    return NULL;
   }
 
   //Fallback question mark character
@@ -32,80 +74,74 @@ void string_to_screen (char * text, char * font , int x , int y) {
   if(question_mark_bmp == NULL) {
     //Load not possible, it is considered that the font does not exist because we always need a failsafe character to print
     //No need to free question_mark_address string since it is stack allocated
-    return;
+    return NULL;
   }
 
   //No need to free question_mark_address string since it is stack allocated
 
-  int s_size = strlen(text);
-  Bitmap* bmp;
+  int s_size = MIN_VAL(strlen(text), FONT_MAX_CHARACTERS);
+  //Bitmap of each character (NULL for spaces), loaded first to know the size of the whole string
+  Bitmap * glyphs[FONT_MAX_CHARACTERS];
   char address[70];
+  int width = 0;
+  int height = question_mark_bmp->bitmapInfoHeader.height;
   int i;
 
-  //Some fonts are lowercase only, list them here to convert all the text to lowercase
-  if(strncmp(font, "codebold-36", strlen("codebold-36")) == 0 || strncmp(font, "monofonto-22", strlen("monofonto-22")) == 0) {
-    for(i = 0; i < s_size; i++) {
-      text[i] = tolower((unsigned char)text[i]);
+  //Some fonts are lowercase only, list them here to convert all the text to lowercase (the passed string is left as it is)
+  bool lowercase_only = strncmp(font, "codebold-36", strlen("codebold-36")) == 0 || strncmp(font, "monofonto-22", strlen("monofonto-22")) == 0;
+
+  for (i = 0; i < s_size; i++) {
+    char c = lowercase_only ? tolower((unsigned char)text[i]) : text[i];
+
+    //If the text is just a space, then there is nothing to draw, just its width
+    if(c == ' ') {
+      glyphs[i] = NULL;
+      width += question_mark_bmp->bitmapInfoHeader.width;
+      continue;
     }
+
+    glyph_address(address, font, c);
+
+    //Attempting to load the bitmap, if the bmp is NULL then the path was not found and the fallback sprite is the question mark
+    glyphs[i] = loadBitmap(address);
+    Bitmap * glyph = glyphs[i] == NULL ? question_mark_bmp : glyphs[i];
+    width += glyph->bitmapInfoHeader.width;
+    height = MAX_VAL(height, glyph->bitmapInfoHeader.height);
   }
 
+  Bitmap * result = in_frame ? createFrameBitmap(width, height) : createTransparentBitmap(width, height);
+
+  int x = 0;
   for (i = 0; i < s_size; i++) {
-    //If the text is just a space, then just increase the x variable and be done with it
-    if(text[i] == ' ') {
+    if(glyphs[i] == NULL && text[i] == ' ') {
       x += question_mark_bmp->bitmapInfoHeader.width;
       continue;
     }
 
-    //Base address
-    strcpy(address, "/home/Robinix/res/img/fonts/");
-
-    //Concatenating passed font
-    strcat(address, font);
-    strcat(address, "/");
-
-    //Because we need to consider special symbols (they have no representation in file names)
-    if(text[i] == '/') {
-      strcat(address, "slash");
-    } else if(text[i] == ':') {
-      strcat(address, "colon");
-    } else if(text[i] == '.'){
-      strcat(address, "dot");
-    } else if(text[i] == '?') {
-      //The case where no matching bmp is found is the one where ? is drawn so there is no need to allocate a special bitmap just for that
-      //Just pass in a random filename
-      strcat(address, "random_string");
-    } else {
-      //If letter is uppercase
-      if(text[i] >= 'A' && text[i] <= 'Z') {
-        text[i] = tolower((unsigned char)text[i]);
-        //Because strcat must receive a null terimanted string, we generate one temporarily in order to concatenate the symbol
-        strcat(address, (char[2]) { text[i], '\0' });
-        strcat(address, "_caps");
-      } else {
-        //If letter is lowercase
-        //Because strcat must receive a null terimanted string, we generate one temporarily in order to concatenate the symbol
-        strcat(address, (char[2]) { text[i], '\0' });
-      }
-    }
-    //Adding file termination
-    strcat(address, ".bmp");
-
-    //Attempting to load the bitmap
-    bmp = loadBitmap(address);
-    //If the bmp is NULL then the path was not found
-    if (bmp == NULL) {
-      //The fallback sprite is the question mark
-      drawBitmap(question_mark_bmp, x, y);
-      x += question_mark_bmp->bitmapInfoHeader.width;
-    } else {
-      drawBitmap(bmp,x,y);
-      x += bmp->bitmapInfoHeader.width;
-      //Only if the bitmap was allocated should it need to be freed
-      deleteBitmap(bmp);
-      bmp = NULL;
-    }
+    Bitmap * glyph = glyphs[i] == NULL ? question_mark_bmp : glyphs[i];
+    drawBitmapIntoBitmap(result, glyph, x, 0);
+    x += glyph->bitmapInfoHeader.width;
+    //Only if the bitmap was allocated should it need to be freed
+    deleteBitmap(glyphs[i]);
   }
 
   deleteBitmap(question_mark_bmp);
   question_mark_bmp = NULL;
+
+  return result;
+}
+
+Bitmap * string_to_bitmap (const char * text, const char * font) {
+  return compose_string(text, font, false);
+}
+
+void string_to_screen (char * text, char * font , int x , int y) {
+  //Only needed until it is drawn
+  Bitmap * bmp = compose_string(text, font, true);
+  if(bmp == NULL) {
+    return;
+  }
+
+  drawBitmap(bmp, x, y);
+  deleteFrameBitmap(bmp);
 }
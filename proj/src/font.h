@@ -1,6 +1,8 @@
 #ifndef _FONT_H
 #define _FONT_H
 
+#include "bitmap.h"
+
 /** @defgroup font font
  * @{
  *
@@ -13,6 +15,14 @@
 //monofonto-18 - Monofonto, 18px, only has number and /, : and . (no lower or uppercase letters)
 //monofonto-22 - Monofonto, 22px, has /, : and . lowercase only - really uppercase
 
+/**
+ * @brief Renders given string in given font into a new bitmap, to be drawn as many times as needed without loading the font again
+ * @param string String to render
+ * @param font   The font to render the string in
+ * @return       Bitmap with the string (transparent around the characters), NULL if the string is empty or the font does not exist
+ */
+Bitmap * string_to_bitmap (const char * string, const char * font);
+
 /**
  * @brief Draws given string in given font at given coordinates
  * @param string String to display in screen
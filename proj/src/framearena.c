@@ -0,0 +1,135 @@
+#include "framearena.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilities.h"
+
+#define NO_BLOCK 0xFFFFFFFF
+
+typedef struct {
+  //Bytes asked for
+  unsigned int size;
+  //Offset of the header of the block under it, NO_BLOCK if it is the first
+  unsigned int prev;
+  bool freed;
+} FrameBlock;
+
+static unsigned char * arena = NULL;
+static FrameArenaStats stats;
+//Offset of the header of the block on top
+static unsigned int last = NO_BLOCK;
+
+static unsigned int round_up(unsigned int size) {
+  return (size + FRAMEARENA_ALIGNMENT - 1) & ~(FRAMEARENA_ALIGNMENT - 1);
+}
+
+static FrameBlock * get_block(unsigned int offset) {
+  return (FrameBlock *) (arena + offset);
+}
+
+int framearena_init(unsigned int size) {
+  framearena_destroy();
+  memset(&stats, 0, sizeof stats);
+
+  arena = malloc(size);
+  if(arena == NULL) {
+    printf("framearena_init::Could not allocate %u bytes\n", size);
+    return 1;
+  }
+
+  stats.size = size;
+  return 0;
+}
+
+void framearena_destroy() {
+  free(arena);
+  arena = NULL;
+  last = NO_BLOCK;
+  stats.size = 0;
+  stats.used = 0;
+}
+
+void * framearena_alloc(unsigned int size) {
+  stats.allocations++;
+
+  unsigned int header_size = round_up(sizeof(FrameBlock));
+  void * ptr;
+  //Checking the size first, so that rounding it up can not overflow
+  if(arena == NULL || size > stats.size || header_size + round_up(size) > stats.size - stats.used) {
+    stats.fallbacks++;
+    ptr = malloc(size);
+  } else {
+    FrameBlock * block = get_block(stats.used);
+    block->size = size;
+    block->prev = last;
+    block->freed = false;
+    last = stats.used;
+    stats.used += header_size + round_up(size);
+    stats.high_water = MAX_VAL(stats.high_water, stats.used);
+    ptr = arena + last + header_size;
+  }
+
+#ifdef FRAMEARENA_DEBUG
+  if(ptr != NULL) {
+    memset(ptr, FRAMEARENA_FRESH_BYTE, size);
+  }
+#endif
+
+  return ptr;
+}
+
+void * framearena_calloc(unsigned int size) {
+  void * ptr = framearena_alloc(size);
+  if(ptr != NULL) {
+    memset(ptr, 0, size);
+  }
+  return ptr;
+}
+
+void framearena_free(void * ptr) {
+  if(ptr == NULL) {
+    return;
+  }
+
+  //Not in the arena, so it came from malloc
+  if(arena == NULL || (unsigned char *) ptr < arena || (unsigned char *) ptr >= arena + stats.size) {
+    free(ptr);
+    return;
+  }
+
+  FrameBlock * block = (FrameBlock *) ((unsigned char *) ptr - round_up(sizeof(FrameBlock)));
+#ifdef FRAMEARENA_DEBUG
+  if(block->freed) {
+    printf("framearena_free::Block at offset %u freed twice\n", (unsigned int) ((unsigned char *) block - arena));
+  }
+  memset(ptr, FRAMEARENA_POISON_BYTE, block->size);
+#endif
+  block->freed = true;
+
+  //Moving the top back past every freed block on it
+  while(last != NO_BLOCK && get_block(last)->freed) {
+    stats.used = last;
+    last = get_block(last)->prev;
+  }
+}
+
+void framearena_reset() {
+#ifdef FRAMEARENA_DEBUG
+  if(arena != NULL) {
+    memset(arena, FRAMEARENA_POISON_BYTE, stats.used);
+  }
+#endif
+
+  stats.used = 0;
+  stats.resets++;
+  last = NO_BLOCK;
+}
+
+const FrameArenaStats * framearena_get_stats() {
+  return &stats;
+}
+
+void framearena_print_stats() {
+  printf("framearena::%u of %u bytes used at most, %lu allocations (%lu from malloc, for not fitting), %lu resets\n", stats.high_water, stats.size, stats.allocations, stats.fallbacks, stats.resets);
+}
@@ -0,0 +1,89 @@
+#ifndef __FRAMEARENA_H
+#define __FRAMEARENA_H
+
+#include <stdbool.h>
+
+/** @defgroup framearena framearena
+ * @{
+ *
+ * Frame arena: memory for allocations that do not outlive a tick (events, collision buffers, text drawn once), taken from a single block by moving a pointer
+ */
+
+/*
+ * Allocating only moves the top of the arena forward, past a small header with the size of the block and where the one before it starts.
+ * Freeing the block on top moves the top back to its start (and past the blocks under it that were already freed), so that the usual
+ * allocate, use and free straight away does not use the arena up. Blocks freed out of order only go back to the arena when the ones over them do,
+ * or when the game loop resets the arena once per tick, right after the events are processed: by then nothing allocated in the previous tick is in use
+ * (the events the update created are the last ones, and were just processed). So anything allocated in it must not be kept past that point.
+ * When the arena is full (or was not created) memory comes from malloc instead, and framearena_free frees it, so running out of room is not an error.
+ * Compiled with FRAMEARENA_DEBUG defined, memory handed out is filled with FRAMEARENA_FRESH_BYTE and memory given back with FRAMEARENA_POISON_BYTE,
+ * so that reading something before writing it, or after freeing it, shows.
+ */
+
+#define FRAMEARENA_ALIGNMENT          8 /* Every block starts at a multiple of it */
+#define FRAMEARENA_EXTRA_SIZE         (256 * 1024) /* Room on top of a screen sized buffer (for the collision checks), in bytes */
+#define FRAMEARENA_FRESH_BYTE         0xCD
+#define FRAMEARENA_POISON_BYTE        0xDD
+
+typedef struct {
+  unsigned int size;
+  unsigned int used;
+  //Most bytes used at once since the arena was created
+  unsigned int high_water;
+  unsigned long allocations;
+  //Allocations that did not fit and came from malloc
+  unsigned long fallbacks;
+  unsigned long resets;
+} FrameArenaStats;
+
+/**
+ * @brief Creates the arena, clearing the statistics
+ * @param  size Bytes the arena has room for
+ * @return      0 if successful, not 0 otherwise (every allocation comes from malloc then)
+ */
+int framearena_init(unsigned int size);
+
+/**
+ * @brief Frees the arena, after which every allocation comes from malloc
+ */
+void framearena_destroy();
+
+/**
+ * @brief Allocates memory that is valid until it is freed or the arena is reset
+ * @param  size Bytes to allocate
+ * @return      Pointer to the memory, NULL if it could not be allocated
+ */
+void * framearena_alloc(unsigned int size);
+
+/**
+ * @brief Allocates memory like framearena_alloc, with every byte set to 0
+ * @param  size Bytes to allocate
+ * @return      Pointer to the memory, NULL if it could not be allocated
+ */
+void * framearena_calloc(unsigned int size);
+
+/**
+ * @brief Frees memory allocated by framearena_alloc or framearena_calloc (before the arena is reset)
+ * @param ptr Memory to free (nothing is done if NULL)
+ */
+void framearena_free(void * ptr);
+
+/**
+ * @brief Gives every block allocated in the arena back to it, to be called once per tick
+ */
+void framearena_reset();
+
+/**
+ * @brief Gets how much of the arena is used and how often it ran out of room
+ * @return Statistics since the arena was created
+ */
+const FrameArenaStats * framearena_get_stats();
+
+/**
+ * @brief Prints the statistics of the arena
+ */
+void framearena_print_stats();
+
+/** @} */
+
+#endif /* __FRAMEARENA_H */
@@ -10,6 +10,14 @@
 #include "robinix.h"
 #include "rtc.h"
 #include "uart.h"
+#include "transport.h"
+#include "gameloop.h"
+#include "gameclock.h"
+#include "framearena.h"
+#include "governor.h"
+#include "headless.h"
+#include "profiler.h"
+#include "trace.h"
 #include "font.h"
 #include "scoremanager.h"
 
@@ -24,6 +32,36 @@ Robinix * get_rob() {
   return rob;
 }
 
+//Ends the game once the game loop has started, returning the passed errorlevel (or, if it is 0, the first error while ending it)
+static int quit_game(int errorlevel) {
+  //Setting the timer back to its usual frequency first, as it is the system clock timer
+  gameloop_stop();
+
+  //Unsubscribing from the peripherals
+  if(unsubscribe_peripherals(rob) != UNSUBS_OK){
+    printf("video_test_play::Error unsubscribing peripherals!");
+    if(errorlevel == 0){
+      errorlevel = -8;
+    }
+  }
+
+  //Destroying game object
+  //Passing address so the pointer can be set to null upon deallocation
+  destroy_robinix(&rob);
+  //Only after the Robinix, whose events might still be in it
+  framearena_destroy();
+
+  //Exiting video mode
+  if(vg_exit() != 0){
+    printf("video_test_play::Error exiting video mode\n");
+    if(errorlevel == 0){
+      errorlevel = -9;
+    }
+  }
+
+  return errorlevel;
+}
+
 int play_game() {
   //Setting the video mode
   if(vg_init(GAME_VIDEO_MODE) == NULL){
@@ -31,6 +69,11 @@ int play_game() {
     return -1;
   }
 
+  //Transient allocations (the collision checks need a buffer the size of the screen)
+  if(framearena_init(getVramSize() + FRAMEARENA_EXTRA_SIZE) != 0){
+    printf("video_test_play::Error creating the frame arena, transient allocations will come from malloc\n");
+  }
+
   //Creating the "game state object"
   rob = create_robinix();
 
@@ -46,6 +89,21 @@ int play_game() {
     return -3;
   }
 
+  //Starting the game clock, measuring the time stamp counter against it
+  if(gameclock_init() != 0){
+    printf("video_test_play::Error measuring the time stamp counter, the clock will only count whole timer interrupts\n");
+  }
+
+  if(profiler_init() != 0){
+    printf("video_test_play::Error initializing the profiler, frames will not be timed\n");
+  }
+
+  //Timer interrupts drive the game loop from now on
+  if(gameloop_start() != 0){
+    printf("video_test_play::Error starting the game loop!");
+    return quit_game(-3);
+  }
+
   //Interrupt loop variables
   int driver_receive_errorlevel;
   int ipcStatus;
@@ -66,43 +124,60 @@ int play_game() {
      switch (_ENDPOINT_P(msg.m_source)){
        //In the case that the notification is sent by the hardware
        case HARDWARE:
+         //When the notification arrived, with every interrupt it is for
+         trace_instant("notification", TRACE_CAT_IRQ, msg.NOTIFY_ARG);
        //Verifying if the interrupt received is the keyboard interrupt, by using the irq bitmask previously created
          if(msg.NOTIFY_ARG & rob->keyboard_irq_bitmask) {
            //Executing keyboard IH
-           if(keyboard_IH() != 0){
+           trace_begin("keyboard IH", TRACE_CAT_IRQ);
+           int keyboard_result = keyboard_IH();
+           trace_end("keyboard IH", TRACE_CAT_IRQ);
+           if(keyboard_result != 0){
               printf("video_test_play::Error in keyboard IH\n");
-              return -5;
+              return quit_game(-5);
            }
          }
 
          //Verifying if the interrupt received is the keyboard interrupt, by using the irq bitmask previously created
          if(msg.NOTIFY_ARG & rob->mouse_irq_bitmask) {
            //Executing mouse IH
-           if(mouse_IH() != 0) {
+           trace_begin("mouse IH", TRACE_CAT_IRQ);
+           int mouse_result = mouse_IH();
+           trace_end("mouse IH", TRACE_CAT_IRQ);
+           if(mouse_result != 0) {
              printf("video_test_play::Error in mouse IH\n");
-             return -6;
+             return quit_game(-6);
            }
          }
          //Verifying if the interrupt received is the timer interrupt, by using the irq bitmask previously created
          if(msg.NOTIFY_ARG & rob->timer_irq_bitmask) {
+           trace_begin("timer IH", TRACE_CAT_IRQ);
            timer_IH();
+           trace_end("timer IH", TRACE_CAT_IRQ);
          }
 
          //Verifying if the interrupt received is the rtc interrupt, by using the irq bitmask previously created
          if(msg.NOTIFY_ARG & rob->rtc_irq_bitmask) {
            //Executing RTC IH
-           if(rtc_IH() != 0) {
+           trace_begin("rtc IH", TRACE_CAT_IRQ);
+           int rtc_result = rtc_IH();
+           trace_end("rtc IH", TRACE_CAT_IRQ);
+           if(rtc_result != 0) {
              printf("video_test_play::Error in RTC IH\n");
-             return -7;
+             return quit_game(-7);
            }
+           game_rtc_update(rob);
          }
 
          //Verifying if the interrupt received is an UART interrupt, by using the irq bitmask previously created
          if(msg.NOTIFY_ARG & rob->uart_irq_bitmask) {
            //Executing UART IH
-           if(uart_IH() != 0) {
+           trace_begin("uart IH", TRACE_CAT_IRQ);
+           int uart_result = uart_IH();
+           trace_end("uart IH", TRACE_CAT_IRQ);
+           if(uart_result != 0) {
               printf("video_test_play::Error in UART IH\n");
-              return -4;
+              return quit_game(-4);
            }
          }
          break;
@@ -113,24 +188,49 @@ int play_game() {
      }
    }
 
-  //Unsubscribing from the peripherals
-  if(unsubscribe_peripherals(rob) != UNSUBS_OK){
-    printf("video_test_play::Error unsubscribing peripherals!");
-    return -8;
+  gameloop_print_stats();
+  governor_print_stats();
+  gameclock_print_stats();
+  framearena_print_stats();
+
+  //Everything went as expected, unless ending the game does not
+  return quit_game(0);
+}
+
+int play_headless(int level, unsigned long n_ticks, unsigned long dump_every, const char * script_path) {
+  HeadlessScript script;
+  if(script_path == NULL) {
+    headless_default_script(&script);
+  } else if(headless_load_script(&script, script_path) != 0) {
+    return -1;
   }
 
-  //Destroying game object
-  //Passing address so the pointer can be set to null upon deallocation
-  destroy_robinix(&rob);
+  //The collision checks need the resolution of the game whether frames are dumped or not
+  if(vg_init_resolution(GAME_VIDEO_MODE) != 0) {
+    printf("play_headless::Error getting the resolution of the game\n");
+    return -2;
+  }
 
-  //Exiting video mode
-  if(vg_exit() != 0){
-    printf("video_test_play::Error exiting video mode\n");
-    return -9;
+  //Frames are only drawn to be dumped, into a buffer with the resolution of the game
+  if(dump_every != 0 && vg_init_headless(GAME_VIDEO_MODE) == NULL) {
+    printf("play_headless::Error initializing the video buffer\n");
+    return -2;
   }
 
-  //Everything went as expected
-  return 0;
+  //Sized like the collision check buffers, whose size is the one of the screen
+  if(framearena_init(getVramSize() + FRAMEARENA_EXTRA_SIZE) != 0) {
+    printf("play_headless::Error creating the frame arena, transient allocations will come from malloc\n");
+  }
+
+  int result = headless_run(level, n_ticks, dump_every, &script);
+  framearena_print_stats();
+  framearena_destroy();
+
+  if(dump_every != 0) {
+    vg_exit_headless();
+  }
+
+  return result == 0 ? 0 : -3;
 }
 
 int test_uart_tx(char * string) {
@@ -162,8 +262,9 @@ int test_uart_tx(char * string) {
   uart_get_conf();
   uart_get_rate();
 
-  //Requesting sending of the message passed
-  uart_send_string(string);
+  //Requesting sending of the message passed, as the payload of a raw frame (truncated if it does not fit in a single frame)
+  transport_send_frame(SERIALFRAME_OP_RAW, (unsigned char *) string, MIN_VAL(strlen(string), SERIALFRAME_MAX_PAYLOAD));
+  transport_flush();
 
   //Interrupt loop
   int driver_receive_errorlevel;
@@ -256,6 +357,12 @@ int test_uart_rx() {
                printf("test_uart_rx::Error in UART IH\n");
                return -4;
             }
+            //Printing every frame received (payload is printed as text since that is what the uart tx test sends)
+            SerialFrameView frame;
+            while(transport_peek_frame(&frame)) {
+              printf("Testing: Received frame with opcode %u and length %u through UART: \"%.*s\"\n", frame.opcode, frame.length, frame.length, (const char *) frame.payload);
+              transport_release_frame();
+            }
           }
           break;
           //No other type of notification is expected, so we do nothing
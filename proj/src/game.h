@@ -21,6 +21,16 @@ Robinix * get_rob();
  */
 int play_game();
 
+/**
+ * @brief Simulates the levels headless (see headless.h), without setting the video mode unless frames are to be dumped
+ * @param  level       Level to simulate, or 0 for every level
+ * @param  n_ticks     Ticks to simulate in each level
+ * @param  dump_every  Ticks between frames dumped, or 0 to draw nothing
+ * @param  script_path Path of the input script, or NULL to use the default one
+ * @return             0 if successful, not 0 otherwise
+ */
+int play_headless(int level, unsigned long n_ticks, unsigned long dump_every, const char * script_path);
+
 /**
  * @brief Tests Serial Port Transmission
  * @param  string The string to send via serial port
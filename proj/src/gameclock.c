@@ -0,0 +1,233 @@
+#include "gameclock.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <minix/syslib.h>
+#include <minix/sysutil.h>
+#include "i8254.h"
+#include "trace.h"
+#include "utilities.h"
+
+#define FS_PER_NS       1000000ULL
+#define NS_PER_SECOND   1000000000ULL
+//Femtoseconds in each period of the timers' clock input
+#define PIT_CLOCK_FS    (1000000000000000ULL / TIMER_FREQ)
+
+static GameClockStats stats;
+//The time returned the last time, so that it never goes back
+static unsigned long long last_ns = 0;
+//Start of the window being compared with the RTC (RTC updates in it so far, -1 if it was not started yet)
+static unsigned long long window_start_ns = 0;
+static int window_updates = -1;
+
+//Period of a timer interrupt, with the correction, in femtoseconds
+static unsigned long long period_fs = 0;
+//Time up to the last interrupt counted, and the femtoseconds counted that do not make a nanosecond yet
+static unsigned long long base_ns = 0;
+static unsigned long long carry_fs = 0;
+static clock_t last_uptime = 0;
+//Time stamp counter when the last timer interrupt was handled (none was if false)
+static unsigned long long interrupt_tsc = 0;
+static bool interrupt_handled = false;
+static bool initialized = false;
+
+static void update_period() {
+  //The divisor loaded into the timer, as timer_set_frequency calculates it
+  unsigned long long nominal_fs = (TIMER_FREQ / stats.timer_rate) * PIT_CLOCK_FS;
+  period_fs = nominal_fs + (long long) (nominal_fs / 1000000) * stats.correction_ppm;
+}
+
+//Adds the interrupts counted by Minix since the last time
+static void count_interrupts() {
+  clock_t now;
+  if(getuptime(&now) != OK) {
+    return;
+  }
+
+  unsigned long elapsed = now - last_uptime;
+  if(elapsed != 0) {
+    //The time since the last interrupt handled is now in base_ns, interpolating from it would count it twice (until the next one is handled)
+    interrupt_handled = false;
+  }
+  unsigned long long fs = elapsed * period_fs + carry_fs;
+  base_ns += fs / FS_PER_NS;
+  carry_fs = fs % FS_PER_NS;
+  last_uptime = now;
+  stats.interrupts += elapsed;
+}
+
+//Waits for the uptime to change, returning the new one
+static clock_t wait_next_clock_tick(clock_t uptime) {
+  clock_t now;
+  do {
+    if(getuptime(&now) != OK) {
+      return uptime;
+    }
+  } while(now == uptime);
+  return now;
+}
+
+//Measures the time stamp counter from the start of a timer interrupt to the start of another, so that whole interrupts are measured
+static unsigned long measure_tsc_rate() {
+  clock_t start;
+  if(getuptime(&start) != OK) {
+    return 0;
+  }
+
+  clock_t now = wait_next_clock_tick(start);
+  unsigned long long tsc_start = trace_read_tsc();
+  clock_t end = now + GAMECLOCK_CALIBRATION_INTERRUPTS;
+  while(now != end) {
+    clock_t next = wait_next_clock_tick(now);
+    if(next == now) {
+      return 0;
+    }
+    now = next;
+  }
+  unsigned long long cycles = trace_read_tsc() - tsc_start;
+
+  unsigned long us = GAMECLOCK_CALIBRATION_INTERRUPTS * period_fs / FS_PER_NS / 1000;
+  return cycles / us;
+}
+
+//Starts counting without measuring the time stamp counter, for when the clock is read before gameclock_init
+static void start_counting() {
+  memset(&stats, 0, sizeof stats);
+  //Minix's frequency, the timer is only set to another one by the game loop
+  stats.timer_rate = sys_hz();
+  update_period();
+  base_ns = 0;
+  carry_fs = 0;
+  last_ns = 0;
+  window_updates = -1;
+  interrupt_handled = false;
+  if(getuptime(&last_uptime) != OK) {
+    last_uptime = 0;
+  }
+  initialized = true;
+}
+
+int gameclock_init() {
+  start_counting();
+
+  stats.tsc_rate = measure_tsc_rate();
+  if(stats.tsc_rate == 0) {
+    printf("gameclock_init::Error measuring the time stamp counter\n");
+    return 1;
+  }
+
+  printf("gameclock_init::Time stamp counter at %lu MHz\n", stats.tsc_rate);
+  return 0;
+}
+
+void gameclock_set_timer_rate(unsigned long rate) {
+  if(!initialized) {
+    start_counting();
+  }
+
+  //Everything before this was at the previous frequency
+  count_interrupts();
+  stats.timer_rate = rate;
+  update_period();
+}
+
+void gameclock_timer_interrupt() {
+  if(!initialized) {
+    start_counting();
+  }
+
+  count_interrupts();
+  interrupt_tsc = trace_read_tsc();
+  interrupt_handled = true;
+}
+
+static unsigned long long read_clock_ns() {
+  if(!initialized) {
+    start_counting();
+  }
+
+  //Only the uptime is read (a kernel call) if the time stamp counter can not be used
+  if(interrupt_handled && stats.tsc_rate != 0) {
+    return base_ns + (trace_read_tsc() - interrupt_tsc) * 1000 / stats.tsc_rate;
+  }
+
+  count_interrupts();
+  return base_ns;
+}
+
+static void correct_period(long ppm) {
+  count_interrupts();
+  stats.correction_ppm = ppm;
+  update_period();
+}
+
+unsigned long long gameclock_now_ns() {
+  unsigned long long ns = read_clock_ns();
+  //Interpolating with the time stamp counter can get ahead of the next interrupt
+  if(ns < last_ns) {
+    return last_ns;
+  }
+
+  last_ns = ns;
+  return ns;
+}
+
+unsigned long gameclock_now_us() {
+  return (unsigned long) (gameclock_now_ns() / 1000);
+}
+
+unsigned long gameclock_now_ms() {
+  return (unsigned long) (gameclock_now_ns() / 1000000);
+}
+
+void gameclock_rtc_update() {
+  unsigned long long now = gameclock_now_ns();
+  stats.rtc_updates++;
+
+  if(window_updates < 0) {
+    window_start_ns = now;
+    window_updates = 0;
+    return;
+  }
+
+  window_updates++;
+  if(window_updates < GAMECLOCK_DISCIPLINE_SECONDS) {
+    return;
+  }
+
+  long long expected = GAMECLOCK_DISCIPLINE_SECONDS * NS_PER_SECOND;
+  long long counted = now - window_start_ns;
+  long error_ppm = (long) ((expected - counted) * 1000 / (expected / 1000));
+  window_start_ns = now;
+  window_updates = 0;
+  stats.last_error_ppm = error_ppm;
+
+  if(error_ppm > GAMECLOCK_MAX_ERROR_PPM || error_ppm < -GAMECLOCK_MAX_ERROR_PPM) {
+    stats.windows_rejected++;
+    return;
+  }
+
+  //Half of the difference, so that how late each update interrupt was handled does not make it swing
+  long ppm = stats.correction_ppm + error_ppm / 2;
+  ppm = MAX_VAL(MIN_VAL(ppm, GAMECLOCK_MAX_CORRECTION_PPM), -GAMECLOCK_MAX_CORRECTION_PPM);
+  correct_period(ppm);
+  stats.disciplines++;
+}
+
+unsigned long gameclock_get_interrupts() {
+  return stats.interrupts;
+}
+
+unsigned long gameclock_get_tsc_rate() {
+  return stats.tsc_rate;
+}
+
+const GameClockStats * gameclock_get_stats() {
+  return &stats;
+}
+
+void gameclock_print_stats() {
+  printf("gameclock::%lu ms, timer at %lu Hz (%lu interrupts), time stamp counter at %lu MHz\n", gameclock_now_ms(), stats.timer_rate, stats.interrupts, stats.tsc_rate);
+  printf("gameclock::%lu RTC updates, %lu windows compared (%lu left out), correction %ld ppm (last difference %ld ppm)\n", stats.rtc_updates, stats.disciplines, stats.windows_rejected, stats.correction_ppm, stats.last_error_ppm);
+}
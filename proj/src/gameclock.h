@@ -0,0 +1,108 @@
+#ifndef __GAMECLOCK_H
+#define __GAMECLOCK_H
+
+/** @defgroup gameclock gameclock
+ * @{
+ *
+ * Monotonic clock in nanoseconds shared by the whole game: counted in timer 0 interrupts at the frequency it was set to, interpolated
+ * in between them with the time stamp counter, and disciplined against the RTC update interrupts
+ */
+
+/*
+ * Minix counts every timer 0 interrupt in its uptime, whatever the frequency the timer was set to (sys_hz is only the frequency it starts with),
+ * so the clock keeps the period of the frequency set by timer_set_frequency (in femtoseconds, from the divisor actually loaded into the timer)
+ * and adds it for every interrupt counted since it last looked. The interrupts themselves are only counted once per timer interrupt handled
+ * (gameclock_timer_interrupt), and in between the time stamp counter, measured against the interrupts by gameclock_init, gives the time since the last one.
+ * The PIT crystal can be off by some parts per million, so every GAMECLOCK_DISCIPLINE_SECONDS RTC update interrupts (exactly one second apart) the time
+ * the clock counted is compared with the seconds that passed, and half of the difference is corrected in the period (up to GAMECLOCK_MAX_CORRECTION_PPM),
+ * a window with a difference too big to be drift (an update interrupt handled late or missed) being left out. The time returned never goes back.
+ * The simulation is still counted in ticks (see gameloop.h), so that both players of a multiplayer game simulate the same, this is for everything that needs real time:
+ * timing (profiler, benchmarks), animation and synchronization.
+ */
+
+#define GAMECLOCK_CALIBRATION_INTERRUPTS  6 /* Timer interrupts the time stamp counter is measured over (100 ms at Minix's 60 Hz) */
+#define GAMECLOCK_DISCIPLINE_SECONDS      240 /* RTC update interrupts in each window the clock is compared over */
+#define GAMECLOCK_MAX_CORRECTION_PPM      500
+#define GAMECLOCK_MAX_ERROR_PPM           2000 /* Windows with a bigger difference are left out */
+
+typedef struct {
+  //Frequency timer 0 is counted at
+  unsigned long timer_rate;
+  unsigned long interrupts;
+  //Time stamp counter increments per microsecond, 0 if not measured
+  unsigned long tsc_rate;
+  unsigned long rtc_updates;
+  //Windows compared with the RTC, and those left out
+  unsigned long disciplines;
+  unsigned long windows_rejected;
+  //Correction applied to the period, and difference found in the last window, in parts per million
+  long correction_ppm;
+  long last_error_ppm;
+} GameClockStats;
+
+/**
+ * @brief Starts the clock from 0 and measures the time stamp counter against it
+ * @return 0 if successful, not 0 if the time stamp counter could not be measured (the clock then only counts whole timer interrupts)
+ */
+int gameclock_init();
+
+/**
+ * @brief Tells the clock timer 0 was set to a new frequency, to be called by timer_set_frequency
+ * @param rate Frequency set, in Hz
+ */
+void gameclock_set_timer_rate(unsigned long rate);
+
+/**
+ * @brief Brings the count of timer interrupts up to date, to be called by every timer 0 interrupt handler
+ */
+void gameclock_timer_interrupt();
+
+/**
+ * @brief Compares the clock with the RTC, to be called on every RTC update interrupt
+ */
+void gameclock_rtc_update();
+
+/**
+ * @brief Gets the time since gameclock_init
+ * @return Time in nanoseconds, never less than the one returned before
+ */
+unsigned long long gameclock_now_ns();
+
+/**
+ * @brief Gets the time since gameclock_init
+ * @return Time in microseconds (wraps around after about 71 minutes)
+ */
+unsigned long gameclock_now_us();
+
+/**
+ * @brief Gets the time since gameclock_init
+ * @return Time in milliseconds
+ */
+unsigned long gameclock_now_ms();
+
+/**
+ * @brief Gets the timer interrupts counted (up to the last timer interrupt handled, if any was)
+ * @return Timer interrupts since gameclock_init
+ */
+unsigned long gameclock_get_interrupts();
+
+/**
+ * @brief Gets the rate of the time stamp counter measured by gameclock_init
+ * @return Time stamp counter increments per microsecond, 0 if not measured
+ */
+unsigned long gameclock_get_tsc_rate();
+
+/**
+ * @brief Gets the statistics of the clock
+ * @return Statistics since gameclock_init
+ */
+const GameClockStats * gameclock_get_stats();
+
+/**
+ * @brief Prints the statistics of the clock
+ */
+void gameclock_print_stats();
+
+/** @} */
+
+#endif /* __GAMECLOCK_H */
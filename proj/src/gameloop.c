@@ -0,0 +1,139 @@
+#include "gameloop.h"
+#include <minix/syslib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "timer.h"
+#include "gameclock.h"
+#include "framearena.h"
+#include "governor.h"
+#include "level.h"
+#include "profiler.h"
+#include "robinix.h"
+#include "utilities.h"
+/* For swap_buffers() */
+#include "video_gr.h"
+
+static GameLoopStats stats;
+//Time not yet simulated and time since the last frame was due, in timer interrupts
+static unsigned long tick_accumulator = 0;
+static unsigned long frame_accumulator = 0;
+//Timer interrupts per frame
+static unsigned long render_interval = GAMELOOP_TIMER_RATE / GAMELOOP_DEFAULT_RENDER_RATE;
+//Timer interrupts counted by the game clock at the last interrupt handled
+static unsigned long last_interrupts = 0;
+
+int gameloop_start() {
+  if(timer_set_frequency(0, GAMELOOP_TIMER_RATE) != 0) {
+    printf("gameloop_start::Error setting the timer frequency\n");
+    return 1;
+  }
+
+  memset(&stats, 0, sizeof stats);
+  governor_reset();
+  tick_accumulator = 0;
+  //Frames are drawn half a tick after the ticks, so that they fall in between two of them
+  frame_accumulator = render_interval / 2;
+
+  last_interrupts = gameclock_get_interrupts();
+
+  return 0;
+}
+
+int gameloop_stop() {
+  if(timer_set_frequency(0, GAMELOOP_DEFAULT_TIMER_RATE) != 0) {
+    printf("gameloop_stop::Error setting the timer frequency back\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+int gameloop_set_render_rate(unsigned int fps) {
+  if(fps == 0 || fps > GAMELOOP_TIMER_RATE) {
+    printf("gameloop_set_render_rate::Invalid rate %u, must be from 1 to %u\n", fps, GAMELOOP_TIMER_RATE);
+    return 1;
+  }
+
+  render_interval = GAMELOOP_TIMER_RATE / fps;
+  frame_accumulator = MIN_VAL(frame_accumulator, render_interval / 2);
+  return 0;
+}
+
+//Gets the timer interrupts elapsed since the previous call (more than one if notifications were merged while the game was busy)
+static unsigned long interrupts_elapsed() {
+  unsigned long now = gameclock_get_interrupts();
+  unsigned long elapsed = now - last_interrupts;
+  last_interrupts = now;
+  return elapsed;
+}
+
+void gameloop_IH(struct Robinix * rob) {
+  //Only ended if a frame is drawn
+  profiler_begin(PROFILER_FRAME);
+  unsigned long elapsed = interrupts_elapsed();
+  stats.interrupts++;
+  stats.max_interrupts_elapsed = MAX_VAL(stats.max_interrupts_elapsed, elapsed);
+  tick_accumulator += elapsed;
+  frame_accumulator += elapsed;
+
+  unsigned int n_ticks = 0;
+  while(tick_accumulator >= GAMELOOP_TICK_INTERRUPTS) {
+    if(n_ticks == GAMELOOP_MAX_CATCH_UP) {
+      //Too far behind to ever catch up, the rest of the time is dropped
+      stats.ticks_dropped += tick_accumulator / GAMELOOP_TICK_INTERRUPTS;
+      tick_accumulator %= GAMELOOP_TICK_INTERRUPTS;
+      break;
+    }
+
+    //Events first, so that the update of the same tick already sees them
+    profiler_begin(PROFILER_EVENTS);
+    game_process_events(rob);
+    profiler_end(PROFILER_EVENTS);
+    //Whatever the frame arena had from the previous tick is no longer in use, the events were its last users
+    framearena_reset();
+    profiler_begin(PROFILER_UPDATE);
+    game_update(rob);
+    profiler_end(PROFILER_UPDATE);
+    tick_accumulator -= GAMELOOP_TICK_INTERRUPTS;
+    n_ticks++;
+    stats.ticks++;
+  }
+
+  if(frame_accumulator < render_interval) {
+    return;
+  }
+  //Frames missed are not drawn late, only the latest one is
+  frame_accumulator %= render_interval;
+
+  //Catching up, the time is better spent simulating
+  if(n_ticks > 1) {
+    stats.frames_skipped++;
+    governor_frame_skipped();
+    return;
+  }
+
+  profiler_begin(PROFILER_DRAW);
+  game_draw(rob);
+  profiler_end(PROFILER_DRAW);
+  //Swapping the buffers since we are drawing in the back buffer (using double buffering)
+  profiler_begin(PROFILER_SWAP);
+  swap_buffers();
+  profiler_end(PROFILER_SWAP);
+  stats.frames_drawn++;
+  profiler_end(PROFILER_FRAME);
+  governor_frame(profiler_get_last(PROFILER_FRAME), render_interval * 1000000UL / GAMELOOP_TIMER_RATE);
+}
+
+unsigned int gameloop_get_alpha() {
+  return tick_accumulator * LEVEL_DRAW_ALPHA_ONE / GAMELOOP_TICK_INTERRUPTS;
+}
+
+const GameLoopStats * gameloop_get_stats() {
+  return &stats;
+}
+
+void gameloop_print_stats() {
+  printf("gameloop::%lu interrupts (at most %lu elapsed between two), %lu ticks, %lu ticks dropped\n", stats.interrupts, stats.max_interrupts_elapsed, stats.ticks, stats.ticks_dropped);
+  printf("gameloop::%lu frames drawn, %lu skipped to catch up\n", stats.frames_drawn, stats.frames_skipped);
+}
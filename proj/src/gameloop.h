@@ -0,0 +1,87 @@
+#ifndef __GAMELOOP_H
+#define __GAMELOOP_H
+
+#include <stdbool.h>
+
+struct Robinix;
+
+/** @defgroup gameloop gameloop
+ * @{
+ *
+ * Fixed timestep game loop, driven by the timer 0 interrupts: decides how many simulation ticks and frames each interrupt is worth
+ */
+
+/*
+ * Timer 0 runs faster than the simulation while the game loop is in use, and each interrupt adds the time elapsed since the previous one
+ * (read from the system uptime, so that interrupts whose notifications got merged while a slow frame was being drawn still count) to an accumulator.
+ * Every GAMELOOP_TICK_INTERRUPTS of accumulated time are one simulation tick: the events received so far are processed (and the frame arena reset, see framearena.h) and then the game is updated,
+ * so ticks always happen at GAMELOOP_TICK_RATE no matter how long drawing takes (lockstep and everything counted in ticks rely on it).
+ * Frames are drawn at their own rate, in between ticks, with the player and guards interpolated between their positions before and after the last tick.
+ * When the loop falls behind (more than one tick to simulate in an interrupt) the frame is skipped, so that the simulation catches up first,
+ * and if it is more than GAMELOOP_MAX_CATCH_UP ticks behind the rest of the time is dropped instead of trying to catch up forever.
+ */
+
+#define GAMELOOP_TIMER_RATE           120 /* Timer 0 frequency while the game loop is in use (interrupts per second) */
+#define GAMELOOP_DEFAULT_TIMER_RATE   60 /* Timer 0 frequency restored when stopping (Minix's) */
+#define GAMELOOP_TICK_RATE            60 /* Simulation ticks per second */
+#define GAMELOOP_TICK_INTERRUPTS      (GAMELOOP_TIMER_RATE / GAMELOOP_TICK_RATE)
+#define GAMELOOP_DEFAULT_RENDER_RATE  60 /* Frames per second, at most GAMELOOP_TIMER_RATE */
+#define GAMELOOP_MAX_CATCH_UP         4 /* Most ticks simulated in a single interrupt */
+
+typedef struct {
+  unsigned long interrupts;
+  unsigned long ticks;
+  unsigned long frames_drawn;
+  //Frames that were due but skipped to catch up with the simulation
+  unsigned long frames_skipped;
+  //Ticks dropped because the loop was more than GAMELOOP_MAX_CATCH_UP ticks behind
+  unsigned long ticks_dropped;
+  //Most timer interrupts elapsed between two handled ones
+  unsigned long max_interrupts_elapsed;
+} GameLoopStats;
+
+/**
+ * @brief Starts the game loop: sets timer 0 to GAMELOOP_TIMER_RATE and resets the accumulated time and the statistics
+ * @return 0 if successful, not 0 otherwise
+ */
+int gameloop_start();
+
+/**
+ * @brief Stops the game loop, setting timer 0 back to GAMELOOP_DEFAULT_TIMER_RATE
+ * @return 0 if successful, not 0 otherwise
+ */
+int gameloop_stop();
+
+/**
+ * @brief Sets the rate at which frames are drawn (GAMELOOP_DEFAULT_RENDER_RATE by default)
+ * @param  fps Frames per second, from 1 to GAMELOOP_TIMER_RATE (rounded to a whole number of timer interrupts per frame)
+ * @return     0 if successful, not 0 otherwise
+ */
+int gameloop_set_render_rate(unsigned int fps);
+
+/**
+ * @brief Runs the simulation ticks and draws the frame due in a timer interrupt. To be called by the timer interrupt handler
+ * @param rob Game object
+ */
+void gameloop_IH(struct Robinix * rob);
+
+/**
+ * @brief Gets how much time since the last tick has accumulated (as a fraction of a tick), to interpolate the frame being drawn with
+ * @return Interpolation factor, from 0 (draw as before the last tick) to LEVEL_DRAW_ALPHA_ONE (draw as after it)
+ */
+unsigned int gameloop_get_alpha();
+
+/**
+ * @brief Gets the statistics of the game loop
+ * @return Statistics since the last start
+ */
+const GameLoopStats * gameloop_get_stats();
+
+/**
+ * @brief Prints the statistics of the game loop (ticks, frames drawn and skipped and time dropped)
+ */
+void gameloop_print_stats();
+
+/** @} */
+
+#endif /* __GAMELOOP_H */
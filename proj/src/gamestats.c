@@ -4,9 +4,22 @@
 #include <math.h>
 #include <string.h>
 #include "gamestats.h"
-#include "rtc.h"
-#include "rtc_defines.h"
-#include "font.h"
+#include "utilities.h"
+#include "governor.h"
+
+static void set_time_text(GameStats * gs_ptr) {
+  char time[EPOCH_TIME_STRING_LENGTH];
+  epoch_format_duration(gs_ptr->time_elapsed, time);
+  textwidget_set_text(gs_ptr->time_widget, time);
+}
+
+static void set_coins_text(GameStats * gs_ptr) {
+  //The maximum value of a 32bit unsigned int is around 4 million - 10 characters (+1 for \0)
+  //Add to that the size of "COINS: " (7) and we get 18
+  char n_coins[18];
+  sprintf(n_coins, "COINS: %u", gs_ptr->n_coins_picked_up);
+  textwidget_set_text(gs_ptr->coins_widget, n_coins);
+}
 
 GameStats * create_gamestats() {
 
@@ -17,8 +30,19 @@ GameStats * create_gamestats() {
     return NULL;
   }
 
-  gs_ptr->time_elapsed = (Date_obj){.year = 0, .month=0, .day=0, .hour = 0, .minute = 0, .second = 0};
+  gs_ptr->time_elapsed = 0;
   gs_ptr->n_coins_picked_up = 0;
+  gs_ptr->hud_frames_left = 0;
+  gs_ptr->time_widget = create_textwidget("monofonto-22", 10, 10);
+  gs_ptr->coins_widget = create_textwidget("monofonto-22", 500, 10);
+
+  if(gs_ptr->time_widget == NULL || gs_ptr->coins_widget == NULL) {
+    destroy_gamestats(&gs_ptr);
+    return NULL;
+  }
+
+  set_time_text(gs_ptr);
+  set_coins_text(gs_ptr);
 
   //Returning a pointer to the created object
   return gs_ptr;
@@ -29,6 +53,8 @@ void destroy_gamestats(GameStats ** gs_ptr) {
     return;
   }
 
+  destroy_textwidget(&((*gs_ptr)->time_widget));
+  destroy_textwidget(&((*gs_ptr)->coins_widget));
   free(*gs_ptr);
   *gs_ptr = NULL;
 }
@@ -39,6 +65,7 @@ void gamestats_tick_coins(GameStats * gs_ptr) {
   }
 
   gs_ptr->n_coins_picked_up++;
+  set_coins_text(gs_ptr);
 }
 
 void gamestats_tick_time(GameStats * gs_ptr) {
@@ -46,7 +73,8 @@ void gamestats_tick_time(GameStats * gs_ptr) {
     return;
   }
 
-  tick_second(&(gs_ptr->time_elapsed));
+  gs_ptr->time_elapsed++;
+  set_time_text(gs_ptr);
 }
 
 unsigned long gamestats_calculate_score(GameStats * gs_ptr) {
@@ -54,11 +82,13 @@ unsigned long gamestats_calculate_score(GameStats * gs_ptr) {
     return 0;
   }
 
-  if ((gs_ptr->time_elapsed.day != 0) ||(gs_ptr->time_elapsed.month != 0) || (gs_ptr->time_elapsed.year != 0)) {
+  //Taking a day or more is not worth any points
+  if (gs_ptr->time_elapsed >= EPOCH_SECONDS_PER_DAY) {
     return 0;
   }
 
-  return 100 + (gs_ptr->n_coins_picked_up)* 50 + (5000 / get_seconds(&(gs_ptr->time_elapsed)));
+  //(A level finished in under a second counts as one second)
+  return 100 + (gs_ptr->n_coins_picked_up)* 50 + (5000 / MAX_VAL(gs_ptr->time_elapsed, 1));
 }
 
 void gamestats_draw (GameStats *gs_ptr) {
@@ -66,17 +96,19 @@ void gamestats_draw (GameStats *gs_ptr) {
     return;
   }
 
-  char * date = date_to_time_string(&(gs_ptr->time_elapsed));
-  //The maximum value of a 32bit unsigned int is around 4 million - 10 characters (+1 for \0)
-  //Add to that the size of "COINS: " (7) and we get 18
-  char n_coins[18];
-  sprintf(n_coins, "COINS: %u", gs_ptr->n_coins_picked_up);
-
-  string_to_screen(date, "monofonto-22", 10, 10);
-  string_to_screen(n_coins, "monofonto-22", 500, 10);
+  //Rendering text loads every character from disk, so while the HUD is slowed down the text rendered before is drawn in between refreshes
+  bool refresh = true;
+  if(governor_slows_hud()) {
+    if(gs_ptr->hud_frames_left > 0) {
+      gs_ptr->hud_frames_left--;
+      refresh = false;
+    } else {
+      gs_ptr->hud_frames_left = GOVERNOR_HUD_REFRESH_FRAMES - 1;
+    }
+  }
 
-  //Date string now no longer needed (n_coins does not need to be free'd since it was stack allocated)
-  free(date);
+  textwidget_draw(gs_ptr->time_widget, refresh);
+  textwidget_draw(gs_ptr->coins_widget, refresh);
 }
 
 char * gamestats_get_time_taken(GameStats * gs_ptr) {
@@ -84,5 +116,11 @@ char * gamestats_get_time_taken(GameStats * gs_ptr) {
     return NULL;
   }
 
-  return date_to_time_string(&(gs_ptr->time_elapsed));
+  char * time = malloc(EPOCH_TIME_STRING_LENGTH * sizeof *time);
+  if(time == NULL) {
+    return NULL;
+  }
+
+  epoch_format_duration(gs_ptr->time_elapsed, time);
+  return time;
 }
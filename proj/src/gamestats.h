@@ -1,7 +1,9 @@
 #ifndef _GAMESTATS_H
 #define _GAMESTATS_H
 
-#include "rtc.h"
+#include "epoch.h"
+#include "textwidget.h"
+
 
 /** @defgroup robinix robinix
  * @{
@@ -11,7 +13,13 @@
 
 typedef struct {
   unsigned int n_coins_picked_up;
-  Date_obj time_elapsed;
+  //Seconds since the level started (see epoch.h)
+  unsigned long time_elapsed;
+  //HUD text, set only when the time or coins change
+  TextWidget * time_widget;
+  TextWidget * coins_widget;
+  //Frames until the HUD text is rendered again, while the governor slows the HUD down
+  unsigned int hud_frames_left;
 } GameStats;
 
 /**
@@ -27,7 +35,7 @@ GameStats * create_gamestats();
 void destroy_gamestats(GameStats ** gs_ptr);
 
 /**
- * @brief Draws the relevant contents of the GameStats object on screen, to be used while playing
+ * @brief Draws the relevant contents of the GameStats object on screen, to be used while playing (text that changed is only rendered again every GOVERNOR_HUD_REFRESH_FRAMES while the governor slows the HUD down)
  * @param gs_ptr GameStats object to draw
  */
 void gamestats_draw(GameStats * gs_ptr);
@@ -0,0 +1,112 @@
+#include "ghost.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "governor.h"
+
+Ghost * create_ghost(Bitmap * bmp) {
+  if(bmp == NULL) {
+    return NULL;
+  }
+
+  Ghost * g_ptr = calloc(1, sizeof *g_ptr);
+
+  if(g_ptr == NULL) {
+    return NULL;
+  }
+
+  g_ptr->bmp = bmp;
+
+  return g_ptr;
+}
+
+void destroy_ghost(Ghost ** g_ptr) {
+  if(*g_ptr == NULL) {
+    return;
+  }
+
+  free(*g_ptr);
+  *g_ptr = NULL;
+}
+
+//Moves one coordinate towards its target, at most GHOST_MAX_STEP. Returns true if it did not get there
+static bool catch_up(long * coord, long target) {
+  long delta = target - *coord;
+  if(delta > GHOST_MAX_STEP) {
+    *coord += GHOST_MAX_STEP;
+    return true;
+  } else if(delta < -GHOST_MAX_STEP) {
+    *coord -= GHOST_MAX_STEP;
+    return true;
+  }
+  *coord = target;
+  return false;
+}
+
+void ghost_update(Ghost * g_ptr, const Player * simulated, unsigned long tick) {
+  if(simulated == NULL) {
+    return;
+  }
+
+  if(!g_ptr->shown) {
+    g_ptr->shown = true;
+    g_ptr->x = simulated->x;
+    g_ptr->y = simulated->y;
+    g_ptr->next_tick_measured = tick;
+  } else if(labs(simulated->x - g_ptr->x) > GHOST_SNAP_DISTANCE || labs(simulated->y - g_ptr->y) > GHOST_SNAP_DISTANCE) {
+    g_ptr->x = simulated->x;
+    g_ptr->y = simulated->y;
+    g_ptr->stats.snaps++;
+  } else {
+    //Both axes have to catch up, so not short-circuiting
+    bool behind_x = catch_up(&g_ptr->x, simulated->x);
+    bool behind_y = catch_up(&g_ptr->y, simulated->y);
+    if(behind_x || behind_y) {
+      g_ptr->stats.ticks_catching_up++;
+    }
+  }
+  g_ptr->angle = simulated->angle;
+
+  g_ptr->history_x[tick % GHOST_HISTORY_TICKS] = g_ptr->x;
+  g_ptr->history_y[tick % GHOST_HISTORY_TICKS] = g_ptr->y;
+  g_ptr->stats.ticks_drawn++;
+}
+
+void ghost_confirm(Ghost * g_ptr, unsigned long tick, const LevelState * confirmed) {
+  //Only once per tick, and only for ticks that were drawn
+  if(!g_ptr->shown || tick < g_ptr->next_tick_measured) {
+    return;
+  }
+  g_ptr->next_tick_measured = tick + 1;
+
+  unsigned long error = labs(g_ptr->history_x[tick % GHOST_HISTORY_TICKS] - confirmed->player_x) + labs(g_ptr->history_y[tick % GHOST_HISTORY_TICKS] - confirmed->player_y);
+  g_ptr->stats.errors_measured++;
+  g_ptr->stats.total_error += error;
+  if(error > g_ptr->stats.max_error) {
+    g_ptr->stats.max_error = error;
+  }
+}
+
+void draw_ghost(Ghost * g_ptr) {
+  if(g_ptr == NULL || !g_ptr->shown) {
+    return;
+  }
+
+  //Rotating is the first thing given up when frames run over their budget
+  if(governor_rotates_others()) {
+    drawBitmapTranslucentWithRotation(g_ptr->bmp, g_ptr->x, g_ptr->y, governor_draw_angle(g_ptr->angle));
+  } else {
+    drawBitmapTranslucent(g_ptr->bmp, g_ptr->x, g_ptr->y);
+  }
+}
+
+void ghost_print_stats(Ghost * g_ptr) {
+  //Since printf might not support floating point values, printing in hundredths
+  unsigned long avg_error = 0;
+  if(g_ptr->stats.errors_measured > 0) {
+    avg_error = g_ptr->stats.total_error * 100 / g_ptr->stats.errors_measured;
+  }
+
+  printf("ghost::0 B/s (driven by the inputs lockstep already sends), %lu ticks drawn, %lu catching up with a correction, %lu snaps\n", g_ptr->stats.ticks_drawn, g_ptr->stats.ticks_catching_up, g_ptr->stats.snaps);
+  printf("ghost::error of the position drawn (pixels, x + y) over %lu confirmed ticks: avg %lu/100, max %lu\n", g_ptr->stats.errors_measured, avg_error, g_ptr->stats.max_error);
+}
@@ -0,0 +1,99 @@
+#ifndef __GHOST_H
+#define __GHOST_H
+
+#include <stdbool.h>
+#include "bitmap.h"
+#include "player.h"
+#include "level.h"
+#include "rollback.h"
+
+/** @defgroup ghost ghost
+ * @{
+ *
+ * Ghost of the other player, drawn translucent over our level while playing multiplayer
+ */
+
+/*
+ * No positions are sent for the ghost: the level of the other player is already simulated here from its inputs (see lockstep and rollback),
+ * so its player is where the ghost has to be, at no cost in bandwidth (the inputs take ~70 of the ~109 bytes per second of the link,
+ * there would be no room for position updates at 15 to 30 per second).
+ * Between inputs the remote player keeps moving with the last one known, which is the dead reckoning. When a rollback corrects
+ * the simulated position, the drawn ghost does not jump to it but catches up at most GHOST_MAX_STEP pixels per tick on each axis,
+ * unless the correction is bigger than GHOST_SNAP_DISTANCE.
+ * The position drawn at each tick is kept, and once the tick is confirmed it is compared with the final position to measure the error.
+ */
+
+#define GHOST_MAX_STEP        (2 * PLAYER_MOVE_SPEED) /* Most the drawn ghost moves per tick on each axis, twice as fast as a player */
+#define GHOST_SNAP_DISTANCE   60 /* Corrections bigger than this (in pixels, on either axis) are not smoothed */
+#define GHOST_HISTORY_TICKS   (ROLLBACK_MAX_TICKS + 1) /* Positions drawn kept until their tick is confirmed */
+
+typedef struct {
+  unsigned long ticks_drawn;
+  //Ticks where the ghost was not where the simulation had the player, since it was catching up with a correction
+  unsigned long ticks_catching_up;
+  unsigned long snaps;
+  //Distance between the position drawn at a tick and the confirmed one, in pixels
+  unsigned long errors_measured;
+  unsigned long total_error;
+  unsigned long max_error;
+} GhostStats;
+
+typedef struct Ghost {
+  //Bitmap drawn (not owned)
+  Bitmap * bmp;
+  bool shown;
+  long x;
+  long y;
+  double angle;
+  //Positions drawn, indexed by tick modulo GHOST_HISTORY_TICKS
+  long history_x[GHOST_HISTORY_TICKS];
+  long history_y[GHOST_HISTORY_TICKS];
+  //Next tick whose position drawn will be compared with the confirmed one
+  unsigned long next_tick_measured;
+  GhostStats stats;
+} Ghost;
+
+/**
+ * @brief Ghost Object Constructor
+ * @param  bmp Bitmap to draw the ghost with (not copied, must outlive the Ghost)
+ * @return     Returns a pointer to a valid Ghost Object or NULL in case of failure
+ */
+Ghost * create_ghost(Bitmap * bmp);
+
+/**
+ * @brief Ghost Object Destructor
+ * @param g_ptr Ghost Object to destroy
+ */
+void destroy_ghost(Ghost ** g_ptr);
+
+/**
+ * @brief Moves the ghost towards the simulated position of the other player
+ * @param g_ptr     Ghost Object
+ * @param simulated Player of the level of the other player, as simulated
+ * @param tick      Tick the simulated position is for (the next one to simulate)
+ */
+void ghost_update(Ghost * g_ptr, const Player * simulated, unsigned long tick);
+
+/**
+ * @brief Measures the error of the position drawn at a tick that was just confirmed
+ * @param g_ptr     Ghost Object
+ * @param tick      Confirmed tick (every tick before it was simulated with known inputs)
+ * @param confirmed State of the level of the other player at the start of that tick
+ */
+void ghost_confirm(Ghost * g_ptr, unsigned long tick, const LevelState * confirmed);
+
+/**
+ * @brief Draws the ghost (translucent) to the back buffer
+ * @param g_ptr Ghost Object
+ */
+void draw_ghost(Ghost * g_ptr);
+
+/**
+ * @brief Prints the statistics of the ghost (bandwidth used and error of the positions drawn)
+ * @param g_ptr Ghost Object
+ */
+void ghost_print_stats(Ghost * g_ptr);
+
+/** @} */
+
+#endif /* __GHOST_H */
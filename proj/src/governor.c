@@ -0,0 +1,139 @@
+#include "governor.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "utilities.h"
+
+//Same as bitmap.c's, math.h does not define it
+#define PI 3.14159265358979323846
+
+static const char * tier_names[GOVERNOR_N_TIERS] = {"full", "no other rotation", "coarse angle", "frozen animation", "slow hud"};
+
+static GovernorStats stats;
+//Overruns not yet made up for by frames within the budget, and frames in a row with headroom
+static unsigned int overruns = 0;
+static unsigned int headroom_frames = 0;
+//Frames in a row with headroom needed to raise the tier, and frames since it was last raised
+static unsigned int upgrade_frames = GOVERNOR_UPGRADE_FRAMES;
+static unsigned long frames_since_upgrade = 0;
+
+void governor_reset() {
+  memset(&stats, 0, sizeof stats);
+  stats.tier = GOVERNOR_FULL;
+  stats.lowest_tier = GOVERNOR_FULL;
+  overruns = 0;
+  headroom_frames = 0;
+  upgrade_frames = GOVERNOR_UPGRADE_FRAMES;
+  frames_since_upgrade = 0;
+}
+
+static void set_tier(governor_tier_enum tier) {
+  stats.tier = tier;
+  stats.lowest_tier = MAX_VAL(stats.lowest_tier, tier);
+  stats.switches++;
+  overruns = 0;
+  headroom_frames = 0;
+}
+
+static void downgrade() {
+  if(stats.tier == GOVERNOR_N_TIERS - 1) {
+    //Nothing left to lower
+    overruns = 0;
+    return;
+  }
+
+  //The last tier raised (if any was) did not hold, waiting longer before trying again
+  bool upgraded_before = stats.switches > stats.downgrades;
+  if(upgraded_before && frames_since_upgrade < upgrade_frames) {
+    upgrade_frames = MIN_VAL(upgrade_frames * 2, GOVERNOR_MAX_UPGRADE_FRAMES);
+  } else {
+    upgrade_frames = GOVERNOR_UPGRADE_FRAMES;
+  }
+
+  stats.downgrades++;
+  set_tier(stats.tier + 1);
+}
+
+static void upgrade() {
+  frames_since_upgrade = 0;
+  set_tier(stats.tier - 1);
+}
+
+static void register_overrun() {
+  headroom_frames = 0;
+  overruns++;
+  if(overruns >= GOVERNOR_DOWNGRADE_FRAMES) {
+    downgrade();
+  }
+}
+
+void governor_frame(unsigned long cost_us, unsigned long budget_us) {
+  stats.frames_at_tier[stats.tier]++;
+  frames_since_upgrade++;
+
+  if(cost_us * 100 > budget_us * GOVERNOR_OVERRUN_PERCENT) {
+    register_overrun();
+    return;
+  }
+
+  if(overruns > 0) {
+    overruns--;
+  }
+
+  if(cost_us * 100 >= budget_us * GOVERNOR_HEADROOM_PERCENT || stats.tier == GOVERNOR_FULL) {
+    headroom_frames = 0;
+    return;
+  }
+
+  headroom_frames++;
+  if(headroom_frames >= upgrade_frames) {
+    upgrade();
+  }
+}
+
+void governor_frame_skipped() {
+  frames_since_upgrade++;
+  register_overrun();
+}
+
+governor_tier_enum governor_get_tier() {
+  return stats.tier;
+}
+
+const char * governor_get_tier_name(governor_tier_enum tier) {
+  return tier_names[tier];
+}
+
+bool governor_rotates_others() {
+  return stats.tier < GOVERNOR_NO_OTHER_ROTATION;
+}
+
+double governor_draw_angle(double angle) {
+  if(stats.tier < GOVERNOR_COARSE_ANGLE) {
+    return angle;
+  }
+
+  double step = 2 * PI / GOVERNOR_ANGLE_STEPS;
+  return ROUND(angle / step) * step;
+}
+
+bool governor_animates_sprites() {
+  return stats.tier < GOVERNOR_FROZEN_ANIMATION;
+}
+
+bool governor_slows_hud() {
+  return stats.tier >= GOVERNOR_SLOW_HUD;
+}
+
+const GovernorStats * governor_get_stats() {
+  return &stats;
+}
+
+void governor_print_stats() {
+  printf("governor::%lu tier switches (%lu lowering), lowest tier reached: %s, current: %s\n", stats.switches, stats.downgrades, tier_names[stats.lowest_tier], tier_names[stats.tier]);
+  int i;
+  for(i = 0; i < GOVERNOR_N_TIERS; i++) {
+    printf("governor::%lu frames drawn in %s\n", stats.frames_at_tier[i], tier_names[i]);
+  }
+}
@@ -0,0 +1,115 @@
+#ifndef __GOVERNOR_H
+#define __GOVERNOR_H
+
+#include <stdbool.h>
+
+/** @defgroup governor governor
+ * @{
+ *
+ * Quality governor: lowers the quality of what is drawn in steps while frames overrun their budget, and restores it once there is headroom again
+ */
+
+/*
+ * The game loop reports the cost of every frame drawn (the whole timer interrupt, as timed by the profiler) and every frame skipped to catch up.
+ * Frames costing more than GOVERNOR_OVERRUN_PERCENT of the budget add to a count of overruns and the others take from it,
+ * so that it only reaches GOVERNOR_DOWNGRADE_FRAMES while overruns are sustained, and not with a single slow frame once in a while: the tier is then lowered.
+ * It is only raised after GOVERNOR_UPGRADE_FRAMES frames in a row under GOVERNOR_HEADROOM_PERCENT of the budget, and if the tier raised has to be lowered
+ * again soon after, the frames needed to raise it the next time are doubled (up to GOVERNOR_MAX_UPGRADE_FRAMES), so that it does not keep going back and forth.
+ * Each tier keeps the reductions of the ones before it.
+ */
+
+#define GOVERNOR_OVERRUN_PERCENT      90
+#define GOVERNOR_HEADROOM_PERCENT     50
+#define GOVERNOR_DOWNGRADE_FRAMES     8
+#define GOVERNOR_UPGRADE_FRAMES       120 /* 2 seconds at 60 frames per second */
+#define GOVERNOR_MAX_UPGRADE_FRAMES   (GOVERNOR_UPGRADE_FRAMES * 8)
+#define GOVERNOR_ANGLE_STEPS          16 /* Angles a sprite can be drawn at from GOVERNOR_COARSE_ANGLE onwards */
+#define GOVERNOR_HUD_REFRESH_FRAMES   60 /* Frames between refreshes of the HUD from GOVERNOR_SLOW_HUD onwards (1 second at 60 frames per second) */
+
+typedef enum {
+  GOVERNOR_FULL = 0,
+  GOVERNOR_NO_OTHER_ROTATION, /* Only the player is drawn rotated */
+  GOVERNOR_COARSE_ANGLE, /* Rotations are rounded to GOVERNOR_ANGLE_STEPS angles, so that the rotated bitmaps can be reused */
+  GOVERNOR_FROZEN_ANIMATION, /* Sprites stay in their current bitmap */
+  GOVERNOR_SLOW_HUD, /* The HUD text is only drawn again every GOVERNOR_HUD_REFRESH_FRAMES */
+  GOVERNOR_N_TIERS
+} governor_tier_enum;
+
+typedef struct {
+  governor_tier_enum tier;
+  governor_tier_enum lowest_tier;
+  unsigned long switches;
+  unsigned long downgrades;
+  //Frames drawn in each tier
+  unsigned long frames_at_tier[GOVERNOR_N_TIERS];
+} GovernorStats;
+
+/**
+ * @brief Restores the full quality and clears the statistics
+ */
+void governor_reset();
+
+/**
+ * @brief Reports the cost of a frame drawn, possibly switching tiers
+ * @param cost_us   Time taken by the frame, in microseconds
+ * @param budget_us Time available for each frame, in microseconds
+ */
+void governor_frame(unsigned long cost_us, unsigned long budget_us);
+
+/**
+ * @brief Reports a frame skipped to catch up with the simulation, counted as an overrun
+ */
+void governor_frame_skipped();
+
+/**
+ * @brief Gets the current quality tier
+ * @return Current tier
+ */
+governor_tier_enum governor_get_tier();
+
+/**
+ * @brief Gets the name of a quality tier
+ * @param  tier Tier to get the name of
+ * @return      Name of the tier
+ */
+const char * governor_get_tier_name(governor_tier_enum tier);
+
+/**
+ * @brief Checks if sprites other than the player should be drawn rotated
+ * @return true if they should, false otherwise
+ */
+bool governor_rotates_others();
+
+/**
+ * @brief Gets the angle at which a sprite should be drawn
+ * @param  angle Angle of the sprite, in radians
+ * @return       The same angle or, from GOVERNOR_COARSE_ANGLE onwards, the closest of the GOVERNOR_ANGLE_STEPS angles
+ */
+double governor_draw_angle(double angle);
+
+/**
+ * @brief Checks if sprites should be animated
+ * @return true if they should, false otherwise
+ */
+bool governor_animates_sprites();
+
+/**
+ * @brief Checks if the HUD should only be refreshed every GOVERNOR_HUD_REFRESH_FRAMES
+ * @return true if it should, false if it should be drawn every frame
+ */
+bool governor_slows_hud();
+
+/**
+ * @brief Gets the tiers the governor was in and how often it switched between them
+ * @return Statistics since the last governor_reset
+ */
+const GovernorStats * governor_get_stats();
+
+/**
+ * @brief Prints the statistics of the governor
+ */
+void governor_print_stats();
+
+/** @} */
+
+#endif /* __GOVERNOR_H */
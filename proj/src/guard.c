@@ -143,7 +143,7 @@ static void update_cyclical_guard(Guard * g_ptr) {
   }
 }
 
-Guard * create_guard(Checkpoint checkpoints[], int ncheckpoints, bool isCyclical){
+Guard * create_guard(Checkpoint checkpoints[], int ncheckpoints, bool isCyclical, Region * region){
 
   //Checking if there are at least 2 checkpoints
   if (ncheckpoints < 2){
@@ -151,7 +151,8 @@ Guard * create_guard(Checkpoint checkpoints[], int ncheckpoints, bool isCyclical
   }
 
   //Allocating and checking if allocation was successful
-  Guard * g_ptr = malloc(sizeof *g_ptr);
+  //(Nothing has to be deallocated if something fails from here on, the region has it all)
+  Guard * g_ptr = region_alloc(region, sizeof *g_ptr);
 
   if(g_ptr == NULL){
     return NULL;
@@ -159,19 +160,13 @@ Guard * create_guard(Checkpoint checkpoints[], int ncheckpoints, bool isCyclical
 
   ////Bitmap loading
   //Loading guard sprites (one for each direction)
-  g_ptr->guardSprites[UP] = loadBitmap("/home/Robinix/res/img/guard/guard_u.bmp");
-  g_ptr->guardSprites[RIGHT] = loadBitmap("/home/Robinix/res/img/guard/guard_r.bmp");
-  g_ptr->guardSprites[DOWN] = loadBitmap("/home/Robinix/res/img/guard/guard_d.bmp");
-  g_ptr->guardSprites[LEFT] = loadBitmap("/home/Robinix/res/img/guard/guard_l.bmp");
+  g_ptr->guardSprites[UP] = loadBitmapInRegion("/home/Robinix/res/img/guard/guard_u.bmp", region);
+  g_ptr->guardSprites[RIGHT] = loadBitmapInRegion("/home/Robinix/res/img/guard/guard_r.bmp", region);
+  g_ptr->guardSprites[DOWN] = loadBitmapInRegion("/home/Robinix/res/img/guard/guard_d.bmp", region);
+  g_ptr->guardSprites[LEFT] = loadBitmapInRegion("/home/Robinix/res/img/guard/guard_l.bmp", region);
 
   //Checking if the bitmaps were correctly loaded
   if(g_ptr->guardSprites[UP] == NULL || g_ptr->guardSprites[RIGHT] == NULL || g_ptr->guardSprites[DOWN] == NULL || g_ptr->guardSprites[LEFT] == NULL){
-    //If any allocation of a bitmap failed, we delete them all to not leave used memory
-    deleteBitmap(g_ptr->guardSprites[UP]);
-    deleteBitmap(g_ptr->guardSprites[RIGHT]);
-    deleteBitmap(g_ptr->guardSprites[DOWN]);
-    deleteBitmap(g_ptr->guardSprites[LEFT]);
-    free(g_ptr);
     return NULL;
   }
 
@@ -180,39 +175,19 @@ Guard * create_guard(Checkpoint checkpoints[], int ncheckpoints, bool isCyclical
 
   int i;
   //Allocating space to store the checkpoints in the Guard
-  g_ptr->checkpoints = malloc(ncheckpoints * sizeof *(g_ptr->checkpoints));
+  g_ptr->checkpoints = region_alloc(region, ncheckpoints * sizeof *(g_ptr->checkpoints));
 
   //Verifying if the allocation was successful
   if(g_ptr->checkpoints == NULL){
-    //It was not, so deallocate everything allocated so far and return NULL
-    deleteBitmap(g_ptr->guardSprites[UP]);
-    deleteBitmap(g_ptr->guardSprites[RIGHT]);
-    deleteBitmap(g_ptr->guardSprites[DOWN]);
-    deleteBitmap(g_ptr->guardSprites[LEFT]);
-    free(g_ptr);
     return NULL;
   }
 
   //Copying the checkpoints to the guard object
   for(i = 0; i < ncheckpoints; i++){
-    g_ptr->checkpoints[i] = create_checkpoint(checkpoints[i].x, checkpoints[i].y, checkpoints[i].speed);
+    g_ptr->checkpoints[i] = create_checkpoint(checkpoints[i].x, checkpoints[i].y, checkpoints[i].speed, region);
 
     //Checking if correctly allocated
     if(g_ptr->checkpoints[i] == NULL){
-      //If not, destroy the already created members
-
-      //Destroying the already created checkpoints
-      int j;
-      for(j = 0; j < i; j++) {
-        destroy_checkpoint(& (g_ptr->checkpoints[j]));
-      }
-
-      //Deleting everything else
-      deleteBitmap(g_ptr->guardSprites[UP]);
-      deleteBitmap(g_ptr->guardSprites[RIGHT]);
-      deleteBitmap(g_ptr->guardSprites[DOWN]);
-      deleteBitmap(g_ptr->guardSprites[LEFT]);
-      free(g_ptr);
       return NULL;
     }
   }
@@ -276,32 +251,3 @@ void update_guard(Guard * g_ptr){
     update_non_cyclical_guard(g_ptr);
   }
 }
-
-void destroy_guard(Guard ** g_ptr) {
-
-  if(*g_ptr == NULL){
-    return;
-  }
-
-  //Deallocating the guard sprites
-  deleteBitmap((*g_ptr)->guardSprites[UP]);
-  deleteBitmap((*g_ptr)->guardSprites[RIGHT]);
-  deleteBitmap((*g_ptr)->guardSprites[DOWN]);
-  deleteBitmap((*g_ptr)->guardSprites[LEFT]);
-
-  //Deallocating the guard checkpoints
-  if((*g_ptr)->n_checkpoints > 0){
-    int i;
-    for(i = 0; i < (*g_ptr)->n_checkpoints; i++){
-      destroy_checkpoint(& ((*g_ptr)->checkpoints[i]));
-    }
-
-    //Deallocating the array itself
-    free((*g_ptr)->checkpoints);
-  }
-
-  free(*g_ptr);
-  //Setting the pointer to the Guard struct to NULL so we can know that the object has been deallocated
-  //(This is the reason for using a Guard ** and not a simple Guard * like in all the other member functions)
-  *g_ptr = NULL;
-}
@@ -38,9 +38,10 @@ typedef struct {
  * @param  checkpoints  The Checkpoints that the guard should go through
  * @param  ncheckpoints The number of checkpoints in the checkpoints array
  * @param  isCyclical   If the guard will be cyclical or "back and forth"
+ * @param  region       Region to create it in (it is freed with the region)
  * @return              Returns a pointer to a valid Guard Object or NULL in case of failure
  */
-Guard * create_guard(Checkpoint checkpoints[], int ncheckpoints, bool isCyclical);
+Guard * create_guard(Checkpoint checkpoints[], int ncheckpoints, bool isCyclical, Region * region);
 
 /**
  * @brief Draws a guard
@@ -48,12 +49,6 @@ Guard * create_guard(Checkpoint checkpoints[], int ncheckpoints, bool isCyclical
  */
 void draw_guard(Guard * g_ptr);
 
-/**
- * @brief Guard Object Destructor
- * @param g_ptr Guard Object to destroy
- */
-void destroy_guard(Guard ** g_ptr);
-
 /**
  * @brief Updates a guard by moving it in between checkpoints
  * @param g_ptr Guard Object to update
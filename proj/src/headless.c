@@ -0,0 +1,210 @@
+#include "headless.h"
+#include <minix/syslib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "level.h"
+#include "gameloop.h"
+#include "gameclock.h"
+#include "framearena.h"
+#include "video_gr.h"
+
+//Adds a step to a script, returns false if it is full
+static bool add_step(HeadlessScript * script, unsigned long ticks, unsigned char keys, unsigned char angle, unsigned char door) {
+  if(script->n_steps == HEADLESS_MAX_STEPS) {
+    return false;
+  }
+
+  HeadlessStep * step = &script->steps[script->n_steps++];
+  step->ticks = ticks;
+  step->input.keys = keys;
+  step->input.angle = angle;
+  step->input.click = door;
+  return true;
+}
+
+void headless_default_script(HeadlessScript * script) {
+  script->n_steps = 0;
+  //Going around in a square, facing where it is going, and then diagonally with every door clicked on the way
+  add_step(script, 90, LEVEL_INPUT_RIGHT, 0, LEVEL_INPUT_NO_CLICK);
+  add_step(script, 90, LEVEL_INPUT_DOWN, LEVEL_INPUT_ANGLE_STEPS * 3 / 4, LEVEL_INPUT_NO_CLICK);
+  add_step(script, 90, LEVEL_INPUT_LEFT, LEVEL_INPUT_ANGLE_STEPS / 2, LEVEL_INPUT_NO_CLICK);
+  add_step(script, 90, LEVEL_INPUT_UP, LEVEL_INPUT_ANGLE_STEPS / 4, LEVEL_INPUT_NO_CLICK);
+  unsigned char door;
+  for(door = 1; door <= LEVEL_MAX_DOORS; door++) {
+    add_step(script, 15, LEVEL_INPUT_RIGHT | LEVEL_INPUT_DOWN, LEVEL_INPUT_ANGLE_STEPS * 7 / 8, door);
+  }
+  add_step(script, 60, 0, LEVEL_INPUT_ANGLE_STEPS / 8, LEVEL_INPUT_NO_CLICK);
+  add_step(script, 150, LEVEL_INPUT_LEFT | LEVEL_INPUT_UP, LEVEL_INPUT_ANGLE_STEPS * 3 / 8, LEVEL_INPUT_NO_CLICK);
+}
+
+//Converts the keys of a script line ("wasd" letters or -) into LEVEL_INPUT_* bits, returns false if a character is not valid
+static bool parse_keys(const char * str, unsigned char * keys) {
+  *keys = 0;
+  if(strcmp(str, "-") == 0) {
+    return true;
+  }
+
+  for(; *str != '\0'; str++) {
+    switch(*str) {
+      case 'w':
+        *keys |= LEVEL_INPUT_UP;
+        break;
+      case 'a':
+        *keys |= LEVEL_INPUT_LEFT;
+        break;
+      case 's':
+        *keys |= LEVEL_INPUT_DOWN;
+        break;
+      case 'd':
+        *keys |= LEVEL_INPUT_RIGHT;
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+int headless_load_script(HeadlessScript * script, const char * path) {
+  FILE * fp = fopen(path, "r");
+
+  if(fp == NULL) {
+    printf("headless_load_script::Could not open %s\n", path);
+    return 1;
+  }
+
+  script->n_steps = 0;
+  char line[HEADLESS_LINE_LENGTH];
+  unsigned int line_n = 0;
+
+  while(fgets(line, HEADLESS_LINE_LENGTH, fp)) {
+    line_n++;
+    if(line[0] == '#' || line[0] == '\n') {
+      continue;
+    }
+
+    unsigned long ticks;
+    char keys_str[HEADLESS_LINE_LENGTH];
+    unsigned int angle, door;
+    unsigned char keys;
+    if(sscanf(line, "%lu %s %u %u", &ticks, keys_str, &angle, &door) != 4 || ticks == 0 || !parse_keys(keys_str, &keys) || angle >= LEVEL_INPUT_ANGLE_STEPS || door > LEVEL_MAX_DOORS) {
+      printf("headless_load_script::Invalid step in line %u of %s\n", line_n, path);
+      fclose(fp);
+      return 2;
+    }
+
+    if(!add_step(script, ticks, keys, angle, door)) {
+      printf("headless_load_script::More than %u steps in %s\n", HEADLESS_MAX_STEPS, path);
+      fclose(fp);
+      return 3;
+    }
+  }
+
+  fclose(fp);
+
+  if(script->n_steps == 0) {
+    printf("headless_load_script::No steps in %s\n", path);
+    return 4;
+  }
+
+  return 0;
+}
+
+//What happened during the run of a level
+typedef struct {
+  unsigned long guards_hit;
+  unsigned long treasures_got;
+  unsigned long coins_got;
+  unsigned long exits_reached;
+  unsigned long frames_dumped;
+} HeadlessCounts;
+
+static void dump_frame(Level * l_ptr, int level_n, unsigned long tick, HeadlessCounts * counts) {
+  char path[HEADLESS_LINE_LENGTH];
+  snprintf(path, sizeof path, "%s/level%d_%06lu.ppm", HEADLESS_DUMP_LOCATION, level_n, tick);
+
+  //The mouse is not scripted, it is left in the corner
+  draw_level(l_ptr, 0, 0);
+  if(vg_dump_frame(path) == 0) {
+    counts->frames_dumped++;
+  }
+}
+
+static int run_level(int level_n, unsigned long n_ticks, unsigned long dump_every, const HeadlessScript * script) {
+  Level * l_ptr = create_level(level_n, false);
+
+  if(l_ptr == NULL) {
+    printf("headless_run::Error creating level %d\n", level_n);
+    return 1;
+  }
+
+  HeadlessCounts counts;
+  memset(&counts, 0, sizeof counts);
+  unsigned int step_index = 0;
+  unsigned long step_tick = 0;
+
+  unsigned long start = gameclock_now_ms();
+
+  unsigned long tick;
+  for(tick = 0; tick < n_ticks; tick++) {
+    const HeadlessStep * step = &script->steps[step_index];
+    LevelInput input = step->input;
+    if(step_tick != 0) {
+      input.click = LEVEL_INPUT_NO_CLICK;
+    }
+    if(++step_tick == step->ticks) {
+      step_tick = 0;
+      step_index = (step_index + 1) % script->n_steps;
+    }
+
+    //Same as in the game loop, once per tick
+    framearena_reset();
+    LevelStepResult result = level_step(l_ptr, &input);
+    counts.guards_hit += result.hit_guard;
+    counts.treasures_got += result.got_treasure;
+    counts.coins_got += result.n_coins_got;
+    counts.exits_reached += result.at_exit;
+
+    if(dump_every != 0 && tick % dump_every == 0) {
+      dump_frame(l_ptr, level_n, tick, &counts);
+    }
+  }
+
+  unsigned long elapsed = gameclock_now_ms() - start;
+
+  //The hash of where the level ended up, for checking that changes to the game logic do not change its behaviour
+  LevelState state;
+  level_save_state(l_ptr, &state);
+  unsigned long hash = level_state_hash(&state, LEVEL_HASH_SEED);
+  destroy_level(&l_ptr);
+
+  //Timed by the game clock, counting whole timer interrupts outside of the game, so short runs are not measured precisely
+  printf("headless::Level %d: %lu ticks simulated in %lu ms", level_n, n_ticks, elapsed);
+  if(elapsed > 0) {
+    printf(", %lu ticks/s (%lu times real time)\n", (unsigned long) ((unsigned long long) n_ticks * 1000 / elapsed), (unsigned long) ((unsigned long long) n_ticks * 1000 / elapsed / GAMELOOP_TICK_RATE));
+  } else {
+    printf(", too fast to measure\n");
+  }
+  printf("headless::Level %d: %lu guards hit, %lu treasures, %lu coins, %lu exits reached, %lu frames dumped, final state hash %lx\n", level_n, counts.guards_hit, counts.treasures_got, counts.coins_got, counts.exits_reached, counts.frames_dumped, hash);
+
+  return 0;
+}
+
+int headless_run(int level, unsigned long n_ticks, unsigned long dump_every, const HeadlessScript * script) {
+  if(level < 0 || level > HEADLESS_LAST_LEVEL || n_ticks == 0 || script == NULL || script->n_steps == 0) {
+    printf("headless_run::Invalid level %d or number of ticks %lu\n", level, n_ticks);
+    return 1;
+  }
+
+  int first = level == 0 ? HEADLESS_FIRST_LEVEL : level;
+  int last = level == 0 ? HEADLESS_LAST_LEVEL : level;
+  int level_n;
+  for(level_n = first; level_n <= last; level_n++) {
+    if(run_level(level_n, n_ticks, dump_every, script) != 0) {
+      return 2;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+#ifndef __HEADLESS_H
+#define __HEADLESS_H
+
+#include "level.h"
+
+/** @defgroup headless headless
+ * @{
+ *
+ * Headless mode: simulates levels from a scripted input as fast as possible, without setting the video mode, to test and benchmark the game logic
+ */
+
+/*
+ * Each level is created as it is for single player and advanced with level_step, the same as update_level does every tick,
+ * but with the input taken from a script instead of the keyboard and mouse. Nothing is drawn, except for a frame dumped every so often if asked.
+ * What happens during the run (guards hit, pick ups, reaching the exit) is only counted, the level keeps going as if nothing happened.
+ *
+ * A script file has one step per line, repeated from the start when the last one ends:
+ *   <ticks> <keys> <angle> <door>
+ * ticks is how many ticks the step lasts, keys the movement keys held ("wasd" letters, or - for none), angle the player angle
+ * (from 0 to LEVEL_INPUT_ANGLE_STEPS - 1, 0 is facing right) and door the door clicked in the first tick (from 1, or 0 for none).
+ * Lines starting with # are ignored.
+ */
+
+#define HEADLESS_MAX_STEPS        64 /* Steps a script can have */
+#define HEADLESS_LINE_LENGTH      64
+#define HEADLESS_FIRST_LEVEL      1
+#define HEADLESS_LAST_LEVEL       2
+#define HEADLESS_DUMP_LOCATION    "/home/Robinix/frames" /* Frames are dumped here (the directory must exist), as level<n>_<tick>.ppm */
+
+typedef struct {
+  //Ticks the step lasts
+  unsigned long ticks;
+  //Input in the first tick of the step, the next ones have no click
+  LevelInput input;
+} HeadlessStep;
+
+typedef struct {
+  HeadlessStep steps[HEADLESS_MAX_STEPS];
+  unsigned int n_steps;
+} HeadlessScript;
+
+/**
+ * @brief Fills a script with the default one, which walks around in every direction while turning and clicking the doors
+ * @param script Script to fill
+ */
+void headless_default_script(HeadlessScript * script);
+
+/**
+ * @brief Loads a script from a file (see the format above)
+ * @param  script Script to fill
+ * @param  path   Path of the script file
+ * @return        0 if successful, not 0 otherwise
+ */
+int headless_load_script(HeadlessScript * script, const char * path);
+
+/**
+ * @brief Simulates levels headless and prints the simulated ticks per second of each one, and what happened in them
+ * @param  level      Level to simulate, or 0 for every level
+ * @param  n_ticks    Ticks to simulate in each level
+ * @param  dump_every Ticks between frames dumped to HEADLESS_DUMP_LOCATION, or 0 to draw nothing
+ * @param  script     Input to simulate with
+ * @return            0 if successful, not 0 otherwise
+ */
+int headless_run(int level, unsigned long n_ticks, unsigned long dump_every, const HeadlessScript * script);
+
+/** @} */
+
+#endif /* __HEADLESS_H */
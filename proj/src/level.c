@@ -3,12 +3,16 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
-//#include <string.h>
+#include <string.h>
 #include "checkpoint.h"
 #include "guard.h"
 #include "player.h"
 #include "robinix.h"
+#include "profiler.h"
 #include "video_gr.h" /* For getting resolutions */
+#include "rtc.h" /* For is_christmas_time */
+
+#define PI 3.14159265358979323846
 
 //Receives x and y variables and width and height and makes sure that they are inside the screen
 static void limit_xy_inside_screen(long * x, long * y, int width, int height) {
@@ -29,6 +33,23 @@ static void limit_xy_inside_screen(long * x, long * y, int width, int height) {
 
 ////Level loading
 
+//Creates the region of a level and the Level object in it, with everything else set to NULL or 0
+static Level * alloc_level() {
+  Region * region = create_region(LEVEL_REGION_CHUNK_SIZE);
+  if(region == NULL) {
+    return NULL;
+  }
+
+  Level * l_ptr = region_alloc(region, sizeof *l_ptr);
+  if(l_ptr == NULL) {
+    destroy_region(&region);
+    return NULL;
+  }
+
+  l_ptr->region = region;
+  return l_ptr;
+}
+
 static Level * load_level_0() {
   //Test level, does not allocate coins or treasure, for simplicity's sake
   ////Level configuration variables
@@ -50,15 +71,15 @@ static Level * load_level_0() {
   char * wall_path = "/home/Robinix/res/img/levels/walls_test.bmp";
   ////
 
-  //Allocating level object
-  Level * l_ptr = calloc(1, sizeof *l_ptr);
+  //Allocating level object (and the region everything in it is allocated in)
+  Level * l_ptr = alloc_level();
 
   if(l_ptr == NULL) {
     return NULL;
   }
 
   //Creating player (with starting coordinates and 0 speeds and starting angle)
-  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0);
+  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0, l_ptr->region);
 
   if(l_ptr->player == NULL) {
     destroy_level(&l_ptr);
@@ -67,22 +88,22 @@ static Level * load_level_0() {
 
   //Creating guards
   l_ptr->n_guards = n_guards;
-  l_ptr->guards = calloc(n_guards, sizeof * l_ptr->guards);
+  l_ptr->guards = region_alloc(l_ptr->region, n_guards * sizeof *(l_ptr->guards));
 
-  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0]);
+  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0], l_ptr->region);
   if(l_ptr->guards[0] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1]);
+  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1], l_ptr->region);
   if(l_ptr->guards[1] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
   //Loading background bitmap
-  l_ptr->background_bmp = loadBitmap(background_path);
+  l_ptr->background_bmp = loadBitmapInRegion(background_path, l_ptr->region);
 
   if(l_ptr->background_bmp == NULL) {
     destroy_level(&l_ptr);
@@ -90,7 +111,7 @@ static Level * load_level_0() {
   }
 
   //Loading walls bitmap
-  l_ptr->level_walls = loadBitmap(wall_path);
+  l_ptr->level_walls = loadBitmapInRegion(wall_path, l_ptr->region);
 
   if(l_ptr->level_walls == NULL) {
     destroy_level(&l_ptr);
@@ -148,15 +169,15 @@ static Level * load_level_1() {
   int exit_y = 730;
   ////
 
-  //Allocating level object
-  Level * l_ptr = calloc(1, sizeof *l_ptr);
+  //Allocating level object (and the region everything in it is allocated in)
+  Level * l_ptr = alloc_level();
 
   if(l_ptr == NULL) {
     return NULL;
   }
 
   //Creating player (with starting coordinates and 0 speeds and starting angle)
-  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0);
+  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0, l_ptr->region);
 
   if(l_ptr->player == NULL) {
     destroy_level(&l_ptr);
@@ -165,46 +186,46 @@ static Level * load_level_1() {
 
   //Creating guards
   l_ptr->n_guards = n_guards;
-  l_ptr->guards = calloc(n_guards, sizeof * l_ptr->guards);
+  l_ptr->guards = region_alloc(l_ptr->region, n_guards * sizeof *(l_ptr->guards));
 
-  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0]);
+  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0], l_ptr->region);
   if(l_ptr->guards[0] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1]);
+  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1], l_ptr->region);
   if(l_ptr->guards[1] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[2] = create_guard(checkpoints_g3, n_checkpoints[2], is_cyclical[2]);
+  l_ptr->guards[2] = create_guard(checkpoints_g3, n_checkpoints[2], is_cyclical[2], l_ptr->region);
   if(l_ptr->guards[2] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[3] = create_guard(checkpoints_g4, n_checkpoints[3], is_cyclical[3]);
+  l_ptr->guards[3] = create_guard(checkpoints_g4, n_checkpoints[3], is_cyclical[3], l_ptr->region);
   if(l_ptr->guards[3] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[4] = create_guard(checkpoints_g5, n_checkpoints[4], is_cyclical[4]);
+  l_ptr->guards[4] = create_guard(checkpoints_g5, n_checkpoints[4], is_cyclical[4], l_ptr->region);
   if(l_ptr->guards[4] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[5] = create_guard(checkpoints_g6, n_checkpoints[5], is_cyclical[5]);
+  l_ptr->guards[5] = create_guard(checkpoints_g6, n_checkpoints[5], is_cyclical[5], l_ptr->region);
   if(l_ptr->guards[5] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
   //Creating treasure
-  l_ptr->treasure = create_treasure(treasure_x, treasure_y);
+  l_ptr->treasure = create_treasure(treasure_x, treasure_y, l_ptr->region);
 
   if(l_ptr->treasure == NULL) {
     destroy_level(&l_ptr);
@@ -213,10 +234,10 @@ static Level * load_level_1() {
 
   //Creating coins
   l_ptr->n_coins = n_coins;
-  l_ptr->coins = calloc(n_coins, sizeof * l_ptr->coins);
+  l_ptr->coins = region_alloc(l_ptr->region, n_coins * sizeof *(l_ptr->coins));
   int i;
   for(i = 0; i < l_ptr->n_coins; i++) {
-    l_ptr->coins[i] = create_coin(coin_x[i], coin_y[i]);
+    l_ptr->coins[i] = create_coin(coin_x[i], coin_y[i], l_ptr->region);
     if(l_ptr->coins[i] == NULL) {
       destroy_level(&l_ptr);
       return NULL;
@@ -224,7 +245,7 @@ static Level * load_level_1() {
   }
 
   //Creating exit
-  l_ptr->exit = create_exit(exit_x, exit_y, false);
+  l_ptr->exit = create_exit(exit_x, exit_y, false, l_ptr->region);
 
   if(l_ptr->exit == NULL) {
     destroy_level(&l_ptr);
@@ -232,7 +253,7 @@ static Level * load_level_1() {
   }
 
   //Loading background bitmap
-  l_ptr->background_bmp = loadBitmap(background_path);
+  l_ptr->background_bmp = loadBitmapInRegion(background_path, l_ptr->region);
 
   if(l_ptr->background_bmp == NULL) {
     destroy_level(&l_ptr);
@@ -240,7 +261,7 @@ static Level * load_level_1() {
   }
 
   //Loading walls bitmap
-  l_ptr->level_walls = loadBitmap(wall_path);
+  l_ptr->level_walls = loadBitmapInRegion(wall_path, l_ptr->region);
 
   if(l_ptr->level_walls == NULL) {
     destroy_level(&l_ptr);
@@ -307,15 +328,15 @@ static Level * load_level_2() {
   bool door_start_closed[] = {true, true, true, true, true};
   ////
 
-  //Allocating level object
-  Level * l_ptr = calloc(1, sizeof *l_ptr);
+  //Allocating level object (and the region everything in it is allocated in)
+  Level * l_ptr = alloc_level();
 
   if(l_ptr == NULL) {
     return NULL;
   }
 
   //Creating player (with starting coordinates and 0 speeds and starting angle)
-  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0);
+  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0, l_ptr->region);
 
   if(l_ptr->player == NULL) {
     destroy_level(&l_ptr);
@@ -324,46 +345,46 @@ static Level * load_level_2() {
 
   //Creating guards
   l_ptr->n_guards = n_guards;
-  l_ptr->guards = calloc(n_guards, sizeof * l_ptr->guards);
+  l_ptr->guards = region_alloc(l_ptr->region, n_guards * sizeof *(l_ptr->guards));
 
-  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0]);
+  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0], l_ptr->region);
   if(l_ptr->guards[0] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1]);
+  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1], l_ptr->region);
   if(l_ptr->guards[1] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[2] = create_guard(checkpoints_g3, n_checkpoints[2], is_cyclical[2]);
+  l_ptr->guards[2] = create_guard(checkpoints_g3, n_checkpoints[2], is_cyclical[2], l_ptr->region);
   if(l_ptr->guards[2] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[3] = create_guard(checkpoints_g4, n_checkpoints[3], is_cyclical[3]);
+  l_ptr->guards[3] = create_guard(checkpoints_g4, n_checkpoints[3], is_cyclical[3], l_ptr->region);
   if(l_ptr->guards[3] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[4] = create_guard(checkpoints_g5, n_checkpoints[4], is_cyclical[4]);
+  l_ptr->guards[4] = create_guard(checkpoints_g5, n_checkpoints[4], is_cyclical[4], l_ptr->region);
   if(l_ptr->guards[4] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[5] = create_guard(checkpoints_g6, n_checkpoints[5], is_cyclical[5]);
+  l_ptr->guards[5] = create_guard(checkpoints_g6, n_checkpoints[5], is_cyclical[5], l_ptr->region);
   if(l_ptr->guards[5] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
   //Creating treasure
-  l_ptr->treasure = create_treasure(treasure_x, treasure_y);
+  l_ptr->treasure = create_treasure(treasure_x, treasure_y, l_ptr->region);
 
   if(l_ptr->treasure == NULL) {
     destroy_level(&l_ptr);
@@ -372,10 +393,10 @@ static Level * load_level_2() {
 
   //Creating coins
   l_ptr->n_coins = n_coins;
-  l_ptr->coins = calloc(n_coins, sizeof * l_ptr->coins);
+  l_ptr->coins = region_alloc(l_ptr->region, n_coins * sizeof *(l_ptr->coins));
   int i;
   for(i = 0; i < l_ptr->n_coins; i++) {
-    l_ptr->coins[i] = create_coin(coin_x[i], coin_y[i]);
+    l_ptr->coins[i] = create_coin(coin_x[i], coin_y[i], l_ptr->region);
     if(l_ptr->coins[i] == NULL) {
       destroy_level(&l_ptr);
       return NULL;
@@ -383,7 +404,7 @@ static Level * load_level_2() {
   }
 
   //Creating exit
-  l_ptr->exit = create_exit(exit_x, exit_y, false);
+  l_ptr->exit = create_exit(exit_x, exit_y, false, l_ptr->region);
 
   if(l_ptr->exit == NULL) {
     destroy_level(&l_ptr);
@@ -392,10 +413,10 @@ static Level * load_level_2() {
 
   //Creating doors
   l_ptr->n_doors = n_doors;
-  l_ptr->doors = calloc(n_doors, sizeof * l_ptr->doors);
+  l_ptr->doors = region_alloc(l_ptr->region, n_doors * sizeof *(l_ptr->doors));
   //No need to redeclare i, declared above
   for(i = 0; i < l_ptr->n_doors; i++) {
-    l_ptr->doors[i] = create_door(door_x[i], door_y[i], door_start_closed[i]);
+    l_ptr->doors[i] = create_door(door_x[i], door_y[i], door_start_closed[i], l_ptr->region);
     if(l_ptr->doors[i] == NULL) {
       destroy_level(&l_ptr);
       return NULL;
@@ -403,7 +424,7 @@ static Level * load_level_2() {
   }
 
   //Loading background bitmap
-  l_ptr->background_bmp = loadBitmap(background_path);
+  l_ptr->background_bmp = loadBitmapInRegion(background_path, l_ptr->region);
 
   if(l_ptr->background_bmp == NULL) {
     destroy_level(&l_ptr);
@@ -411,7 +432,7 @@ static Level * load_level_2() {
   }
 
   //Loading walls bitmap
-  l_ptr->level_walls = loadBitmap(wall_path);
+  l_ptr->level_walls = loadBitmapInRegion(wall_path, l_ptr->region);
 
   if(l_ptr->level_walls == NULL) {
     destroy_level(&l_ptr);
@@ -464,15 +485,15 @@ static Level * load_level_mp1() {
   bool door_start_closed[] = {true, true, true, true};
   ////
 
-  //Allocating level object
-  Level * l_ptr = calloc(1, sizeof *l_ptr);
+  //Allocating level object (and the region everything in it is allocated in)
+  Level * l_ptr = alloc_level();
 
   if(l_ptr == NULL) {
     return NULL;
   }
 
   //Creating player (with starting coordinates and 0 speeds and starting angle)
-  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0);
+  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0, l_ptr->region);
 
   if(l_ptr->player == NULL) {
     destroy_level(&l_ptr);
@@ -481,34 +502,34 @@ static Level * load_level_mp1() {
 
   //Creating guards
   l_ptr->n_guards = n_guards;
-  l_ptr->guards = calloc(n_guards, sizeof * l_ptr->guards);
+  l_ptr->guards = region_alloc(l_ptr->region, n_guards * sizeof *(l_ptr->guards));
 
-  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0]);
+  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0], l_ptr->region);
   if(l_ptr->guards[0] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1]);
+  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1], l_ptr->region);
   if(l_ptr->guards[1] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[2] = create_guard(checkpoints_g3, n_checkpoints[2], is_cyclical[2]);
+  l_ptr->guards[2] = create_guard(checkpoints_g3, n_checkpoints[2], is_cyclical[2], l_ptr->region);
   if(l_ptr->guards[2] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[3] = create_guard(checkpoints_g4, n_checkpoints[3], is_cyclical[3]);
+  l_ptr->guards[3] = create_guard(checkpoints_g4, n_checkpoints[3], is_cyclical[3], l_ptr->region);
   if(l_ptr->guards[3] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
   //Creating treasure
-  l_ptr->treasure = create_treasure(treasure_x, treasure_y);
+  l_ptr->treasure = create_treasure(treasure_x, treasure_y, l_ptr->region);
 
   if(l_ptr->treasure == NULL) {
     destroy_level(&l_ptr);
@@ -517,10 +538,10 @@ static Level * load_level_mp1() {
 
   //Creating coins
   l_ptr->n_coins = n_coins;
-  l_ptr->coins = calloc(n_coins, sizeof * l_ptr->coins);
+  l_ptr->coins = region_alloc(l_ptr->region, n_coins * sizeof *(l_ptr->coins));
   int i;
   for(i = 0; i < l_ptr->n_coins; i++) {
-    l_ptr->coins[i] = create_coin(coin_x[i], coin_y[i]);
+    l_ptr->coins[i] = create_coin(coin_x[i], coin_y[i], l_ptr->region);
     if(l_ptr->coins[i] == NULL) {
       destroy_level(&l_ptr);
       return NULL;
@@ -528,7 +549,7 @@ static Level * load_level_mp1() {
   }
 
   //Creating exit
-  l_ptr->exit = create_exit(exit_x, exit_y, true);
+  l_ptr->exit = create_exit(exit_x, exit_y, true, l_ptr->region);
   if(l_ptr->exit == NULL) {
     destroy_level(&l_ptr);
     return NULL;
@@ -536,10 +557,10 @@ static Level * load_level_mp1() {
 
   //Creating doors
   l_ptr->n_doors = n_doors;
-  l_ptr->doors = calloc(n_doors, sizeof * l_ptr->doors);
+  l_ptr->doors = region_alloc(l_ptr->region, n_doors * sizeof *(l_ptr->doors));
   //No need to redeclare i, declared above
   for(i = 0; i < l_ptr->n_doors; i++) {
-    l_ptr->doors[i] = create_door(door_x[i], door_y[i], door_start_closed[i]);
+    l_ptr->doors[i] = create_door(door_x[i], door_y[i], door_start_closed[i], l_ptr->region);
     if(l_ptr->doors[i] == NULL) {
       destroy_level(&l_ptr);
       return NULL;
@@ -547,7 +568,7 @@ static Level * load_level_mp1() {
   }
 
   //Loading background bitmap
-  l_ptr->background_bmp = loadBitmap(background_path);
+  l_ptr->background_bmp = loadBitmapInRegion(background_path, l_ptr->region);
 
   if(l_ptr->background_bmp == NULL) {
     destroy_level(&l_ptr);
@@ -555,7 +576,7 @@ static Level * load_level_mp1() {
   }
 
   //Loading walls bitmap
-  l_ptr->level_walls = loadBitmap(wall_path);
+  l_ptr->level_walls = loadBitmapInRegion(wall_path, l_ptr->region);
 
   if(l_ptr->level_walls == NULL) {
     destroy_level(&l_ptr);
@@ -608,15 +629,15 @@ static Level * load_level_mp2() {
   bool door_start_closed[] = {true, true, true, true};
   ////
 
-  //Allocating level object
-  Level * l_ptr = calloc(1, sizeof *l_ptr);
+  //Allocating level object (and the region everything in it is allocated in)
+  Level * l_ptr = alloc_level();
 
   if(l_ptr == NULL) {
     return NULL;
   }
 
   //Creating player (with starting coordinates and 0 speeds and starting angle)
-  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0);
+  l_ptr->player = create_player(player_start_x, player_start_y, 0, 0, 0, l_ptr->region);
 
   if(l_ptr->player == NULL) {
     destroy_level(&l_ptr);
@@ -625,34 +646,34 @@ static Level * load_level_mp2() {
 
   //Creating guards
   l_ptr->n_guards = n_guards;
-  l_ptr->guards = calloc(n_guards, sizeof * l_ptr->guards);
+  l_ptr->guards = region_alloc(l_ptr->region, n_guards * sizeof *(l_ptr->guards));
 
-  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0]);
+  l_ptr->guards[0] = create_guard(checkpoints_g1, n_checkpoints[0], is_cyclical[0], l_ptr->region);
   if(l_ptr->guards[0] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1]);
+  l_ptr->guards[1] = create_guard(checkpoints_g2, n_checkpoints[1], is_cyclical[1], l_ptr->region);
   if(l_ptr->guards[1] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[2] = create_guard(checkpoints_g3, n_checkpoints[2], is_cyclical[2]);
+  l_ptr->guards[2] = create_guard(checkpoints_g3, n_checkpoints[2], is_cyclical[2], l_ptr->region);
   if(l_ptr->guards[2] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
-  l_ptr->guards[3] = create_guard(checkpoints_g4, n_checkpoints[3], is_cyclical[3]);
+  l_ptr->guards[3] = create_guard(checkpoints_g4, n_checkpoints[3], is_cyclical[3], l_ptr->region);
   if(l_ptr->guards[3] == NULL) {
     destroy_level(&l_ptr);
     return NULL;
   }
 
   //Creating treasure
-  l_ptr->treasure = create_treasure(treasure_x, treasure_y);
+  l_ptr->treasure = create_treasure(treasure_x, treasure_y, l_ptr->region);
 
   if(l_ptr->treasure == NULL) {
     destroy_level(&l_ptr);
@@ -661,10 +682,10 @@ static Level * load_level_mp2() {
 
   //Creating coins
   l_ptr->n_coins = n_coins;
-  l_ptr->coins = calloc(n_coins, sizeof * l_ptr->coins);
+  l_ptr->coins = region_alloc(l_ptr->region, n_coins * sizeof *(l_ptr->coins));
   int i;
   for(i = 0; i < l_ptr->n_coins; i++) {
-    l_ptr->coins[i] = create_coin(coin_x[i], coin_y[i]);
+    l_ptr->coins[i] = create_coin(coin_x[i], coin_y[i], l_ptr->region);
     if(l_ptr->coins[i] == NULL) {
       destroy_level(&l_ptr);
       return NULL;
@@ -672,7 +693,7 @@ static Level * load_level_mp2() {
   }
 
   //Creating exit
-  l_ptr->exit = create_exit(exit_x, exit_y, true);
+  l_ptr->exit = create_exit(exit_x, exit_y, true, l_ptr->region);
 
   if(l_ptr->exit == NULL) {
     destroy_level(&l_ptr);
@@ -681,10 +702,10 @@ static Level * load_level_mp2() {
 
   //Creating doors
   l_ptr->n_doors = n_doors;
-  l_ptr->doors = calloc(n_doors, sizeof * l_ptr->doors);
+  l_ptr->doors = region_alloc(l_ptr->region, n_doors * sizeof *(l_ptr->doors));
   //No need to redeclare i, declared above
   for(i = 0; i < l_ptr->n_doors; i++) {
-    l_ptr->doors[i] = create_door(door_x[i], door_y[i], door_start_closed[i]);
+    l_ptr->doors[i] = create_door(door_x[i], door_y[i], door_start_closed[i], l_ptr->region);
     if(l_ptr->doors[i] == NULL) {
       destroy_level(&l_ptr);
       return NULL;
@@ -692,7 +713,7 @@ static Level * load_level_mp2() {
   }
 
   //Loading background bitmap
-  l_ptr->background_bmp = loadBitmap(background_path);
+  l_ptr->background_bmp = loadBitmapInRegion(background_path, l_ptr->region);
 
   if(l_ptr->background_bmp == NULL) {
     destroy_level(&l_ptr);
@@ -700,7 +721,7 @@ static Level * load_level_mp2() {
   }
 
   //Loading walls bitmap
-  l_ptr->level_walls = loadBitmap(wall_path);
+  l_ptr->level_walls = loadBitmapInRegion(wall_path, l_ptr->region);
 
   if(l_ptr->level_walls == NULL) {
     destroy_level(&l_ptr);
@@ -741,10 +762,17 @@ Level * create_level(int level_n, bool is_mp) {
     return NULL;
   }
 
+  //Everything that changes while playing must fit in a LevelState
+  if(l_ptr->n_guards > LEVEL_MAX_GUARDS || l_ptr->n_coins > LEVEL_MAX_COINS || l_ptr->n_doors > LEVEL_MAX_DOORS) {
+    printf("create_level::Level %d has too many objects for a LevelState\n", level_n);
+    destroy_level(&l_ptr);
+    return NULL;
+  }
+
   ////Some allocations are always the same so they can be done here
 
   //Loading the bitmap of the level border into memory
-  l_ptr->level_border = loadBitmap("/home/Robinix/res/img/other/level_border.bmp");
+  l_ptr->level_border = loadBitmapInRegion("/home/Robinix/res/img/other/level_border.bmp", l_ptr->region);
 
   //If the level border bmp was not correctly allocated, destroy the level and return NULL
   if(l_ptr->level_border == NULL) {
@@ -754,8 +782,8 @@ Level * create_level(int level_n, bool is_mp) {
 
 
   //Loading the bitmaps of the mouse pointers into memory
-  l_ptr->mouse_bmps[M_OVER_NOTHING] = loadBitmap("/home/Robinix/res/img/mouse/mouse_arrow.bmp");
-  l_ptr->mouse_bmps[M_OVER_DOOR] = loadBitmap("/home/Robinix/res/img/mouse/mouse_check.bmp");
+  l_ptr->mouse_bmps[M_OVER_NOTHING] = loadBitmapInRegion("/home/Robinix/res/img/mouse/mouse_arrow.bmp", l_ptr->region);
+  l_ptr->mouse_bmps[M_OVER_DOOR] = loadBitmapInRegion("/home/Robinix/res/img/mouse/mouse_check.bmp", l_ptr->region);
 
   //If one of the mouse pointer bmps was not correctly allocated, destroy the level and return NULL
   if(l_ptr->mouse_bmps[M_OVER_NOTHING] == NULL || l_ptr->mouse_bmps[M_OVER_DOOR] == NULL) {
@@ -766,64 +794,12 @@ Level * create_level(int level_n, bool is_mp) {
   //Setting mouse_over initial state
   l_ptr->current_mouse_over = M_OVER_NOTHING;
 
-  return l_ptr;
-}
-
-//Helper function for clearing the array of guards
-static void clear_guard_arr(Level * l_ptr) {
-  //If there are guards stored, destroy them
-  if(l_ptr->n_guards > 0) {
-    int i;
-    for(i = 0; i < l_ptr->n_guards; i++){
-      //Destroying a guard if it is allocated
-      destroy_guard(&(l_ptr->guards[i]));
-    }
-
-    //Updating the number of guards stored variable
-    l_ptr->n_guards = 0;
+  //Nothing moved yet, so there is nothing to interpolate from
+  level_save_draw_positions(l_ptr);
 
-    //Deallocating space in memory for the array (** was used so this must be done)
-    free(l_ptr->guards);
-    l_ptr->guards = NULL;
-  }
-}
+  printf("create_level::Level %d: %lu allocations, %lu bytes in %u chunks (%lu bytes)\n", level_n, l_ptr->region->allocations, l_ptr->region->bytes, l_ptr->region->n_chunks, l_ptr->region->bytes_reserved);
 
-//Helper function for clearing the array of doors
-static void clear_door_arr(Level * l_ptr) {
-  //If there are doors stored, destroy them
-  if(l_ptr->n_doors > 0) {
-    int i;
-    for(i = 0; i < l_ptr->n_doors; i++){
-      //Destroying a doors if it is allocated
-      destroy_door(&(l_ptr->doors[i]));
-    }
-
-    //Updating the number of doors stored variable
-    l_ptr->n_doors = 0;
-
-    //Deallocating space in memory for the array (** was used so this must be done)
-    free(l_ptr->doors);
-    l_ptr->doors = NULL;
-  }
-}
-
-//Helper function for clearing the array of coins
-static void clear_coin_arr(Level * l_ptr) {
-  //If there are coins stored, destroy them
-  if(l_ptr->n_coins > 0) {
-    int i;
-    for(i = 0; i < l_ptr->n_coins; i++){
-      //Destroying a coin if it is allocated
-      destroy_coin(&(l_ptr->coins[i]));
-    }
-
-    //Updating the number of coins stored variable
-    l_ptr->n_coins = 0;
-
-    //Deallocating space in memory for the array (** was used so this must be done)
-    free(l_ptr->coins);
-    l_ptr->coins = NULL;
-  }
+  return l_ptr;
 }
 
 void destroy_level(Level ** l_ptr) {
@@ -832,37 +808,11 @@ void destroy_level(Level ** l_ptr) {
     return;
   }
 
-  //Deallocating the player
-  destroy_player(&((*l_ptr)->player));
-
-  //Clearing the guard array (Calls destroy_guard for each event and deallocates the array itself)
-  clear_guard_arr(*l_ptr);
-
-  //Deallocating the treasure
-  destroy_treasure(&((*l_ptr)->treasure));
-
-  //Clearing the coin array
-  clear_coin_arr(*l_ptr);
-
-  //CLearing the doors array
-  clear_door_arr(*l_ptr);
-
-  //Deallocating the exit
-  destroy_exit(&((*l_ptr)->exit));
-
-  //Clearing the background bitmap stored
-  deleteBitmap((*l_ptr)->background_bmp);
-  //Clearing the level walls bmp stored
-  deleteBitmap((*l_ptr)->level_walls);
-
-  //Clearing the mouse bitmaps stored
-  deleteBitmap((*l_ptr)->mouse_bmps[M_OVER_NOTHING]);
-  deleteBitmap((*l_ptr)->mouse_bmps[M_OVER_DOOR]);
-
-  //NOTE: Don't forget to update with more deallocations if there are any, eventually
-
-  //Finally, deallocating Level object
-  free(*l_ptr);
+  //Everything in the level, the Level object included, is in its region, so destroying it deallocates everything at once
+  Region * region = (*l_ptr)->region;
+  //Its bitmaps do not go through deleteBitmap, so their rotations have to be forgotten here
+  forgetRegionRotations(region);
+  destroy_region(&region);
   //Setting the pointer to the Level struct to NULL so we can know that the object has been deallocated
   //(This is the reason for using a Level ** and not a simple Level * like in all the other functions)
   *l_ptr = NULL;
@@ -870,21 +820,21 @@ void destroy_level(Level ** l_ptr) {
 
 ////Creating and destroying of helper objects
 
-Treasure * create_treasure(long startx, long starty) {
-  Treasure * t_ptr = malloc(sizeof *t_ptr);
+Treasure * create_treasure(long startx, long starty, Region * region) {
+  Treasure * t_ptr = region_alloc(region, sizeof *t_ptr);
 
   if(t_ptr == NULL) {
     return NULL;
   }
 
   if(is_christmas_time()) {
-    t_ptr->bmp = loadBitmap("/home/Robinix/res/img/levels/xmas_treasure.bmp");
+    t_ptr->bmp = loadBitmapInRegion("/home/Robinix/res/img/levels/xmas_treasure.bmp", region);
   } else {
-    t_ptr->bmp = loadBitmap("/home/Robinix/res/img/levels/closed_treasure.bmp");
+    t_ptr->bmp = loadBitmapInRegion("/home/Robinix/res/img/levels/closed_treasure.bmp", region);
   }
 
+  //(Nothing to deallocate, the region has it)
   if(t_ptr->bmp == NULL) {
-    destroy_treasure(&t_ptr);
     return NULL;
   }
 
@@ -906,35 +856,22 @@ void draw_treasure(Treasure * t_ptr) {
   }
 }
 
-void destroy_treasure(Treasure ** t_ptr) {
-  if(*t_ptr == NULL) {
-    return;
-  }
-
-  deleteBitmap((*t_ptr)->bmp);
-
-  free(*t_ptr);
-  *t_ptr = NULL;
-}
-
-Door * create_door(long startx, long starty, bool closed_at_start) {
-  Door * d_ptr = malloc(sizeof *d_ptr);
+Door * create_door(long startx, long starty, bool closed_at_start, Region * region) {
+  Door * d_ptr = region_alloc(region, sizeof *d_ptr);
 
   if (d_ptr == NULL) {
     return NULL;
   }
 
-  d_ptr->closed_bmp = loadBitmap("/home/Robinix/res/img/levels/closed_door.bmp");
+  d_ptr->closed_bmp = loadBitmapInRegion("/home/Robinix/res/img/levels/closed_door.bmp", region);
 
   if(d_ptr->closed_bmp == NULL) {
-    destroy_door(&d_ptr);
     return NULL;
   }
 
-  d_ptr->open_bmp = loadBitmap("/home/Robinix/res/img/levels/open_door.bmp");
+  d_ptr->open_bmp = loadBitmapInRegion("/home/Robinix/res/img/levels/open_door.bmp", region);
 
   if(d_ptr->open_bmp == NULL) {
-    destroy_door(&d_ptr);
     return NULL;
   }
 
@@ -978,30 +915,16 @@ void draw_door(Door * d_ptr) {
   }
 }
 
-void destroy_door(Door ** d_ptr) {
-
-  if(*d_ptr == NULL) {
-    return;
-  }
-
-  deleteBitmap((*d_ptr)->closed_bmp);
-  deleteBitmap((*d_ptr)->open_bmp);
-
-  free(*d_ptr);
-  *d_ptr = NULL;
-}
-
-Coin * create_coin(long startx, long starty) {
-  Coin * c_ptr = malloc(sizeof *c_ptr);
+Coin * create_coin(long startx, long starty, Region * region) {
+  Coin * c_ptr = region_alloc(region, sizeof *c_ptr);
 
   if(c_ptr == NULL) {
     return NULL;
   }
 
-  c_ptr->bmp = loadBitmap("/home/Robinix/res/img/levels/golden_coin.bmp");
+  c_ptr->bmp = loadBitmapInRegion("/home/Robinix/res/img/levels/golden_coin.bmp", region);
 
   if(c_ptr->bmp == NULL) {
-    destroy_coin(&c_ptr);
     return NULL;
   }
 
@@ -1023,47 +946,33 @@ void draw_coin(Coin * c_ptr) {
   }
 }
 
-void destroy_coin(Coin ** c_ptr) {
-  if(*c_ptr == NULL) {
-    return;
-  }
-
-  deleteBitmap((*c_ptr)->bmp);
-
-  free(*c_ptr);
-  *c_ptr = NULL;
-}
-
-Exit * create_exit(long startx, long starty, bool superlocked) {
-  Exit * ex_ptr = malloc(sizeof *ex_ptr);
+Exit * create_exit(long startx, long starty, bool superlocked, Region * region) {
+  Exit * ex_ptr = region_alloc(region, sizeof *ex_ptr);
 
   if(ex_ptr == NULL) {
     return NULL;
   }
 
   //Loading closed bitmap
-  ex_ptr->closed_sprite = loadBitmap("/home/Robinix/res/img/levels/exit_closed.bmp");
+  ex_ptr->closed_sprite = loadBitmapInRegion("/home/Robinix/res/img/levels/exit_closed.bmp", region);
 
   if(ex_ptr->closed_sprite == NULL) {
-    destroy_exit(&ex_ptr);
     return NULL;
   }
 
   //Loading superlocked bitmap
-  ex_ptr->superlocked_sprite = loadBitmap("/home/Robinix/res/img/levels/exit_superlocked.bmp");
+  ex_ptr->superlocked_sprite = loadBitmapInRegion("/home/Robinix/res/img/levels/exit_superlocked.bmp", region);
 
   if(ex_ptr->superlocked_sprite == NULL) {
-    destroy_exit(&ex_ptr);
     return NULL;
   }
 
   //Loading open sprite (animated!)
   char * open_sprite_paths[] = {"/home/Robinix/res/img/levels/exit_open1.bmp", "/home/Robinix/res/img/levels/exit_open2.bmp", "/home/Robinix/res/img/levels/exit_open3.bmp", "/home/Robinix/res/img/levels/exit_open4.bmp"};
   //Arguments are paths, n_paths and frames per bitmap
-  ex_ptr->open_sprite = create_sprite(open_sprite_paths, 4, 15);
+  ex_ptr->open_sprite = create_sprite_in_region(open_sprite_paths, 4, 15, region);
 
   if(ex_ptr->open_sprite == NULL) {
-    destroy_exit(&ex_ptr);
     return NULL;
   }
 
@@ -1103,19 +1012,6 @@ void exit_goto_next_state(Exit * ex_ptr) {
   }
 }
 
-void destroy_exit(Exit ** ex_ptr) {
-  if(*ex_ptr == NULL) {
-    return;
-  }
-
-  deleteBitmap((*ex_ptr)->closed_sprite);
-  deleteBitmap((*ex_ptr)->superlocked_sprite);
-  destroy_sprite(&((*ex_ptr)->open_sprite));
-
-  free(*ex_ptr);
-  *ex_ptr = NULL;
-}
-
 ////Drawing
 static void level_draw_background(Level * l_ptr) {
   drawFullscreenBitmap(l_ptr->background_bmp);
@@ -1147,16 +1043,34 @@ static void level_draw_doors(Level * l_ptr) {
   }
 }
 
-static void level_draw_guards(Level * l_ptr) {
+//Position alpha of the way from prev to curr (alpha in 1/LEVEL_DRAW_ALPHA_ONE)
+static long level_interpolate(long prev, long curr, unsigned int alpha) {
+  return prev + (curr - prev) * (long) alpha / LEVEL_DRAW_ALPHA_ONE;
+}
+
+//The guards and player are moved to where they are drawn and then put back, so that drawing them stays the same
+static void level_draw_guards(Level * l_ptr, unsigned int alpha) {
   int i;
   for(i = 0; i < l_ptr->n_guards; i++) {
-    draw_guard(l_ptr->guards[i]);
+    Guard * g_ptr = l_ptr->guards[i];
+    long x = g_ptr->guardX, y = g_ptr->guardY;
+    g_ptr->guardX = level_interpolate(l_ptr->prev_guards_x[i], x, alpha);
+    g_ptr->guardY = level_interpolate(l_ptr->prev_guards_y[i], y, alpha);
+    draw_guard(g_ptr);
+    g_ptr->guardX = x;
+    g_ptr->guardY = y;
   }
 }
 
-static void level_draw_player(Level * l_ptr) {
+static void level_draw_player(Level * l_ptr, unsigned int alpha) {
   if(l_ptr->player != NULL) {
-    draw_player(l_ptr->player);
+    Player * p_ptr = l_ptr->player;
+    long x = p_ptr->x, y = p_ptr->y;
+    p_ptr->x = level_interpolate(l_ptr->prev_player_x, x, alpha);
+    p_ptr->y = level_interpolate(l_ptr->prev_player_y, y, alpha);
+    draw_player(p_ptr);
+    p_ptr->x = x;
+    p_ptr->y = y;
   }
 }
 
@@ -1165,62 +1079,93 @@ static void level_draw_mouse(Level * l_ptr, long mouseX, long mouseY) {
 }
 
 void draw_level(Level * l_ptr, long mouseX, long mouseY) {
+  draw_level_interpolated(l_ptr, mouseX, mouseY, LEVEL_DRAW_ALPHA_ONE);
+}
+
+void draw_level_interpolated(Level * l_ptr, long mouseX, long mouseY, unsigned int alpha) {
   if(l_ptr == NULL) {
     return;
   }
 
+  profiler_begin(PROFILER_DRAW_BACKGROUND);
   level_draw_background(l_ptr);
+  profiler_end(PROFILER_DRAW_BACKGROUND);
+  profiler_begin(PROFILER_DRAW_WALLS);
   level_draw_walls(l_ptr);
+  profiler_end(PROFILER_DRAW_WALLS);
+  profiler_begin(PROFILER_DRAW_TREASURE);
   level_draw_treasure(l_ptr);
+  profiler_end(PROFILER_DRAW_TREASURE);
+  profiler_begin(PROFILER_DRAW_COINS);
   level_draw_coins(l_ptr);
+  profiler_end(PROFILER_DRAW_COINS);
+  profiler_begin(PROFILER_DRAW_EXIT);
   level_draw_exit(l_ptr);
+  profiler_end(PROFILER_DRAW_EXIT);
+  profiler_begin(PROFILER_DRAW_DOORS);
   level_draw_doors(l_ptr);
-  level_draw_guards(l_ptr);
-  level_draw_player(l_ptr);
+  profiler_end(PROFILER_DRAW_DOORS);
+  profiler_begin(PROFILER_DRAW_GUARDS);
+  level_draw_guards(l_ptr, alpha);
+  profiler_end(PROFILER_DRAW_GUARDS);
+  profiler_begin(PROFILER_DRAW_PLAYER);
+  level_draw_player(l_ptr, alpha);
+  profiler_end(PROFILER_DRAW_PLAYER);
+  profiler_begin(PROFILER_DRAW_MOUSE);
   level_draw_mouse(l_ptr, mouseX, mouseY);
+  profiler_end(PROFILER_DRAW_MOUSE);
+}
+
+void level_save_draw_positions(Level * l_ptr) {
+  if(l_ptr == NULL) {
+    return;
+  }
+
+  if(l_ptr->player != NULL) {
+    l_ptr->prev_player_x = l_ptr->player->x;
+    l_ptr->prev_player_y = l_ptr->player->y;
+  }
+
+  int i;
+  for(i = 0; i < l_ptr->n_guards; i++) {
+    l_ptr->prev_guards_x[i] = l_ptr->guards[i]->guardX;
+    l_ptr->prev_guards_y[i] = l_ptr->guards[i]->guardY;
+  }
 }
 
 ////Updating
-static void level_update_player(Level * l_ptr, Robinix * rob) {
+//Converts a quantized angle back into radians
+static double level_input_angle(unsigned char angle) {
+  //Steps above half are the negative angles, to stay in the same range as atan2
+  int steps = angle < LEVEL_INPUT_ANGLE_STEPS / 2 ? angle : angle - LEVEL_INPUT_ANGLE_STEPS;
+  return steps * 2 * PI / LEVEL_INPUT_ANGLE_STEPS;
+}
+
+static void level_update_player(Level * l_ptr, const LevelInput * input) {
   //Do nothing if there is no player allocated
   if(l_ptr->player == NULL) {
     return;
   }
 
   //Player speed update based on pressed keys
-  if(rob->currstate.w_pressed) {
+  if(input->keys & LEVEL_INPUT_UP) {
     set_player_moving_up(l_ptr->player);
-  } else if(rob->currstate.s_pressed) {
+  } else if(input->keys & LEVEL_INPUT_DOWN) {
     set_player_moving_down(l_ptr->player);
   } else {
     set_player_stopped_y(l_ptr->player);
   }
 
-  if(rob->currstate.a_pressed) {
+  if(input->keys & LEVEL_INPUT_LEFT) {
     set_player_moving_left(l_ptr->player);
-  } else if(rob->currstate.d_pressed) {
+  } else if(input->keys & LEVEL_INPUT_RIGHT) {
     set_player_moving_right(l_ptr->player);
   } else {
     set_player_stopped_x(l_ptr->player);
   }
 
-  //The angle from the player to the mouse is calulated considering the vector from the player to the mouse
-  int player_center_x = l_ptr->player->x + get_player_current_bitmap(l_ptr->player)->bitmapInfoHeader.width/2;
-  int player_center_y = l_ptr->player->y + get_player_current_bitmap(l_ptr->player)->bitmapInfoHeader.height/2;
-  int mouse_center_x = rob->currstate.mouseX + l_ptr->mouse_bmps[l_ptr->current_mouse_over]->bitmapInfoHeader.width/2;
-  int mouse_center_y = rob->currstate.mouseY + l_ptr->mouse_bmps[l_ptr->current_mouse_over]->bitmapInfoHeader.height/2;
-
-  //dx and dy are the coordinates of said vector
-  int dx = player_center_x - mouse_center_x;
-  int dy = player_center_y - mouse_center_y;
-
-  //To get the angle relative to the 1,0 vector it is enough to use atan2, which was defined precisely for this usage
-  //We have to pass in -dy because in the considered mathematical y axis, y increases when going up
-  //However, in this implementation, y increases when going down. Therefore we invert the sign
-  double angle = atan2(-dy, dx);
-
   //Setting the angle in the player object
-  set_player_angle(l_ptr->player, angle);
+  set_player_angle(l_ptr->player, level_input_angle(input->angle));
 
   //Collisions with walls
 
@@ -1303,30 +1248,35 @@ static void level_update_guards(Level * l_ptr){
   }
 }
 
-static void level_test_collisions(Level * l_ptr, Robinix * rob) {
+static LevelStepResult level_test_collisions(Level * l_ptr) {
+  LevelStepResult result = {.hit_guard = false, .got_treasure = false, .n_coins_got = 0, .at_exit = false};
 
   if(l_ptr->player == NULL) {
-    return;
+    return result;
   }
-  //Checking collisions from player with guards (adds event to buffer in case they collide)
+
+  //NOTE: Using the player's idle BMP (like for the walls) instead of the current animation frame, since the animation advances when drawing
+  //and the result must not depend on whether (or how often) the level is drawn, otherwise two simulations of the same level diverge
+  Bitmap * player_bmp = l_ptr->player->playerSprite->bmps[0];
+
+  //Checking collisions from player with guards
   int i;
   for(i = 0; i < l_ptr->n_guards; i++) {
-    if(check_if_bitmaps_collided_rotated_w_non_rotated(get_player_current_bitmap(l_ptr->player), l_ptr->player->x, l_ptr->player->y, l_ptr->player->angle,
+    if(check_if_bitmaps_collided_rotated_w_non_rotated(player_bmp, l_ptr->player->x, l_ptr->player->y, l_ptr->player->angle,
 	   get_guard_current_bitmap(l_ptr->guards[i]), l_ptr->guards[i]->guardX, l_ptr->guards[i]->guardY)) {
-       add_event_to_buffer(rob, create_event(PLAYER_COLLIDE_WITH_GUARD, 0, 0, '?', NULL));
+      result.hit_guard = true;
       //It should only be possible for one collision to happen at a time (and anyways, one is enough to result in a loss)
       break;
     }
   }
   //Checking player collisions with treasure
   if(l_ptr->treasure != NULL && !l_ptr->treasure->picked_up) {
-    if(check_if_bitmaps_collided_rotated_w_non_rotated(get_player_current_bitmap(l_ptr->player), l_ptr->player->x, l_ptr->player->y, l_ptr->player->angle,
+    if(check_if_bitmaps_collided_rotated_w_non_rotated(player_bmp, l_ptr->player->x, l_ptr->player->y, l_ptr->player->angle,
     l_ptr->treasure->bmp, l_ptr->treasure->x, l_ptr->treasure->y)) {
       l_ptr->treasure->picked_up = true;
       //Setting exit to the next state on treasure pick up
       exit_goto_next_state(l_ptr->exit);
-      //Sending event about getting treasure due to multiplayer
-      add_event_to_buffer(rob, create_event(PLAYER_GOT_TREASURE, 0, 0, '?', NULL));
+      result.got_treasure = true;
     }
   }
   //Checking player collisions with coins
@@ -1334,33 +1284,231 @@ static void level_test_collisions(Level * l_ptr, Robinix * rob) {
   for(i = 0; i < l_ptr->n_coins; i++) {
     if(!l_ptr->coins[i]->picked_up) {
       //If coin has not yet been picked up, test for collision with player
-      if(check_if_bitmaps_collided_rotated_w_non_rotated(get_player_current_bitmap(l_ptr->player), l_ptr->player->x, l_ptr->player->y, l_ptr->player->angle,
+      if(check_if_bitmaps_collided_rotated_w_non_rotated(player_bmp, l_ptr->player->x, l_ptr->player->y, l_ptr->player->angle,
                                                          l_ptr->coins[i]->bmp, l_ptr->coins[i]->x, l_ptr->coins[i]->y)) {
         l_ptr->coins[i]->picked_up = true;
-        add_event_to_buffer(rob, create_event(PLAYER_GOT_COIN, 0, 0, '?', NULL));
+        result.n_coins_got++;
       }
     }
   }
   //Checking player collisions with exit (Can only collide with exit if exit is open - aka not closed)
   if(l_ptr->exit != NULL && l_ptr->exit->exit_state == EXIT_OPEN) {
-    if(check_if_bitmaps_collided_rotated_w_non_rotated(get_player_current_bitmap(l_ptr->player), l_ptr->player->x, l_ptr->player->y, l_ptr->player->angle,
+    if(check_if_bitmaps_collided_rotated_w_non_rotated(player_bmp, l_ptr->player->x, l_ptr->player->y, l_ptr->player->angle,
        l_ptr->exit->closed_sprite, l_ptr->exit->x, l_ptr->exit->y)) {
-      add_event_to_buffer(rob, create_event(PLAYER_COLLIDE_WITH_EXIT, 0, 0, '?', NULL));
+      result.at_exit = true;
     }
   }
+
+  return result;
 }
 
+LevelInput level_make_input(Level * l_ptr, unsigned char keys, long mouseX, long mouseY, bool clicked) {
+  LevelInput input = {.keys = keys, .angle = 0, .click = LEVEL_INPUT_NO_CLICK};
 
-//NOTE: rob pointer is necessary due to sending events
-void update_level(Level * l_ptr, Robinix * rob) {
+  if(l_ptr == NULL || l_ptr->player == NULL) {
+    return input;
+  }
+
+  //The angle from the player to the mouse is calulated considering the vector from the player to the mouse
+  int player_center_x = l_ptr->player->x + get_player_current_bitmap(l_ptr->player)->bitmapInfoHeader.width/2;
+  int player_center_y = l_ptr->player->y + get_player_current_bitmap(l_ptr->player)->bitmapInfoHeader.height/2;
+  int mouse_center_x = mouseX + l_ptr->mouse_bmps[l_ptr->current_mouse_over]->bitmapInfoHeader.width/2;
+  int mouse_center_y = mouseY + l_ptr->mouse_bmps[l_ptr->current_mouse_over]->bitmapInfoHeader.height/2;
+
+  //dx and dy are the coordinates of said vector
+  int dx = player_center_x - mouse_center_x;
+  int dy = player_center_y - mouse_center_y;
+
+  //To get the angle relative to the 1,0 vector it is enough to use atan2, which was defined precisely for this usage
+  //We have to pass in -dy because in the considered mathematical y axis, y increases when going up
+  //However, in this implementation, y increases when going down. Therefore we invert the sign
+  double angle = atan2(-dy, dx);
+
+  //Quantizing to the nearest step (negative angles wrap around to the upper half)
+  int steps = (int) floor(angle * LEVEL_INPUT_ANGLE_STEPS / (2 * PI) + 0.5);
+  input.angle = (unsigned char) ((steps + LEVEL_INPUT_ANGLE_STEPS) % LEVEL_INPUT_ANGLE_STEPS);
+
+  //A click only matters if it is over a door, in which case the (first) hovered door is the one clicked
+  if(clicked && l_ptr->current_mouse_over == M_OVER_DOOR) {
+    int i;
+    for(i = 0; i < l_ptr->n_doors; i++) {
+      if(l_ptr->doors[i]->hovered) {
+        input.click = i + 1;
+        break;
+      }
+    }
+  }
+
+  return input;
+}
+
+LevelStepResult level_step(Level * l_ptr, const LevelInput * input) {
+  //Clicks are applied first, as they used to be applied when processing the events of the previous tick
+  if(input->click != LEVEL_INPUT_NO_CLICK && input->click <= l_ptr->n_doors) {
+    Door * clicked_door = l_ptr->doors[input->click - 1];
+    clicked_door->closed = !(clicked_door->closed);
+  }
   //Update player
-  level_update_player(l_ptr, rob);
+  level_update_player(l_ptr, input);
   //Update guards
   level_update_guards(l_ptr);
+  //Test for guard, coin, treasure and exit collisions
+  profiler_begin(PROFILER_COLLISIONS);
+  LevelStepResult result = level_test_collisions(l_ptr);
+  profiler_end(PROFILER_COLLISIONS);
+  return result;
+}
+
+//NOTE: rob pointer is necessary due to sending events
+void update_level(Level * l_ptr, Robinix * rob) {
+  //Single player: the input is taken straight from the current state (clicks are handled by level_handle_mouse_click as they happen)
+  unsigned char keys = 0;
+  if(rob->currstate.w_pressed) {
+    keys |= LEVEL_INPUT_UP;
+  }
+  if(rob->currstate.a_pressed) {
+    keys |= LEVEL_INPUT_LEFT;
+  }
+  if(rob->currstate.s_pressed) {
+    keys |= LEVEL_INPUT_DOWN;
+  }
+  if(rob->currstate.d_pressed) {
+    keys |= LEVEL_INPUT_RIGHT;
+  }
+  LevelInput input = level_make_input(l_ptr, keys, rob->currstate.mouseX, rob->currstate.mouseY, false);
+
+  LevelStepResult result = level_step(l_ptr, &input);
   //Ensuring mouse does not go offscreen (kind of ugly but I don't see any good way to make it better besides needless pixel perfect collision)
   limit_xy_inside_screen(&(rob->currstate.mouseX), &(rob->currstate.mouseY), l_ptr->mouse_bmps[l_ptr->current_mouse_over]->bitmapInfoHeader.width, l_ptr->mouse_bmps[l_ptr->current_mouse_over]->bitmapInfoHeader.height);
-  //Test for guard, coin, treasure and exit collisions
-  level_test_collisions(l_ptr, rob);
+
+  //Adding events to the buffer for what happened
+  if(result.hit_guard) {
+    add_event_to_buffer(rob, create_event(PLAYER_COLLIDE_WITH_GUARD, 0, 0, '?', NULL));
+  }
+  if(result.got_treasure) {
+    add_event_to_buffer(rob, create_event(PLAYER_GOT_TREASURE, 0, 0, '?', NULL));
+  }
+  unsigned int i;
+  for(i = 0; i < result.n_coins_got; i++) {
+    add_event_to_buffer(rob, create_event(PLAYER_GOT_COIN, 0, 0, '?', NULL));
+  }
+  if(result.at_exit) {
+    add_event_to_buffer(rob, create_event(PLAYER_COLLIDE_WITH_EXIT, 0, 0, '?', NULL));
+  }
+}
+
+//Continues a FNV-1a hash with the bytes of the passed value
+static unsigned long hash_value(unsigned long hash, long value) {
+  unsigned int i;
+  for(i = 0; i < sizeof value; i++) {
+    hash ^= (unsigned char) (value >> (8 * i));
+    hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+  }
+  return hash;
+}
+
+void level_save_state(Level * l_ptr, LevelState * state) {
+  //Cleared first so that unused guards are always zero (the state is hashed as a whole)
+  memset(state, 0, sizeof *state);
+  if(l_ptr == NULL) {
+    return;
+  }
+
+  if(l_ptr->player != NULL) {
+    state->player_x = l_ptr->player->x;
+    state->player_y = l_ptr->player->y;
+    state->player_speedX = l_ptr->player->speedX;
+    state->player_speedY = l_ptr->player->speedY;
+    state->player_angle = l_ptr->player->angle;
+    state->player_moving = l_ptr->player->isMoving;
+  }
+  unsigned int i;
+  for(i = 0; i < l_ptr->n_guards; i++) {
+    GuardState * guard = &state->guards[i];
+    guard->x = l_ptr->guards[i]->guardX;
+    guard->y = l_ptr->guards[i]->guardY;
+    guard->speedX = l_ptr->guards[i]->speedX;
+    guard->speedY = l_ptr->guards[i]->speedY;
+    guard->current_checkpoint = l_ptr->guards[i]->current_checkpoint;
+    guard->goingForward = l_ptr->guards[i]->goingForward;
+    guard->currdirection = l_ptr->guards[i]->currdirection;
+  }
+  if(l_ptr->treasure != NULL) {
+    state->treasure_picked_up = l_ptr->treasure->picked_up;
+  }
+  for(i = 0; i < l_ptr->n_coins; i++) {
+    if(l_ptr->coins[i]->picked_up) {
+      state->coins_picked_up |= BIT(i);
+    }
+  }
+  for(i = 0; i < l_ptr->n_doors; i++) {
+    if(l_ptr->doors[i]->closed) {
+      state->doors_closed |= BIT(i);
+    }
+  }
+  if(l_ptr->exit != NULL) {
+    state->exit_state = l_ptr->exit->exit_state;
+  }
+}
+
+void level_restore_state(Level * l_ptr, const LevelState * state) {
+  if(l_ptr == NULL) {
+    return;
+  }
+
+  if(l_ptr->player != NULL) {
+    l_ptr->player->x = state->player_x;
+    l_ptr->player->y = state->player_y;
+    l_ptr->player->speedX = state->player_speedX;
+    l_ptr->player->speedY = state->player_speedY;
+    l_ptr->player->angle = state->player_angle;
+    l_ptr->player->isMoving = state->player_moving;
+  }
+  unsigned int i;
+  for(i = 0; i < l_ptr->n_guards; i++) {
+    const GuardState * guard = &state->guards[i];
+    l_ptr->guards[i]->guardX = guard->x;
+    l_ptr->guards[i]->guardY = guard->y;
+    l_ptr->guards[i]->speedX = guard->speedX;
+    l_ptr->guards[i]->speedY = guard->speedY;
+    l_ptr->guards[i]->current_checkpoint = guard->current_checkpoint;
+    l_ptr->guards[i]->goingForward = guard->goingForward;
+    l_ptr->guards[i]->currdirection = guard->currdirection;
+  }
+  if(l_ptr->treasure != NULL) {
+    l_ptr->treasure->picked_up = state->treasure_picked_up;
+  }
+  for(i = 0; i < l_ptr->n_coins; i++) {
+    l_ptr->coins[i]->picked_up = (state->coins_picked_up & BIT(i)) != 0;
+  }
+  for(i = 0; i < l_ptr->n_doors; i++) {
+    l_ptr->doors[i]->closed = (state->doors_closed & BIT(i)) != 0;
+  }
+  if(l_ptr->exit != NULL) {
+    l_ptr->exit->exit_state = state->exit_state;
+  }
+}
+
+unsigned long level_state_hash(const LevelState * state, unsigned long hash) {
+  //Fields are hashed one by one, hashing the struct bytes would include its padding
+  hash = hash_value(hash, state->player_x);
+  hash = hash_value(hash, state->player_y);
+  hash = hash_value(hash, state->player_speedX);
+  hash = hash_value(hash, state->player_speedY);
+  hash = hash_value(hash, (long) floor(state->player_angle * LEVEL_INPUT_ANGLE_STEPS / (2 * PI) + 0.5));
+  unsigned int i;
+  for(i = 0; i < LEVEL_MAX_GUARDS; i++) {
+    hash = hash_value(hash, state->guards[i].x);
+    hash = hash_value(hash, state->guards[i].y);
+    hash = hash_value(hash, state->guards[i].current_checkpoint);
+    hash = hash_value(hash, state->guards[i].currdirection);
+  }
+  hash = hash_value(hash, state->treasure_picked_up);
+  hash = hash_value(hash, state->coins_picked_up);
+  hash = hash_value(hash, state->doors_closed);
+  hash = hash_value(hash, state->exit_state);
+
+  return hash;
 }
 
 ////Updating based on mouse
@@ -7,6 +7,7 @@
 #include "guard.h"
 #include "sprite.h"
 #include "robinix.h"
+#include "utilities.h"
 
 struct Robinix;
 
@@ -61,7 +62,68 @@ typedef enum {
   M_OVER_ENUM_SIZE
 } mouse_over_enum;
 
+////Input that drives the simulation of a Level (all that is needed to advance it deterministically)
+#define LEVEL_INPUT_UP            BIT(0)
+#define LEVEL_INPUT_LEFT          BIT(1)
+#define LEVEL_INPUT_DOWN          BIT(2)
+#define LEVEL_INPUT_RIGHT         BIT(3)
+#define LEVEL_INPUT_ANGLE_STEPS   256 /* The player angle is quantized to this many steps, so that it fits in a byte */
+#define LEVEL_INPUT_NO_CLICK      0
+#define LEVEL_HASH_SEED           2166136261UL /* FNV-1a offset basis */
+#define LEVEL_MAX_GUARDS          8 /* Limits of what a LevelState can hold, checked when creating a Level */
+#define LEVEL_MAX_COINS           32
+#define LEVEL_MAX_DOORS           32
+#define LEVEL_REGION_CHUNK_SIZE   (64 * 1024) /* Bytes of each chunk of the Region everything in a Level is allocated in */
+#define LEVEL_DRAW_ALPHA_ONE      256 /* Interpolation factor of the current positions (0 is the positions before the last tick) */
+
+typedef struct {
+  //Movement keys pressed (LEVEL_INPUT_* bits)
+  unsigned char keys;
+  //Player angle, quantized
+  unsigned char angle;
+  //Index of the door clicked plus 1, or LEVEL_INPUT_NO_CLICK
+  unsigned char click;
+} LevelInput;
+
+//What happened in a Level during a step, for the caller to act upon
+typedef struct {
+  bool hit_guard;
+  bool got_treasure;
+  unsigned int n_coins_got;
+  bool at_exit;
+} LevelStepResult;
+
+//Dynamic state of a Guard, as kept in a LevelState
+typedef struct {
+  long x;
+  long y;
+  int speedX;
+  int speedY;
+  int current_checkpoint;
+  bool goingForward;
+  guard_direction_enum currdirection;
+} GuardState;
+
+//Everything in a Level that level_step changes, fixed size so that it can be saved and restored without allocations
+typedef struct {
+  long player_x;
+  long player_y;
+  int player_speedX;
+  int player_speedY;
+  double player_angle;
+  bool player_moving;
+  GuardState guards[LEVEL_MAX_GUARDS];
+  bool treasure_picked_up;
+  //Bit i is coin i picked up
+  unsigned long coins_picked_up;
+  //Bit i is door i closed
+  unsigned long doors_closed;
+  exit_state_enum exit_state;
+} LevelState;
+
 typedef struct Level {
+  //Region everything in the level (this included) is allocated in
+  Region * region;
   //Pointer to a player (Pointer to allow allocation and deallocation)
   Player * player;
   //Indicates the number of guards (size of array below)
@@ -90,6 +152,11 @@ typedef struct Level {
   mouse_over_enum current_mouse_over;
   //Bitmaps of the mouse cursor, drawn depending on the mouse being over different things
   Bitmap * mouse_bmps[M_OVER_ENUM_SIZE];
+  //Positions of the player and guards before the last tick, drawing interpolates between them and the current ones
+  long prev_player_x;
+  long prev_player_y;
+  long prev_guards_x[LEVEL_MAX_GUARDS];
+  long prev_guards_y[LEVEL_MAX_GUARDS];
 } Level;
 
 /**
@@ -101,7 +168,7 @@ typedef struct Level {
 Level * create_level(int level_n, bool is_mp);
 
 /**
- * @brief Level Object Destructor
+ * @brief Level Object Destructor, frees everything in the Level at once by destroying its Region
  * @param l_ptr Level Object to destroy
  */
 void destroy_level(Level ** l_ptr);
@@ -114,6 +181,21 @@ void destroy_level(Level ** l_ptr);
  */
 void draw_level(Level * l_ptr, long mouseX, long mouseY);
 
+/**
+ * @brief Draws a Level Object with the player and guards in between their positions before and after the last tick
+ * @param l_ptr  Level object to draw
+ * @param mouseX Current Mouse X
+ * @param mouseY Current Mouse Y
+ * @param alpha  How far into the last tick to draw the player and guards, from 0 to LEVEL_DRAW_ALPHA_ONE
+ */
+void draw_level_interpolated(Level * l_ptr, long mouseX, long mouseY, unsigned int alpha);
+
+/**
+ * @brief Keeps the current positions of the player and guards, to interpolate from when drawing. To be called before each tick
+ * @param l_ptr Level about to be updated
+ */
+void level_save_draw_positions(Level * l_ptr);
+
 /**
  * @brief Updates a Level
  * @param l_ptr Level to Update
@@ -121,6 +203,47 @@ void draw_level(Level * l_ptr, long mouseX, long mouseY);
  */
 void update_level(Level * l_ptr, struct Robinix * rob);
 
+/**
+ * @brief Builds the input for a Level from the current state of the keys and mouse
+ * @param  l_ptr   Level the input is for (player position is used for the angle and hovered doors for the click)
+ * @param  keys    Movement keys pressed (LEVEL_INPUT_* bits)
+ * @param  mouseX  Current Mouse X
+ * @param  mouseY  Current Mouse Y
+ * @param  clicked If the mouse was clicked since the last input
+ * @return         Input to pass to level_step
+ */
+LevelInput level_make_input(Level * l_ptr, unsigned char keys, long mouseX, long mouseY, bool clicked);
+
+/**
+ * @brief Advances a Level by one tick. Depends only on the Level state and the input, so that both players can simulate the same Level and get the same result
+ * @param  l_ptr Level to advance
+ * @param  input Input to apply in this tick
+ * @return       What happened during the step (collisions and pick ups)
+ */
+LevelStepResult level_step(Level * l_ptr, const LevelInput * input);
+
+/**
+ * @brief Saves the dynamic state of a Level (what level_step changes)
+ * @param l_ptr Level to save
+ * @param state Filled with the state of the Level
+ */
+void level_save_state(Level * l_ptr, LevelState * state);
+
+/**
+ * @brief Restores a dynamic state previously saved from the same Level
+ * @param l_ptr Level to restore
+ * @param state State to go back to
+ */
+void level_restore_state(Level * l_ptr, const LevelState * state);
+
+/**
+ * @brief Calculates a hash (FNV-1a) of the dynamic state of a Level, to check if two simulations of it diverged
+ * @param  state State to hash (see level_save_state)
+ * @param  hash  Hash to continue from (to combine several levels), or LEVEL_HASH_SEED
+ * @return       The updated hash
+ */
+unsigned long level_state_hash(const LevelState * state, unsigned long hash);
+
 /**
  * @brief Updates mouse overs for a Level
  * @param l_ptr  Level to update mouse overs for
@@ -147,46 +270,39 @@ void level_remote_got_treasure(Level * l_ptr);
  * @brief Constructor for Treasure Object
  * @param  startx x where the treasure will be created
  * @param  starty y where the treasure will be created
+ * @param  region Region to create it in (it is freed with the region)
  * @return        Returns a pointer to a valid Treasure object or NULL in case of failure
  */
-Treasure * create_treasure(long startx, long starty);
+Treasure * create_treasure(long startx, long starty, Region * region);
 /**
  * @brief Draws a Treasure object
  * @param t_ptr Treasure to draw
  */
 void draw_treasure(Treasure * t_ptr);
-/**
- * @brief Destructor for the Treasure Object
- * @param t_ptr Treasure to destroy
- */
-void destroy_treasure(Treasure ** t_ptr);
 
 /**
  * @brief Constructor for the Coin Object
  * @param  startx x where the coin will be created
  * @param  starty y where the coin will be created
+ * @param  region Region to create it in (it is freed with the region)
  * @return        Returns a pointer to a valid Coin object or NULL in case of failure
  */
-Coin * create_coin(long startx, long starty);
+Coin * create_coin(long startx, long starty, Region * region);
 /**
  * @brief Draws a Coin Object
  * @param c_ptr Coin to draw
  */
 void draw_coin(Coin * c_ptr);
-/**
- * @brief Destructor for the Coin Object
- * @param c_ptr Coin to destroy
- */
-void destroy_coin(Coin ** c_ptr);
 
 /**
  * @brief Constructor for the Exit Object
  * @param  startx      x where the Exit will be created
  * @param  starty      y where the Exit will be created
  * @param  superlocked if the exit should start superlocked (for use in multiplayer)
+ * @param  region      Region to create it in (it is freed with the region)
  * @return             Returns a pointer to a valid Exit object or NULL in case of failure
  */
-Exit * create_exit(long startx, long starty, bool superlocked);
+Exit * create_exit(long startx, long starty, bool superlocked, Region * region);
 /**
  * @brief Draws an Exit Object
  * @param ex_ptr Exit to draw
@@ -197,20 +313,16 @@ void draw_exit(Exit * ex_ptr);
  * @param ex_ptr Exit to alter
  */
 void exit_goto_next_state(Exit * ex_ptr);
-/**
- * @brief Destructor for the Exit Object
- * @param ex_ptr Exit to destroy
- */
-void destroy_exit(Exit ** ex_ptr);
 
 /**
  * @brief Constructor for the Door Object
  * @param  startx          x where the Door will be created
  * @param  starty          y where the Door will be created
  * @param  closed_at_start If the door should start closed
+ * @param  region          Region to create it in (it is freed with the region)
  * @return                 Returns a pointer to a valid Door object or NULL in case of failure
  */
-Door * create_door(long startx, long starty, bool closed_at_start);
+Door * create_door(long startx, long starty, bool closed_at_start, Region * region);
 /**
  * @brief Draws a Door Object
  * @param d_ptr Door to draw
@@ -225,10 +337,4 @@ void draw_door(Door * d_ptr);
  * @return           Returns true if mouse if over this certain door, or false if not
  */
 bool is_mouse_over_door(Door * d_ptr, Bitmap * mouse_bmp, long mouseX, long mouseY);
-/**
- * @brief Destructor for the Door Object
- * @param d_ptr Door to destroy
- */
-void destroy_door(Door ** d_ptr);
-
 #endif /* __LEVEL_H */
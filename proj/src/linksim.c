@@ -0,0 +1,196 @@
+#include "linksim.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "uart.h"
+#include "serialframe.h"
+
+LinkSim * create_linksim(const LinkSimConfig * config) {
+  if(config == NULL) {
+    return NULL;
+  }
+
+  LinkSim * ls_ptr = calloc(1, sizeof *ls_ptr);
+
+  if(ls_ptr == NULL) {
+    return NULL;
+  }
+
+  ls_ptr->config = *config;
+  ls_ptr->random_state = config->seed;
+
+  return ls_ptr;
+}
+
+void destroy_linksim(LinkSim ** ls_ptr) {
+  if(*ls_ptr == NULL) {
+    return;
+  }
+
+  free(*ls_ptr);
+  *ls_ptr = NULL;
+}
+
+void linksim_default_config(LinkSimConfig * config) {
+  memset(config, 0, sizeof *config);
+  config->baud_rate = UART_GAME_RATE;
+  config->bits_per_char = UART_BITS_PER_CHAR;
+  config->seed = 1;
+}
+
+//Own generator (instead of rand) so that each link has its own reproducible sequence. Returns 30 random bits
+static unsigned long random_bits(LinkSim * ls_ptr) {
+  unsigned long value = 0;
+  int i;
+  for(i = 0; i < 2; i++) {
+    ls_ptr->random_state = (ls_ptr->random_state * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    value = (value << 15) | ((ls_ptr->random_state >> 16) & 0x7FFF);
+  }
+  return value;
+}
+
+static bool random_chance(LinkSim * ls_ptr, unsigned long ppm) {
+  return ppm > 0 && random_bits(ls_ptr) % LINKSIM_PPM < ppm;
+}
+
+//Time the transmitter takes to send one byte
+static unsigned long long char_time_us(LinkSim * ls_ptr) {
+  if(ls_ptr->config.baud_rate == 0) {
+    return 0;
+  }
+  return ls_ptr->config.bits_per_char * LINKSIM_US_PER_SECOND / ls_ptr->config.baud_rate;
+}
+
+void linksim_push(LinkSim * ls_ptr, const unsigned char * bytes, unsigned int n, unsigned long long now_us) {
+  unsigned int i;
+  for(i = 0; i < n; i++) {
+    ls_ptr->stats.bytes_sent++;
+
+    //The byte takes the line even if it ends up lost
+    unsigned long long start_us = MAX_VAL(now_us, ls_ptr->line_free_us);
+    ls_ptr->line_free_us = start_us + char_time_us(ls_ptr);
+
+    if(random_chance(ls_ptr, ls_ptr->config.byte_loss_ppm)) {
+      ls_ptr->stats.bytes_lost++;
+      continue;
+    }
+
+    if(ls_ptr->n_bytes == LINKSIM_QUEUE_SIZE) {
+      ls_ptr->stats.overflow_drops++;
+      continue;
+    }
+
+    unsigned char byte = bytes[i];
+    if(random_chance(ls_ptr, ls_ptr->config.bit_flip_ppm)) {
+      byte ^= BIT(random_bits(ls_ptr) % 8);
+      ls_ptr->stats.bits_flipped++;
+    }
+
+    unsigned long long arrival_us = ls_ptr->line_free_us + ls_ptr->config.latency_us;
+    if(ls_ptr->config.jitter_us > 0) {
+      arrival_us += random_bits(ls_ptr) % (ls_ptr->config.jitter_us + 1);
+    }
+    //Bytes can be delayed but never reordered
+    arrival_us = MAX_VAL(arrival_us, ls_ptr->last_arrival_us);
+    ls_ptr->last_arrival_us = arrival_us;
+
+    LinkSimByte * slot = &ls_ptr->queue[(ls_ptr->head + ls_ptr->n_bytes) % LINKSIM_QUEUE_SIZE];
+    slot->byte = byte;
+    slot->arrival_us = arrival_us;
+    ls_ptr->n_bytes++;
+  }
+}
+
+unsigned int linksim_pop(LinkSim * ls_ptr, unsigned long long now_us, unsigned char * out, unsigned int max) {
+  unsigned int n = 0;
+  while(n < max && ls_ptr->n_bytes > 0 && ls_ptr->queue[ls_ptr->head].arrival_us <= now_us) {
+    out[n++] = ls_ptr->queue[ls_ptr->head].byte;
+    ls_ptr->head = (ls_ptr->head + 1) % LINKSIM_QUEUE_SIZE;
+    ls_ptr->n_bytes--;
+  }
+  ls_ptr->stats.bytes_delivered += n;
+  return n;
+}
+
+unsigned long long linksim_backlog_us(LinkSim * ls_ptr, unsigned long long now_us) {
+  if(ls_ptr->line_free_us <= now_us) {
+    return 0;
+  }
+  return ls_ptr->line_free_us - now_us;
+}
+
+#define LINKSIM_BENCH_STEP_US   1000 /* Simulated time advances 1 ms at a time */
+#define LINKSIM_BENCH_SEQS      256 /* Frames are numbered by their first payload byte */
+
+void linksim_benchmark(const LinkSimConfig * config, unsigned int payload_len, unsigned int seconds) {
+  if(payload_len < 1 || payload_len > SERIALFRAME_MAX_PAYLOAD || seconds == 0) {
+    printf("linksim_benchmark::Invalid payload length %u or duration %u\n", payload_len, seconds);
+    return;
+  }
+
+  LinkSim * link = create_linksim(config);
+  if(link == NULL) {
+    printf("linksim_benchmark::Could not create the link\n");
+    return;
+  }
+
+  SerialFrameDecoder decoder;
+  memset(&decoder, 0, sizeof decoder);
+  unsigned long long send_times[LINKSIM_BENCH_SEQS];
+  unsigned long frames_sent = 0, frames_received = 0, frames_wrong = 0;
+  unsigned long long total_latency_us = 0, max_latency_us = 0;
+  unsigned long long end_us = seconds * LINKSIM_US_PER_SECOND;
+  unsigned long long now_us;
+
+  for(now_us = 0; now_us < end_us; now_us += LINKSIM_BENCH_STEP_US) {
+    //Keeping the transmitter busy, as a sender limited only by the link would
+    if(linksim_backlog_us(link, now_us) == 0) {
+      unsigned char payload[SERIALFRAME_MAX_PAYLOAD];
+      unsigned char encoded[SERIALFRAME_MAX_SIZE];
+      unsigned int i;
+      payload[0] = (unsigned char) frames_sent;
+      for(i = 1; i < payload_len; i++) {
+        payload[i] = (unsigned char) (payload[0] + i);
+      }
+      unsigned int encoded_len = serialframe_encode(SERIALFRAME_OP_RAW, payload, payload_len, encoded);
+      send_times[frames_sent % LINKSIM_BENCH_SEQS] = now_us;
+      linksim_push(link, encoded, encoded_len, now_us);
+      frames_sent++;
+    }
+
+    unsigned char received[SERIALFRAME_MAX_SIZE];
+    unsigned int n = linksim_pop(link, now_us, received, sizeof received);
+    unsigned int i;
+    for(i = 0; i < n; i++) {
+      serialframe_decoder_feed(&decoder, received[i]);
+    }
+
+    SerialFrame frame;
+    while(serialframe_decoder_next(&decoder, &frame)) {
+      frames_received++;
+      //A corrupted frame that got past the CRC
+      bool wrong = frame.length != payload_len;
+      for(i = 1; !wrong && i < payload_len; i++) {
+        wrong = frame.payload[i] != (unsigned char) (frame.payload[0] + i);
+      }
+      if(wrong) {
+        frames_wrong++;
+        continue;
+      }
+
+      unsigned long long latency_us = now_us - send_times[frame.payload[0]];
+      total_latency_us += latency_us;
+      max_latency_us = MAX_VAL(max_latency_us, latency_us);
+    }
+  }
+
+  unsigned long frames_ok = frames_received - frames_wrong;
+  //Since printf might not support floating point or long long values, printing in bytes per second and milliseconds
+  printf("linksim_benchmark::%u baud, latency %lu us, jitter %lu us, loss %lu ppm, flips %lu ppm, %u byte payloads for %u s\n", config->baud_rate, config->latency_us, config->jitter_us, config->byte_loss_ppm, config->bit_flip_ppm, payload_len, seconds);
+  printf("linksim_benchmark::%lu frames sent, %lu received, %lu not received (lost, rejected by the CRC or still in flight), %lu corrupted past the CRC\n", frames_sent, frames_ok, frames_sent - frames_received, frames_wrong);
+  printf("linksim_benchmark::throughput %lu payload B/s (%lu wire B/s), latency avg %lu max %lu ms\n", (unsigned long) (frames_ok * payload_len / seconds), (unsigned long) (link->stats.bytes_delivered / seconds), (unsigned long) (frames_ok > 0 ? total_latency_us / frames_ok / 1000 : 0), (unsigned long) (max_latency_us / 1000));
+  printf("linksim_benchmark::%lu bytes lost, %lu bits flipped, %lu CRC errors, %lu bytes discarded by the decoder\n", link->stats.bytes_lost, link->stats.bits_flipped, decoder.crc_errors, decoder.bytes_discarded);
+
+  destroy_linksim(&link);
+}
@@ -0,0 +1,123 @@
+#ifndef __LINKSIM_H
+#define __LINKSIM_H
+
+#include <stdbool.h>
+
+/** @defgroup linksim linksim
+ * @{
+ *
+ * Simulation of one direction of a serial link: baud rate throttling, latency, jitter, byte loss and bit flips
+ */
+
+/*
+ * Bytes pushed into the link leave the transmitter one after the other at the configured baud rate,
+ * and arrive latency plus a random jitter after being fully transmitted. Like on a real serial line they never overtake each other.
+ * Each byte may be lost or have one of its bits flipped, with the configured probabilities.
+ * Time is in microseconds and always passed by the caller, so the link can run in real time or in simulated time.
+ */
+
+#define LINKSIM_QUEUE_SIZE      2048 /* Bytes that can be on the wire at once */
+#define LINKSIM_PPM             1000000 /* Probabilities are in parts per million */
+#define LINKSIM_US_PER_SECOND   1000000ULL
+
+typedef struct {
+  //Bits per second, 0 for no throttling
+  unsigned int baud_rate;
+  //Bits sent per byte (start, data, parity and stop bits)
+  unsigned int bits_per_char;
+  //Fixed one way latency, on top of the time the byte takes on the wire
+  unsigned long latency_us;
+  //Maximum random extra latency (uniformly distributed)
+  unsigned long jitter_us;
+  //Probability of a byte being lost
+  unsigned long byte_loss_ppm;
+  //Probability of a byte having one of its bits flipped
+  unsigned long bit_flip_ppm;
+  //Seed of the random generator, the same seed and traffic always give the same result
+  unsigned long seed;
+} LinkSimConfig;
+
+typedef struct {
+  unsigned char byte;
+  unsigned long long arrival_us;
+} LinkSimByte;
+
+typedef struct {
+  unsigned long bytes_sent;
+  unsigned long bytes_delivered;
+  unsigned long bytes_lost;
+  unsigned long bits_flipped;
+  unsigned long overflow_drops;
+} LinkSimStats;
+
+typedef struct LinkSim {
+  LinkSimConfig config;
+  //Bytes on the wire (circular), in order of arrival
+  LinkSimByte queue[LINKSIM_QUEUE_SIZE];
+  unsigned int head;
+  unsigned int n_bytes;
+  //When the transmitter is done with the last byte pushed
+  unsigned long long line_free_us;
+  //Arrival time of the last byte pushed (no byte arrives before it)
+  unsigned long long last_arrival_us;
+  unsigned long random_state;
+  LinkSimStats stats;
+} LinkSim;
+
+/**
+ * @brief LinkSim Object Constructor
+ * @param  config Configuration of the link (copied)
+ * @return        Returns a pointer to a valid LinkSim Object or NULL in case of failure
+ */
+LinkSim * create_linksim(const LinkSimConfig * config);
+
+/**
+ * @brief LinkSim Object Destructor
+ * @param ls_ptr LinkSim Object to destroy
+ */
+void destroy_linksim(LinkSim ** ls_ptr);
+
+/**
+ * @brief Fills a configuration with the parameters of the game link (1200 baud, no latency, jitter or errors)
+ * @param config Configuration to fill
+ */
+void linksim_default_config(LinkSimConfig * config);
+
+/**
+ * @brief Puts bytes on the link
+ * @param ls_ptr LinkSim Object
+ * @param bytes  Bytes to send
+ * @param n      Number of bytes
+ * @param now_us Current time
+ */
+void linksim_push(LinkSim * ls_ptr, const unsigned char * bytes, unsigned int n, unsigned long long now_us);
+
+/**
+ * @brief Takes the bytes that already arrived at the other end of the link
+ * @param  ls_ptr LinkSim Object
+ * @param  now_us Current time
+ * @param  out    Buffer for the bytes
+ * @param  max    Size of the buffer
+ * @return        Number of bytes written to out
+ */
+unsigned int linksim_pop(LinkSim * ls_ptr, unsigned long long now_us, unsigned char * out, unsigned int max);
+
+/**
+ * @brief Checks how long the transmitter will still be busy with the bytes already pushed
+ * @param  ls_ptr LinkSim Object
+ * @param  now_us Current time
+ * @return        Time in microseconds, 0 if it is idle
+ */
+unsigned long long linksim_backlog_us(LinkSim * ls_ptr, unsigned long long now_us);
+
+/**
+ * @brief Sends frames through a simulated link for a while, printing the throughput, the latency and how many frames were lost or corrupted
+ * @param config      Configuration of the link
+ * @param payload_len Payload length of the frames sent
+ * @param seconds     Simulated time to run for
+ */
+void linksim_benchmark(const LinkSimConfig * config, unsigned int payload_len, unsigned int seconds);
+
+/** @} */
+
+#endif /* __LINKSIM_H */
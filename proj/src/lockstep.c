@@ -0,0 +1,244 @@
+#include "lockstep.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "commlink.h"
+#include "robinix.h"
+
+Lockstep * create_lockstep(bool is_player1) {
+  //calloc so that every input starts empty (no keys, angle 0, no click), which is what both players use for the first turns
+  Lockstep * ls_ptr = calloc(1, sizeof *ls_ptr);
+
+  if(ls_ptr == NULL) {
+    return NULL;
+  }
+
+  ls_ptr->is_player1 = is_player1;
+  ls_ptr->local_known = LOCKSTEP_DELAY_TURNS;
+  ls_ptr->remote_known = LOCKSTEP_DELAY_TURNS;
+  ls_ptr->remote_acked = LOCKSTEP_DELAY_TURNS;
+
+  return ls_ptr;
+}
+
+void destroy_lockstep(Lockstep ** ls_ptr) {
+  if(*ls_ptr == NULL) {
+    return;
+  }
+
+  free(*ls_ptr);
+  *ls_ptr = NULL;
+}
+
+//Turns are sent as their LSB, the full value is recovered from the closest turn to a reference one
+static unsigned long turn_from_lsb(unsigned long reference, unsigned char lsb) {
+  signed char delta = (signed char) (lsb - (unsigned char) reference);
+  if(delta < 0 && (unsigned long) (-delta) > reference) {
+    return 0;
+  }
+  return reference + delta;
+}
+
+static void send_inputs(Lockstep * ls_ptr) {
+  unsigned char payload[2 + LOCKSTEP_MAX_INPUTS_PER_FRAME * LOCKSTEP_INPUT_SIZE];
+  unsigned int len = 0;
+
+  //First remote turn we are still missing (acknowledges every one before it)
+  payload[len++] = (unsigned char) ls_ptr->remote_known;
+  //Sending every input the other player does not have yet
+  payload[len++] = (unsigned char) ls_ptr->remote_acked;
+  unsigned long turn;
+  for(turn = ls_ptr->remote_acked; turn < ls_ptr->local_known && turn < ls_ptr->remote_acked + LOCKSTEP_MAX_INPUTS_PER_FRAME; turn++) {
+    const LevelInput * input = &ls_ptr->local_inputs[turn % LOCKSTEP_BUFFER_TURNS];
+    //There are never more than 15 doors, so the click fits in a nibble
+    payload[len++] = (input->keys & 0x0F) | (input->click << 4);
+    payload[len++] = input->angle;
+  }
+
+  commlink_send(COMM_OP_LOCKSTEP_INPUTS, payload, len);
+  ls_ptr->ticks_since_send = 0;
+  ls_ptr->stats.input_frames_sent++;
+  ls_ptr->stats.input_bytes_sent += len + SERIALFRAME_OVERHEAD;
+}
+
+bool lockstep_needs_local_input(Lockstep * ls_ptr) {
+  return ls_ptr->tick_in_turn == 0 && ls_ptr->local_known == ls_ptr->turn + LOCKSTEP_DELAY_TURNS;
+}
+
+void lockstep_set_local_input(Lockstep * ls_ptr, const LevelInput * input) {
+  ls_ptr->local_inputs[ls_ptr->local_known % LOCKSTEP_BUFFER_TURNS] = *input;
+  ls_ptr->local_known++;
+  //Sending straight away, the sooner it arrives the less the other player has to go back and simulate again
+  send_inputs(ls_ptr);
+}
+
+bool lockstep_get_inputs(Lockstep * ls_ptr, unsigned long tick, LevelInput * p1_input, LevelInput * p2_input) {
+  unsigned long turn = tick / LOCKSTEP_TURN_TICKS;
+  bool known = turn < ls_ptr->remote_known;
+
+  LevelInput local = ls_ptr->local_inputs[turn % LOCKSTEP_BUFFER_TURNS];
+  LevelInput remote = {0, 0, LEVEL_INPUT_NO_CLICK};
+  if(known) {
+    remote = ls_ptr->remote_inputs[turn % LOCKSTEP_BUFFER_TURNS];
+  } else if(ls_ptr->remote_known > 0) {
+    //Prediction: the other player keeps doing what it did in the last turn we know of (without clicking again)
+    remote = ls_ptr->remote_inputs[(ls_ptr->remote_known - 1) % LOCKSTEP_BUFFER_TURNS];
+    remote.click = LEVEL_INPUT_NO_CLICK;
+  }
+  //The input holds for the whole turn, but a click only happens once
+  if(tick % LOCKSTEP_TURN_TICKS != 0) {
+    local.click = LEVEL_INPUT_NO_CLICK;
+    remote.click = LEVEL_INPUT_NO_CLICK;
+  }
+
+  if(ls_ptr->is_player1) {
+    *p1_input = local;
+    *p2_input = remote;
+  } else {
+    *p1_input = remote;
+    *p2_input = local;
+  }
+
+  return known;
+}
+
+unsigned long lockstep_get_remote_known(Lockstep * ls_ptr) {
+  return ls_ptr->remote_known;
+}
+
+void lockstep_advance(Lockstep * ls_ptr) {
+  ls_ptr->tick_in_turn++;
+  if(ls_ptr->tick_in_turn < LOCKSTEP_TURN_TICKS) {
+    return;
+  }
+
+  ls_ptr->tick_in_turn = 0;
+  ls_ptr->turn++;
+  ls_ptr->stats.turns_simulated++;
+}
+
+//Gets the slot for the hash of the passed turn, resetting it if it held an older turn
+static LockstepHashSlot * get_hash_slot(Lockstep * ls_ptr, unsigned long turn) {
+  LockstepHashSlot * slot = &ls_ptr->hashes[(turn / LOCKSTEP_HASH_INTERVAL) % LOCKSTEP_HASH_SLOTS];
+  if(slot->turn != turn) {
+    slot->turn = turn;
+    slot->local_valid = false;
+    slot->remote_valid = false;
+  }
+  return slot;
+}
+
+static void compare_hashes(Lockstep * ls_ptr, LockstepHashSlot * slot) {
+  if(!slot->local_valid || !slot->remote_valid) {
+    return;
+  }
+
+  ls_ptr->stats.hashes_checked++;
+  if(slot->local_hash != slot->remote_hash) {
+    printf("lockstep::Desync detected at turn %lu, local hash %lx, remote hash %lx\n", slot->turn, slot->local_hash, slot->remote_hash);
+    ls_ptr->desynced = true;
+    ls_ptr->stats.desyncs++;
+  }
+  //Only compared once
+  slot->remote_valid = false;
+}
+
+void lockstep_record_hash(Lockstep * ls_ptr, unsigned long turn, unsigned long hash) {
+  LockstepHashSlot * slot = get_hash_slot(ls_ptr, turn);
+  slot->local_hash = hash;
+  slot->local_valid = true;
+
+  //Hashes are rare and a lost one would leave a hole in the checking, so they are sent reliably
+  unsigned char payload[2 * VARINT_MAX_SIZE];
+  unsigned int len = varint_encode(turn, payload);
+  len += varint_encode(hash, payload + len);
+  commlink_send_reliable(COMM_OP_STATE_HASH, payload, len);
+
+  compare_hashes(ls_ptr, slot);
+}
+
+void lockstep_tick(Lockstep * ls_ptr) {
+  ls_ptr->ticks_since_send++;
+  //If no input was sampled for over a turn (simulation held back), the unacknowledged ones are sent again (they may have been lost)
+  if(ls_ptr->ticks_since_send > LOCKSTEP_TURN_TICKS) {
+    send_inputs(ls_ptr);
+  }
+}
+
+static void receive_inputs(Lockstep * ls_ptr, const SerialFrameView * frame) {
+  if(frame->length < 2 || (frame->length - 2) % LOCKSTEP_INPUT_SIZE != 0) {
+    printf("lockstep::Invalid inputs frame with length %u\n", frame->length);
+    return;
+  }
+
+  //Acknowledgement of our inputs (never going back, an older frame may arrive after a newer one)
+  unsigned long acked = turn_from_lsb(ls_ptr->remote_acked, frame->payload[0]);
+  if(acked > ls_ptr->remote_acked && acked <= ls_ptr->local_known) {
+    ls_ptr->remote_acked = acked;
+  }
+
+  unsigned long first = turn_from_lsb(ls_ptr->remote_known, frame->payload[1]);
+  unsigned int n_inputs = (frame->length - 2) / LOCKSTEP_INPUT_SIZE;
+  unsigned int i;
+  for(i = 0; i < n_inputs; i++) {
+    unsigned long turn = first + i;
+    //Only turns not known yet that have a free slot in the buffer
+    if(turn < ls_ptr->remote_known || turn >= ls_ptr->turn + LOCKSTEP_BUFFER_TURNS || ls_ptr->remote_received[turn % LOCKSTEP_BUFFER_TURNS]) {
+      continue;
+    }
+
+    LevelInput * input = &ls_ptr->remote_inputs[turn % LOCKSTEP_BUFFER_TURNS];
+    input->keys = frame->payload[2 + i * LOCKSTEP_INPUT_SIZE] & 0x0F;
+    input->click = frame->payload[2 + i * LOCKSTEP_INPUT_SIZE] >> 4;
+    input->angle = frame->payload[3 + i * LOCKSTEP_INPUT_SIZE];
+    ls_ptr->remote_received[turn % LOCKSTEP_BUFFER_TURNS] = true;
+  }
+
+  //Turns that become known free their slot for the remote input LOCKSTEP_BUFFER_TURNS turns ahead (their input stays there until then)
+  while(ls_ptr->remote_received[ls_ptr->remote_known % LOCKSTEP_BUFFER_TURNS] && ls_ptr->remote_known < ls_ptr->turn + LOCKSTEP_BUFFER_TURNS) {
+    ls_ptr->remote_received[ls_ptr->remote_known % LOCKSTEP_BUFFER_TURNS] = false;
+    ls_ptr->remote_known++;
+  }
+}
+
+static void receive_hash(Lockstep * ls_ptr, const SerialFrameView * frame) {
+  unsigned int offset = 0;
+  unsigned long long turn, hash;
+  if(serialframe_read_varint(frame, &offset, &turn) != 0 || serialframe_read_varint(frame, &offset, &hash) != 0) {
+    printf("lockstep::Invalid hash frame\n");
+    return;
+  }
+
+  LockstepHashSlot * slot = get_hash_slot(ls_ptr, (unsigned long) turn);
+  slot->remote_hash = (unsigned long) hash;
+  slot->remote_valid = true;
+  compare_hashes(ls_ptr, slot);
+}
+
+bool lockstep_receive(Lockstep * ls_ptr, const SerialFrameView * frame) {
+  if(frame->opcode == COMM_OP_LOCKSTEP_INPUTS) {
+    receive_inputs(ls_ptr, frame);
+    return true;
+  }
+
+  if(frame->opcode == COMM_OP_STATE_HASH) {
+    receive_hash(ls_ptr, frame);
+    return true;
+  }
+
+  return false;
+}
+
+bool lockstep_is_desynced(Lockstep * ls_ptr) {
+  return ls_ptr->desynced;
+}
+
+void lockstep_print_stats(Lockstep * ls_ptr) {
+  unsigned long bytes_per_second = 0;
+  if(ls_ptr->stats.turns_simulated > 0) {
+    bytes_per_second = ls_ptr->stats.input_bytes_sent * LOCKSTEP_TICKS_PER_SECOND / LOCKSTEP_TURN_TICKS / ls_ptr->stats.turns_simulated;
+  }
+
+  printf("lockstep::%lu turns simulated\n", ls_ptr->stats.turns_simulated);
+  printf("lockstep::%lu input frames sent (%lu bytes, %lu B/s), %lu hashes checked, %lu desyncs\n", ls_ptr->stats.input_frames_sent, ls_ptr->stats.input_bytes_sent, bytes_per_second, ls_ptr->stats.hashes_checked, ls_ptr->stats.desyncs);
+}
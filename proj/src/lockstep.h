@@ -0,0 +1,162 @@
+#ifndef __LOCKSTEP_H
+#define __LOCKSTEP_H
+
+#include <stdbool.h>
+#include "level.h"
+#include "serialframe.h"
+
+/** @defgroup lockstep lockstep
+ * @{
+ *
+ * Deterministic lockstep for multiplayer: only the inputs of each player cross the wire and both machines simulate both levels with the same inputs
+ */
+
+/*
+ * Time is split in turns of LOCKSTEP_TURN_TICKS ticks, and the input of each player is sampled once per turn (at its start).
+ * The input sampled at the start of turn k is used in turn k + LOCKSTEP_DELAY_TURNS.
+ * While the remote input for a turn has not arrived, it is predicted to be the last one known, and the simulation goes on with it
+ * (the rollback module goes back and simulates again if the prediction turns out wrong).
+ *
+ * Inputs are sent unreliably, once per turn, in a frame with every input not yet acknowledged by the other player:
+ *   | first turn missing from the other player (LSB) | first turn in frame (LSB) | input 1 | input 2 | ...
+ * where the first field acknowledges every input of the other player before it, and each input is:
+ *   | keys (low nibble) and click (high nibble) | angle |
+ * Every LOCKSTEP_HASH_INTERVAL turns both players hash the state of both levels and exchange the hashes, a mismatch means a desync.
+ */
+
+#define LOCKSTEP_TURN_TICKS           10 /* 6 turns per second, with input frames of around 12 bytes that is ~70 of the ~109 bytes per second of the 1200 baud link */
+#define LOCKSTEP_DELAY_TURNS          0 /* Local input is used straight away, the remote one is predicted until it arrives */
+#define LOCKSTEP_BUFFER_TURNS         16 /* Turns of input kept (must be a power of 2) */
+#define LOCKSTEP_MAX_INPUTS_PER_FRAME 6
+#define LOCKSTEP_HASH_INTERVAL        6 /* Once per second */
+#define LOCKSTEP_HASH_SLOTS           4
+#define LOCKSTEP_INPUT_SIZE           2 /* Bytes used by an input in a frame */
+#define LOCKSTEP_TICKS_PER_SECOND     60 /* For the statistics */
+
+typedef struct {
+  unsigned long turns_simulated;
+  unsigned long input_frames_sent;
+  unsigned long input_bytes_sent;
+  unsigned long hashes_checked;
+  unsigned long desyncs;
+} LockstepStats;
+
+typedef struct {
+  unsigned long turn;
+  bool local_valid;
+  unsigned long local_hash;
+  bool remote_valid;
+  unsigned long remote_hash;
+} LockstepHashSlot;
+
+typedef struct Lockstep {
+  bool is_player1;
+  //Turn being simulated (ahead of what is confirmed, with predicted remote inputs) and how many of its ticks were already simulated
+  unsigned long turn;
+  unsigned int tick_in_turn;
+  //Inputs of each player, indexed by turn modulo LOCKSTEP_BUFFER_TURNS
+  LevelInput local_inputs[LOCKSTEP_BUFFER_TURNS];
+  LevelInput remote_inputs[LOCKSTEP_BUFFER_TURNS];
+  bool remote_received[LOCKSTEP_BUFFER_TURNS];
+  //Local inputs are known for every turn before this one
+  unsigned long local_known;
+  //Remote inputs are known for every turn before this one (some after it may also be known)
+  unsigned long remote_known;
+  //The other player has every local input before this turn
+  unsigned long remote_acked;
+  //Ticks since the last input frame was sent
+  unsigned int ticks_since_send;
+  LockstepHashSlot hashes[LOCKSTEP_HASH_SLOTS];
+  bool desynced;
+  LockstepStats stats;
+} Lockstep;
+
+/**
+ * @brief Lockstep Object Constructor. The first LOCKSTEP_DELAY_TURNS turns use empty inputs for both players
+ * @param  is_player1 If this machine is player 1 (decides which level is the first in the simulation order)
+ * @return            Returns a pointer to a valid Lockstep Object or NULL in case of failure
+ */
+Lockstep * create_lockstep(bool is_player1);
+
+/**
+ * @brief Lockstep Object Destructor
+ * @param ls_ptr Lockstep Object to destroy
+ */
+void destroy_lockstep(Lockstep ** ls_ptr);
+
+/**
+ * @brief Checks if the local input for a new turn must be sampled (at the start of each turn)
+ * @param  ls_ptr Lockstep Object
+ * @return        true if lockstep_set_local_input should be called before simulating, false otherwise
+ */
+bool lockstep_needs_local_input(Lockstep * ls_ptr);
+
+/**
+ * @brief Sets the local input sampled now, to be used LOCKSTEP_DELAY_TURNS turns from the current one, and sends it to the other player
+ * @param ls_ptr Lockstep Object
+ * @param input  Local input
+ */
+void lockstep_set_local_input(Lockstep * ls_ptr, const LevelInput * input);
+
+/**
+ * @brief Gets the inputs of both players for a tick (the current one or an earlier one being simulated again)
+ * @param  ls_ptr   Lockstep Object
+ * @param  tick     Tick to get the inputs for (its local input must be known)
+ * @param  p1_input Filled with the input of player 1
+ * @param  p2_input Filled with the input of player 2
+ * @return          true if both inputs are known, false if the remote one is a prediction
+ */
+bool lockstep_get_inputs(Lockstep * ls_ptr, unsigned long tick, LevelInput * p1_input, LevelInput * p2_input);
+
+/**
+ * @brief Gets the first turn whose remote input is not known yet
+ * @param  ls_ptr Lockstep Object
+ * @return        Turn number, the remote inputs of every turn before it are known
+ */
+unsigned long lockstep_get_remote_known(Lockstep * ls_ptr);
+
+/**
+ * @brief Marks the current tick as simulated, moving to the next one
+ * @param ls_ptr Lockstep Object
+ */
+void lockstep_advance(Lockstep * ls_ptr);
+
+/**
+ * @brief Records the hash of the state of both levels at the start of a turn and sends it to the other player.
+ * Must only be called with states simulated with known inputs, every LOCKSTEP_HASH_INTERVAL turns
+ * @param ls_ptr Lockstep Object
+ * @param turn   Turn at whose start the state was taken
+ * @param hash   Hash of the state (see level_state_hash)
+ */
+void lockstep_record_hash(Lockstep * ls_ptr, unsigned long turn, unsigned long hash);
+
+/**
+ * @brief To be called once per tick (even when not simulating): resends inputs not yet acknowledged every LOCKSTEP_TURN_TICKS ticks
+ * @param ls_ptr Lockstep Object
+ */
+void lockstep_tick(Lockstep * ls_ptr);
+
+/**
+ * @brief Processes a received frame if it is a lockstep one (inputs or hash)
+ * @param  ls_ptr Lockstep Object
+ * @param  frame  Received frame
+ * @return        true if the frame was a lockstep one, false otherwise
+ */
+bool lockstep_receive(Lockstep * ls_ptr, const SerialFrameView * frame);
+
+/**
+ * @brief Checks if a hash mismatch was detected
+ * @param  ls_ptr Lockstep Object
+ * @return        true if both simulations diverged, false otherwise
+ */
+bool lockstep_is_desynced(Lockstep * ls_ptr);
+
+/**
+ * @brief Prints the statistics of the lockstep session
+ * @param ls_ptr Lockstep Object
+ */
+void lockstep_print_stats(Lockstep * ls_ptr);
+
+/** @} */
+
+#endif /* __LOCKSTEP_H */
@@ -7,9 +7,17 @@
 #include <minix/drivers.h>
 //User includes
 #include "game.h"
+#include "clocksync.h"
+#include "linksim.h"
+#include "scoremanager.h"
+#include "epoch.h"
+
+#define SYNC_SIM_RUNS 1000
+#define LINK_SIM_PAYLOAD 16 /* Around the size of the messages the game sends */
+#define LINK_SIM_SECONDS 60
 
 static int proc_args(int argc, char **argv);
-//static unsigned long parse_ulong(char *str, int base);
+static unsigned long parse_ulong(char *str, int base);
 //static long parse_long(char *str, int base);
 static void print_usage(char **argv);
 
@@ -30,7 +38,12 @@ static void print_usage(char **argv) {
   printf("Usage: one of the following:\n"
           "\t service run %s -args \"play\"\n"
           "\t service run %s -args \"uart <tx | rx> <string - text, if tx>\"\n"
-          , argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+          "\t service run %s -args \"sync_sim <decimal no. - latency> <decimal no. - jitter>\" (both in hundredths of a tick)\n"
+          "\t service run %s -args \"headless <decimal no. - level, 0 for all> <decimal no. - ticks> <decimal no. - ticks between frame dumps, 0 for none> [script path]\"\n"
+          "\t service run %s -args \"link_sim <decimal no. - latency> <decimal no. - jitter> <decimal no. - byte loss> <decimal no. - bit flips>\" (ms and parts per million)\n"
+          "\t service run %s -args \"score_bench <decimal no. - scores> <decimal no. - scores inserted>\"\n"
+          "\t service run %s -args \"epoch_test <decimal no. - random times>\"\n"
+          , argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
 }
 
 static int proc_args(int argc, char **argv) {
@@ -81,6 +94,95 @@ static int proc_args(int argc, char **argv) {
     printf("robinix::test_uart_tx(%s)\n", text);
     return test_uart_tx(text);
 
+  } else if(strncmp(argv[1], "sync_sim", strlen("sync_sim")) == 0) {
+    //
+    if (argc != 4) {
+      printf("robinix: wrong no. of arguments for clocksync_simulate()\n");
+      return 1;
+    }
+
+    unsigned long latency = parse_ulong(argv[2], 10);
+    unsigned long jitter = parse_ulong(argv[3], 10);
+    if(latency == ULONG_MAX || jitter == ULONG_MAX) {
+      return 1;
+    }
+
+    printf("robinix::clocksync_simulate(%lu, %lu)\n", latency, jitter);
+    clocksync_simulate(latency / 100.0, jitter / 100.0, SYNC_SIM_RUNS);
+    return 0;
+  } else if(strncmp(argv[1], "headless", strlen("headless")) == 0) {
+    //
+    if (argc != 5 && argc != 6) {
+      printf("robinix: wrong no. of arguments for play_headless()\n");
+      return 1;
+    }
+
+    unsigned long level = parse_ulong(argv[2], 10);
+    unsigned long ticks = parse_ulong(argv[3], 10);
+    unsigned long dump_every = parse_ulong(argv[4], 10);
+    if(level == ULONG_MAX || ticks == ULONG_MAX || dump_every == ULONG_MAX) {
+      return 1;
+    }
+    char * script_path = argc == 6 ? argv[5] : NULL;
+
+    printf("robinix::play_headless(%lu, %lu, %lu, %s)\n", level, ticks, dump_every, script_path != NULL ? script_path : "default script");
+    return play_headless(level, ticks, dump_every, script_path);
+  } else if(strncmp(argv[1], "link_sim", strlen("link_sim")) == 0) {
+    //
+    if (argc != 6) {
+      printf("robinix: wrong no. of arguments for linksim_benchmark()\n");
+      return 1;
+    }
+
+    unsigned long latency = parse_ulong(argv[2], 10);
+    unsigned long jitter = parse_ulong(argv[3], 10);
+    unsigned long loss = parse_ulong(argv[4], 10);
+    unsigned long flips = parse_ulong(argv[5], 10);
+    if(latency == ULONG_MAX || jitter == ULONG_MAX || loss == ULONG_MAX || flips == ULONG_MAX) {
+      return 1;
+    }
+
+    //The link of the game with the passed impairments
+    LinkSimConfig config;
+    linksim_default_config(&config);
+    config.latency_us = latency * 1000;
+    config.jitter_us = jitter * 1000;
+    config.byte_loss_ppm = loss;
+    config.bit_flip_ppm = flips;
+
+    printf("robinix::linksim_benchmark(%lu, %lu, %lu, %lu)\n", latency, jitter, loss, flips);
+    linksim_benchmark(&config, LINK_SIM_PAYLOAD, LINK_SIM_SECONDS);
+    return 0;
+  } else if(strncmp(argv[1], "score_bench", strlen("score_bench")) == 0) {
+    //
+    if (argc != 4) {
+      printf("robinix: wrong no. of arguments for scoremanager_benchmark()\n");
+      return 1;
+    }
+
+    unsigned long n_scores = parse_ulong(argv[2], 10);
+    unsigned long n_inserts = parse_ulong(argv[3], 10);
+    if(n_scores == ULONG_MAX || n_inserts == ULONG_MAX) {
+      return 1;
+    }
+
+    printf("robinix::scoremanager_benchmark(%lu, %lu)\n", n_scores, n_inserts);
+    scoremanager_benchmark(n_scores, n_inserts);
+    return 0;
+  } else if(strncmp(argv[1], "epoch_test", strlen("epoch_test")) == 0) {
+    //
+    if (argc != 3) {
+      printf("robinix: wrong no. of arguments for epoch_selftest()\n");
+      return 1;
+    }
+
+    unsigned long n_random = parse_ulong(argv[2], 10);
+    if(n_random == ULONG_MAX) {
+      return 1;
+    }
+
+    printf("robinix::epoch_selftest(%lu)\n", n_random);
+    return epoch_selftest(n_random) == 0 ? 0 : 1;
   } else {
     printf("robinix: %s - no valid function!\n", argv[1]);
     return 1;
@@ -109,6 +211,7 @@ static long parse_long(char *str, int base) {
 	// Successful conversion
 	return val;
 }
+*/
 
 static unsigned long parse_ulong(char *str, int base) {
   char *endptr;
@@ -131,4 +234,3 @@ static unsigned long parse_ulong(char *str, int base) {
   // Successful conversion
   return val;
 }
-*/
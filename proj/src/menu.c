@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "bitmap.h"
+#include "utilities.h"
 
 static Menu * create_main_menu() {
   /////Menu configuration variables
@@ -15,7 +16,7 @@ static Menu * create_main_menu() {
   /////
 
   //Allocating menu object
-  Menu * menu = malloc(sizeof * menu);
+  Menu * menu = calloc(1, sizeof *menu);
   if(menu == NULL) {
     return NULL;
   }
@@ -62,7 +63,7 @@ static Menu * create_gametype_menu() {
   /////
 
   //Allocating menu object
-  Menu * menu = malloc(sizeof * menu);
+  Menu * menu = calloc(1, sizeof *menu);
   if(menu == NULL) {
     return NULL;
   }
@@ -109,7 +110,7 @@ static Menu * create_level_menu() {
   /////
 
   //Allocating menu object
-  Menu * menu = malloc(sizeof * menu);
+  Menu * menu = calloc(1, sizeof *menu);
   if(menu == NULL) {
     return NULL;
   }
@@ -156,7 +157,7 @@ static Menu * create_highscore_menu() {
   /////
 
   //Allocating menu object
-  Menu * menu = malloc(sizeof * menu);
+  Menu * menu = calloc(1, sizeof *menu);
   if(menu == NULL) {
     return NULL;
   }
@@ -192,24 +193,55 @@ static Menu * create_highscore_menu() {
   return menu;
 }
 
+//Composites the background and every button (in its current hover state) into the menu frame
+static int compose_menu_frame(Menu * menu) {
+  menu->frame = copyBitmap(menu->background);
+  if(menu->frame == NULL) {
+    return 1;
+  }
+
+  int i;
+  for(i = 0; i < menu->n_buttons; i++) {
+    Button * but = menu->buttons[i];
+    drawBitmapIntoBitmap(menu->frame, but->is_hovered ? but->hovered_bmp : but->bmp, but->x, but->y);
+    but->drawn_hovered = but->is_hovered;
+  }
+
+  return 0;
+}
+
 Menu * create_menu(int menu_id) {
+  Menu * menu;
+
   switch(menu_id) {
     case 0:
-      return create_main_menu();
+      menu = create_main_menu();
       break;
     case 1:
-      return create_gametype_menu();
+      menu = create_gametype_menu();
       break;
     case 2:
-      return create_level_menu();
+      menu = create_level_menu();
       break;
     case 3:
-      return create_highscore_menu();
+      menu = create_highscore_menu();
       break;
     default:
       return NULL;
       break;
   }
+
+  if(menu == NULL) {
+    return NULL;
+  }
+
+  if(compose_menu_frame(menu) != 0) {
+    printf("create_menu::Could not composite menu %d\n", menu_id);
+    destroy_menu(&menu);
+    return NULL;
+  }
+
+  return menu;
 }
 
 void menu_update_mouse_over(Menu * menu, long mouseX, long mouseY) {
@@ -254,13 +286,18 @@ int menu_handle_button_click(Menu * menu) {
   return -1;
 }
 
-static void draw_menu_background(Menu * menu) {
-  if(menu == NULL) {
+//Composites again the rectangle of a button whose hover changed since it was composited in the menu frame
+static void update_button_in_frame(Menu * menu, Button * but) {
+  if(but->is_hovered == but->drawn_hovered) {
     return;
   }
 
-  //Because the background will basically always be fullscreen (and since it is the background itself, transparency doesn't matter)
-  drawFullscreenBitmap(menu->background);
+  //The rectangle covers both bitmaps, in case they are not the same size
+  int width = MAX_VAL(but->bmp->bitmapInfoHeader.width, but->hovered_bmp->bitmapInfoHeader.width);
+  int height = MAX_VAL(but->bmp->bitmapInfoHeader.height, but->hovered_bmp->bitmapInfoHeader.height);
+  copyBitmapRegion(menu->frame, menu->background, but->x, but->y, width, height);
+  drawBitmapIntoBitmap(menu->frame, but->is_hovered ? but->hovered_bmp : but->bmp, but->x, but->y);
+  but->drawn_hovered = but->is_hovered;
 }
 
 void draw_menu(Menu * menu) {
@@ -268,12 +305,13 @@ void draw_menu(Menu * menu) {
     return;
   }
 
-  draw_menu_background(menu);
-
   int i;
   for(i = 0; i < menu->n_buttons; i++) {
-    draw_button(menu->buttons[i]);
+    update_button_in_frame(menu, menu->buttons[i]);
   }
+
+  //Because the frame will basically always be fullscreen (and since the background is part of it, transparency doesn't matter)
+  drawFullscreenBitmap(menu->frame);
 }
 
 void destroy_menu(Menu ** menu) {
@@ -282,6 +320,7 @@ void destroy_menu(Menu ** menu) {
   }
 
   deleteBitmap((*menu)->background);
+  deleteBitmap((*menu)->frame);
 
   int i;
   for(i = 0; i < (*menu)->n_buttons; i++) {
@@ -319,6 +358,7 @@ Button * create_button(int x, int y, char * bmp_path, char * hovered_bmp_path) {
   but->x = x;
   but->y = y;
   but->is_hovered = false;
+  but->drawn_hovered = false;
 
   return but;
 }
@@ -10,18 +10,28 @@
  * Module that represents a Menu, allowing for operations over it
  */
 
+/*
+ * A Menu composites its background and buttons once, when created, into a frame of the size of the screen, so that drawing it is a single fullscreen blit.
+ * Each button remembers which of its bitmaps is in the frame, and when it is hovered or stops being hovered only its rectangle of the frame is
+ * composited again (the background under it is copied back and the other bitmap drawn over it), just before the frame is drawn.
+ */
+
 typedef struct {
   long x;
   long y;
   Bitmap * bmp;
   Bitmap * hovered_bmp;
   bool is_hovered;
+  //If the hovered bitmap is the one composited in the menu frame
+  bool drawn_hovered;
 } Button;
 
 typedef struct {
   Bitmap * background;
   Button ** buttons;
   unsigned int n_buttons;
+  //Background with the buttons composited over it
+  Bitmap * frame;
 } Menu;
 
 /**
@@ -53,7 +63,7 @@ void clear_menu_mouse_over(Menu * menu);
 int menu_handle_button_click(Menu * menu);
 
 /**
- * @brief Draws a Menu
+ * @brief Draws a Menu, compositing again first the buttons whose hover changed
  * @param menu Menu to draw
  */
 void draw_menu(Menu * menu);
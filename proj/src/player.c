@@ -1,10 +1,11 @@
 #include <stdlib.h>
 #include "player.h"
 #include "bitmap.h"
+#include "governor.h"
 
-Player * create_player(long startx, long starty, int speedx, int speedy, double angle) {
+Player * create_player(long startx, long starty, int speedx, int speedy, double angle, Region * region) {
   //Allocating and checking if allocation was successful
-  Player * p_ptr = malloc(sizeof *p_ptr);
+  Player * p_ptr = region_alloc(region, sizeof *p_ptr);
 
   if(p_ptr == NULL){
     return NULL;
@@ -13,11 +14,10 @@ Player * create_player(long startx, long starty, int speedx, int speedy, double
   //Loading player sprite
   char * sprite_paths[] = {"/home/Robinix/res/img/player/anim1.bmp", "/home/Robinix/res/img/player/anim2.bmp", "/home/Robinix/res/img/player/anim3.bmp", "/home/Robinix/res/img/player/anim4.bmp", "/home/Robinix/res/img/player/anim5.bmp", "/home/Robinix/res/img/player/anim6.bmp"};
   //Arguments are paths, n_paths and frames per bitmap
-  p_ptr->playerSprite = create_sprite(sprite_paths, 6, 10);
+  p_ptr->playerSprite = create_sprite_in_region(sprite_paths, 6, 10, region);
 
-  //Checking if correctly loaded
+  //Checking if correctly loaded (the player itself is freed with the region)
   if(p_ptr->playerSprite == NULL){
-    free(p_ptr);
     return NULL;
   }
 
@@ -46,10 +46,12 @@ void update_player(Player * p_ptr) {
 }
 
 void draw_player(Player * p_ptr) {
+  //The angle drawn might be coarser than the real one when frames run over their budget (collisions still use the real one)
+  double angle = governor_draw_angle(p_ptr->angle);
   if(p_ptr->isMoving){
-    draw_sprite_wRotation(p_ptr->playerSprite, p_ptr->x, p_ptr->y, p_ptr->angle);
+    draw_sprite_wRotation(p_ptr->playerSprite, p_ptr->x, p_ptr->y, angle);
   } else {
-    drawBitmapWithRotation(p_ptr->playerSprite->bmps[0], p_ptr->x, p_ptr->y, p_ptr->angle);
+    drawBitmapWithRotation(p_ptr->playerSprite->bmps[0], p_ptr->x, p_ptr->y, angle);
   }
 }
 
@@ -101,18 +103,3 @@ void set_player_moving_down(Player * p_ptr) {
 void set_player_angle(Player * p_ptr, double angle) {
   p_ptr->angle = angle;
 }
-
-void destroy_player(Player ** p_ptr) {
-  if(*p_ptr == NULL){
-    return;
-  }
-
-  if((*p_ptr)->playerSprite != NULL){
-    destroy_sprite(&((*p_ptr)->playerSprite));
-  }
-
-  free(*p_ptr);
-  //Setting the pointer to the Player struct to NULL so we can know that the object has been deallocated
-  //(This is the reason for using a Player ** and not a simple Player * like in all the other member functions)
-  *p_ptr = NULL;
-}
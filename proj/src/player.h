@@ -34,9 +34,10 @@ typedef struct {
  * @param  speedx The speed in the x direction at which to start
  * @param  speedy The speed in the y direction at which to start
  * @param  angle  The angle at which to start
+ * @param  region Region to create it in (it is freed with the region)
  * @return        Returns a pointer to a valid Player Object or NULL in case of failure
  */
-Player * create_player(long startx, long starty, int speedx, int speedy, double angle);
+Player * create_player(long startx, long starty, int speedx, int speedy, double angle, Region * region);
 
 ///Updates player internal speed
 /**
@@ -119,10 +120,4 @@ void draw_player(Player * p_ptr);
  */
 Bitmap * get_player_current_bitmap(Player * p_ptr);
 
-/**
- * @brief Player Object Destructor. A Player ** is passed to set the pointer itself to NULL, to enable knowing if the "object" is trully deallocated
- * @param p_ptr Player to destroy
- */
-void destroy_player(Player ** p_ptr);
-
 #endif /* __PLAYER_H */
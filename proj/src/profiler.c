@@ -0,0 +1,188 @@
+#include "profiler.h"
+#include <minix/syslib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "font.h"
+#include "gameclock.h"
+#include "governor.h"
+#include "trace.h"
+#include "utilities.h"
+
+static const char * phase_names[PROFILER_N_PHASES] = {
+  "frame", "events", "update", "collisions", "draw",
+  "background", "walls", "treasure", "coins", "exit", "doors", "guards", "player", "mouse",
+  "swap"
+};
+
+static ProfilerPhase phases[PROFILER_N_PHASES];
+static unsigned long long phase_starts[PROFILER_N_PHASES];
+static unsigned long frame_histogram[PROFILER_HISTOGRAM_BUCKETS];
+//Time stamp counter increments per microsecond, 0 if not measured (every time is then 0)
+static unsigned long cycles_per_us = 0;
+static bool overlay_shown = false;
+static unsigned int frames_since_refresh = 0;
+
+int profiler_init() {
+  memset(phases, 0, sizeof phases);
+  memset(frame_histogram, 0, sizeof frame_histogram);
+
+  //Measured by the game clock
+  cycles_per_us = gameclock_get_tsc_rate();
+  if(cycles_per_us == 0) {
+    printf("profiler_init::The time stamp counter was not measured\n");
+    return 1;
+  }
+
+  trace_set_tsc_rate(cycles_per_us);
+  return 0;
+}
+
+//The frame is not traced, it only ends if drawn and the timer interrupt handler that holds it is traced already
+static bool is_traced(profiler_phase_enum phase) {
+  return phase != PROFILER_FRAME;
+}
+
+void profiler_begin(profiler_phase_enum phase) {
+  if(is_traced(phase)) {
+    trace_begin(phase_names[phase], TRACE_CAT_FRAME);
+  }
+  phase_starts[phase] = trace_read_tsc();
+}
+
+void profiler_end(profiler_phase_enum phase) {
+  if(is_traced(phase)) {
+    trace_end(phase_names[phase], TRACE_CAT_FRAME);
+  }
+  if(cycles_per_us == 0) {
+    return;
+  }
+
+  unsigned long us = (trace_read_tsc() - phase_starts[phase]) / cycles_per_us;
+  ProfilerPhase * p = &phases[phase];
+  p->window[p->window_next] = us;
+  p->window_next = (p->window_next + 1) % PROFILER_WINDOW;
+  p->window_n = MIN_VAL(p->window_n + 1, PROFILER_WINDOW);
+  p->count++;
+  p->total_us += us;
+  p->max_us = MAX_VAL(p->max_us, us);
+
+  if(phase == PROFILER_FRAME) {
+    frame_histogram[MIN_VAL(us / PROFILER_HISTOGRAM_BUCKET_US, PROFILER_HISTOGRAM_BUCKETS - 1)]++;
+    frames_since_refresh++;
+  }
+}
+
+unsigned long profiler_get_last(profiler_phase_enum phase) {
+  const ProfilerPhase * p = &phases[phase];
+  if(p->window_n == 0) {
+    return 0;
+  }
+  return p->window[(p->window_next + PROFILER_WINDOW - 1) % PROFILER_WINDOW];
+}
+
+//Calculates the rolling statistics of a phase, sorting a copy of its window
+static void update_phase_stats(ProfilerPhase * p) {
+  if(p->window_n == 0) {
+    return;
+  }
+
+  unsigned long sorted[PROFILER_WINDOW];
+  unsigned long total = 0;
+  int i;
+  //Insertion sort, the window is small
+  for(i = 0; i < (int) p->window_n; i++) {
+    unsigned long value = p->window[i];
+    total += value;
+    int j = i - 1;
+    while(j >= 0 && sorted[j] > value) {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = value;
+  }
+
+  p->min_us = sorted[0];
+  p->avg_us = total / p->window_n;
+  p->p99_us = sorted[(p->window_n * 99 - 1) / 100];
+}
+
+void profiler_update_stats() {
+  int i;
+  for(i = 0; i < PROFILER_N_PHASES; i++) {
+    update_phase_stats(&phases[i]);
+  }
+}
+
+const ProfilerPhase * profiler_get_phase(profiler_phase_enum phase) {
+  return &phases[phase];
+}
+
+void profiler_toggle_overlay() {
+  overlay_shown = !overlay_shown;
+  frames_since_refresh = PROFILER_OVERLAY_REFRESH;
+}
+
+void draw_profiler_overlay() {
+  if(!overlay_shown) {
+    return;
+  }
+
+  //The statistics change too fast to be read every frame anyway
+  if(frames_since_refresh >= PROFILER_OVERLAY_REFRESH) {
+    profiler_update_stats();
+    frames_since_refresh = 0;
+  }
+
+  //Top left corner, one line per phase timed in the window (min, average and 99th percentile)
+  char line[64];
+  int y = 10;
+  int i;
+  for(i = 0; i < PROFILER_N_PHASES; i++) {
+    if(phases[i].window_n == 0) {
+      continue;
+    }
+    sprintf(line, "%s %lu %lu %lu us", phase_names[i], phases[i].min_us, phases[i].avg_us, phases[i].p99_us);
+    string_to_screen(line, "monofonto-22", 10, y);
+    y += 30;
+  }
+
+  const GovernorStats * governor = governor_get_stats();
+  sprintf(line, "quality %s (%lu switches)", governor_get_tier_name(governor->tier), governor->switches);
+  string_to_screen(line, "monofonto-22", 10, y);
+}
+
+int profiler_dump(const char * path) {
+  FILE * fp = fopen(path, "w");
+  if(fp == NULL) {
+    printf("profiler_dump::Could not open %s\n", path);
+    return -1;
+  }
+
+  profiler_update_stats();
+  fprintf(fp, "time stamp counter: %lu MHz\n", cycles_per_us);
+  fprintf(fp, "phase: samples, avg us, max us (last %u samples: min, avg, p99 us)\n", PROFILER_WINDOW);
+  int i;
+  for(i = 0; i < PROFILER_N_PHASES; i++) {
+    const ProfilerPhase * p = &phases[i];
+    fprintf(fp, "%s: %lu, %lu, %lu (%lu, %lu, %lu)\n", phase_names[i], p->count, p->count > 0 ? p->total_us / p->count : 0, p->max_us, p->min_us, p->avg_us, p->p99_us);
+  }
+
+  //Each bucket as "first value: count"
+  fprintf(fp, "frame time (ms):");
+  for(i = 0; i < PROFILER_HISTOGRAM_BUCKETS; i++) {
+    fprintf(fp, " %lu%s: %lu", (unsigned long) i * PROFILER_HISTOGRAM_BUCKET_US / 1000, i == PROFILER_HISTOGRAM_BUCKETS - 1 ? "+" : "", frame_histogram[i]);
+  }
+  fprintf(fp, "\n");
+
+  //Frames drawn in each quality tier
+  const GovernorStats * governor = governor_get_stats();
+  fprintf(fp, "quality tier switches: %lu (%lu lowering), frames:", governor->switches, governor->downgrades);
+  for(i = 0; i < GOVERNOR_N_TIERS; i++) {
+    fprintf(fp, " %s: %lu", governor_get_tier_name(i), governor->frames_at_tier[i]);
+  }
+  fprintf(fp, "\n");
+
+  fclose(fp);
+  return 0;
+}
@@ -0,0 +1,117 @@
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#include <stdbool.h>
+
+/** @defgroup profiler profiler
+ * @{
+ *
+ * Timing of the phases of each frame, with rolling statistics shown in an optional overlay and a frame time histogram dumped to a file when exiting
+ */
+
+/*
+ * Each phase is timed with the CPU's time stamp counter, between a profiler_begin and a profiler_end with the same phase
+ * (phases can be nested, each one keeps its own start). The counter is converted to microseconds with the rate measured by the game clock (see gameclock_init).
+ * The last PROFILER_WINDOW samples of each phase are kept, and its min, average and 99th percentile are calculated from them
+ * only when asked for, so that timing costs little more than reading the counter twice.
+ * Every phase timed (but the frame as a whole) is also recorded in the trace (see trace.h), so that a slow frame can be looked at phase by phase.
+ */
+
+#define PROFILER_WINDOW               128 /* Samples of each phase the rolling statistics are calculated over */
+#define PROFILER_HISTOGRAM_BUCKETS    20
+#define PROFILER_HISTOGRAM_BUCKET_US  1000 /* Each frame time bucket covers 1 ms, the last one also everything above */
+#define PROFILER_OVERLAY_REFRESH      30 /* Frames between updates of the statistics shown in the overlay */
+#define PROFILER_OVERLAY_KEY          'p' /* Shows or hides the overlay (except when writing the player name) */
+#define PROFILER_DUMP_LOCATION        "/home/Robinix/profile.txt"
+
+typedef enum {
+  PROFILER_FRAME = 0, /* Whole timer interrupt in which a frame was drawn */
+  PROFILER_EVENTS,
+  PROFILER_UPDATE,
+  PROFILER_COLLISIONS,
+  PROFILER_DRAW,
+  PROFILER_DRAW_BACKGROUND,
+  PROFILER_DRAW_WALLS,
+  PROFILER_DRAW_TREASURE,
+  PROFILER_DRAW_COINS,
+  PROFILER_DRAW_EXIT,
+  PROFILER_DRAW_DOORS,
+  PROFILER_DRAW_GUARDS,
+  PROFILER_DRAW_PLAYER,
+  PROFILER_DRAW_MOUSE,
+  PROFILER_SWAP,
+  PROFILER_N_PHASES
+} profiler_phase_enum;
+
+typedef struct {
+  //Last samples (circular), in microseconds
+  unsigned long window[PROFILER_WINDOW];
+  unsigned int window_next;
+  unsigned int window_n;
+  //Since the start
+  unsigned long count;
+  unsigned long total_us;
+  unsigned long max_us;
+  //Over the window, as of the last profiler_update_stats
+  unsigned long min_us;
+  unsigned long avg_us;
+  unsigned long p99_us;
+} ProfilerPhase;
+
+/**
+ * @brief Clears every phase and takes the rate of the time stamp counter from the game clock. Must be called after gameclock_init
+ * @return 0 if successful, not 0 otherwise
+ */
+int profiler_init();
+
+/**
+ * @brief Starts timing a phase
+ * @param phase Phase to time
+ */
+void profiler_begin(profiler_phase_enum phase);
+
+/**
+ * @brief Stops timing a phase and registers the time since its profiler_begin
+ * @param phase Phase timed
+ */
+void profiler_end(profiler_phase_enum phase);
+
+/**
+ * @brief Gets the last time registered for a phase
+ * @param  phase Phase to get
+ * @return       Last time registered, in microseconds (0 if none was)
+ */
+unsigned long profiler_get_last(profiler_phase_enum phase);
+
+/**
+ * @brief Calculates the min, average and 99th percentile of the samples in the window of every phase
+ */
+void profiler_update_stats();
+
+/**
+ * @brief Gets the timings of a phase
+ * @param  phase Phase to get
+ * @return       Timings of the phase (the rolling statistics as of the last profiler_update_stats)
+ */
+const ProfilerPhase * profiler_get_phase(profiler_phase_enum phase);
+
+/**
+ * @brief Shows the overlay if hidden and hides it otherwise
+ */
+void profiler_toggle_overlay();
+
+/**
+ * @brief Draws the overlay (min, average and 99th percentile of every phase timed, and the quality tier), if shown
+ */
+void draw_profiler_overlay();
+
+/**
+ * @brief Writes the statistics of every phase and the frame time histogram to a file
+ * @param  path Path of the file to write
+ * @return      0 if successful, not 0 otherwise
+ */
+int profiler_dump(const char * path);
+
+/** @} */
+
+#endif /* __PROFILER_H */
@@ -0,0 +1,117 @@
+#include "region.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned int round_up(unsigned int size) {
+  return (size + REGION_ALIGNMENT - 1) & ~(REGION_ALIGNMENT - 1);
+}
+
+//Gets where the memory of a chunk starts, right after its header
+static unsigned char * chunk_data(RegionChunk * chunk) {
+  return (unsigned char *) chunk + round_up(sizeof *chunk);
+}
+
+static RegionChunk * add_chunk(Region * region, unsigned int size) {
+  RegionChunk * chunk = malloc(round_up(sizeof *chunk) + size);
+  if(chunk == NULL) {
+    return NULL;
+  }
+
+  chunk->size = size;
+  chunk->used = 0;
+  chunk->next = region->chunks;
+  region->chunks = chunk;
+  region->n_chunks++;
+  region->bytes_reserved += size;
+  return chunk;
+}
+
+static void * lane_alloc(Region * region, region_lane_enum lane, unsigned int size) {
+  if(region == NULL) {
+    return NULL;
+  }
+
+  void * ptr;
+  if(size > region->chunk_size / 2) {
+    //A chunk of its own, the one being filled is left as it is
+    RegionChunk * chunk = add_chunk(region, size);
+    if(chunk == NULL) {
+      return NULL;
+    }
+    chunk->used = size;
+    ptr = chunk_data(chunk);
+  } else {
+    RegionChunk * chunk = region->current[lane];
+    if(chunk == NULL || chunk->size - chunk->used < round_up(size)) {
+      chunk = add_chunk(region, region->chunk_size);
+      if(chunk == NULL) {
+        return NULL;
+      }
+      region->current[lane] = chunk;
+    }
+    ptr = chunk_data(chunk) + chunk->used;
+    chunk->used += round_up(size);
+  }
+
+  region->allocations++;
+  region->bytes += size;
+  return ptr;
+}
+
+Region * create_region(unsigned int chunk_size) {
+  if(chunk_size == 0) {
+    return NULL;
+  }
+
+  Region * region = calloc(1, sizeof *region);
+  if(region == NULL) {
+    return NULL;
+  }
+
+  region->chunk_size = round_up(chunk_size);
+  return region;
+}
+
+void * region_alloc(Region * region, unsigned int size) {
+  void * ptr = lane_alloc(region, REGION_OBJECTS, size);
+  if(ptr != NULL) {
+    memset(ptr, 0, size);
+  }
+  return ptr;
+}
+
+void * region_alloc_bulk(Region * region, unsigned int size) {
+  return lane_alloc(region, REGION_BULK, size);
+}
+
+bool region_contains(Region * region, const void * ptr) {
+  if(region == NULL) {
+    return false;
+  }
+
+  RegionChunk * chunk;
+  for(chunk = region->chunks; chunk != NULL; chunk = chunk->next) {
+    const unsigned char * data = chunk_data(chunk);
+    if((const unsigned char *) ptr >= data && (const unsigned char *) ptr < data + chunk->size) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void destroy_region(Region ** region) {
+  if(*region == NULL) {
+    return;
+  }
+
+  RegionChunk * chunk = (*region)->chunks;
+  while(chunk != NULL) {
+    RegionChunk * next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+
+  free(*region);
+  *region = NULL;
+}
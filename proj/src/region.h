@@ -0,0 +1,86 @@
+#ifndef __REGION_H
+#define __REGION_H
+
+#include <stdbool.h>
+
+/** @defgroup region region
+ * @{
+ *
+ * Region: memory for objects that all live exactly as long as something else (the objects of a level), freed all at once
+ */
+
+/*
+ * A Region hands out memory from big chunks, by moving a pointer, and nothing in it is freed on its own: destroying the region frees every chunk,
+ * so tearing down everything in it costs one free per chunk instead of one per object (and there is no clean up to get wrong when creating something fails half way).
+ * It has two lanes, each with its own chunk being filled: objects (the structs and small arrays) and bulk data (the pixels of bitmaps),
+ * so that objects created one after the other end up next to each other in memory, and going through them does not mean going through their pixels too.
+ * Anything bigger than half a chunk gets a chunk of its own, so a big bitmap does not waste the rest of the chunk being filled.
+ */
+
+#define REGION_ALIGNMENT              8 /* Every allocation starts at a multiple of it */
+
+typedef enum {
+  REGION_OBJECTS = 0,
+  REGION_BULK,
+  REGION_N_LANES
+} region_lane_enum;
+
+typedef struct RegionChunk {
+  //Every chunk of the region, to free them
+  struct RegionChunk * next;
+  unsigned int size;
+  unsigned int used;
+} RegionChunk;
+
+typedef struct {
+  RegionChunk * chunks;
+  //Chunk being filled in each lane, NULL if none yet
+  RegionChunk * current[REGION_N_LANES];
+  unsigned int chunk_size;
+  unsigned int n_chunks;
+  unsigned long allocations;
+  //Bytes asked for, and bytes taken from malloc for the chunks
+  unsigned long bytes;
+  unsigned long bytes_reserved;
+} Region;
+
+/**
+ * @brief Region Object Constructor, no chunk is allocated until something is allocated in it
+ * @param  chunk_size Bytes of each chunk
+ * @return            Pointer to a valid Region or NULL in case of failure
+ */
+Region * create_region(unsigned int chunk_size);
+
+/**
+ * @brief Allocates memory for an object, valid until the region is destroyed
+ * @param  region Region to allocate in
+ * @param  size   Bytes to allocate
+ * @return        Pointer to the memory, set to 0, or NULL if it could not be allocated
+ */
+void * region_alloc(Region * region, unsigned int size);
+
+/**
+ * @brief Allocates memory for bulk data (like the pixels of a bitmap), valid until the region is destroyed
+ * @param  region Region to allocate in
+ * @param  size   Bytes to allocate
+ * @return        Pointer to the memory (not set to anything) or NULL if it could not be allocated
+ */
+void * region_alloc_bulk(Region * region, unsigned int size);
+
+/**
+ * @brief Checks if the passed memory was allocated in a region
+ * @param  region Region to look in
+ * @param  ptr    Memory to look for
+ * @return        Returns true if ptr is inside one of the chunks of the region, false otherwise
+ */
+bool region_contains(Region * region, const void * ptr);
+
+/**
+ * @brief Region Object Destructor, frees everything allocated in it
+ * @param region Region to destroy
+ */
+void destroy_region(Region ** region);
+
+/** @} */
+
+#endif /* __REGION_H */
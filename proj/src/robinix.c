@@ -10,7 +10,19 @@
 #include "keyboard.h"
 #include "mouse.h"
 #include "rtc.h"
+#include "epoch.h"
 #include "uart.h"
+#include "commlink.h"
+#include "clocksync.h"
+#include "lockstep.h"
+#include "rollback.h"
+#include "ghost.h"
+#include "telemetry.h"
+#include "transport.h"
+#include "gameloop.h"
+#include "profiler.h"
+#include "trace.h"
+#include "framearena.h"
 //For mouse commands
 #include "i8042.h"
 
@@ -42,6 +54,70 @@ static void limit_xy_inside_screen(long * x, long * y, int width, int height) {
   }
 }
 
+//Sets how the messages exchanged are scheduled in each tick: what changes the session goes first, beacons last,
+//and for beacons, clock probes and inputs only the latest queued in a tick is sent (the inputs frame has every input not acknowledged)
+static void comm_set_opcode_classes() {
+  commlink_set_opcode_class(COMM_OP_SEARCHING, TRANSPORT_PRIORITY_BEACON, true);
+  commlink_set_opcode_class(COMM_OP_REPLY, TRANSPORT_PRIORITY_BEACON, true);
+  commlink_set_opcode_class(COMM_OP_ACKNOWLEDGE_REPLY, TRANSPORT_PRIORITY_BEACON, true);
+  commlink_set_opcode_class(COMM_OP_SYNC_PROBE, TRANSPORT_PRIORITY_GAME, true);
+  commlink_set_opcode_class(COMM_OP_SYNC_REPLY, TRANSPORT_PRIORITY_GAME, false);
+  commlink_set_opcode_class(COMM_OP_SYNCED, TRANSPORT_PRIORITY_CRITICAL, false);
+  commlink_set_opcode_class(COMM_OP_START_TICK, TRANSPORT_PRIORITY_CRITICAL, false);
+  commlink_set_opcode_class(COMM_OP_LOCKSTEP_INPUTS, TRANSPORT_PRIORITY_GAME, true);
+  commlink_set_opcode_class(COMM_OP_STATE_HASH, TRANSPORT_PRIORITY_GAME, false);
+  commlink_set_opcode_class(COMM_OP_PLAYER_LEAVING, TRANSPORT_PRIORITY_CRITICAL, false);
+  commlink_set_opcode_class(COMM_OP_ABORT, TRANSPORT_PRIORITY_CRITICAL, false);
+}
+
+//Sends a message with no arguments to the other player
+//Reliable messages are retransmitted until the other player acknowledges them, the others are sent only once
+static void comm_send(comm_opcode_enum opcode, bool reliable) {
+  if(reliable) {
+    commlink_send_reliable(opcode, NULL, 0);
+  } else {
+    commlink_send(opcode, NULL, 0);
+  }
+}
+
+//Sends a message with numeric arguments to the other player (each encoded as a varint), returns the size of the frame sent
+static unsigned int comm_send_values(comm_opcode_enum opcode, const unsigned long long * values, unsigned int n_values, bool reliable) {
+  unsigned char payload[SERIALFRAME_MAX_PAYLOAD];
+  unsigned int len = 0;
+  unsigned int i;
+  for(i = 0; i < n_values; i++) {
+    len += varint_encode(values[i], payload + len);
+  }
+  if(reliable) {
+    commlink_send_reliable(opcode, payload, len);
+  } else {
+    commlink_send(opcode, payload, len);
+  }
+  return len + SERIALFRAME_OVERHEAD;
+}
+
+//Sends a message with a single numeric argument to the other player
+static void comm_send_value(comm_opcode_enum opcode, unsigned long long value, bool reliable) {
+  comm_send_values(opcode, &value, 1, reliable);
+}
+
+//Reads the numeric arguments of a received message, returns 0 if successful
+static int comm_read_values(const SerialFrameView * frame, unsigned long long * values, unsigned int n_values) {
+  unsigned int offset = 0;
+  unsigned int i;
+  for(i = 0; i < n_values; i++) {
+    if(serialframe_read_varint(frame, &offset, &values[i]) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+//Reads the single numeric argument of a received message, returns 0 if successful
+static int comm_read_value(const SerialFrameView * frame, unsigned long long * value) {
+  return comm_read_values(frame, value, 1);
+}
+
 ////Public functions
 
 Robinix * create_robinix() {
@@ -58,9 +134,10 @@ Robinix * create_robinix() {
   rob_ptr->timer_ticks_playing = 0;
   rob_ptr->mp_msg_delay_ticks = 0;
   rob_ptr->mp_syncing_ticks = 0;
-  rob_ptr->n_ticks_synced = 0;
+  rob_ptr->clock_synced = false;
   rob_ptr->tick_decided = 0;
   rob_ptr->comm_state = COMM_WAITING_TO_PING;
+  rob_ptr->mp_click_pending = false;
 
   //(Using a compound literal for initialization)
   //Also doing key state initialization here
@@ -72,7 +149,12 @@ Robinix * create_robinix() {
   rob_ptr->event_buffer = NULL;
   rob_ptr->snapshot_buffer = NULL;
   rob_ptr->level = NULL;
+  rob_ptr->remote_level = NULL;
+  rob_ptr->lockstep = NULL;
+  rob_ptr->rollback = NULL;
+  rob_ptr->ghost = NULL;
   rob_ptr->game_stats = NULL;
+  rob_ptr->menu_clock = NULL;
 
   //Loading the bitmap of the pause menu into memory
   rob_ptr->pause_menu_bmp = loadBitmap("/home/Robinix/res/img/other/pause_menu.bmp");
@@ -101,6 +183,15 @@ Robinix * create_robinix() {
     return NULL;
   }
 
+  //Creating the date shown in the menu (768 - 22 = 746 +- mais uns pozinhos, 740)
+  rob_ptr->menu_clock = create_textwidget("monofonto-22", 10, 740);
+
+  if(rob_ptr->menu_clock == NULL) {
+    destroy_robinix(&rob_ptr);
+    return NULL;
+  }
+  game_rtc_update(rob_ptr);
+
   //Loading the bitmap of the mouse pointer into memory (for use in menus, in levels Level object takes care of rendering the mouse due to mouse overs)
   rob_ptr->mouse_bmp = loadBitmap("/home/Robinix/res/img/mouse/mouse_menu.bmp");
 
@@ -183,7 +274,7 @@ int subscribe_peripherals(Robinix * rob) {
     return UART_SUB_ERROR;
   }
 
-  if(uart_set_rate(1200) != 0) {
+  if(uart_set_rate(UART_GAME_RATE) != 0) {
     return UART_SUB_ERROR;
   }
 
@@ -256,10 +347,16 @@ void destroy_robinix(Robinix ** rob) {
   destroy_sprite(&((*rob)->lose_screen_sprite));
   //Destroying score manager object
   destroy_scoremanager(&((*rob)->score_man));
+  destroy_textwidget(&((*rob)->menu_clock));
   //Destroying game stats object if allocated
   destroy_gamestats(&((*rob)->game_stats));
   //Destroying level object if allocated
   destroy_level(&((*rob)->level));
+  //Destroying multiplayer objects if allocated
+  destroy_level(&((*rob)->remote_level));
+  destroy_rollback(&((*rob)->rollback));
+  destroy_ghost(&((*rob)->ghost));
+  destroy_lockstep(&((*rob)->lockstep));
 
   //Clearing snapshot buffer if still allocated
   clear_game_snapshot(*rob);
@@ -297,7 +394,7 @@ void add_event_to_buffer(Robinix * rob, Event * evt) {
     //Error, could not reallocate to a bigger buffer
     printf("ERROR in add_event_to_buffer, event buffer could not be reallocated to a bigger size!!!\n");
     //Freeing the event since it could not be added to the buffer...
-    free(evt);
+    framearena_free(evt);
     evt = NULL;
     //Note: temp_event_buffer does not need to be freed since realloc returns NULL on failure
     return;
@@ -305,8 +402,9 @@ void add_event_to_buffer(Robinix * rob, Event * evt) {
 
 }
 
-Event * create_event(event_enum evt_type, int mouse_move_x, int mouse_move_y, char pressed_key, char * remote_msg) {
-  Event * evt = malloc(sizeof *evt);
+Event * create_event(event_enum evt_type, int mouse_move_x, int mouse_move_y, char pressed_key, const SerialFrameView * remote_frame) {
+  //Events are processed in the tick after they are created at the latest, so they can come from the frame arena
+  Event * evt = framearena_alloc(sizeof *evt);
 
   if(evt == NULL){
     return NULL;
@@ -317,12 +415,12 @@ Event * create_event(event_enum evt_type, int mouse_move_x, int mouse_move_y, ch
   evt->mouse_move_x = mouse_move_x;
   evt->mouse_move_y = mouse_move_y;
   evt->pressed_key = pressed_key;
-  evt->remote_msg = remote_msg;
+  evt->remote_frame = remote_frame;
 
   /*
   //TEMP orary
   if(evt->evt_type == RECEIVED_REMOTE_MESSAGE) {
-    printf("DBG: Received UART event with content: \"%s\"\n", evt->remote_msg);
+    printf("DBG: Received UART event with opcode: %u\n", evt->remote_frame->opcode);
   }
   */
 
@@ -335,12 +433,8 @@ void destroy_event(Event ** evt) {
     return;
   }
 
-  //Also deallocating the received message string
-  //If the event is not one from remote communication this is NULL and thus there is no problem with the free as well
-  free((*evt)->remote_msg);
-
-  //(Don't forget that free also checks for NULL, so there is no problem if evt is already NULL)
-  free(*evt);
+  //(Don't forget that framearena_free also checks for NULL, so there is no problem if evt is already NULL)
+  framearena_free(*evt);
   *evt = NULL;
 }
 
@@ -373,13 +467,13 @@ int game_load_level(Robinix * rob, int level, bool is_mp) {
   rob->currstate.d_pressed = false;
 
   //Resetting auxiliar variables for score just in case
-  free(rob->current_date_string);
-  rob->current_date_string = NULL;
   free(rob->time_taken);
   rob->time_taken = NULL;
   //To reset a char [] we can just write a null terminator to the first index
   rob->player_name[0] = '\0';
   rob->player_score = 0;
+  rob->score_level = level;
+  rob->score_mode = is_mp ? SCORE_MODE_MP : SCORE_MODE_SP;
 
   //Also allocating our game stats manager
   //(And deallocating it if it is allocated, before trying to reallocate)
@@ -410,6 +504,69 @@ int game_load_level(Robinix * rob, int level, bool is_mp) {
   }
 }
 
+//Loads the objects used when playing multiplayer: our level, the level of the other player, the lockstep and rollback state and the ghost. Returns 0 if successful
+static int game_load_mp(Robinix * rob) {
+  //Player 1 (host) plays level 1 and player 2 (client) plays level 2
+  int own_level = rob->isPlayer1 ? 1 : 2;
+  int other_level = rob->isPlayer1 ? 2 : 1;
+
+  if(game_load_level(rob, own_level, true) != 0) {
+    printf("DBG: Error loading mp level %d\n", own_level);
+    return -1;
+  }
+
+  destroy_level(&(rob->remote_level));
+  rob->remote_level = create_level(other_level, true);
+  destroy_lockstep(&(rob->lockstep));
+  rob->lockstep = create_lockstep(rob->isPlayer1);
+  destroy_rollback(&(rob->rollback));
+  //Levels of player 1 and 2, in this order
+  if(rob->isPlayer1) {
+    rob->rollback = create_rollback(rob->level, rob->remote_level, rob->lockstep);
+  } else {
+    rob->rollback = create_rollback(rob->remote_level, rob->level, rob->lockstep);
+  }
+  destroy_ghost(&(rob->ghost));
+  //The other player is drawn with the same bitmap as ours
+  if(rob->level->player != NULL) {
+    rob->ghost = create_ghost(rob->level->player->playerSprite->bmps[0]);
+  }
+
+  if(rob->remote_level == NULL || rob->lockstep == NULL || rob->rollback == NULL || rob->ghost == NULL) {
+    printf("DBG: Error loading the simulation of mp level %d\n", other_level);
+    destroy_ghost(&(rob->ghost));
+    destroy_rollback(&(rob->rollback));
+    destroy_level(&(rob->level));
+    destroy_level(&(rob->remote_level));
+    destroy_lockstep(&(rob->lockstep));
+    destroy_gamestats(&(rob->game_stats));
+    return -2;
+  }
+
+  rob->mp_click_pending = false;
+  return 0;
+}
+
+//Destroys every object used when playing multiplayer
+static void game_unload_mp(Robinix * rob) {
+  if(rob->lockstep != NULL) {
+    lockstep_print_stats(rob->lockstep);
+  }
+  if(rob->rollback != NULL) {
+    rollback_print_stats(rob->rollback);
+  }
+  if(rob->ghost != NULL) {
+    ghost_print_stats(rob->ghost);
+  }
+  transport_print_stats();
+  destroy_ghost(&(rob->ghost));
+  destroy_rollback(&(rob->rollback));
+  destroy_lockstep(&(rob->lockstep));
+  destroy_level(&(rob->remote_level));
+  destroy_level(&(rob->level));
+  destroy_gamestats(&(rob->game_stats));
+}
+
 state_enum get_game_state(Robinix * rob) {
   return rob->currstate.state;
 }
@@ -454,13 +611,15 @@ static void draw_menu_highscores(Robinix * rob) {
   display_highscores(rob->score_man, 20, 240, "kenneypixel-38", 60);
 }
 
-static void draw_date_in_menu() {
-  Date_obj temp = get_current_date();
-  char * text = date_to_string(&temp);
-  //768 - 22 = 746 +- mais uns pozinhos, 740
-  string_to_screen(text, "monofonto-22", 10, 740);
-  //Text string no longer necessary (Date_obj does not need to be free'd since it is stack allocated only)
-  free(text);
+void game_rtc_update(Robinix * rob) {
+  char text[EPOCH_STRING_LENGTH];
+  epoch_format(get_current_epoch(), text);
+  //Only rendered again if the date shown changed
+  textwidget_set_text(rob->menu_clock, text);
+}
+
+static void draw_date_in_menu(Robinix * rob) {
+  textwidget_draw(rob->menu_clock, true);
 }
 
 static void draw_game_stats(Robinix * rob) {
@@ -501,7 +660,7 @@ void game_draw(Robinix * rob) {
   switch(rob->currstate.state) {
     //While playing all drawing is handled by the Level object (except game stats)
     case PLAYING_SP:
-      draw_level(rob->level, rob->currstate.mouseX, rob->currstate.mouseY);
+      draw_level_interpolated(rob->level, rob->currstate.mouseX, rob->currstate.mouseY, gameloop_get_alpha());
       draw_game_stats(rob);
       break;
     case PAUSED_SP:
@@ -519,7 +678,7 @@ void game_draw(Robinix * rob) {
         //Returning 1 is the way that the menumanger has to request highscores drawing
         draw_menu_highscores(rob);
       }
-      draw_date_in_menu();
+      draw_date_in_menu(rob);
       game_draw_mouse(rob);
       break;
     case SCORE_SUBMIT:
@@ -546,14 +705,15 @@ void game_draw(Robinix * rob) {
       game_draw_snapshot_buffer(rob);
       string_to_screen("Get ready", "monofonto-22", 335, 350);
       //Getting the delta in ticks and dividing by 60 to convert to seconds
-      unsigned int seconds_to_start = (rob->tick_decided - rob->mp_syncing_ticks) / 60;
+      unsigned int seconds_to_start = (rob->tick_decided - rob->mp_syncing_ticks) / GAMELOOP_TICK_RATE;
       char temp_str[20];
       sprintf(temp_str, "Starting in %u", seconds_to_start);
       string_to_screen(temp_str, "monofonto-22", 300, 380);
       game_draw_mouse(rob);
       break;
     case PLAYING_MP:
-      draw_level(rob->level, rob->currstate.mouseX, rob->currstate.mouseY);
+      draw_level_interpolated(rob->level, rob->currstate.mouseX, rob->currstate.mouseY, gameloop_get_alpha());
+      draw_ghost(rob->ghost);
       draw_game_stats(rob);
       //game_draw_mouse(rob); //Level already draws mouse
       break;
@@ -564,14 +724,20 @@ void game_draw(Robinix * rob) {
     default:
       break;
   }
+
+  //Over everything else, if shown
+  draw_telemetry_overlay();
+  draw_profiler_overlay();
 }
 
 static void game_update_playing_sp(Robinix * rob) {
+  //Where everything was before this tick, drawing interpolates from there
+  level_save_draw_positions(rob->level);
   //While playing updates are handled by Level object
   update_level(rob->level, rob);
   //Except for ticking timer interrupts and stats time, which is done here
   rob->timer_ticks_playing++;
-  if(rob->timer_ticks_playing % 60 == 0) {
+  if(rob->timer_ticks_playing % GAMELOOP_TICK_RATE == 0) {
     gamestats_tick_time(rob->game_stats);
   }
 }
@@ -590,15 +756,15 @@ static void game_update_searching_mp(Robinix * rob) {
         break;
       case COMM_PINGING:
         printf("DBG: Sending searching msg at tick %u\n", rob->mp_msg_delay_ticks);
-        uart_send_string(COMM_SEARCHING_STR);
+        comm_send(COMM_OP_SEARCHING, false);
         break;
       case COMM_REPLYING:
         printf("DBG: Sending reply msg at tick %u\n", rob->mp_msg_delay_ticks);
-        uart_send_string(COMM_REPLY_STR);
+        comm_send(COMM_OP_REPLY, false);
         break;
       case COMM_ACKING:
         printf("DBG: Sending ACKs at tick %u\n", rob->mp_msg_delay_ticks);
-        uart_send_string(COMM_ACKNOWLEDGE_REPLY);
+        comm_send(COMM_OP_ACKNOWLEDGE_REPLY, false);
         break;
       default:
         printf("game_update_searching_mp::Erroneous state, comm_state: %d\n", rob->comm_state);
@@ -608,20 +774,16 @@ static void game_update_searching_mp(Robinix * rob) {
 }
 
 static void game_update_syncing_mp(Robinix * rob) {
-  //Player 1 is host
-  if(rob->isPlayer1) {
-    if(rob->mp_msg_delay_ticks % COMM_TICK_SYNC_DELAY == 0) {
-      //A very large buffer can be used with no negative effects since uart_send_string copies the string until strlen so no unnecessary space is used
-      //The buffer is also stack allocated so no large block of memory is kept in use indefinitely
-      char sync_msg[45];
-      sprintf(sync_msg, "%s%llu", COMM_SYNC_PREFIX, rob->mp_syncing_ticks);
-      //printf("DBG: Sending syncing msg: %s\n", sync_msg);
-      uart_send_string(sync_msg);
+  //Both must update ticks for every timer interrupt (update call)
+  rob->mp_syncing_ticks++;
+  //Player 2 probes the clock of player 1 (the host) until the offset between both is known
+  if(!(rob->isPlayer1) && !(rob->clock_synced)) {
+    if(rob->mp_msg_delay_ticks % CLOCKSYNC_PROBE_INTERVAL == 0) {
+      //Probes are not sent reliably: a lost one is simply replaced by the next, and a retransmitted one would give a wrong sample
+      comm_send_value(COMM_OP_SYNC_PROBE, rob->mp_syncing_ticks, false);
     }
     rob->mp_msg_delay_ticks++;
   }
-  //Both must update ticks for every timer interrupt (update call)
-  rob->mp_syncing_ticks++;
   /*
   //TEMP for testing if are synced manually
   if(rob->mp_syncing_ticks % 6 == 0) {
@@ -654,16 +816,77 @@ static void game_update_waiting_mp(Robinix * rob) {
 }
 
 static void game_update_playing_mp(Robinix * rob) {
+  //Both simulations diverged, there is no way to recover so the game is left
+  if(lockstep_is_desynced(rob->lockstep)) {
+    printf("DBG: Simulation desynced, leaving the game\n");
+    comm_send(COMM_OP_PLAYER_LEAVING, true);
+    reset_menumanager(rob->menu_man);
+    rob->currstate.state = MENU;
+    game_unload_mp(rob);
+    return;
+  }
+
+  //Where everything was before this tick (and its rollbacks), drawing interpolates from there
+  level_save_draw_positions(rob->level);
   rob->mp_syncing_ticks++;
   //Ticking time for displaying
-  if(rob->mp_syncing_ticks % 60 == 0) {
+  if(rob->mp_syncing_ticks % GAMELOOP_TICK_RATE == 0) {
     gamestats_tick_time(rob->game_stats);
   }
-  //All other updating is done by level object (moving guards, etc)
-  update_level(rob->level, rob);
+  //Ensuring mouse does not go offscreen
+  limit_xy_inside_screen(&(rob->currstate.mouseX), &(rob->currstate.mouseY), rob->mouse_bmp->bitmapInfoHeader.width, rob->mouse_bmp->bitmapInfoHeader.height);
+
+  //Resending inputs if needed
+  lockstep_tick(rob->lockstep);
+
+  //Sampling our input at the start of every turn
+  if(lockstep_needs_local_input(rob->lockstep)) {
+    unsigned char keys = 0;
+    if(rob->currstate.w_pressed) {
+      keys |= LEVEL_INPUT_UP;
+    }
+    if(rob->currstate.a_pressed) {
+      keys |= LEVEL_INPUT_LEFT;
+    }
+    if(rob->currstate.s_pressed) {
+      keys |= LEVEL_INPUT_DOWN;
+    }
+    if(rob->currstate.d_pressed) {
+      keys |= LEVEL_INPUT_RIGHT;
+    }
+    LevelInput input = level_make_input(rob->level, keys, rob->currstate.mouseX, rob->currstate.mouseY, rob->mp_click_pending);
+    rob->mp_click_pending = false;
+    lockstep_set_local_input(rob->lockstep, &input);
+  }
+
+  //Simulating the new tick (going back first if the other player did something else than predicted)
+  RollbackOutcome outcome;
+  rollback_update(rob->rollback, &outcome);
+
+  //The ghost follows the other player as simulated, and is checked against where it really was once that is confirmed
+  int remote_index = rob->isPlayer1 ? 1 : 0;
+  LevelState confirmed;
+  ghost_update(rob->ghost, rob->remote_level->player, rob->rollback->tick);
+  rollback_get_confirmed_state(rob->rollback, remote_index, &confirmed);
+  ghost_confirm(rob->ghost, rollback_get_confirmed_tick(rob->rollback), &confirmed);
+
+  //Only what happened in confirmed ticks is acted upon, so that it never has to be undone
+  unsigned int i;
+  for(i = 0; i < outcome.n_coins_got; i++) {
+    add_event_to_buffer(rob, create_event(PLAYER_GOT_COIN, 0, 0, '?', NULL));
+  }
+  if(outcome.caught) {
+    add_event_to_buffer(rob, create_event(PLAYER_COLLIDE_WITH_GUARD, 0, 0, '?', NULL));
+  } else if(outcome.both_at_exit) {
+    add_event_to_buffer(rob, create_event(PLAYER_COLLIDE_WITH_EXIT, 0, 0, '?', NULL));
+  }
 }
 
 void game_update(Robinix * rob) {
+  telemetry_tick();
+  //The link must keep ticking in every state, so that acks are sent and messages still in flight are retransmitted (even after leaving a multiplayer game)
+  commlink_tick();
+
   switch (rob->currstate.state) {
     case PLAYING_SP:
       game_update_playing_sp(rob);
@@ -694,6 +917,9 @@ void game_update(Robinix * rob) {
     default:
       break;
   }
+
+  //Everything sent during this tick goes out now, in as few frames as possible
+  transport_flush();
 }
 
 static void game_process_event_menu(Robinix * rob, Event * evt) {
@@ -723,6 +949,9 @@ static void game_process_event_menu(Robinix * rob, Event * evt) {
       rob->mp_msg_delay_ticks = 0;
       //Resetting communications state
       rob->comm_state = COMM_WAITING_TO_PING;
+      //Starting a new session in the link (sequence numbers, RTT estimates)
+      commlink_reset();
+      comm_set_opcode_classes();
       //Using snapshot as background so take it here
       snapshot_game(rob);
       break;
@@ -743,8 +972,12 @@ static void game_process_event_menu(Robinix * rob, Event * evt) {
       }
       break;
     case CLICKED_EXIT_GAME:
-      //Before exiting the game save the scores to a file (can't be done in destroy_robinix since that would be called on errors as well)
-      write_scores_to_scores_file(rob->score_man);
+      //Before exiting the game save the link telemetry, to tune the link with (the scores were saved as they were submitted)
+      telemetry_dump(TELEMETRY_DUMP_LOCATION);
+      //And the frame timings
+      profiler_dump(PROFILER_DUMP_LOCATION);
+      //And the last events traced
+      trace_export(TRACE_DUMP_LOCATION);
       rob->currstate.state = EXIT_GAME;
       break;
     //No other events are being considered at the moment
@@ -959,15 +1192,13 @@ static void game_process_events_score_submit(Robinix * rob, Event * evt) {
           //Enter was pressed, user desires to submit score
           //Just to not be weird and possibly cause problems check if the name as one character at least, before submitting
           if(strlen(rob->player_name) > 0) {
-            Date_obj temp_date = get_current_date();
-            rob->current_date_string = date_to_date_string(&temp_date);
+            char finish_date[EPOCH_DATE_STRING_LENGTH];
+            epoch_format_date(get_current_epoch(), finish_date);
             //Submitting score and going back to main menu
-            add_score_to_scoremanager(rob->score_man, rob->player_score, rob->player_name, rob->current_date_string);
+            add_score_to_scoremanager(rob->score_man, rob->player_score, rob->player_name, finish_date, rob->score_level, rob->score_mode);
 
             //Resetting helper score variables for future use
-            //temp_date is stack allocated so does not need to be free'd
-            free(rob->current_date_string);
-            rob->current_date_string = NULL;
+            //finish_date is stack allocated so does not need to be free'd
             free(rob->time_taken);
             rob->time_taken = NULL;
             //To reset a char [] we can just write a null terminator to the first index
@@ -1034,14 +1265,14 @@ static void game_process_events_searching_mp(Robinix * rob, Event * evt) {
       break;
     case RECEIVED_REMOTE_MESSAGE:
       //If searching (or waiting to search) and other is also searching then switch to replying
-      if((rob->comm_state == COMM_WAITING_TO_PING || rob->comm_state == COMM_PINGING) && strncmp(evt->remote_msg, COMM_SEARCHING_STR, strlen(COMM_SEARCHING_STR)) == 0) {
+      if((rob->comm_state == COMM_WAITING_TO_PING || rob->comm_state == COMM_PINGING) && evt->remote_frame->opcode == COMM_OP_SEARCHING) {
         printf("DBG: Got ping, switching to sending replies\n");
         rob->comm_state = COMM_REPLYING;
       }
       //Check for response (if was searching and got a reply, send ACK)
-      if(rob->comm_state == COMM_PINGING && strncmp(evt->remote_msg, COMM_REPLY_STR, strlen(COMM_REPLY_STR)) == 0) {
+      if(rob->comm_state == COMM_PINGING && evt->remote_frame->opcode == COMM_OP_REPLY) {
         printf("DBG: Got reply, sending ACK and disabling sending pings or replies\n");
-        uart_send_string(COMM_ACKNOWLEDGE_REPLY);
+        comm_send(COMM_OP_ACKNOWLEDGE_REPLY, true);
         rob->comm_state = COMM_ACKING;
         //If I am the ACK sender, then I am player 1 (I was searching first)
         rob->isPlayer1 = true;
@@ -1052,11 +1283,12 @@ static void game_process_events_searching_mp(Robinix * rob, Event * evt) {
         rob->mp_msg_delay_ticks = 0;
         //Resetting all the ticks
         rob->mp_syncing_ticks = 0;
-        rob->n_ticks_synced = 0;
+        rob->clock_synced = false;
         rob->tick_decided = 0;
+        clocksync_reset();
       }
       //Check for ACK to my response (if I was replying and got an ACK)
-      if(rob->comm_state == COMM_REPLYING && strncmp(evt->remote_msg, COMM_ACKNOWLEDGE_REPLY, strlen(COMM_ACKNOWLEDGE_REPLY)) == 0) {
+      if(rob->comm_state == COMM_REPLYING && evt->remote_frame->opcode == COMM_OP_ACKNOWLEDGE_REPLY) {
         printf("DBG: Received ACK to my reply, disabling sending messages\n");
         rob->comm_state = COMM_SYNCING;
         //If I am the ACK receiver, then I am player 2 (I was searching last)
@@ -1068,8 +1300,9 @@ static void game_process_events_searching_mp(Robinix * rob, Event * evt) {
         rob->mp_msg_delay_ticks = 0;
         //Resetting all the ticks
         rob->mp_syncing_ticks = 0;
-        rob->n_ticks_synced = 0;
+        rob->clock_synced = false;
         rob->tick_decided = 0;
+        clocksync_reset();
       }
       break;
     //No other events are being considered at the moment
@@ -1097,55 +1330,68 @@ static void game_process_events_syncing_mp(Robinix * rob, Event * evt) {
       break;
     case RECEIVED_REMOTE_MESSAGE:
       //Checking for old messages to know if something went wrong
-      if(strncmp(evt->remote_msg, COMM_SEARCHING_STR, strlen(COMM_SEARCHING_STR)) == 0) {
+      if(evt->remote_frame->opcode == COMM_OP_SEARCHING) {
         printf("Debug: Got search string while in sync!!\n");
       }
-      if(strncmp(evt->remote_msg, COMM_REPLY_STR, strlen(COMM_REPLY_STR)) == 0) {
+      if(evt->remote_frame->opcode == COMM_OP_REPLY) {
         printf("Debug: Got reply while in sync!!\n");
       }
-      if(strncmp(evt->remote_msg, COMM_ACKNOWLEDGE_REPLY, strlen(COMM_ACKNOWLEDGE_REPLY)) == 0) {
+      if(evt->remote_frame->opcode == COMM_OP_ACKNOWLEDGE_REPLY) {
         printf("Debug: Received ACK to reply while in sync!!\n");
       }
 
-      //If not host, then sync according to received tick
-      if(!(rob->isPlayer1) && strncmp(evt->remote_msg, COMM_SYNC_PREFIX, strlen(COMM_SYNC_PREFIX)) == 0) {
-        //printf("DBG: Received sync message - Contents: %s\n", evt->remote_msg);
+      //If host, reply to clock sync probes straight away, so that the tick the probe was received in is also the tick the reply is sent in
+      if(rob->isPlayer1 && evt->remote_frame->opcode == COMM_OP_SYNC_PROBE) {
+        unsigned long long probe_tick = 0;
+        if(comm_read_value(evt->remote_frame, &probe_tick) != 0) {
+          printf("Debug: Error reading tick from sync probe!\n");
+        } else {
+          unsigned long long reply_values[2] = {probe_tick, rob->mp_syncing_ticks};
+          comm_send_values(COMM_OP_SYNC_REPLY, reply_values, 2, false);
+        }
+      }
 
-        //Parsing string into unsigned long long, the start element passed is a shift by the size of the sync message prefix
-        unsigned long long temp_ull = parse_ullong(evt->remote_msg + strlen(COMM_SYNC_PREFIX), 10);
-        if(temp_ull == ULLONG_MAX) {
-          printf("Debug: Error in UART message to ullong conversion!\n");
+      //If not host, use the reply to estimate the offset to the clock of the host
+      if(!(rob->isPlayer1) && !(rob->clock_synced) && evt->remote_frame->opcode == COMM_OP_SYNC_REPLY) {
+        //Reading the tick the probe was sent in and the tick the host received it in
+        unsigned long long reply_values[2] = {0, 0};
+        if(comm_read_values(evt->remote_frame, reply_values, 2) != 0) {
+          printf("Debug: Error reading ticks from sync reply!\n");
         } else {
-          //Valid value, verify versus current timer tick
-          if(temp_ull == rob->mp_syncing_ticks) {
-            printf("DBG: Ticks were synced for %d times\n", rob->n_ticks_synced);
-            rob->n_ticks_synced++;
-          } else {
-            rob->mp_syncing_ticks = temp_ull;
-            rob->n_ticks_synced = 0;
-            //TEMP Since printf does not accept %llu, we have to use sprintf beforehand
-            //char tempbuf[30];
-            //sprintf(tempbuf, "%llu", rob->mp_syncing_ticks);
-            //printf("DBG: Syncing self, tick is now %s\n", tempbuf);
-          }
+          unsigned char temp[VARINT_MAX_SIZE];
+          double probe_wire = clocksync_wire_ticks(SERIALFRAME_OVERHEAD + varint_encode(reply_values[0], temp));
+          double reply_wire = clocksync_wire_ticks(SERIALFRAME_OVERHEAD + evt->remote_frame->length);
+          //The host replies in the same tick it receives the probe, so t3 is the same as t2
+          clocksync_add_sample(reply_values[0], reply_values[1], reply_values[1], rob->mp_syncing_ticks, probe_wire, reply_wire);
         }
 
-        if(rob->n_ticks_synced >= COMM_TICK_SYNC_MIN) {
-          //printf("DBG: Synced for the minimum required ticks!\n");
-          //Sending "Synced!" message
-          uart_send_string(COMM_SYNCED_STR);
+        if(clocksync_is_synced()) {
+          long long offset = clocksync_get_offset();
+          //Ticks are unsigned, the client can never go back further than the start of syncing
+          if(offset < 0 && (unsigned long long) (-offset) > rob->mp_syncing_ticks) {
+            rob->mp_syncing_ticks = 0;
+          } else {
+            rob->mp_syncing_ticks += offset;
+          }
+          rob->clock_synced = true;
+          //Since printf does not accept %lld, we have to use sprintf beforehand
+          char offset_str[30];
+          sprintf(offset_str, "%lld", offset);
+          printf("DBG: Clock synced with %u samples, offset %s ticks, bound %d/100 ticks\n", clocksync_get_n_samples(), offset_str, (int) (clocksync_get_bound() * 100));
+          //Sending "Synced!" message (only once, since it is delivered reliably)
+          comm_send(COMM_OP_SYNCED, true);
           printf("DBG: Sent 'synced' message\n");
         }
       }
 
       //If not host also check if received a "starting in tick X" message
-      if(!(rob->isPlayer1) && strncmp(evt->remote_msg, COMM_START_TICK_PREFIX, strlen(COMM_START_TICK_PREFIX)) == 0) {
+      if(!(rob->isPlayer1) && evt->remote_frame->opcode == COMM_OP_START_TICK) {
         printf("DBG: Received a starting in tick X message\n");
 
-        //Parsing string into unsigned long long, the start element passed is a shift by the size of the sync message prefix
-        unsigned long long temp_ull = parse_ullong(evt->remote_msg + strlen(COMM_START_TICK_PREFIX), 10);
-        if(temp_ull == ULLONG_MAX) {
-          printf("Debug: Error in UART message to ullong conversion in start tick!\n");
+        //Reading the start tick from the frame payload
+        unsigned long long temp_ull = 0;
+        if(comm_read_value(evt->remote_frame, &temp_ull) != 0) {
+          printf("Debug: Error reading start tick from frame!\n");
         } else {
           //Valid value, set start tick
           rob->tick_decided = temp_ull;
@@ -1161,17 +1407,14 @@ static void game_process_events_syncing_mp(Robinix * rob, Event * evt) {
         rob->currstate.state = WAITING_MP;
         //Switching the comm mode to "ingame none", will be used when transferring message about player being over door
         rob->comm_state = COMM_IG_NONE;
-        rob->other_player_at_exit = false;
-        rob->sent_at_exit = false;
         //Resetting the message delay ticks (will also be used for this)
         rob->mp_msg_delay_ticks = 0;
 
         //When entering waiting state, load game and take snapshot
         //I am client, I get level 2 for multiplayer
-        if(game_load_level(rob, 2, true) != 0) {
-          printf("DBG: Error loading mp level 2\n");
+        if(game_load_mp(rob) != 0) {
           //In case of error send abort message and go back to main menu
-          uart_send_string(COMM_ABORT_STR);
+          comm_send(COMM_OP_ABORT, true);
           rob->currstate.state = MENU;
           //Upon leaving state clear the game snapshot for better memory management
           clear_game_snapshot(rob);
@@ -1183,16 +1426,15 @@ static void game_process_events_syncing_mp(Robinix * rob, Event * evt) {
       }
 
       //If host then check for the "Synced" message by the client
-      if(rob->isPlayer1 && strncmp(evt->remote_msg, COMM_SYNCED_STR, strlen(COMM_SYNCED_STR)) == 0) {
+      if(rob->isPlayer1 && evt->remote_frame->opcode == COMM_OP_SYNCED) {
         //printf("DBG: Received synced indication, calculating and sending tick to start the game on\n");
 
         rob->tick_decided = rob->mp_syncing_ticks + COMM_DELTA_FOR_HANDSHAKE;
-        //A very large buffer can be used with no negative effects since uart_send_string copies the string until strlen so no unnecessary space is used
-        //The buffer is also stack allocated so no large block of memory is kept in use indefinitely
-        char start_msg[45];
-        sprintf(start_msg, "%s%llu", COMM_START_TICK_PREFIX, rob->tick_decided);
-        printf("DBG: Player1, Sending starting tick msg: %s\n", start_msg);
-        uart_send_string(start_msg);
+        //Since printf does not accept %llu, we have to use sprintf beforehand
+        char tick_str[30];
+        sprintf(tick_str, "%llu", rob->tick_decided);
+        printf("DBG: Player1, Sending starting tick msg: %s\n", tick_str);
+        comm_send_value(COMM_OP_START_TICK, rob->tick_decided, true);
 
         //Upon leaving state clear the game snapshot for better memory management
         clear_game_snapshot(rob);
@@ -1200,17 +1442,14 @@ static void game_process_events_syncing_mp(Robinix * rob, Event * evt) {
         rob->currstate.state = WAITING_MP;
         //Switching the comm mode to "ingame none", will be used when transferring message about player being over door
         rob->comm_state = COMM_IG_NONE;
-        rob->other_player_at_exit = false;
-        rob->sent_at_exit = false;
         //Resetting the message delay ticks (will also be used for this)
         rob->mp_msg_delay_ticks = 0;
 
         //When entering waiting state, load game and take snapshot
         //I am host, I get level 1 for multiplayer
-        if(game_load_level(rob, 1, true) != 0) {
-          printf("DBG: Error loading mp level 1\n");
+        if(game_load_mp(rob) != 0) {
           //In case of error send abort message and go back to main menu
-          uart_send_string(COMM_ABORT_STR);
+          comm_send(COMM_OP_ABORT, true);
           rob->currstate.state = MENU;
         }
         //Have to force level draw and buffer swap so that the snapshot is taken correctly... Sorry
@@ -1231,11 +1470,10 @@ static void game_process_events_waiting_mp(Robinix * rob, Event * evt) {
       if(evt->pressed_key == '!') {
         //TEMP for debug using escape to go back
         //If exiting to menu also warn other player so that they exit as well
-        uart_send_string(COMM_PLAYER_LEAVING_STR);
+        comm_send(COMM_OP_PLAYER_LEAVING, true);
         rob->currstate.state = MENU;
         //If exiting, destroy all objects that can be in use and leave
-        destroy_level(&(rob->level));
-        destroy_gamestats(&(rob->game_stats));
+        game_unload_mp(rob);
       }
       break;
     case MOUSE_MOVE:
@@ -1248,18 +1486,20 @@ static void game_process_events_waiting_mp(Robinix * rob, Event * evt) {
       limit_xy_inside_screen(&(rob->currstate.mouseX), &(rob->currstate.mouseY), rob->mouse_bmp->bitmapInfoHeader.width, rob->mouse_bmp->bitmapInfoHeader.height);
       break;
     case RECEIVED_REMOTE_MESSAGE:
-      if(strncmp(evt->remote_msg, COMM_ABORT_STR, strlen(COMM_ABORT_STR)) == 0) {
+      //The other player may start playing a tick before us, so its inputs can already arrive
+      if(rob->lockstep != NULL && lockstep_receive(rob->lockstep, evt->remote_frame)) {
+        break;
+      }
+      if(evt->remote_frame->opcode == COMM_OP_ABORT) {
         //If abort ocurred, destroy all objects that can be in use and leave as well
-        destroy_level(&(rob->level));
-        destroy_gamestats(&(rob->game_stats));
+        game_unload_mp(rob);
         rob->currstate.state = MENU;
       }
-      if(strncmp(evt->remote_msg, COMM_PLAYER_LEAVING_STR, strlen(COMM_PLAYER_LEAVING_STR)) == 0) {
+      if(evt->remote_frame->opcode == COMM_OP_PLAYER_LEAVING) {
         //If the other player is leaving so are we
         rob->currstate.state = MENU;
         //If exiting, destroy all objects that can be in use and leave
-        destroy_level(&(rob->level));
-        destroy_gamestats(&(rob->game_stats));
+        game_unload_mp(rob);
       }
       break;
     //No other events are being considered at the moment
@@ -1305,13 +1545,12 @@ static void game_process_events_playing_mp(Robinix * rob, Event * evt) {
         case '!':
           //TEMP for debug using escape to go back
           //If exiting to menu also warn other player so that they exit as well
-          uart_send_string(COMM_PLAYER_LEAVING_STR);
+          comm_send(COMM_OP_PLAYER_LEAVING, true);
           //Resetting menu before going there (Going back to main menu, etc)
           reset_menumanager(rob->menu_man);
           rob->currstate.state = MENU;
           //When leaving also deallocate used things
-          destroy_gamestats(&(rob->game_stats));
-          destroy_level(&(rob->level));
+          game_unload_mp(rob);
           break;
         default:
           break;
@@ -1326,125 +1565,63 @@ static void game_process_events_playing_mp(Robinix * rob, Event * evt) {
       level_update_mouse_over(rob->level, rob->currstate.mouseX, rob->currstate.mouseY);
       break;
     case MOUSE_LB_DOWN:
-      level_handle_mouse_click(rob->level);
+      //The click is part of the next input sampled, so that it happens in the same tick for both players
+      rob->mp_click_pending = true;
       break;
+    //The following events come from the simulation of both levels, so both players get them in the same tick and no message is needed
     case PLAYER_GOT_COIN:
       gamestats_tick_coins(rob->game_stats);
-      //Sending message to other player so both track total coins
-      uart_send_string(COMM_COIN_GOT_STR);
-      break;
-    case PLAYER_GOT_TREASURE:
-      //Sending message so other player knows we got the treasure
-      uart_send_string(COMM_TREASURE_GOT_STR);
       break;
     case PLAYER_COLLIDE_WITH_GUARD:
-      //Send message so other player also knows he lost
-      uart_send_string(COMM_PLAYER_LOST_STR);
+      //One of the players was caught, both lose
       rob->currstate.state = LOSE_MP;
       //Upon losing, level and gamestats are destroyed to save memory
-      destroy_level(&(rob->level));
-      destroy_gamestats(&(rob->game_stats));
+      game_unload_mp(rob);
       break;
     case PLAYER_COLLIDE_WITH_EXIT:
-      if(rob->other_player_at_exit) {
-        //If other player is already at the exit, then send "we won" string and move to win state
-        uart_send_string(COMM_BOTH_AT_EXIT_STR);
-        //Moving to win state
-        //Get stats and move to score submit screen
-        //First, we calculate player score to have it stored for display later on
-        rob->player_score = gamestats_calculate_score(rob->game_stats);
-        //Also saving time taken for displaying
-        rob->time_taken = gamestats_get_time_taken(rob->game_stats);
-        //Checking if the score is a new highscore
-        if(rob->player_score > scoremanager_get_highest_score(rob->score_man)) {
-          rob->is_new_highscore = true;
-        } else {
-          rob->is_new_highscore = false;
-        }
-
-        //Going into score submit state
-        rob->currstate.state = SCORE_SUBMIT;
-        //Upon winning, level is destroyed to save memory
-        destroy_level(&(rob->level));
-        //Game Stats as well since we already got what we wanted from it (time taken as hh:mm:ss string and calculated score)
-        destroy_gamestats(&(rob->game_stats));
-        //Winning the game uses a snapshot as a background
-        snapshot_game(rob);
+      //Both players are at the exit, moving to win state
+      //Get stats and move to score submit screen
+      //First, we calculate player score to have it stored for display later on
+      rob->player_score = gamestats_calculate_score(rob->game_stats);
+      //Also saving time taken for displaying
+      rob->time_taken = gamestats_get_time_taken(rob->game_stats);
+      //Checking if the score is a new highscore
+      if(rob->player_score > scoremanager_get_highest_score(rob->score_man)) {
+        rob->is_new_highscore = true;
       } else {
-        if(!(rob->sent_at_exit)) {
-          //Otherwise just tell the other player we are at the exit
-          uart_send_string(COMM_OVER_EXIT_STR);
-          //To prevent spamming until overrun
-          rob->sent_at_exit = true;
-        }
+        rob->is_new_highscore = false;
       }
+
+      //Going into score submit state
+      rob->currstate.state = SCORE_SUBMIT;
+      //Upon winning, levels are destroyed to save memory
+      //Game Stats as well since we already got what we wanted from it (time taken as hh:mm:ss string and calculated score)
+      game_unload_mp(rob);
+      //Winning the game uses a snapshot as a background
+      snapshot_game(rob);
       break;
     case RECEIVED_REMOTE_MESSAGE:
       //Process messages from other player here
+      //Inputs and hashes of the other player
+      if(lockstep_receive(rob->lockstep, evt->remote_frame)) {
+        break;
+      }
       //If other player leaves game
-      if(strncmp(evt->remote_msg, COMM_PLAYER_LEAVING_STR, strlen(COMM_PLAYER_LEAVING_STR)) == 0) {
+      if(evt->remote_frame->opcode == COMM_OP_PLAYER_LEAVING) {
         //If the other player is leaving so are we
         rob->currstate.state = MENU;
         //Resetting menu before going there (Going back to main menu, etc)
         reset_menumanager(rob->menu_man);
         //When leaving also deallocate used things
-        destroy_gamestats(&(rob->game_stats));
-        destroy_level(&(rob->level));
-      }
-      //Remote lost (Collided with guard)
-      if(strncmp(evt->remote_msg, COMM_PLAYER_LOST_STR, strlen(COMM_PLAYER_LOST_STR)) == 0) {
-        //If other player lost, so did we
-        //Destroy used objects and move into lose state
-        destroy_gamestats(&(rob->game_stats));
-        destroy_level(&(rob->level));
-        rob->currstate.state = LOSE_MP;
-      }
-      //Remote got treasure (need to open exit lock)
-      if(strncmp(evt->remote_msg, COMM_TREASURE_GOT_STR, strlen(COMM_TREASURE_GOT_STR)) == 0) {
-        //Updates exit state
-        level_remote_got_treasure(rob->level);
-      }
-      //Remote got coin, also tick local coins
-      if(strncmp(evt->remote_msg, COMM_COIN_GOT_STR, strlen(COMM_COIN_GOT_STR)) == 0) {
-        gamestats_tick_coins(rob->game_stats);
-      }
-      //We are both at the exit! Moving to win state
-      if(strncmp(evt->remote_msg, COMM_BOTH_AT_EXIT_STR, strlen(COMM_BOTH_AT_EXIT_STR)) == 0) {
-        printf("DBG: Got both at exit message! Moving to win screen!\n");
-        //Get stats and move to score submit screen
-        //First, we calculate player score to have it stored for display later on
-        rob->player_score = gamestats_calculate_score(rob->game_stats);
-        //Also saving time taken for displaying
-        rob->time_taken = gamestats_get_time_taken(rob->game_stats);
-        //Checking if the score is a new highscore
-        if(rob->player_score > scoremanager_get_highest_score(rob->score_man)) {
-          rob->is_new_highscore = true;
-        } else {
-          rob->is_new_highscore = false;
-        }
-
-        //Going into score submit state
-        rob->currstate.state = SCORE_SUBMIT;
-        //Upon winning, level is destroyed to save memory
-        destroy_level(&(rob->level));
-        //Game Stats as well since we already got what we wanted from it (time taken as hh:mm:ss string and calculated score)
-        destroy_gamestats(&(rob->game_stats));
-        //Winning the game uses a snapshot as a background
-        snapshot_game(rob);
-      }
-      if(strncmp(evt->remote_msg, COMM_OVER_EXIT_STR, strlen(COMM_OVER_EXIT_STR)) == 0) {
-        //The other player is now at the exit, remember that
-        rob->other_player_at_exit = true;
-        //Now, when we touch the exit we should send win string
+        game_unload_mp(rob);
       }
       //Abort, error ocurred
-      if(strncmp(evt->remote_msg, COMM_ABORT_STR, strlen(COMM_ABORT_STR)) == 0) {
+      if(evt->remote_frame->opcode == COMM_OP_ABORT) {
         rob->currstate.state = MENU;
         //Resetting menu before going there (Going back to main menu, etc)
         reset_menumanager(rob->menu_man);
         //When leaving also deallocate used things
-        destroy_gamestats(&(rob->game_stats));
-        destroy_level(&(rob->level));
+        game_unload_mp(rob);
       }
       break;
     //No other events are being considered at the moment
@@ -1482,43 +1659,84 @@ static void game_process_events_lose_mp(Robinix * rob, Event * evt) {
   }
 }
 
+//Checks if the game is in one of the multiplayer states
+static bool game_is_mp(Robinix * rob) {
+  return rob->currstate.state >= SEARCHING_MP && rob->currstate.state <= LOSE_MP;
+}
+
+//Hands an event to the handler of the current state
+static void game_process_event(Robinix * rob, Event * evt) {
+  //The telemetry overlay can be shown in every multiplayer state
+  if(evt->evt_type == KEY_DOWN && evt->pressed_key == TELEMETRY_OVERLAY_KEY && game_is_mp(rob)) {
+    telemetry_toggle_overlay();
+    return;
+  }
+  //The profiler overlay in every state, except when the key is part of the player name
+  if(evt->evt_type == KEY_DOWN && evt->pressed_key == PROFILER_OVERLAY_KEY && rob->currstate.state != SCORE_SUBMIT) {
+    profiler_toggle_overlay();
+    return;
+  }
+  if(evt->evt_type == KEY_DOWN && evt->pressed_key == TRACE_EXPORT_KEY && rob->currstate.state != SCORE_SUBMIT) {
+    trace_export(TRACE_DUMP_LOCATION);
+    return;
+  }
+
+  switch (rob->currstate.state) {
+    case PLAYING_SP:
+      game_process_event_playing_sp(rob, evt);
+      break;
+    case PAUSED_SP:
+      game_process_event_paused(rob, evt);
+      break;
+    case LOSE_SP:
+      game_process_event_lose_sp(rob, evt);
+      break;
+    case MENU:
+      game_process_event_menu(rob, evt);
+      break;
+    case SCORE_SUBMIT:
+      game_process_events_score_submit(rob, evt);
+      break;
+    case SEARCHING_MP:
+      game_process_events_searching_mp(rob, evt);
+      break;
+    case SYNCING_MP:
+      game_process_events_syncing_mp(rob, evt);
+      break;
+    case WAITING_MP:
+      game_process_events_waiting_mp(rob, evt);
+      break;
+    case PLAYING_MP:
+      game_process_events_playing_mp(rob, evt);
+      break;
+    case LOSE_MP:
+      game_process_events_lose_mp(rob, evt);
+      break;
+    default:
+      break;
+  }
+}
+
+//Handles every frame received since the last tick where it is, in the transport's queue
+//The event is on the stack and only holds a view of the frame, so nothing is allocated or copied per message
+static void game_process_remote_messages(Robinix * rob) {
+  SerialFrameView frame;
+  while(transport_peek_frame(&frame)) {
+    //Remote messages go through the link first, which consumes acks and duplicates
+    if(commlink_receive(&frame)) {
+      Event evt = {RECEIVED_REMOTE_MESSAGE, 0, 0, '?', &frame};
+      game_process_event(rob, &evt);
+    }
+    transport_release_frame();
+  }
+}
+
 void game_process_events(Robinix * rob) {
+  game_process_remote_messages(rob);
+
   int i;
   for(i = 0; i < rob->n_events_to_process; i++) {
-    switch (rob->currstate.state) {
-      case PLAYING_SP:
-        game_process_event_playing_sp(rob, rob->event_buffer[i]);
-        break;
-      case PAUSED_SP:
-        game_process_event_paused(rob, rob->event_buffer[i]);
-        break;
-      case LOSE_SP:
-        game_process_event_lose_sp(rob, rob->event_buffer[i]);
-        break;
-      case MENU:
-        game_process_event_menu(rob, rob->event_buffer[i]);
-        break;
-      case SCORE_SUBMIT:
-        game_process_events_score_submit(rob, rob->event_buffer[i]);
-        break;
-      case SEARCHING_MP:
-        game_process_events_searching_mp(rob, rob->event_buffer[i]);
-        break;
-      case SYNCING_MP:
-        game_process_events_syncing_mp(rob, rob->event_buffer[i]);
-        break;
-      case WAITING_MP:
-        game_process_events_waiting_mp(rob, rob->event_buffer[i]);
-        break;
-      case PLAYING_MP:
-        game_process_events_playing_mp(rob, rob->event_buffer[i]);
-        break;
-      case LOSE_MP:
-        game_process_events_lose_mp(rob, rob->event_buffer[i]);
-        break;
-      default:
-        break;
-    }
+    game_process_event(rob, rob->event_buffer[i]);
   }
 
   //After processing events clear event array
@@ -8,6 +8,8 @@
 #include "menumanager.h"
 #include "scoremanager.h"
 #include "gamestats.h"
+#include "textwidget.h"
+#include "serialframe.h"
 
 /** @defgroup robinix robinix
  * @{
@@ -55,8 +57,8 @@ typedef struct {
   int mouse_move_y;
   //Which keyboard key was pressed (already in the correct char value)
   char pressed_key;
-  //Remote string received through Serial Port
-  char * remote_msg;
+  //Remote frame received through Serial Port (a view into the transport's queue, only valid while the event is being handled)
+  const SerialFrameView * remote_frame;
 } Event;
 
 //Game states enum
@@ -96,22 +98,23 @@ typedef struct {
 ///Communication
 #define COMM_MSG_RETRY_TICKDELAY        15 /* 4 times per second */
 #define COMM_DELAY_UNTIL_PINGING        60 /* The delay to wait until starting to send beacon messages */
-#define COMM_TICK_SYNC_DELAY            10 /* The delay in which to send sync ticks */
 #define COMM_DELTA_FOR_HANDSHAKE        239 /* Number of ticks to agree to start in (4 seconds minus 1 tick at the moment) */
-#define COMM_TICK_SYNC_MIN              6 /* Minimum number of concurrent successfully synced ticks to consider the program synced */
-#define COMM_SEARCHING_STR              "any1there" /* "Beacon" message, to seach for player 2 */
-#define COMM_REPLY_STR                  "im here" /* Reply to the "beacon" */
-#define COMM_ACKNOWLEDGE_REPLY          "gotcha" /* To reply to the reply and establish connection */
-#define COMM_SYNC_PREFIX                "sk" /* Prefix to identify a timer sync value */
-#define COMM_SYNCED_STR                 "nsync" /* When synced correctly, message to pass */
-#define COMM_START_TICK_PREFIX          "when i say go" /* Prefix to the agreed tick to start in */
-#define COMM_TREASURE_GOT_STR           "gottem"
-#define COMM_COIN_GOT_STR               "ding"
-#define COMM_OVER_EXIT_STR              "im at soup"
-#define COMM_BOTH_AT_EXIT_STR           "winning"
-#define COMM_PLAYER_LOST_STR            "i died"
-#define COMM_PLAYER_LEAVING_STR         "im out"
-#define COMM_ABORT_STR                  "cancela" /* In case of a critical error that should abort the process this is sent */
+
+//Opcodes of the messages exchanged between players (sent as binary frames, see serialframe.h)
+//Opcode 0 is reserved (SERIALFRAME_OP_RAW)
+typedef enum {
+  COMM_OP_SEARCHING = 1, /* "Beacon" message, to seach for player 2 */
+  COMM_OP_REPLY, /* Reply to the "beacon" */
+  COMM_OP_ACKNOWLEDGE_REPLY, /* To reply to the reply and establish connection */
+  COMM_OP_SYNC_PROBE, /* Clock sync probe sent by player 2, payload: varint tick when sent */
+  COMM_OP_SYNC_REPLY, /* Reply to a probe by player 1, payload: varint probe tick, varint tick when received (and replied, in the same tick) */
+  COMM_OP_SYNCED, /* When synced correctly, message to pass */
+  COMM_OP_START_TICK, /* The agreed tick to start in, payload: varint tick */
+  COMM_OP_LOCKSTEP_INPUTS, /* Inputs of the sender for the next turns, see lockstep.h for the payload */
+  COMM_OP_STATE_HASH, /* Hash of the simulation, payload: varint turn, varint hash */
+  COMM_OP_PLAYER_LEAVING,
+  COMM_OP_ABORT /* In case of a critical error that should abort the process this is sent */
+} comm_opcode_enum;
 
 typedef enum {
   COMM_WAITING_TO_PING = 0,
@@ -158,6 +161,9 @@ typedef struct Robinix {
   //Object for managing scores
   ScoreManager * score_man;
 
+  //Current date shown in the menu, set on every RTC update interrupt
+  TextWidget * menu_clock;
+
   //Helper variable for counting timer ticks while playing (to know when a second has passed)
   unsigned int timer_ticks_playing;
   //Object for calculating scores and managing game stats
@@ -165,24 +171,31 @@ typedef struct Robinix {
   //Helper variables for game stat calculation before submission
   char player_name[PLAYER_NAME_MAX_LENGTH + 1]; //+1 to have space for the null terminator, forgot that previously, oops
   unsigned long player_score;
-  char * current_date_string;
   char * time_taken;
   bool is_new_highscore;
+  //Level and mode being played, submitted with the score
+  unsigned int score_level;
+  score_mode_enum score_mode;
 
   //Object for all types of level handling
   struct Level * level;
 
   ////Helper variables for multiplayer
-  //Used for checking the delay when sending searching messages and also for delay when sending timer ticks to sync
+  //Used for checking the delay when sending searching messages and also for delay when sending clock sync probes
   comm_state_enum comm_state;
   unsigned int mp_msg_delay_ticks;
   bool isPlayer1;
   unsigned long long mp_syncing_ticks;
-  unsigned int n_ticks_synced;
+  bool clock_synced;
   //The tick that both agreed on to start the game
   unsigned long long tick_decided;
-  bool other_player_at_exit;
-  bool sent_at_exit;
+  //While playing both levels are simulated with rollback: ours and a copy of the other player's (only its player is drawn, as a ghost)
+  struct Level * remote_level;
+  struct Lockstep * lockstep;
+  struct Rollback * rollback;
+  struct Ghost * ghost;
+  //If the mouse was clicked since the last input was sampled
+  bool mp_click_pending;
 } Robinix;
 
 //Subscription macros (for easier debugging - knowing exactly what happened)
@@ -245,10 +258,10 @@ void add_event_to_buffer(Robinix * rob, Event * evt);
  * @param  mouse_move_x How much the mouse has moved in the X coordinate
  * @param  mouse_move_y How much the mouse has moved in the Y coordinate
  * @param  pressed_key  Which key was pressed (interpreted into the correct character)
- * @param  remote_msg   The message that was received through the UART
- * @return              Returns a pointer to a valid Event object or NULL in case of failure
+ * @param  remote_frame View of the frame that was received through the UART (not owned by the Event)
+ * @return              Returns a pointer to a valid Event object (in the frame arena, so not valid after the next tick's events are processed) or NULL in case of failure
  */
-Event * create_event(event_enum evt_type, int mouse_move_x, int mouse_move_y, char pressed_key, char * remote_msg);
+Event * create_event(event_enum evt_type, int mouse_move_x, int mouse_move_y, char pressed_key, const SerialFrameView * remote_frame);
 /**
  * @brief Event Object Destructor
  * @param evt Event to destroy
@@ -268,17 +281,23 @@ void clear_event_buffer(Robinix * rob);
 state_enum get_game_state(Robinix * rob);
 
 /**
- * @brief Processes all the Events in the Robinix Object Event buffer by calling appropriate event processing functions depending on the current state
+ * @brief Processes all the Events in the Robinix Object Event buffer (and the remote messages received) by calling appropriate event processing functions depending on the current state. Called in every tick, before game_update
  * @param rob Robinix Object to process events for
  */
 void game_process_events(Robinix * rob);
 
 /**
- * @brief Updates the game for every timer interrupt: Sends remote messages, moves player and guards, etc
+ * @brief Updates the game for every tick (see gameloop.h): Sends remote messages, moves player and guards, etc
  * @param rob Robinix Object for which to update
  */
 void game_update(Robinix * rob);
 
+/**
+ * @brief Updates what shows the current date, to be called after an RTC update interrupt
+ * @param rob Robinix Object to update
+ */
+void game_rtc_update(Robinix * rob);
+
 /**
  * @brief Draws the game based on the current game state
  * @param rob Robinix Object to draw, depending on current state
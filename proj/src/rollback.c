@@ -0,0 +1,181 @@
+#include "rollback.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+Rollback * create_rollback(Level * p1_level, Level * p2_level, Lockstep * ls_ptr) {
+  if(p1_level == NULL || p2_level == NULL || ls_ptr == NULL) {
+    return NULL;
+  }
+
+  Rollback * rb_ptr = calloc(1, sizeof *rb_ptr);
+
+  if(rb_ptr == NULL) {
+    return NULL;
+  }
+
+  rb_ptr->levels[0] = p1_level;
+  rb_ptr->levels[1] = p2_level;
+  rb_ptr->lockstep = ls_ptr;
+
+  return rb_ptr;
+}
+
+void destroy_rollback(Rollback ** rb_ptr) {
+  if(*rb_ptr == NULL) {
+    return;
+  }
+
+  free(*rb_ptr);
+  *rb_ptr = NULL;
+}
+
+static RollbackTick * get_tick(Rollback * rb_ptr, unsigned long tick) {
+  return &rb_ptr->ticks[tick % ROLLBACK_MAX_TICKS];
+}
+
+static bool same_input(const LevelInput * a, const LevelInput * b) {
+  return a->keys == b->keys && a->angle == b->angle && a->click == b->click;
+}
+
+//Simulates a tick of both levels, saving the snapshot and the inputs needed to go back to it
+static void simulate_tick(Rollback * rb_ptr, unsigned long tick) {
+  RollbackTick * entry = get_tick(rb_ptr, tick);
+  int i;
+  for(i = 0; i < 2; i++) {
+    level_save_state(rb_ptr->levels[i], &entry->states[i]);
+  }
+  rb_ptr->stats.snapshots_saved++;
+
+  entry->inputs_known = lockstep_get_inputs(rb_ptr->lockstep, tick, &entry->inputs[0], &entry->inputs[1]);
+
+  //Both levels are simulated in the same order by both players (player 1's first), so that whatever depends on both happens the same way
+  for(i = 0; i < 2; i++) {
+    entry->results[i] = level_step(rb_ptr->levels[i], &entry->inputs[i]);
+  }
+  for(i = 0; i < 2; i++) {
+    //The treasure of each level is needed to open the exit of the other
+    if(entry->results[i].got_treasure) {
+      level_remote_got_treasure(rb_ptr->levels[1 - i]);
+    }
+  }
+}
+
+//Goes back to the snapshot of the passed tick and simulates every tick from it up to the current one again
+static void resimulate_from(Rollback * rb_ptr, unsigned long tick) {
+  RollbackTick * entry = get_tick(rb_ptr, tick);
+  int i;
+  for(i = 0; i < 2; i++) {
+    level_restore_state(rb_ptr->levels[i], &entry->states[i]);
+  }
+  rb_ptr->stats.snapshots_restored++;
+
+  unsigned long t;
+  for(t = tick; t < rb_ptr->tick; t++) {
+    simulate_tick(rb_ptr, t);
+  }
+
+  unsigned long n_ticks = rb_ptr->tick - tick;
+  rb_ptr->stats.rollbacks++;
+  rb_ptr->stats.ticks_resimulated += n_ticks;
+  if(n_ticks > rb_ptr->stats.longest_rollback) {
+    rb_ptr->stats.longest_rollback = n_ticks;
+  }
+}
+
+//Checks the ticks simulated with predictions whose remote inputs are now known, going back to the first one that was wrong
+static void check_predictions(Rollback * rb_ptr) {
+  unsigned long known_end = lockstep_get_remote_known(rb_ptr->lockstep) * LOCKSTEP_TURN_TICKS;
+  unsigned long t;
+  for(t = rb_ptr->confirmed_tick; t < rb_ptr->tick && t < known_end; t++) {
+    RollbackTick * entry = get_tick(rb_ptr, t);
+    if(entry->inputs_known) {
+      continue;
+    }
+
+    LevelInput inputs[2];
+    lockstep_get_inputs(rb_ptr->lockstep, t, &inputs[0], &inputs[1]);
+    if(!same_input(&inputs[0], &entry->inputs[0]) || !same_input(&inputs[1], &entry->inputs[1])) {
+      //Every tick after this one is simulated again with what is known now, so there is nothing else to check
+      resimulate_from(rb_ptr, t);
+      return;
+    }
+    entry->inputs_known = true;
+  }
+}
+
+//Confirms every tick simulated with known inputs, reporting what happened in them
+static void confirm_ticks(Rollback * rb_ptr, RollbackOutcome * outcome) {
+  while(rb_ptr->confirmed_tick < rb_ptr->tick) {
+    RollbackTick * entry = get_tick(rb_ptr, rb_ptr->confirmed_tick);
+    if(!entry->inputs_known) {
+      break;
+    }
+
+    //The snapshot at the start of a turn is final once confirmed, so it is what both players hash
+    unsigned long turn = rb_ptr->confirmed_tick / LOCKSTEP_TURN_TICKS;
+    if(rb_ptr->confirmed_tick % LOCKSTEP_TURN_TICKS == 0 && turn > 0 && turn % LOCKSTEP_HASH_INTERVAL == 0) {
+      unsigned long hash = level_state_hash(&entry->states[1], level_state_hash(&entry->states[0], LEVEL_HASH_SEED));
+      lockstep_record_hash(rb_ptr->lockstep, turn, hash);
+    }
+
+    int i;
+    for(i = 0; i < 2; i++) {
+      outcome->n_coins_got += entry->results[i].n_coins_got;
+      if(entry->results[i].hit_guard) {
+        outcome->caught = true;
+      }
+      if(entry->results[i].at_exit) {
+        rb_ptr->at_exit[i] = true;
+      }
+    }
+
+    rb_ptr->confirmed_tick++;
+  }
+
+  outcome->both_at_exit = rb_ptr->at_exit[0] && rb_ptr->at_exit[1];
+}
+
+void rollback_update(Rollback * rb_ptr, RollbackOutcome * outcome) {
+  memset(outcome, 0, sizeof *outcome);
+
+  check_predictions(rb_ptr);
+
+  //Not going too far ahead of the other player, there would be too much to simulate again (and no snapshot to go back to)
+  if(rb_ptr->tick - rb_ptr->confirmed_tick < ROLLBACK_MAX_TICKS) {
+    simulate_tick(rb_ptr, rb_ptr->tick);
+    rb_ptr->tick++;
+    lockstep_advance(rb_ptr->lockstep);
+    rb_ptr->stats.ticks_simulated++;
+  } else {
+    rb_ptr->stats.wait_ticks++;
+  }
+
+  confirm_ticks(rb_ptr, outcome);
+}
+
+unsigned long rollback_get_confirmed_tick(Rollback * rb_ptr) {
+  return rb_ptr->confirmed_tick;
+}
+
+void rollback_get_confirmed_state(Rollback * rb_ptr, int player, LevelState * state) {
+  //Once every tick simulated is confirmed the level itself is the confirmed state, otherwise it is the snapshot of the first tick not confirmed
+  if(rb_ptr->confirmed_tick == rb_ptr->tick) {
+    level_save_state(rb_ptr->levels[player], state);
+  } else {
+    *state = get_tick(rb_ptr, rb_ptr->confirmed_tick)->states[player];
+  }
+}
+
+void rollback_print_stats(Rollback * rb_ptr) {
+  //Since printf might not support floating point values, printing in hundredths
+  unsigned long resim_per_second = 0;
+  if(rb_ptr->stats.ticks_simulated > 0) {
+    resim_per_second = rb_ptr->stats.ticks_resimulated * ROLLBACK_TICKS_PER_SECOND * 100 / rb_ptr->stats.ticks_simulated;
+  }
+
+  printf("rollback::%lu ticks simulated, %lu waiting for the other player\n", rb_ptr->stats.ticks_simulated, rb_ptr->stats.wait_ticks);
+  printf("rollback::%lu rollbacks (longest %lu ticks), %lu ticks simulated again, %lu/100 per second\n", rb_ptr->stats.rollbacks, rb_ptr->stats.longest_rollback, rb_ptr->stats.ticks_resimulated, resim_per_second);
+  printf("rollback::snapshots of %u bytes, %lu saved, %lu restored\n", (unsigned int) sizeof rb_ptr->ticks[0].states, rb_ptr->stats.snapshots_saved, rb_ptr->stats.snapshots_restored);
+}
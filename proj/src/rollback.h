@@ -0,0 +1,113 @@
+#ifndef __ROLLBACK_H
+#define __ROLLBACK_H
+
+#include <stdbool.h>
+#include "level.h"
+#include "lockstep.h"
+
+/** @defgroup rollback rollback
+ * @{
+ *
+ * Rollback for multiplayer: both levels are simulated straight away with the local input and a prediction of the remote one,
+ * going back to a snapshot and simulating again whenever a remote input arrives that does not match its prediction
+ */
+
+/*
+ * Before simulating each tick, the dynamic state of both levels is saved in a ring of snapshots, along with the inputs used.
+ * When the remote inputs of a turn arrive (see lockstep), they are compared with the ones the ticks of that turn were simulated with:
+ * on the first mismatch the snapshot of that tick is restored and every tick from it to the current one is simulated again.
+ * A tick is confirmed once it was simulated with known inputs, only then what happened in it (coins, guards, exits) is reported,
+ * so that nothing reported has to be taken back. The state hashes exchanged by lockstep are also taken from confirmed snapshots.
+ */
+
+#define ROLLBACK_MAX_TICKS        60 /* Ticks the simulation can be ahead of what is confirmed (one second), after that it waits for the other player */
+#define ROLLBACK_TICKS_PER_SECOND 60 /* For the statistics */
+
+//What is kept for each tick not yet confirmed
+typedef struct {
+  //Snapshot of both levels before the tick (player 1's first)
+  LevelState states[2];
+  //Inputs the tick was simulated with and if they were both known (false if the remote one was a prediction)
+  LevelInput inputs[2];
+  bool inputs_known;
+  LevelStepResult results[2];
+} RollbackTick;
+
+typedef struct {
+  unsigned long ticks_simulated;
+  unsigned long ticks_resimulated;
+  unsigned long rollbacks;
+  unsigned long longest_rollback;
+  unsigned long wait_ticks;
+  unsigned long snapshots_saved;
+  unsigned long snapshots_restored;
+} RollbackStats;
+
+//What happened in the ticks confirmed by an update
+typedef struct {
+  unsigned int n_coins_got;
+  bool caught;
+  bool both_at_exit;
+} RollbackOutcome;
+
+typedef struct Rollback {
+  //Levels being simulated, player 1's first (not owned)
+  Level * levels[2];
+  Lockstep * lockstep;
+  //Next tick to simulate
+  unsigned long tick;
+  //Every tick before this one was simulated with known inputs and reported
+  unsigned long confirmed_tick;
+  //Which players reached their exit in a confirmed tick
+  bool at_exit[2];
+  //Ticks from confirmed_tick to tick, indexed by tick modulo ROLLBACK_MAX_TICKS
+  RollbackTick ticks[ROLLBACK_MAX_TICKS];
+  RollbackStats stats;
+} Rollback;
+
+/**
+ * @brief Rollback Object Constructor
+ * @param  p1_level Level of player 1
+ * @param  p2_level Level of player 2
+ * @param  ls_ptr   Lockstep Object providing the inputs (its local input must be set whenever lockstep_needs_local_input says so)
+ * @return          Returns a pointer to a valid Rollback Object or NULL in case of failure
+ */
+Rollback * create_rollback(Level * p1_level, Level * p2_level, Lockstep * ls_ptr);
+
+/**
+ * @brief Rollback Object Destructor (the levels and the Lockstep Object are not destroyed)
+ * @param rb_ptr Rollback Object to destroy
+ */
+void destroy_rollback(Rollback ** rb_ptr);
+
+/**
+ * @brief Advances the simulation by one tick, first going back and simulating again if a remote input did not match its prediction
+ * @param rb_ptr  Rollback Object
+ * @param outcome Filled with what happened in the ticks that were confirmed in this update
+ */
+void rollback_update(Rollback * rb_ptr, RollbackOutcome * outcome);
+
+/**
+ * @brief Gets the first tick not yet confirmed (every tick before it was simulated with known inputs)
+ * @param  rb_ptr Rollback Object
+ * @return        First tick not yet confirmed
+ */
+unsigned long rollback_get_confirmed_tick(Rollback * rb_ptr);
+
+/**
+ * @brief Gets the state of a level at the start of the first tick not yet confirmed, which will not change anymore
+ * @param rb_ptr Rollback Object
+ * @param player Index of the player (0 for player 1, 1 for player 2)
+ * @param state  Filled with the state
+ */
+void rollback_get_confirmed_state(Rollback * rb_ptr, int player, LevelState * state);
+
+/**
+ * @brief Prints the statistics of the rollback session (ticks simulated again per second and cost of the snapshots)
+ * @param rb_ptr Rollback Object
+ */
+void rollback_print_stats(Rollback * rb_ptr);
+
+/** @} */
+
+#endif /* __ROLLBACK_H */
@@ -9,12 +9,16 @@
 //#include <string.h>
 #include <math.h>
 #include "i8042.h"
+#include "epoch.h"
+#include "gameclock.h"
 
 ////Private variables
 //Hook ID for subscribing to rtc interrupts
 static int rtc_hookID = 8;
 
 static Date_obj curr_date = {.year = 0, .month = 0, .day = 0, .hour = 0, .minute = 0, .second = 0};
+//curr_date converted to seconds since 2000/01/01 (see epoch.h), once per update interrupt
+static unsigned long curr_epoch = 0;
 
 
 int rtc_subscribe_int() {
@@ -154,6 +158,8 @@ int rtc_IH() {
 
 	//Update interrupt
 	if(regC & RTC_REG_C_UE) {
+		//Exactly a second after the previous one
+		gameclock_rtc_update();
 		if(update_RTC_date() != 0) {
 			printf("rtc_IH::Error in handling update interrupt\n");
 			return -3;
@@ -197,163 +203,12 @@ unsigned long data_bcd_to_binary(unsigned long n){
 
 bool is_christmas_time() {
 
-	Date_obj date = get_current_date();
-
-	return ((date.month == 12 && (date.day >= 18 && date.day <= 31)) || (date.month == 1 && (date.day >= 1 && date.day <= 6)));
+	return ((curr_date.month == 12 && (curr_date.day >= 18 && curr_date.day <= 31)) || (curr_date.month == 1 && (curr_date.day >= 1 && curr_date.day <= 6)));
 
 }
 
-void tick_second(Date_obj * date) {
-	if (date->second == 59) {
-		date->second = 0;
-		if (date->minute == 59){
-			date->minute = 0;
-			if (date->hour == 24){
-				date->hour = 0;
-				date->day++;
-			} else {
-				date->hour++;
-			}
-		} else {
-			date->minute++;
-		}
-	} else {
-		date->second++;
-	}
-}
-
-int get_seconds_elapsed_between_dates(Date_obj d1, Date_obj d2) {
-
-	Date_obj passed_time;
-
-
-	int days_per_month = 0;
-	int days_per_year = 0;
-	//Calculating how many days there are in the month that possibly passed and how many days there are in the year that possibly passed
-	if(d1.month == 4 || d1.month == 6 || d1.month ==9 || d1.month == 11){
-		days_per_month = 30;
-
-	}	else if(d1.month == 2){
-		if(d1.year % 4 == 0){
-			days_per_month = 29;
-			days_per_year = 366;
-
-		} else {
-			days_per_month = 28;
-			days_per_year = 365;
-		}
-	} else 	if (d1.month == 1 || d1.month ==3 || d1.month==5 || d1.month ==7 || d1.month ==8 || d1.month ==10 || d1.month==12){
-		days_per_month = 31;
-	}
-
-
-	if(d2.second > d1.second){
-		--d1.minute;
-		d1.second += 60;
-	}
-
-  passed_time.second = d1.second - d2.second;
-  if(d2.minute > d1.minute){
-      --d1.hour;
-      d1.minute += 60;
-  }
-
-  passed_time.minute = d1.minute - d2.minute;
-
-	if(d2.hour > d1.hour){
-      --d1.day;
-      d1.hour += 24;
-  }
-
-  passed_time.hour = d1.hour - d2.hour;
-
-	if (d2.day > d1.day) {
-		--d1.month;
-		d1.day += days_per_month;
-		}
-
-	passed_time.day = d1.day - d2.day;
-
-	if (d2.month > d1.month) {
-		--d1.year;
-		d1.month += 12;
-	}
-
-	passed_time.month = d1.month - d2.month;
-	passed_time.year = d1.year - d2.year;
-
-	int a = (passed_time.year)*days_per_year*24*60*60 + (passed_time.month)*days_per_month*24*60*60 + (passed_time.day)*24*60*60 +(passed_time.hour)*60*60 + (passed_time.minute)*60 + (passed_time.second);
-	return a;
-}
-
-int get_seconds(const Date_obj * d1) {
-	if(d1 == NULL) {
-		return -1;
-	}
-	return d1->hour * 60*60 + d1->minute * 60 + d1->second;
-}
-
-char * date_to_date_string (const Date_obj * date) {
-
-	if (date == NULL) {
-		return NULL;
-	}
-
-	//Date string is at most YYYY:MM:DD so 10 characters + 1 for \0 = 11 + 3 for safety = 14
-
-	char * rtc_string = malloc(14 * sizeof *rtc_string);
-
-	if(rtc_string == NULL) {
-		//Could not be allocated
-		return NULL;
-	}
-
-	sprintf(rtc_string, "20%02d/%02d/%02d", date->year, date->month, date->day);
-
-	return rtc_string;
-}
-
-char * date_to_time_string(const Date_obj * date) {
-
-	if (date == NULL) {
-		return NULL;
-	}
-
-	//Time string is at most HH:MM:SS so 8 characters + 1 for \0 = 9 + 3 for safety = 12
-
-	char * rtc_string = malloc(12 * sizeof *rtc_string);
-
-	if(rtc_string == NULL) {
-		//Could not be allocated
-		return NULL;
-	}
-
-	sprintf(rtc_string, "%02d:%02d:%02d", date->hour, date->minute, date->second);
-
-	return rtc_string;
-}
-
-char* date_to_string(const Date_obj* date) {
-    if (date == NULL) {
-      return NULL;
-    }
-
-		//Total date string is 8 for time + 10 for date + 1 for space + 1 for \0 = 20 + 6 for safety = 26
-
-		char * rtc_string = malloc(26 * sizeof *rtc_string);
-
-		if(rtc_string == NULL) {
-			//Could not be allocated
-			return NULL;
-		}
-
-    sprintf(rtc_string, "20%02d/%02d/%02d %02d:%02d:%02d", date->year, date->month, date->day, date->hour, date->minute, date->second);
-
-    return rtc_string;
-}
-
-Date_obj get_current_date() {
-  return curr_date;
+unsigned long get_current_epoch() {
+  return curr_epoch;
 }
 
 int update_RTC_date() {
@@ -434,5 +289,12 @@ int update_RTC_date() {
 	temp_var = data_bcd_to_binary(temp_var);
 	curr_date.second = temp_var;
 
+	//Converted just once, everything that needs the time as a number uses this
+	unsigned long t = epoch_from_civil(curr_date.year, curr_date.month, curr_date.day, curr_date.hour, curr_date.minute, curr_date.second);
+	//(A date that is not valid, such as the one of an RTC never set, leaves the last one there was)
+	if(t != EPOCH_INVALID_TIME) {
+		curr_epoch = t;
+	}
+
 	return 0;
 }
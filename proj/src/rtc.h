@@ -64,27 +64,6 @@ int rtc_deactivate_update_interrupts();
  */
 unsigned long data_bcd_to_binary(unsigned long n);
 
-/**
- * @brief Calculates the seconds elapsed between two dates
- * @param  d1 Date 1
- * @param  d2 Date 2
- * @return    Number of seconds elapsed between two dates
- */
-int get_seconds_elapsed_between_dates(Date_obj d1, Date_obj d2);
-
-/**
- * @brief Gets the number of seconds elapse since 00:00:00 (Only considers HH:MM:SS since this is used during gameplay, where a Date_obj is used as a time counter)
- * @param  d1 Date object to get the number of seconds for
- * @return    The number of seconds in the passed Date
- */
-int get_seconds(const Date_obj * d1);
-
-/**
- * @brief Increments time by 1 second in the passed Date
- * @param date Date to increment
- */
-void tick_second(Date_obj * date);
-
 /**
  * @brief Checks if the curr_date (Date_obj) is between the 18th of December and 6th January
 * @return Returns true if the date is between (XXXX/12/18) and (XXXX/01/06) or false otherwise
@@ -92,10 +71,10 @@ void tick_second(Date_obj * date);
 bool is_christmas_time();
 
 /**
- * @brief Returns a copy of the current Date, kept updated using RTC update interrupts
- * @return Returns a copy of the current Date
+ * @brief Returns the current date and time as seconds since 2000/01/01 00:00:00 (see epoch.h), kept updated using RTC update interrupts
+ * @return Returns the current time, 0 until the first update interrupt
  */
-Date_obj get_current_date();
+unsigned long get_current_epoch();
 
 /**
  * @brief Waits until the current date can be read, was used for polling
@@ -108,25 +87,4 @@ void wait_RTC();
  */
 int update_RTC_date();
 
-/**
- * @brief Converts a Date to a date string in the YYYY/MM/DD format
- * @param  date Date to convert to date string
- * @return      Returns a string in the correct date format
- */
-char * date_to_date_string(const Date_obj * date);
-
-/**
- * @brief Converts a Date to a time string in the HH:MM:SS format
- * @param  date Date to convert to time string
- * @return      Returns a string in the correct time format
- */
-char * date_to_time_string(const Date_obj * date);
-
-/**
- * @brief Converts a Date to a date and time string in the YYYY/MM/DD HH:MM:SS format
- * @param  curr_date Date to convert to string
- * @return           Returns a string representative of the passed date
- */
-char* date_to_string(const Date_obj* curr_date);
-
 #endif /* __RTC_H */
@@ -6,7 +6,20 @@
 #include <limits.h>
 #include <errno.h>
 
-Score * create_score(unsigned long points, const char * name, const char * finish_date) {
+unsigned long score_date_to_day(unsigned long year, unsigned long month, unsigned long day) {
+  return epoch_days_from_civil(year, month, day);
+}
+
+//Reads the day of a YYYY/MM/DD (or YY/MM/DD) finish date
+static unsigned long finish_date_to_day(const char * finish_date) {
+  unsigned long year, month, day;
+  if(sscanf(finish_date, "%lu/%lu/%lu", &year, &month, &day) != 3) {
+    return SCORE_UNKNOWN_DAY;
+  }
+  return score_date_to_day(year, month, day);
+}
+
+Score * create_score(unsigned long points, const char * name, const char * finish_date, unsigned int level, score_mode_enum mode) {
   //Allocating and checking if allocation was successful
   Score * s_ptr = malloc(sizeof *s_ptr);
 
@@ -19,6 +32,9 @@ Score * create_score(unsigned long points, const char * name, const char * finis
   s_ptr->points = points;
   s_ptr->name = strdup(name);
   s_ptr->finish_date = strdup(finish_date);
+  s_ptr->level = level;
+  s_ptr->mode = mode;
+  s_ptr->day = finish_date_to_day(finish_date);
 
   if(s_ptr->name == NULL || s_ptr->finish_date == NULL) {
     //Allocation unsuccessful, free the other variables and return NULL
@@ -126,6 +142,9 @@ Score * create_score_from_string(const char * s) {
   s_ptr->points = points_int;
   s_ptr->name = final_name;
   s_ptr->finish_date = final_date;
+  s_ptr->level = SCORE_UNKNOWN_LEVEL;
+  s_ptr->mode = SCORE_MODE_SP;
+  s_ptr->day = finish_date_to_day(final_date);
 
   //Returning created score object
   return s_ptr;
@@ -1,30 +1,48 @@
 #ifndef __SCORE_H
 #define __SCORE_H
 
+#include "epoch.h"
+
 /** @defgroup score score
  * @{
  *
  * Functions and structs for Score creation and operation
  */
 
+#define SCORE_UNKNOWN_LEVEL 0 /* Level of the scores from before levels were saved with them */
+#define SCORE_UNKNOWN_DAY   EPOCH_INVALID_DAY /* Day of a finish date that could not be read */
+
+typedef enum {
+  SCORE_MODE_SP = 0,
+  SCORE_MODE_MP,
+  SCORE_N_MODES
+} score_mode_enum;
+
 typedef struct {
   unsigned long points;
   char * name;
   char * finish_date;
+  unsigned int level;
+  score_mode_enum mode;
+  //Finish date as days since 2000/01/01 (see score_date_to_day), to compare dates with
+  unsigned long day;
 } Score;
 
 /**
  * @brief Creates a new Score based on the passed arguments
  * @param  points      The number of points that were scored
  * @param  name        The name of the player
- * @param  finish_date The finish date of the score
+ * @param  finish_date The finish date of the score, YYYY/MM/DD
+ * @param  level       The level the score was got in
+ * @param  mode        The mode the level was played in
  * @return             Returns a pointer to a valid score or NULL if an error ocurred
  */
-Score * create_score(unsigned long points, const char * name, const char * finish_date);
+Score * create_score(unsigned long points, const char * name, const char * finish_date, unsigned int level, score_mode_enum mode);
 
 /**
  * @brief Creates a new Score based on a passed string
  * @param  s String to interpret, in the format <Points> <Name> <Date> in which these elements are space separated and date is YY/MM/DD
+ * (as older versions of the game saved them, so the level is SCORE_UNKNOWN_LEVEL and the mode SCORE_MODE_SP)
  * @return   Returns a pointer to a valid score or NULL if an error ocurred
  */
 Score * create_score_from_string(const char * s);
@@ -42,5 +60,14 @@ void destroy_score(Score ** s_ptr);
  */
 char * score_to_string (Score * s_ptr);
 
+/**
+ * @brief Converts a date to the number of days since 2000/01/01 (see epoch_days_from_civil)
+ * @param  year  Year, either full (2018) or since 2000 (18)
+ * @param  month Month, from 1 to 12
+ * @param  day   Day of the month, from 1
+ * @return       Days since 2000/01/01, or SCORE_UNKNOWN_DAY if the date is not valid (or before 2000)
+ */
+unsigned long score_date_to_day(unsigned long year, unsigned long month, unsigned long day);
+
 
 #endif /* __SCORE_H */
@@ -0,0 +1,252 @@
+#include "scoreindex.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "utilities.h"
+
+bool scorelist_reserve(ScoreList * list, unsigned int n_scores) {
+  if(n_scores <= list->capacity) {
+    return true;
+  }
+
+  //Doubling, so that adding scores one at a time does not realloc every time
+  unsigned int capacity = MAX_VAL(list->capacity * 2, SCORELIST_MIN_CAPACITY);
+  capacity = MAX_VAL(capacity, n_scores);
+  Score ** temp = realloc(list->scores, capacity * sizeof *(list->scores));
+  if(temp == NULL) {
+    return false;
+  }
+
+  list->scores = temp;
+  list->capacity = capacity;
+  return true;
+}
+
+//Gets the position a score with the passed points goes in: after every score with as many points or more
+static unsigned int find_insert_position(const ScoreList * list, unsigned long points) {
+  unsigned int low = 0;
+  unsigned int high = list->n_scores;
+  while(low < high) {
+    unsigned int mid = low + (high - low) / 2;
+    if(list->scores[mid]->points >= points) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+void scorelist_insert(ScoreList * list, Score * s) {
+  unsigned int pos = list->n_scores;
+  if(pos > 0 && list->scores[pos - 1]->points < s->points) {
+    pos = find_insert_position(list, s->points);
+    memmove(&list->scores[pos + 1], &list->scores[pos], (list->n_scores - pos) * sizeof *(list->scores));
+  }
+
+  list->scores[pos] = s;
+  list->n_scores++;
+}
+
+void scorelist_free(ScoreList * list) {
+  free(list->scores);
+  list->scores = NULL;
+  list->n_scores = 0;
+  list->capacity = 0;
+}
+
+void scoreindex_init(ScoreIndex * idx) {
+  memset(idx, 0, sizeof *idx);
+}
+
+void scoreindex_free(ScoreIndex * idx) {
+  int level, mode;
+  for(level = 0; level <= SCOREINDEX_MAX_LEVEL; level++) {
+    for(mode = 0; mode < SCORE_N_MODES; mode++) {
+      scorelist_free(&idx->levels[level][mode]);
+    }
+  }
+
+  unsigned int i;
+  for(i = 0; i < idx->players_capacity; i++) {
+    //Empty slots might have a list allocated as well
+    scorelist_free(&idx->players[i].list);
+  }
+  free(idx->players);
+  free(idx->days);
+  scoreindex_init(idx);
+}
+
+//FNV-1a, 32 bits
+static unsigned long hash_name(const char * name) {
+  unsigned long hash = 2166136261UL;
+  while(*name != '\0') {
+    hash ^= (unsigned char) *name++;
+    hash = (hash * 16777619UL) & 0xFFFFFFFF;
+  }
+  return hash;
+}
+
+//Gets the slot of a player, or the empty slot it would take if it has no scores yet (NULL if the table was not allocated yet)
+static PlayerScores * find_player(PlayerScores * players, unsigned int capacity, const char * name, unsigned long hash) {
+  if(capacity == 0) {
+    return NULL;
+  }
+
+  //Linear probing, the table is never full
+  unsigned int i = hash & (capacity - 1);
+  while(true) {
+    PlayerScores * slot = &players[i];
+    if(slot->list.n_scores == 0) {
+      return slot;
+    }
+    if(slot->hash == hash && strcmp(slot->list.scores[0]->name, name) == 0) {
+      return slot;
+    }
+    i = (i + 1) & (capacity - 1);
+  }
+}
+
+//Makes room for one more player, doubling the table (and moving every player to its slot in the new one) if it is too full
+static bool reserve_player(ScoreIndex * idx) {
+  if((idx->n_players + 1) * 100 <= idx->players_capacity * SCOREINDEX_PLAYERS_LOAD) {
+    return true;
+  }
+
+  unsigned int capacity = MAX_VAL(idx->players_capacity * 2, SCOREINDEX_MIN_PLAYERS);
+  PlayerScores * players = calloc(capacity, sizeof *players);
+  if(players == NULL) {
+    return false;
+  }
+
+  unsigned int i;
+  for(i = 0; i < idx->players_capacity; i++) {
+    PlayerScores * old = &idx->players[i];
+    if(old->list.n_scores == 0) {
+      scorelist_free(&old->list);
+      continue;
+    }
+    *find_player(players, capacity, old->list.scores[0]->name, old->hash) = *old;
+  }
+
+  free(idx->players);
+  idx->players = players;
+  idx->players_capacity = capacity;
+  return true;
+}
+
+//Gets the position of a day in the days with scores, or the one it would take if it has none yet
+static unsigned int find_day_position(const ScoreIndex * idx, unsigned long day) {
+  unsigned int low = 0;
+  unsigned int high = idx->n_days;
+  while(low < high) {
+    unsigned int mid = low + (high - low) / 2;
+    if(idx->days[mid].day < day) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+static bool has_day(const ScoreIndex * idx, unsigned int pos, unsigned long day) {
+  return pos < idx->n_days && idx->days[pos].day == day;
+}
+
+bool scoreindex_reserve(ScoreIndex * idx, Score * s) {
+  if(s->level <= SCOREINDEX_MAX_LEVEL) {
+    ScoreList * list = &idx->levels[s->level][s->mode];
+    if(!scorelist_reserve(list, list->n_scores + 1)) {
+      return false;
+    }
+  }
+
+  if(!reserve_player(idx)) {
+    return false;
+  }
+  PlayerScores * player = find_player(idx->players, idx->players_capacity, s->name, hash_name(s->name));
+  if(!scorelist_reserve(&player->list, player->list.n_scores + 1)) {
+    return false;
+  }
+
+  if(s->day != SCORE_UNKNOWN_DAY && !has_day(idx, find_day_position(idx, s->day), s->day) && idx->n_days == idx->days_capacity) {
+    unsigned int capacity = MAX_VAL(idx->days_capacity * 2, SCORELIST_MIN_CAPACITY);
+    DayScores * temp = realloc(idx->days, capacity * sizeof *(idx->days));
+    if(temp == NULL) {
+      return false;
+    }
+    idx->days = temp;
+    idx->days_capacity = capacity;
+  }
+
+  return true;
+}
+
+void scoreindex_add(ScoreIndex * idx, Score * s) {
+  if(s->level <= SCOREINDEX_MAX_LEVEL) {
+    scorelist_insert(&idx->levels[s->level][s->mode], s);
+  }
+
+  unsigned long hash = hash_name(s->name);
+  PlayerScores * player = find_player(idx->players, idx->players_capacity, s->name, hash);
+  if(player->list.n_scores == 0) {
+    player->hash = hash;
+    idx->n_players++;
+  }
+  scorelist_insert(&player->list, s);
+
+  if(s->day == SCORE_UNKNOWN_DAY) {
+    return;
+  }
+
+  unsigned int pos = find_day_position(idx, s->day);
+  if(has_day(idx, pos, s->day)) {
+    DayScores * day = &idx->days[pos];
+    day->n_scores++;
+    if(s->points > day->best->points) {
+      day->best = s;
+    }
+    return;
+  }
+
+  memmove(&idx->days[pos + 1], &idx->days[pos], (idx->n_days - pos) * sizeof *(idx->days));
+  idx->days[pos].day = s->day;
+  idx->days[pos].best = s;
+  idx->days[pos].n_scores = 1;
+  idx->n_days++;
+}
+
+Score * const * scoreindex_get_top_on_level(ScoreIndex * idx, unsigned int level, score_mode_enum mode, unsigned int k, unsigned int * n) {
+  if(level > SCOREINDEX_MAX_LEVEL || mode >= SCORE_N_MODES) {
+    *n = 0;
+    return NULL;
+  }
+
+  ScoreList * list = &idx->levels[level][mode];
+  *n = MIN_VAL(k, list->n_scores);
+  return list->scores;
+}
+
+Score * scoreindex_get_personal_best(ScoreIndex * idx, const char * name) {
+  PlayerScores * player = find_player(idx->players, idx->players_capacity, name, hash_name(name));
+  if(player == NULL || player->list.n_scores == 0) {
+    return NULL;
+  }
+
+  return player->list.scores[0];
+}
+
+Score * scoreindex_get_best_between(ScoreIndex * idx, unsigned long first_day, unsigned long last_day) {
+  Score * best = NULL;
+
+  unsigned int i;
+  for(i = find_day_position(idx, first_day); i < idx->n_days && idx->days[i].day <= last_day; i++) {
+    if(best == NULL || idx->days[i].best->points > best->points) {
+      best = idx->days[i].best;
+    }
+  }
+
+  return best;
+}
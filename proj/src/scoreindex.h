@@ -0,0 +1,138 @@
+#ifndef __SCOREINDEX_H
+#define __SCOREINDEX_H
+
+#include <stdbool.h>
+#include "score.h"
+
+/** @defgroup scoreindex scoreindex
+ * @{
+ *
+ * Sorted score lists and the indexes over the scores of a ScoreManager: by level and mode, by player name and by finish date
+ */
+
+/*
+ * A ScoreList keeps scores sorted from the highest down: each one is inserted in its place, found with a binary search (after the ones with
+ * as many points, so that ties stay in the order they were added), and one that goes last is just appended. So its best k scores are always its first k.
+ * The index keeps, for the same Score objects (owned by the ScoreManager):
+ *  - A ScoreList per level (up to SCOREINDEX_MAX_LEVEL, SCORE_UNKNOWN_LEVEL included) and mode, for the top scores of a level
+ *  - A ScoreList per player name, in a hash table (open addressing, FNV-1a hashes), for the best scores of a player
+ *  - The best score of each day with scores, in an array sorted by day, for the best score between two dates
+ *    (a binary search for the first day and then one step per day with scores, at most 7 for a week)
+ * Adding a score to the index is done in two steps: scoreindex_reserve allocates everything the score needs, and only if it succeeds
+ * scoreindex_add adds it (which can not fail then), so that a score is either in every list or in none.
+ */
+
+#define SCOREINDEX_MAX_LEVEL          8 /* Scores of levels after it are not indexed by level */
+#define SCORELIST_MIN_CAPACITY        16
+#define SCOREINDEX_MIN_PLAYERS        64 /* Slots in the player table, always a power of 2 */
+#define SCOREINDEX_PLAYERS_LOAD       70 /* Percentage of the player table in use after which it doubles */
+
+typedef struct {
+  //Sorted from the highest score down
+  Score ** scores;
+  unsigned int n_scores;
+  unsigned int capacity;
+} ScoreList;
+
+typedef struct {
+  unsigned long hash;
+  //Empty slot if it has no scores
+  ScoreList list;
+} PlayerScores;
+
+typedef struct {
+  unsigned long day;
+  Score * best;
+  unsigned int n_scores;
+} DayScores;
+
+typedef struct {
+  ScoreList levels[SCOREINDEX_MAX_LEVEL + 1][SCORE_N_MODES];
+  PlayerScores * players;
+  unsigned int players_capacity;
+  unsigned int n_players;
+  //Sorted by day
+  DayScores * days;
+  unsigned int n_days;
+  unsigned int days_capacity;
+} ScoreIndex;
+
+/**
+ * @brief Makes room in a list for at least the passed number of scores
+ * @param  list     ScoreList to grow
+ * @param  n_scores Scores it must have room for
+ * @return          true if successful, false otherwise (the list is left as it was)
+ */
+bool scorelist_reserve(ScoreList * list, unsigned int n_scores);
+
+/**
+ * @brief Inserts a score in a list with room for it (see scorelist_reserve), keeping it sorted
+ * @param list ScoreList to insert in
+ * @param s    Score to insert
+ */
+void scorelist_insert(ScoreList * list, Score * s);
+
+/**
+ * @brief Frees the memory of a list (not the scores in it)
+ * @param list ScoreList to free
+ */
+void scorelist_free(ScoreList * list);
+
+/**
+ * @brief Clears an index, to be used before adding anything to it
+ * @param idx ScoreIndex to clear
+ */
+void scoreindex_init(ScoreIndex * idx);
+
+/**
+ * @brief Frees the memory of an index (not the scores in it)
+ * @param idx ScoreIndex to free
+ */
+void scoreindex_free(ScoreIndex * idx);
+
+/**
+ * @brief Allocates everything needed to add a score to the index
+ * @param  idx ScoreIndex the score is going to be added to
+ * @param  s   Score to add
+ * @return     true if successful (scoreindex_add can then be called), false otherwise
+ */
+bool scoreindex_reserve(ScoreIndex * idx, Score * s);
+
+/**
+ * @brief Adds a score to the index, after scoreindex_reserve succeeded for it
+ * @param idx ScoreIndex to add to
+ * @param s   Score to add
+ */
+void scoreindex_add(ScoreIndex * idx, Score * s);
+
+/**
+ * @brief Gets the best scores of a level, without copying them
+ * @param  idx   ScoreIndex to look in
+ * @param  level Level of the scores
+ * @param  mode  Mode of the scores
+ * @param  k     Most scores to get
+ * @param  n     Where to return how many scores were got (k, or all of them if there are fewer)
+ * @return       The best scores, from the highest down (only valid until a score is added)
+ */
+Score * const * scoreindex_get_top_on_level(ScoreIndex * idx, unsigned int level, score_mode_enum mode, unsigned int k, unsigned int * n);
+
+/**
+ * @brief Gets the best score of a player
+ * @param  idx  ScoreIndex to look in
+ * @param  name Name of the player
+ * @return      The best score of the player, NULL if there is none
+ */
+Score * scoreindex_get_personal_best(ScoreIndex * idx, const char * name);
+
+/**
+ * @brief Gets the best score finished between two days (see score_date_to_day)
+ * @param  idx       ScoreIndex to look in
+ * @param  first_day First day, included
+ * @param  last_day  Last day, included
+ * @return           The best score, NULL if there is none
+ */
+Score * scoreindex_get_best_between(ScoreIndex * idx, unsigned long first_day, unsigned long last_day);
+
+/** @} */
+
+#endif /* __SCOREINDEX_H */
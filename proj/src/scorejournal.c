@@ -0,0 +1,490 @@
+#include "scorejournal.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#define SNAPSHOT_MAGIC 0x53585842 /* "RBXS" */
+#define JOURNAL_MAGIC  0x4A585842 /* "RBXJ" */
+
+//Results of read_file
+#define READ_OK       0
+#define READ_MISSING  -1
+#define READ_FAILED   -2
+
+//Bitwise CRC-32 (reflected polynomial 0xEDB88320, the one used by zip), scores are few enough to not need a table
+static unsigned long crc32(const unsigned char * data, unsigned int len) {
+  unsigned long crc = 0xFFFFFFFF;
+
+  unsigned int i;
+  for(i = 0; i < len; i++) {
+    crc ^= data[i];
+    int bit;
+    for(bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+  }
+
+  return (crc ^ 0xFFFFFFFF) & 0xFFFFFFFF;
+}
+
+static void put_u32(unsigned char * out, unsigned long value) {
+  out[0] = value & 0xFF;
+  out[1] = (value >> 8) & 0xFF;
+  out[2] = (value >> 16) & 0xFF;
+  out[3] = (value >> 24) & 0xFF;
+}
+
+static unsigned long get_u32(const unsigned char * in) {
+  return (unsigned long) in[0] | ((unsigned long) in[1] << 8) | ((unsigned long) in[2] << 16) | ((unsigned long) in[3] << 24);
+}
+
+//Size of the records of a version of the files (0 if it is not one that can be read)
+static unsigned int record_size(unsigned long version) {
+  switch(version) {
+    case 1:
+      return SCOREJOURNAL_V1_RECORD_SIZE;
+    case SCOREJOURNAL_VERSION:
+      return SCOREJOURNAL_RECORD_SIZE;
+    default:
+      return 0;
+  }
+}
+
+static void encode_record(const ScoreRecord * r, unsigned char * out) {
+  put_u32(out, r->points);
+  out[4] = r->level;
+  out[5] = r->mode;
+  out[6] = 0;
+  out[7] = 0;
+  memcpy(out + 8, r->name, SCOREJOURNAL_NAME_LENGTH);
+  memcpy(out + 8 + SCOREJOURNAL_NAME_LENGTH, r->finish_date, SCOREJOURNAL_DATE_LENGTH);
+  put_u32(out + SCOREJOURNAL_RECORD_SIZE - 4, crc32(out, SCOREJOURNAL_RECORD_SIZE - 4));
+}
+
+//Returns false if the record is damaged
+static bool decode_record(const unsigned char * in, unsigned long version, ScoreRecord * r) {
+  unsigned int size = record_size(version);
+  if(crc32(in, size - 4) != get_u32(in + size - 4)) {
+    return false;
+  }
+
+  r->points = get_u32(in);
+  unsigned int strings = 4;
+  if(version == 1) {
+    r->level = SCORE_UNKNOWN_LEVEL;
+    r->mode = SCORE_MODE_SP;
+  } else {
+    r->level = in[4];
+    r->mode = in[5] < SCORE_N_MODES ? in[5] : SCORE_MODE_SP;
+    strings = 8;
+  }
+  memcpy(r->name, in + strings, SCOREJOURNAL_NAME_LENGTH);
+  memcpy(r->finish_date, in + strings + SCOREJOURNAL_NAME_LENGTH, SCOREJOURNAL_DATE_LENGTH);
+  //Even if the file was not written by us
+  r->name[SCOREJOURNAL_NAME_LENGTH - 1] = '\0';
+  r->finish_date[SCOREJOURNAL_DATE_LENGTH - 1] = '\0';
+  return true;
+}
+
+//Reads a whole file into a new buffer with a single read, returning READ_OK, READ_MISSING if it does not exist or READ_FAILED if it exists but could not be read
+static int read_file(const char * path, unsigned char ** data, unsigned long * size) {
+  *data = NULL;
+  FILE * fp = fopen(path, "rb");
+  if(fp == NULL) {
+    return errno == ENOENT ? READ_MISSING : READ_FAILED;
+  }
+
+  if(fseek(fp, 0, SEEK_END) != 0) {
+    fclose(fp);
+    return READ_FAILED;
+  }
+  long length = ftell(fp);
+  if(length < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+    fclose(fp);
+    return READ_FAILED;
+  }
+
+  //At least one byte, so that an empty file is not mistaken for a failed allocation
+  *data = malloc(length + 1);
+  if(*data == NULL) {
+    fclose(fp);
+    return READ_FAILED;
+  }
+
+  if(fread(*data, 1, length, fp) != (size_t) length) {
+    free(*data);
+    *data = NULL;
+    fclose(fp);
+    return READ_FAILED;
+  }
+
+  fclose(fp);
+  *size = length;
+  return READ_OK;
+}
+
+//Writes a whole file under a temporary name and then renames it over the path, so that the path always holds either the old or the new file
+static int replace_file(const char * path, const unsigned char * data, unsigned long size) {
+  char * temp_path = malloc(strlen(path) + 5);
+  if(temp_path == NULL) {
+    return -1;
+  }
+  sprintf(temp_path, "%s.tmp", path);
+
+  FILE * fp = fopen(temp_path, "wb");
+  if(fp == NULL) {
+    printf("scorejournal::Could not open %s\n", temp_path);
+    free(temp_path);
+    return -2;
+  }
+
+  bool written = fwrite(data, 1, size, fp) == size;
+  //fclose also flushes, so it must succeed as well
+  if(fclose(fp) != 0 || !written) {
+    printf("scorejournal::Could not write %s\n", temp_path);
+    remove(temp_path);
+    free(temp_path);
+    return -3;
+  }
+
+  if(rename(temp_path, path) != 0) {
+    printf("scorejournal::Could not rename %s to %s\n", temp_path, path);
+    remove(temp_path);
+    free(temp_path);
+    return -4;
+  }
+
+  free(temp_path);
+  return 0;
+}
+
+ScoreJournal * create_scorejournal(const char * snapshot_path, const char * journal_path) {
+  ScoreJournal * sj = calloc(1, sizeof *sj);
+  if(sj == NULL) {
+    return NULL;
+  }
+
+  sj->snapshot_path = strdup(snapshot_path);
+  sj->journal_path = strdup(journal_path);
+  if(sj->snapshot_path == NULL || sj->journal_path == NULL) {
+    free(sj->snapshot_path);
+    free(sj->journal_path);
+    free(sj);
+    return NULL;
+  }
+
+  return sj;
+}
+
+void destroy_scorejournal(ScoreJournal ** sj_ptr) {
+  if(*sj_ptr == NULL) {
+    return;
+  }
+
+  free((*sj_ptr)->snapshot_path);
+  free((*sj_ptr)->journal_path);
+  free(*sj_ptr);
+  *sj_ptr = NULL;
+}
+
+void scorejournal_make_record(ScoreRecord * r, unsigned long points, const char * name, const char * finish_date, unsigned int level, score_mode_enum mode) {
+  //Zeroed so that the bytes after the strings are always the same (they are part of the CRC)
+  memset(r, 0, sizeof *r);
+  r->points = points;
+  r->level = level;
+  r->mode = mode;
+  strncpy(r->name, name, SCOREJOURNAL_NAME_LENGTH - 1);
+  strncpy(r->finish_date, finish_date, SCOREJOURNAL_DATE_LENGTH - 1);
+}
+
+//Moves a damaged snapshot out of the way (to be looked at, it is never read again), so that compacting does not write over it
+static void set_snapshot_aside(ScoreJournal * sj) {
+  char * bad_path = malloc(strlen(sj->snapshot_path) + 5);
+  if(bad_path != NULL) {
+    sprintf(bad_path, "%s.bad", sj->snapshot_path);
+    if(rename(sj->snapshot_path, bad_path) == 0) {
+      printf("scorejournal::%s moved to %s\n", sj->snapshot_path, bad_path);
+      sj->snapshot = SCOREJOURNAL_SNAPSHOT_DAMAGED;
+      free(bad_path);
+      return;
+    }
+    free(bad_path);
+  }
+
+  printf("scorejournal::Could not move %s aside, it will not be written over\n", sj->snapshot_path);
+  sj->snapshot = SCOREJOURNAL_SNAPSHOT_UNREADABLE;
+}
+
+//Reads the snapshot into records (that must have space for every record in it), returning how many were read, or -1 if it could not be (sj->snapshot tells why)
+static int load_snapshot(ScoreJournal * sj, ScoreRecord ** records) {
+  unsigned long size = 0;
+  unsigned char * data;
+  int read_result = read_file(sj->snapshot_path, &data, &size);
+  if(read_result != READ_OK) {
+    if(read_result == READ_MISSING) {
+      sj->snapshot = SCOREJOURNAL_SNAPSHOT_MISSING;
+    } else {
+      printf("scorejournal::Could not read %s\n", sj->snapshot_path);
+      sj->snapshot = SCOREJOURNAL_SNAPSHOT_UNREADABLE;
+    }
+    return -1;
+  }
+
+  if(size < SCOREJOURNAL_SNAPSHOT_HEADER_SIZE || get_u32(data) != SNAPSHOT_MAGIC || record_size(get_u32(data + 4)) == 0 || crc32(data, 16) != get_u32(data + 16)) {
+    printf("scorejournal::%s is not a valid snapshot\n", sj->snapshot_path);
+    free(data);
+    set_snapshot_aside(sj);
+    return -1;
+  }
+
+  unsigned long version = get_u32(data + 4);
+  unsigned int rec_size = record_size(version);
+  if(version != SCOREJOURNAL_VERSION) {
+    //Rewritten in the current version
+    sj->needs_compaction = true;
+  }
+
+  unsigned long count = get_u32(data + 12);
+  if(size != SCOREJOURNAL_SNAPSHOT_HEADER_SIZE + count * rec_size) {
+    printf("scorejournal::%s has the wrong size for its %lu records\n", sj->snapshot_path, count);
+    free(data);
+    set_snapshot_aside(sj);
+    return -1;
+  }
+
+  *records = malloc((count + 1) * sizeof **records);
+  if(*records == NULL) {
+    //Nothing wrong with the file itself
+    printf("scorejournal::Could not allocate the records of %s\n", sj->snapshot_path);
+    sj->snapshot = SCOREJOURNAL_SNAPSHOT_UNREADABLE;
+    free(data);
+    return -1;
+  }
+
+  //Damaged records are left out (the snapshot is only ever replaced whole, so it would have been damaged afterwards)
+  int n = 0;
+  unsigned long i;
+  for(i = 0; i < count; i++) {
+    if(decode_record(data + SCOREJOURNAL_SNAPSHOT_HEADER_SIZE + i * rec_size, version, &(*records)[n])) {
+      n++;
+    } else {
+      sj->needs_compaction = true;
+    }
+  }
+  if(n != (int) count) {
+    printf("scorejournal::%lu damaged records in %s left out\n", count - n, sj->snapshot_path);
+  }
+
+  sj->generation = get_u32(data + 8);
+  sj->snapshot = SCOREJOURNAL_SNAPSHOT_FOUND;
+  free(data);
+  return n;
+}
+
+//Appends the valid records of the journal to records (that has space for n_records), returning the new number of records
+//With no snapshot to check its generation against (it was damaged), the journal is read whatever its generation, and the generation is taken from it
+static unsigned int load_journal(ScoreJournal * sj, ScoreRecord ** records, unsigned int n_records) {
+  sj->n_journaled = 0;
+
+  unsigned long size = 0;
+  unsigned char * data;
+  int read_result = read_file(sj->journal_path, &data, &size);
+  if(read_result == READ_FAILED) {
+    //Its records might be fine, compacting would lose them
+    printf("scorejournal::Could not read %s, it will not be written over\n", sj->journal_path);
+    sj->read_only = true;
+    return n_records;
+  }
+  if(read_result == READ_MISSING) {
+    //Never started (or lost), only usable after compacting
+    sj->needs_compaction = true;
+    return n_records;
+  }
+
+  if(size < SCOREJOURNAL_JOURNAL_HEADER_SIZE || get_u32(data) != JOURNAL_MAGIC || record_size(get_u32(data + 4)) == 0 || crc32(data, 12) != get_u32(data + 12)) {
+    printf("scorejournal::%s is not a valid journal\n", sj->journal_path);
+    sj->needs_compaction = true;
+    free(data);
+    return n_records;
+  }
+
+  if(sj->snapshot == SCOREJOURNAL_SNAPSHOT_DAMAGED) {
+    //Whatever was compacted out of it is lost with the snapshot, so none of its records can be there twice
+    sj->generation = get_u32(data + 8);
+    sj->needs_compaction = true;
+  } else if(get_u32(data + 8) != sj->generation) {
+    //Its records were already compacted into the snapshot
+    sj->needs_compaction = true;
+    free(data);
+    return n_records;
+  }
+
+  //Records of an older version are read, but the ones appended next would not be of the same size
+  unsigned long version = get_u32(data + 4);
+  unsigned int rec_size = record_size(version);
+  if(version != SCOREJOURNAL_VERSION) {
+    sj->needs_compaction = true;
+  }
+
+  unsigned long count = (size - SCOREJOURNAL_JOURNAL_HEADER_SIZE) / rec_size;
+  ScoreRecord * temp = realloc(*records, (n_records + count + 1) * sizeof **records);
+  if(temp == NULL) {
+    sj->needs_compaction = true;
+    free(data);
+    return n_records;
+  }
+  *records = temp;
+
+  unsigned long i;
+  for(i = 0; i < count; i++) {
+    if(!decode_record(data + SCOREJOURNAL_JOURNAL_HEADER_SIZE + i * rec_size, version, &(*records)[n_records])) {
+      break;
+    }
+    n_records++;
+    sj->n_journaled++;
+  }
+
+  //A record cut short or damaged, the journal must be compacted before anything else is appended after it
+  if(i != count || size != SCOREJOURNAL_JOURNAL_HEADER_SIZE + count * rec_size) {
+    printf("scorejournal::%s ends in a damaged record, %u records before it kept\n", sj->journal_path, sj->n_journaled);
+    sj->needs_compaction = true;
+  }
+
+  free(data);
+  return n_records;
+}
+
+ScoreRecord * scorejournal_load(ScoreJournal * sj, unsigned int * n_records) {
+  *n_records = 0;
+  if(sj == NULL) {
+    return NULL;
+  }
+
+  sj->needs_compaction = false;
+  sj->read_only = false;
+  sj->n_journaled = 0;
+
+  ScoreRecord * records = NULL;
+  int n_snapshot = load_snapshot(sj, &records);
+  if(sj->snapshot == SCOREJOURNAL_SNAPSHOT_UNREADABLE) {
+    //It might still hold every score, so neither file is written to
+    sj->read_only = true;
+    return NULL;
+  }
+  if(sj->snapshot == SCOREJOURNAL_SNAPSHOT_MISSING) {
+    //Without a snapshot there is no generation to trust a journal with
+    sj->generation = 0;
+    sj->needs_compaction = true;
+    return NULL;
+  }
+  if(sj->snapshot == SCOREJOURNAL_SNAPSHOT_DAMAGED) {
+    //The journal is all that is left, and the snapshot it was appended after is set aside
+    sj->generation = 0;
+    n_snapshot = 0;
+  }
+
+  *n_records = load_journal(sj, &records, n_snapshot);
+  if(*n_records == 0) {
+    free(records);
+    return NULL;
+  }
+
+  return records;
+}
+
+int scorejournal_append(ScoreJournal * sj, const ScoreRecord * r) {
+  if(sj == NULL || r == NULL) {
+    return -1;
+  }
+
+  //The journal is not one that would be read back, or the files must not be written to
+  if(sj->needs_compaction || sj->read_only) {
+    return -2;
+  }
+
+  unsigned char data[SCOREJOURNAL_RECORD_SIZE];
+  encode_record(r, data);
+
+  FILE * fp = fopen(sj->journal_path, "ab");
+  if(fp == NULL) {
+    printf("scorejournal_append::Could not open %s\n", sj->journal_path);
+    return -3;
+  }
+
+  bool written = fwrite(data, 1, SCOREJOURNAL_RECORD_SIZE, fp) == SCOREJOURNAL_RECORD_SIZE;
+  if(fclose(fp) != 0 || !written) {
+    printf("scorejournal_append::Could not write to %s\n", sj->journal_path);
+    //Part of the record might be there already, nothing else can be appended after it
+    sj->needs_compaction = true;
+    return -4;
+  }
+
+  sj->n_journaled++;
+  return 0;
+}
+
+bool scorejournal_should_compact(ScoreJournal * sj) {
+  if(sj == NULL) {
+    return false;
+  }
+
+  return sj->needs_compaction || sj->n_journaled >= SCOREJOURNAL_COMPACT_THRESHOLD;
+}
+
+int scorejournal_compact(ScoreJournal * sj, const ScoreRecord * records, unsigned int n_records) {
+  if(sj == NULL || (records == NULL && n_records > 0)) {
+    return -1;
+  }
+
+  //Scores in the files might not be in records
+  if(sj->read_only) {
+    return -5;
+  }
+
+  unsigned long generation = (sj->generation + 1) & 0xFFFFFFFF;
+
+  unsigned long size = SCOREJOURNAL_SNAPSHOT_HEADER_SIZE + (unsigned long) n_records * SCOREJOURNAL_RECORD_SIZE;
+  unsigned char * data = malloc(size);
+  if(data == NULL) {
+    printf("scorejournal_compact::Could not allocate the snapshot\n");
+    return -2;
+  }
+
+  put_u32(data, SNAPSHOT_MAGIC);
+  put_u32(data + 4, SCOREJOURNAL_VERSION);
+  put_u32(data + 8, generation);
+  put_u32(data + 12, n_records);
+  put_u32(data + 16, crc32(data, 16));
+  unsigned int i;
+  for(i = 0; i < n_records; i++) {
+    encode_record(&records[i], data + SCOREJOURNAL_SNAPSHOT_HEADER_SIZE + (unsigned long) i * SCOREJOURNAL_RECORD_SIZE);
+  }
+
+  int result = replace_file(sj->snapshot_path, data, size);
+  free(data);
+  if(result != 0) {
+    //The old snapshot and journal are untouched
+    return -3;
+  }
+
+  //From here on the old journal is stale, whether or not the new one can be started
+  sj->generation = generation;
+  sj->snapshot = SCOREJOURNAL_SNAPSHOT_FOUND;
+  sj->n_journaled = 0;
+  sj->needs_compaction = true;
+
+  unsigned char header[SCOREJOURNAL_JOURNAL_HEADER_SIZE];
+  put_u32(header, JOURNAL_MAGIC);
+  put_u32(header + 4, SCOREJOURNAL_VERSION);
+  put_u32(header + 8, generation);
+  put_u32(header + 12, crc32(header, 12));
+  if(replace_file(sj->journal_path, header, sizeof header) != 0) {
+    return -4;
+  }
+
+  sj->needs_compaction = false;
+  sj->compactions++;
+  return 0;
+}
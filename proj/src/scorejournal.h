@@ -0,0 +1,135 @@
+#ifndef __SCOREJOURNAL_H
+#define __SCOREJOURNAL_H
+
+#include <stdbool.h>
+#include "score.h"
+
+/** @defgroup scorejournal scorejournal
+ * @{
+ *
+ * Binary storage of the scores: a snapshot of every score plus an append-only journal of the ones submitted since, compacted into a new snapshot once it grows
+ */
+
+/*
+ * File layouts (every number is 4 bytes, little endian, and every CRC is a CRC-32 of the bytes before it in the same header or record):
+ *
+ *   Snapshot: | "RBXS" | VERSION | GENERATION | COUNT | CRC | RECORD * COUNT
+ *   Journal:  | "RBXJ" | VERSION | GENERATION | CRC | RECORD * n
+ *   Record:   | POINTS | LEVEL (1 byte) | MODE (1 byte) | 0 (2 bytes) | NAME (16 bytes) | FINISH DATE (16 bytes) | CRC |
+ *
+ * Version 1 records had no level and mode (nor the 2 bytes after them), they are still read (as SCORE_UNKNOWN_LEVEL and SCORE_MODE_SP),
+ * but files of that version are compacted right away, so that only records of the current version are appended.
+ *
+ * Submitting a score appends a single record to the journal, and loading reads each file with a single read.
+ * Compacting writes every score to a new snapshot with the next generation, which replaces the old one only once it is
+ * completely written (rename), and then starts an empty journal of that generation in the same way.
+ * A journal is only read if its generation is the snapshot's, so one whose records were already compacted (the game stopped
+ * in between the two renames) is not read twice, and a record cut short or damaged (the game stopped while appending it) ends the journal:
+ * the records before it are kept and the next compaction leaves it out.
+ * A snapshot that is damaged (its header or size is wrong) is renamed to its path with ".bad" added, and the journal is read
+ * whatever its generation (the records it has are all that is left), to be compacted into a new snapshot.
+ * A file that exists but can not be read (or whose records do not fit in memory) is not written over: nothing is appended or compacted
+ * until the files are loaded again, so the scores submitted meanwhile are only kept in memory.
+ */
+
+#define SCOREJOURNAL_VERSION              2
+#define SCOREJOURNAL_NAME_LENGTH          16 /* Bytes of the name and finish date in a record, with the null terminator */
+#define SCOREJOURNAL_DATE_LENGTH          16
+#define SCOREJOURNAL_RECORD_SIZE          (4 + 4 + SCOREJOURNAL_NAME_LENGTH + SCOREJOURNAL_DATE_LENGTH + 4)
+#define SCOREJOURNAL_V1_RECORD_SIZE       (4 + SCOREJOURNAL_NAME_LENGTH + SCOREJOURNAL_DATE_LENGTH + 4)
+#define SCOREJOURNAL_SNAPSHOT_HEADER_SIZE 20
+#define SCOREJOURNAL_JOURNAL_HEADER_SIZE  16
+#define SCOREJOURNAL_COMPACT_THRESHOLD    64 /* Records in the journal after which it is compacted */
+
+typedef enum {
+  SCOREJOURNAL_SNAPSHOT_FOUND = 0,
+  SCOREJOURNAL_SNAPSHOT_MISSING,
+  SCOREJOURNAL_SNAPSHOT_DAMAGED,
+  SCOREJOURNAL_SNAPSHOT_UNREADABLE
+} scorejournal_snapshot_enum;
+
+typedef struct {
+  unsigned long points;
+  unsigned char level;
+  unsigned char mode;
+  char name[SCOREJOURNAL_NAME_LENGTH];
+  char finish_date[SCOREJOURNAL_DATE_LENGTH];
+} ScoreRecord;
+
+typedef struct {
+  char * snapshot_path;
+  char * journal_path;
+  //Generation of the snapshot and of the journal records are appended to
+  unsigned long generation;
+  //Records in the journal
+  unsigned int n_journaled;
+  //Set when loading found no snapshot, or a journal that is missing, stale or damaged (compacting fixes it)
+  bool needs_compaction;
+  //Set when a file exists but could not be read, so that it is not written over
+  bool read_only;
+  //What loading found of the snapshot
+  scorejournal_snapshot_enum snapshot;
+  unsigned long compactions;
+} ScoreJournal;
+
+/**
+ * @brief Creates a ScoreJournal, without reading anything yet
+ * @param  snapshot_path Path of the snapshot
+ * @param  journal_path  Path of the journal
+ * @return               Pointer to a valid ScoreJournal or NULL in case of failure
+ */
+ScoreJournal * create_scorejournal(const char * snapshot_path, const char * journal_path);
+
+/**
+ * @brief Destroys the passed ScoreJournal (the files are left as they are), setting the passed pointer to NULL
+ * @param sj_ptr ScoreJournal to destroy
+ */
+void destroy_scorejournal(ScoreJournal ** sj_ptr);
+
+/**
+ * @brief Fills a record with a score, truncating the name and finish date if too long
+ * @param r           Record to fill
+ * @param points      Points of the score
+ * @param name        Name of the score owner
+ * @param finish_date Finish date of the score
+ * @param level       Level the score was got in (up to 255)
+ * @param mode        Mode the level was played in
+ */
+void scorejournal_make_record(ScoreRecord * r, unsigned long points, const char * name, const char * finish_date, unsigned int level, score_mode_enum mode);
+
+/**
+ * @brief Reads the records of the snapshot and of the journal
+ * @param  sj        ScoreJournal to read
+ * @param  n_records Where to return the number of records read
+ * @return           Array with the records read (to be freed by the caller), NULL if there were none or in case of failure
+ */
+ScoreRecord * scorejournal_load(ScoreJournal * sj, unsigned int * n_records);
+
+/**
+ * @brief Appends a record to the journal
+ * @param  sj ScoreJournal to append to
+ * @param  r  Record to append
+ * @return    0 if successful, not 0 otherwise
+ */
+int scorejournal_append(ScoreJournal * sj, const ScoreRecord * r);
+
+/**
+ * @brief Checks if the journal should be compacted (it passed SCOREJOURNAL_COMPACT_THRESHOLD or was found in need of it when loading)
+ * @param  sj ScoreJournal to check
+ * @return    true if it should, false otherwise
+ */
+bool scorejournal_should_compact(ScoreJournal * sj);
+
+/**
+ * @brief Writes every record to a new snapshot and starts an empty journal
+ * @param  sj        ScoreJournal to compact
+ * @param  records   Every record there is (the ones loaded plus the ones appended since)
+ * @param  n_records Number of records
+ * @return           0 if successful, not 0 otherwise. If the new snapshot could not be written the previous snapshot and journal are still valid,
+ *                   and if it was but the new journal could not be started (-4) the new snapshot holds every record and the old journal is stale (it is not read)
+ */
+int scorejournal_compact(ScoreJournal * sj, const ScoreRecord * records, unsigned int n_records);
+
+/** @} */
+
+#endif /* __SCOREJOURNAL_H */
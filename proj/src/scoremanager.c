@@ -1,59 +1,51 @@
 #include "scoremanager.h"
 #include "score.h"
+#include <minix/syslib.h>
+#include <minix/sysutil.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include "utilities.h"
 #include "font.h"
+#include "video_gr.h"
+#include "gameclock.h"
 
 
-static void sort_scores(ScoreManager * sm){
-
-  if(sm == NULL || sm->n_scores <= 0) {
-    return;
+//Adds a score to the sorted list of every score and to the index, returning false if they could not be grown (the score is then not added)
+static bool add_scoreobj_to_scoremanager(ScoreManager * sm, Score * s) {
+  if(sm == NULL || s == NULL) {
+    return false;
   }
 
-  int i ;
-  int j;
+  if(!scorelist_reserve(&sm->all, sm->all.n_scores + 1) || !scoreindex_reserve(&sm->index, s)) {
+    return false;
+  }
 
-  for(i = sm->n_scores - 1; i > 0; i--) {
-    bool swapped = false;
+  scorelist_insert(&sm->all, s);
+  scoreindex_add(&sm->index, s);
 
-    for (j = 0; j < i; j++) {
-      if(sm->scores[j+1]->points > sm->scores[j]->points) {
-        SWAP(Score *, sm->scores[j], sm->scores[j+1]);
-        swapped = true;
-      }
-    }
-    if (!swapped) return;
+  //The highscores shown might have changed
+  if(sm->highscores_panel != NULL) {
+    deleteBitmap(sm->highscores_panel);
+    sm->highscores_panel = NULL;
   }
+  return true;
 }
 
-///Constructs a ScoreManager based on file contents
-//Errors are returned through the int passed by reference, 0 is no errors ocurred, != 0 is otherwise
-//If the errorlevel is non-zero then the returned value is NULL and nothing extra needs to be deallocated, guaranteed
-static ScoreManager * load_scores_from_file(int * errorlevel) {
-  ScoreManager * sm = malloc(sizeof *sm);
-  if(sm == NULL) {
-    *errorlevel = -1;
-    return NULL;
-  }
-
-  sm->n_scores = 0;
-  sm->scores = NULL;
-
+///Adds the scores in the text file older versions of the game kept them in (one per line, see create_score_from_string)
+//Returns 0 if no errors ocurred (a missing file is not one, there are just no scores to import), != 0 otherwise
+static int import_legacy_scores(ScoreManager * sm) {
   FILE *file_ptr = fopen(SCORES_TXT_LOCATION, "r");
 
   if(file_ptr == NULL) {
-    //Could not open file, return 0 (no scores exist yet) and NULL
-    //The errors when opening file is basically only if the file does not exist yet, so we consider there to be no scores yet
-    //We are not using multithreading so no necessity to worry about data races, so this assumption can be considered
-    *errorlevel = 0;
-    return sm;
+    //The errors when opening file is basically only if the file does not exist, so we consider there to be no scores to import
+    return 0;
   }
 
   char line[LINE_MAX_LENGTH];
+  unsigned int n_imported = 0;
 
   while(fgets(line, LINE_MAX_LENGTH, file_ptr)) {
     //Removing the trailing newline (fgets also copies the newline) by inserting a NULL terminator as the last character
@@ -61,140 +53,158 @@ static ScoreManager * load_scores_from_file(int * errorlevel) {
     Score * s_ptr = create_score_from_string(line);
 
     if(s_ptr == NULL) {
-      printf("DBG: s_ptr was NULL\n");
-      //Score could not be created correctly
-      destroy_scoremanager(&sm);
-      //Also close file
-      fclose(file_ptr);
-      *errorlevel = -2;
-      return sm;
+      printf("import_legacy_scores::Invalid line, ignored: %s\n", line);
+      continue;
     }
 
-    //No need to free allocated line since it was stack allocated
-
-    //Score allocated correctly, count up scores and allocate space for one more element (and add the score to the array)
-    Score ** score_arr_temp = realloc(sm->scores, (sm->n_scores + 1) * sizeof *(sm->scores));
-    if(score_arr_temp == NULL) {
-      //More scores could not be allocated correctly
-      printf("Error creating score manager, score array could not be reallocated\n");
-      //Destroy scores allocated until now and return -1 and NULL
+    if(!add_scoreobj_to_scoremanager(sm, s_ptr)) {
+      printf("import_legacy_scores::Score array could not be reallocated\n");
       destroy_score(&s_ptr);
-      destroy_scoremanager(&sm);
-      //Also close file
       fclose(file_ptr);
-
-      *errorlevel = -3;
-      return sm;
-    } else {
-      //Score array reallocated correctly
-      sm->scores = score_arr_temp;
-      sm->n_scores++;
-      //Adding created score at the end of the score array
-      sm->scores[sm->n_scores - 1] = s_ptr;
+      return -1;
     }
+    n_imported++;
   }
 
-  //Closing file and returning with an error level of 0
   fclose(file_ptr);
-  *errorlevel = 0;
-  return sm;
+  printf("import_legacy_scores::%u scores imported from %s\n", n_imported, SCORES_TXT_LOCATION);
+  return 0;
 }
 
-ScoreManager* create_scoremanager() {
-  ScoreManager * sm_ptr = NULL;
-  int errorlevel = 0;
-  sm_ptr = load_scores_from_file(&errorlevel);
-  //If errorlevel is != 0, sm_ptr is guaranteed to return NULL as well so no further deallocations are required
-  if(errorlevel != 0) {
-    return NULL;
+///Creates the Score objects of the records loaded, allocating the score array once for all of them
+//Returns 0 if no errors ocurred, != 0 otherwise (the scores created until then are kept)
+static int add_records_to_scoremanager(ScoreManager * sm, const ScoreRecord * records, unsigned int n_records) {
+  if(!scorelist_reserve(&sm->all, sm->all.n_scores + n_records)) {
+    return -1;
   }
 
-  sort_scores(sm_ptr);
+  unsigned int i;
+  for(i = 0; i < n_records; i++) {
+    Score * s_ptr = create_score(records[i].points, records[i].name, records[i].finish_date, records[i].level, records[i].mode);
+    if(!add_scoreobj_to_scoremanager(sm, s_ptr)) {
+      if(s_ptr != NULL) {
+        destroy_score(&s_ptr);
+      }
+      return -2;
+    }
+  }
 
-  //Everything went as expected
-  return sm_ptr;
+  return 0;
 }
 
-void destroy_scoremanager(ScoreManager ** sm_ptr) {
-  if(*sm_ptr == NULL) {
-    return;
+///Writes every score to a new snapshot, emptying the journal
+static int compact_scores(ScoreManager * sm) {
+  //At least one, so that no scores is not mistaken for a failed allocation
+  ScoreRecord * records = malloc((sm->all.n_scores + 1) * sizeof *records);
+  if(records == NULL) {
+    return -1;
   }
 
-  //Destroying scores
-  int i;
-  for(i = 0; i < (*sm_ptr)->n_scores; i++) {
-    destroy_score(&((*sm_ptr)->scores[i]));
+  unsigned int i;
+  for(i = 0; i < sm->all.n_scores; i++) {
+    Score * s = sm->all.scores[i];
+    scorejournal_make_record(&records[i], s->points, s->name, s->finish_date, s->level, s->mode);
   }
 
-  //Deallocating object itself
-  free(*sm_ptr);
-  *sm_ptr = NULL;
-}
-
-//Useful since we are always appending to the file (Must clear first)
-static void clear_scores_file() {
-  FILE * fp = fopen(SCORES_TXT_LOCATION, "w");
-  if(fp != NULL) {
-    fclose(fp);
+  int result = scorejournal_compact(sm->journal, records, sm->all.n_scores);
+  free(records);
+  if(result != 0) {
+    printf("compact_scores::Error %d compacting the score journal\n", result);
   }
+  return result;
 }
 
-static void write_line_to_scores_file(char * text) {
-  if(text == NULL) {
-    return;
+//Creates a ScoreManager with the scores saved in the passed snapshot and journal, importing the legacy text file if there is no snapshot and import_legacy is true
+static ScoreManager * load_scoremanager(const char * snapshot_path, const char * journal_path, bool import_legacy) {
+  ScoreManager * sm = calloc(1, sizeof *sm);
+  if(sm == NULL) {
+    return NULL;
   }
 
-  FILE *fp = fopen(SCORES_TXT_LOCATION, "a");
-  if (fp != NULL) {
-    fprintf(fp, "%s\n",text);
-    fclose (fp);
+  scoreindex_init(&sm->index);
+  sm->journal = create_scorejournal(snapshot_path, journal_path);
+  if(sm->journal == NULL) {
+    free(sm);
+    return NULL;
   }
-}
 
-void write_scores_to_scores_file(ScoreManager * sm) {
-  clear_scores_file();
+  unsigned int n_records = 0;
+  ScoreRecord * records = scorejournal_load(sm->journal, &n_records);
+  int errorlevel = add_records_to_scoremanager(sm, records, n_records);
+  free(records);
 
-  char * tempstring;
-
-  int i;
-  for(i = 0; i < sm->n_scores; i++) {
-    tempstring = score_to_string(sm->scores[i]);
-    write_line_to_scores_file(tempstring);
-    free(tempstring);
+  if(errorlevel == 0 && import_legacy && sm->journal->snapshot == SCOREJOURNAL_SNAPSHOT_MISSING) {
+    errorlevel = import_legacy_scores(sm);
   }
-}
 
-static void add_scoreobj_to_scoremanager(ScoreManager * sm, Score * s) {
-  if(sm == NULL || s == NULL) {
-    return;
+  if(errorlevel != 0) {
+    printf("load_scoremanager::Error %d loading the scores\n", errorlevel);
+    destroy_scoremanager(&sm);
+    return NULL;
   }
 
-  //Attempting to grow the score array by 1
-  Score ** temp = realloc(sm->scores, (sm->n_scores + 1) * sizeof *(sm->scores));
-  if(temp != NULL) {
-    //If the returned pointer is not NULL, reallocation was successful
-    sm->scores = temp;
-    sm->n_scores++;
-    sm->scores[sm->n_scores - 1] = s;
+  //The journal has to be usable before the first score is submitted (a failure is only reported, it is tried again then)
+  if(scorejournal_should_compact(sm->journal)) {
+    compact_scores(sm);
   }
+
+  //Everything went as expected
+  return sm;
 }
 
-void add_score_to_scoremanager(ScoreManager * sm, unsigned long points, char * name, char * finish_date) {
-  if(sm == NULL) {
+ScoreManager* create_scoremanager() {
+  return load_scoremanager(SCORES_SNAPSHOT_LOCATION, SCORES_JOURNAL_LOCATION, true);
+}
+
+void destroy_scoremanager(ScoreManager ** sm_ptr) {
+  if(*sm_ptr == NULL) {
     return;
   }
 
-  add_scoreobj_to_scoremanager(sm, create_score(points, name, finish_date));
+  //Destroying scores (the index only points to them)
+  int i;
+  for(i = 0; i < (*sm_ptr)->all.n_scores; i++) {
+    destroy_score(&((*sm_ptr)->all.scores[i]));
+  }
+  scorelist_free(&((*sm_ptr)->all));
+  scoreindex_free(&((*sm_ptr)->index));
+
+  //The files are already up to date, every score was saved when added
+  destroy_scorejournal(&((*sm_ptr)->journal));
 
-  sort_scores(sm);
+  if((*sm_ptr)->highscores_panel != NULL) {
+    deleteBitmap((*sm_ptr)->highscores_panel);
+  }
+
+  //Deallocating object itself
+  free(*sm_ptr);
+  *sm_ptr = NULL;
 }
 
-void display_highscores(ScoreManager *sm, int x, int y, char * font, int y_spacing){
+void add_score_to_scoremanager(ScoreManager * sm, unsigned long points, char * name, char * finish_date, unsigned int level, score_mode_enum mode) {
   if(sm == NULL) {
     return;
   }
 
-  if(sm->n_scores == 0) {
+  Score * s_ptr = create_score(points, name, finish_date, level, mode);
+  if(!add_scoreobj_to_scoremanager(sm, s_ptr)) {
+    if(s_ptr != NULL) {
+      destroy_score(&s_ptr);
+    }
+    return;
+  }
+
+  //A single record appended, unless the journal can not be appended to, in which case compacting saves the score as well
+  ScoreRecord record;
+  scorejournal_make_record(&record, points, name, finish_date, level, mode);
+  if(scorejournal_append(sm->journal, &record) != 0 || scorejournal_should_compact(sm->journal)) {
+    compact_scores(sm);
+  }
+}
+
+//Draws the highscores panel text by text (loading every character of the font)
+static void draw_highscores_text(ScoreManager *sm, int x, int y, char * font, int y_spacing){
+  if(sm->all.n_scores == 0) {
     //If there are no scores yet, display that on the screen
     string_to_screen("No scores were added yet...", font, x, y);
     y += y_spacing;
@@ -202,13 +212,13 @@ void display_highscores(ScoreManager *sm, int x, int y, char * font, int y_spaci
     return;
   }
 
-  const unsigned int max_scores_to_display = 5;
   //The number of scores that are going to be displayed is given by the minimum between the scores we can display and the maximum number of scores that we want to display
-  unsigned int n_scores_to_display = MIN_VAL(sm->n_scores, max_scores_to_display);
+  unsigned int n_scores_to_display;
+  Score * const * top = scoremanager_get_top(sm, SCOREMANAGER_HIGHSCORES_SHOWN, &n_scores_to_display);
 
   int i;
   for(i = 0; i < n_scores_to_display; i++) {
-    char * score_str = score_to_string(sm->scores[i]);
+    char * score_str = score_to_string(top[i]);
     if(score_str == NULL) {
       continue;
     }
@@ -232,10 +242,243 @@ void display_highscores(ScoreManager *sm, int x, int y, char * font, int y_spaci
   }
 }
 
+static bool highscores_panel_matches(ScoreManager * sm, int x, int y, char * font, int y_spacing) {
+  return sm->highscores_panel != NULL && sm->panel_x == x && sm->panel_y == y && sm->panel_spacing == y_spacing && strcmp(sm->panel_font, font) == 0;
+}
+
+void display_highscores(ScoreManager *sm, int x, int y, char * font, int y_spacing){
+  if(sm == NULL || font == NULL) {
+    return;
+  }
+
+  if(highscores_panel_matches(sm, x, y, font, y_spacing)) {
+    drawBitmap(sm->highscores_panel, x, y);
+    return;
+  }
+
+  if(sm->highscores_panel != NULL) {
+    deleteBitmap(sm->highscores_panel);
+    sm->highscores_panel = NULL;
+  }
+
+  //The panel goes from x to the right of the screen, one line of y_spacing per score (or the 2 lines saying there are none)
+  int n_lines = MAX_VAL(SCOREMANAGER_HIGHSCORES_SHOWN, 2);
+  Bitmap * panel = NULL;
+  if(strlen(font) < SCOREMANAGER_FONT_LENGTH && x < getHorResolution()) {
+    panel = captureBitmap(x, y, getHorResolution() - x, n_lines * y_spacing);
+  }
+
+  draw_highscores_text(sm, x, y, font, y_spacing);
+
+  if(panel == NULL) {
+    //Could not be kept, rendered again the next time
+    return;
+  }
+
+  keepDrawnOverCapture(panel, x, y);
+  sm->highscores_panel = panel;
+  sm->panel_x = x;
+  sm->panel_y = y;
+  sm->panel_spacing = y_spacing;
+  strcpy(sm->panel_font, font);
+}
+
 unsigned long scoremanager_get_highest_score (ScoreManager * sm) {
-  if(sm == NULL || sm->n_scores == 0) {
+  if(sm == NULL || sm->all.n_scores == 0) {
     return 0;
   }
 
-  return sm->scores[0]->points;
+  return sm->all.scores[0]->points;
+}
+
+Score * const * scoremanager_get_top(ScoreManager * sm, unsigned int k, unsigned int * n) {
+  if(sm == NULL) {
+    *n = 0;
+    return NULL;
+  }
+
+  //The scores are always sorted, so the best k are just the first k
+  *n = MIN_VAL(k, sm->all.n_scores);
+  return sm->all.scores;
+}
+
+Score * const * scoremanager_get_top_on_level(ScoreManager * sm, unsigned int level, score_mode_enum mode, unsigned int k, unsigned int * n) {
+  if(sm == NULL) {
+    *n = 0;
+    return NULL;
+  }
+
+  return scoreindex_get_top_on_level(&sm->index, level, mode, k, n);
+}
+
+Score * scoremanager_get_personal_best(ScoreManager * sm, const char * name) {
+  if(sm == NULL || name == NULL) {
+    return NULL;
+  }
+
+  return scoreindex_get_personal_best(&sm->index, name);
+}
+
+Score * scoremanager_get_best_between(ScoreManager * sm, unsigned long first_day, unsigned long last_day) {
+  if(sm == NULL) {
+    return NULL;
+  }
+
+  return scoreindex_get_best_between(&sm->index, first_day, last_day);
+}
+
+//Fills a synthetic score for the benchmark: random level (1 or 2), mode, player (of SCORES_BENCH_PLAYERS) and finish date (in SCORES_BENCH_YEARS years)
+static void make_bench_record(ScoreRecord * r, unsigned long points) {
+  char name[6];
+  sprintf(name, "B%04u", (unsigned int) (rand() % SCORES_BENCH_PLAYERS));
+  char date[14];
+  sprintf(date, "20%02u/%02u/%02u", (unsigned int) (SCORES_BENCH_FIRST_YEAR + rand() % SCORES_BENCH_YEARS), (unsigned int) (1 + rand() % 12), (unsigned int) (1 + rand() % 28));
+  unsigned int level = 1 + rand() % 2;
+  scorejournal_make_record(r, points, name, date, level, rand() % SCORE_N_MODES);
+}
+
+//Times the queries of the index against scanning every score (from the best down, stopping as soon as the answer is known)
+static void benchmark_queries(ScoreManager * sm, unsigned long n_queries) {
+  unsigned long first_day = score_date_to_day(SCORES_BENCH_FIRST_YEAR, 1, 1);
+  unsigned long n_days = score_date_to_day(SCORES_BENCH_FIRST_YEAR + SCORES_BENCH_YEARS, 1, 1) - first_day;
+  //Sums of what was found, so that both ways can be checked to find the same
+  unsigned long indexed_sum = 0, scan_sum = 0;
+  unsigned long i, j;
+
+  srand(1);
+  unsigned long start = gameclock_now_ms();
+  for(i = 0; i < n_queries; i++) {
+    //In the same order as when scanning (the order arguments are evaluated in is not defined)
+    unsigned int level = 1 + rand() % 2;
+    score_mode_enum mode = rand() % SCORE_N_MODES;
+    unsigned int n;
+    Score * const * top = scoremanager_get_top_on_level(sm, level, mode, SCOREMANAGER_HIGHSCORES_SHOWN, &n);
+    for(j = 0; j < n; j++) {
+      indexed_sum += top[j]->points;
+    }
+
+    char name[6];
+    sprintf(name, "B%04u", (unsigned int) (rand() % SCORES_BENCH_PLAYERS));
+    Score * best = scoremanager_get_personal_best(sm, name);
+    indexed_sum += best != NULL ? best->points : 0;
+
+    unsigned long day = first_day + rand() % n_days;
+    best = scoremanager_get_best_between(sm, day, day + 6);
+    indexed_sum += best != NULL ? best->points : 0;
+  }
+  unsigned long indexed_ms = gameclock_now_ms() - start;
+
+  srand(1);
+  start = gameclock_now_ms();
+  for(i = 0; i < n_queries; i++) {
+    unsigned int level = 1 + rand() % 2;
+    score_mode_enum mode = rand() % SCORE_N_MODES;
+    unsigned int n = 0;
+    for(j = 0; j < sm->all.n_scores && n < SCOREMANAGER_HIGHSCORES_SHOWN; j++) {
+      if(sm->all.scores[j]->level == level && sm->all.scores[j]->mode == mode) {
+        scan_sum += sm->all.scores[j]->points;
+        n++;
+      }
+    }
+
+    char name[6];
+    sprintf(name, "B%04u", (unsigned int) (rand() % SCORES_BENCH_PLAYERS));
+    for(j = 0; j < sm->all.n_scores; j++) {
+      if(strcmp(sm->all.scores[j]->name, name) == 0) {
+        scan_sum += sm->all.scores[j]->points;
+        break;
+      }
+    }
+
+    unsigned long day = first_day + rand() % n_days;
+    for(j = 0; j < sm->all.n_scores; j++) {
+      if(sm->all.scores[j]->day >= day && sm->all.scores[j]->day <= day + 6) {
+        scan_sum += sm->all.scores[j]->points;
+        break;
+      }
+    }
+  }
+  unsigned long scan_ms = gameclock_now_ms() - start;
+
+  printf("scoremanager_benchmark::%lu queries of each kind (top %u on a level, personal best, best in a week): %lu ms indexed, %lu ms scanning%s\n", n_queries, SCOREMANAGER_HIGHSCORES_SHOWN, indexed_ms, scan_ms, indexed_sum == scan_sum ? "" : " (DIFFERENT RESULTS)");
+}
+
+void scoremanager_benchmark(unsigned long n_scores, unsigned long n_inserts) {
+  if(n_scores == 0) {
+    printf("scoremanager_benchmark::Invalid number of scores %lu\n", n_scores);
+    return;
+  }
+
+  //A snapshot of n_scores synthetic scores, in order, as compacting writes them (with ties, since points are often the same)
+  ScoreRecord * records = malloc(n_scores * sizeof *records);
+  ScoreJournal * journal = create_scorejournal(SCORES_BENCH_SNAPSHOT_LOCATION, SCORES_BENCH_JOURNAL_LOCATION);
+  if(records == NULL || journal == NULL) {
+    printf("scoremanager_benchmark::Could not allocate %lu scores\n", n_scores);
+    free(records);
+    destroy_scorejournal(&journal);
+    return;
+  }
+
+  srand((unsigned int) n_scores);
+  unsigned long i;
+  for(i = 0; i < n_scores; i++) {
+    make_bench_record(&records[i], (n_scores - i) / 4);
+  }
+
+  unsigned long start = gameclock_now_ms();
+  int result = scorejournal_compact(journal, records, n_scores);
+  unsigned long write_ms = gameclock_now_ms() - start;
+  free(records);
+  destroy_scorejournal(&journal);
+  if(result != 0) {
+    printf("scoremanager_benchmark::Could not write the snapshot\n");
+    return;
+  }
+
+  start = gameclock_now_ms();
+  ScoreManager * sm = load_scoremanager(SCORES_BENCH_SNAPSHOT_LOCATION, SCORES_BENCH_JOURNAL_LOCATION, false);
+  unsigned long load_ms = gameclock_now_ms() - start;
+  if(sm == NULL) {
+    printf("scoremanager_benchmark::Could not load the snapshot\n");
+    return;
+  }
+
+  //Inserted in memory only, saving them would be timing the journal (and every compaction rewriting the whole snapshot)
+  unsigned long n_inserted = 0;
+  start = gameclock_now_ms();
+  for(i = 0; i < n_inserts; i++) {
+    ScoreRecord r;
+    make_bench_record(&r, rand() % (n_scores / 4 + 1));
+    Score * s_ptr = create_score(r.points, r.name, r.finish_date, r.level, r.mode);
+    if(!add_scoreobj_to_scoremanager(sm, s_ptr)) {
+      if(s_ptr != NULL) {
+        destroy_score(&s_ptr);
+      }
+      continue;
+    }
+    n_inserted++;
+  }
+  unsigned long insert_ms = gameclock_now_ms() - start;
+
+  //Checking that the scores are still in order, and reading the top through the view
+  bool sorted = true;
+  for(i = 1; i < sm->all.n_scores; i++) {
+    if(sm->all.scores[i - 1]->points < sm->all.scores[i]->points) {
+      sorted = false;
+      break;
+    }
+  }
+  unsigned int n_top;
+  Score * const * top = scoremanager_get_top(sm, SCOREMANAGER_HIGHSCORES_SHOWN, &n_top);
+
+  printf("scoremanager_benchmark::%lu scores: snapshot written in %lu ms, loaded (and indexed) in %lu ms\n", n_scores, write_ms, load_ms);
+  printf("scoremanager_benchmark::%lu scores inserted in %lu ms (%lu us each)\n", n_inserted, insert_ms, n_inserted > 0 ? insert_ms * 1000 / n_inserted : 0);
+  printf("scoremanager_benchmark::%u scores, %s, top %u from %lu points, %u players, %u days\n", sm->all.n_scores, sorted ? "sorted" : "NOT SORTED", n_top, n_top > 0 ? top[0]->points : 0, sm->index.n_players, sm->index.n_days);
+
+  benchmark_queries(sm, SCORES_BENCH_QUERIES);
+
+  //The benchmark's files are not kept, they are only of use to it
+  destroy_scoremanager(&sm);
+  remove(SCORES_BENCH_SNAPSHOT_LOCATION);
+  remove(SCORES_BENCH_JOURNAL_LOCATION);
 }
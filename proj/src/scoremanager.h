@@ -2,6 +2,9 @@
 #define __SCOREMANAGER_H
 
 #include "score.h"
+#include "scorejournal.h"
+#include "scoreindex.h"
+#include "bitmap.h"
 
 /** @defgroup scoremanager scoremanager
  * @{
@@ -9,12 +12,40 @@
  * Functions and structs for Score management
  */
 
+/*
+ * Scores are kept in a binary snapshot plus a journal of the ones submitted since (see scorejournal.h): each score submitted
+ * is appended to the journal right away, and the journal is compacted into a new snapshot once it passes SCOREJOURNAL_COMPACT_THRESHOLD.
+ * If there is no snapshot yet, the scores are imported from the text file older versions of the game wrote (which is then left as it was).
+ * The scores are kept sorted from the highest down at all times (see ScoreList in scoreindex.h), those read from a snapshot (written in order) are just appended,
+ * and indexed by level and mode, by player and by finish date, for the queries of a level, player or date range.
+ * The highscores panel is only rendered the first time it is displayed (over the menu background, keeping just what was drawn, see captureBitmap),
+ * and then drawn with a single bitmap until a score is added or it is displayed somewhere else or in another font.
+ */
+
 #define LINE_MAX_LENGTH  80
-#define SCORES_TXT_LOCATION "/home/Robinix/scores/scores.txt"
+#define SCORES_TXT_LOCATION "/home/Robinix/scores/scores.txt" /* Only read, to import the scores from */
+#define SCORES_SNAPSHOT_LOCATION "/home/Robinix/scores/scores.snapshot"
+#define SCORES_JOURNAL_LOCATION "/home/Robinix/scores/scores.journal"
+#define SCORES_BENCH_SNAPSHOT_LOCATION "/home/Robinix/scores/bench.snapshot" /* Written and removed by scoremanager_benchmark */
+#define SCORES_BENCH_JOURNAL_LOCATION "/home/Robinix/scores/bench.journal"
+#define SCORES_BENCH_PLAYERS 1000 /* Players, years and queries of the synthetic scores of scoremanager_benchmark */
+#define SCORES_BENCH_FIRST_YEAR 16
+#define SCORES_BENCH_YEARS 2
+#define SCORES_BENCH_QUERIES 100000
+#define SCOREMANAGER_HIGHSCORES_SHOWN 5
+#define SCOREMANAGER_FONT_LENGTH 24 /* Characters of the font name the highscores panel was rendered in, with the null terminator */
 
 typedef struct {
-  Score ** scores;
-  unsigned int n_scores;
+  //Every score, owned by the ScoreManager
+  ScoreList all;
+  ScoreIndex index;
+  ScoreJournal * journal;
+  //Rendered highscores panel, NULL if it has to be rendered again, and where and how it was rendered
+  Bitmap * highscores_panel;
+  int panel_x;
+  int panel_y;
+  int panel_spacing;
+  char panel_font[SCOREMANAGER_FONT_LENGTH];
 } ScoreManager;
 
 /**
@@ -30,22 +61,55 @@ ScoreManager* create_scoremanager();
 void destroy_scoremanager(ScoreManager ** sm_ptr);
 
 /**
- * @brief Writes the scores saved in the ScoreManager to the scores txt file
- * @param sm The ScoreManager whose scores to store
- */
-void write_scores_to_scores_file(ScoreManager * sm);
-
-/**
- * @brief Adds a score to the ScoreManger
+ * @brief Adds a score to the ScoreManger, saving it to the journal (and compacting it if needed)
  * @param sm          ScoreManager to add the score to
  * @param points      Points of the new score
  * @param name        Name of the new score owner
  * @param finish_date Finish date of the new score
+ * @param level       Level the new score was got in
+ * @param mode        Mode the level was played in
+ */
+void add_score_to_scoremanager(ScoreManager * sm, unsigned long points, char * name, char * finish_date, unsigned int level, score_mode_enum mode);
+
+/**
+ * @brief Gets the best scores, without copying them
+ * @param  sm ScoreManager to get the scores of
+ * @param  k  Most scores to get
+ * @param  n  Where to return how many scores were got (k, or all of them if there are fewer)
+ * @return    The best scores, from the highest down (only valid until a score is added)
+ */
+Score * const * scoremanager_get_top(ScoreManager * sm, unsigned int k, unsigned int * n);
+
+/**
+ * @brief Gets the best scores of a level, without copying them
+ * @param  sm    ScoreManager to get the scores of
+ * @param  level Level of the scores
+ * @param  mode  Mode the level was played in
+ * @param  k     Most scores to get
+ * @param  n     Where to return how many scores were got (k, or all of them if there are fewer)
+ * @return       The best scores, from the highest down (only valid until a score is added)
+ */
+Score * const * scoremanager_get_top_on_level(ScoreManager * sm, unsigned int level, score_mode_enum mode, unsigned int k, unsigned int * n);
+
+/**
+ * @brief Gets the best score of a player
+ * @param  sm   ScoreManager to look in
+ * @param  name Name of the player
+ * @return      The best score of the player, NULL if there is none
+ */
+Score * scoremanager_get_personal_best(ScoreManager * sm, const char * name);
+
+/**
+ * @brief Gets the best score finished between two days, for example the last 7 days for the best of the week
+ * @param  sm        ScoreManager to look in
+ * @param  first_day First day, included (see score_date_to_day)
+ * @param  last_day  Last day, included
+ * @return           The best score, NULL if there is none
  */
-void add_score_to_scoremanager(ScoreManager * sm, unsigned long points, char * name, char * finish_date);
+Score * scoremanager_get_best_between(ScoreManager * sm, unsigned long first_day, unsigned long last_day);
 
 /**
- * @brief Displays the top 3 scores
+ * @brief Displays the top SCOREMANAGER_HIGHSCORES_SHOWN scores (rendered once and then kept until the scores change)
  * @param sm        ScoreManager whose highscores to display
  * @param x         The x in the screen at which to display the scores
  * @param y         The y in the screen at which to display the scores
@@ -61,4 +125,11 @@ void display_highscores(ScoreManager *sm, int x, int y, char* font, int y_spacin
  */
 unsigned long scoremanager_get_highest_score(ScoreManager * sm);
 
+/**
+ * @brief Times writing and loading a snapshot of synthetic scores, inserting more scores (in memory only) into them and then querying them, printing the results
+ * @param n_scores  Number of scores in the snapshot
+ * @param n_inserts Number of scores inserted after loading
+ */
+void scoremanager_benchmark(unsigned long n_scores, unsigned long n_inserts);
+
 #endif /* __SCOREMANAGER_H */
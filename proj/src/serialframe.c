@@ -0,0 +1,193 @@
+#include "serialframe.h"
+#include <stdbool.h>
+#include <string.h>
+
+unsigned char serialframe_crc8(const unsigned char * data, unsigned int len) {
+  unsigned char crc = 0;
+  unsigned int i, bit;
+
+  for(i = 0; i < len; i++) {
+    crc ^= data[i];
+    for(bit = 0; bit < 8; bit++) {
+      //Shifting out the MSB and applying the polynomial (0x07) if it was set
+      if(crc & 0x80) {
+        crc = (crc << 1) ^ 0x07;
+      } else {
+        crc <<= 1;
+      }
+    }
+  }
+
+  return crc;
+}
+
+unsigned int varint_encode(unsigned long long value, unsigned char * out) {
+  unsigned int n = 0;
+
+  //Writing 7 bits at a time, setting the MSB while there are more to come
+  while(value >= 0x80) {
+    out[n++] = (unsigned char) ((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (unsigned char) value;
+
+  return n;
+}
+
+int varint_decode(const unsigned char * in, unsigned int len, unsigned long long * value) {
+  unsigned long long result = 0;
+  unsigned int i;
+
+  for(i = 0; i < len && i < VARINT_MAX_SIZE; i++) {
+    result |= ((unsigned long long) (in[i] & 0x7F)) << (7 * i);
+    if((in[i] & 0x80) == 0) {
+      //Last byte of the varint
+      *value = result;
+      return i + 1;
+    }
+  }
+
+  //Ran out of bytes (or the varint is longer than possible) before finding the last byte
+  return -1;
+}
+
+unsigned int serialframe_encode(unsigned char opcode, const unsigned char * payload, unsigned int len, unsigned char * out) {
+  if(len > SERIALFRAME_MAX_PAYLOAD || (payload == NULL && len != 0)) {
+    return 0;
+  }
+
+  out[0] = SERIALFRAME_START_BYTE;
+  out[1] = (unsigned char) len;
+  out[2] = opcode;
+  if(len > 0) {
+    memcpy(out + 3, payload, len);
+  }
+  //CRC covers length, opcode and payload (not the start byte)
+  out[3 + len] = serialframe_crc8(out + 1, len + 2);
+
+  return len + SERIALFRAME_OVERHEAD;
+}
+
+int serialframe_read_varint(const SerialFrameView * frame, unsigned int * offset, unsigned long long * value) {
+  if(frame == NULL || *offset >= frame->length) {
+    return -1;
+  }
+
+  int n_read = varint_decode(frame->payload + *offset, frame->length - *offset, value);
+  if(n_read < 0) {
+    return -2;
+  }
+
+  *offset += n_read;
+  return 0;
+}
+
+void serialframe_view(const SerialFrame * frame, SerialFrameView * view) {
+  view->opcode = frame->opcode;
+  view->length = frame->length;
+  view->payload = frame->payload;
+}
+
+void serialframe_decoder_reset(SerialFrameDecoder * fd) {
+  //Whatever was in the buffer is considered lost
+  fd->bytes_discarded += fd->n_bytes;
+  fd->n_bytes = 0;
+}
+
+//Gets the byte at position i of the decoder buffer (counting from the oldest)
+static unsigned char decoder_at(const SerialFrameDecoder * fd, unsigned int i) {
+  return fd->buffer[(fd->head + i) % SERIALFRAME_DECODER_BUF_SIZE];
+}
+
+//Removes the first n bytes of the decoder buffer
+static void decoder_consume(SerialFrameDecoder * fd, unsigned int n) {
+  if(n >= fd->n_bytes) {
+    fd->head = 0;
+    fd->n_bytes = 0;
+    return;
+  }
+
+  fd->head = (fd->head + n) % SERIALFRAME_DECODER_BUF_SIZE;
+  fd->n_bytes -= n;
+}
+
+void serialframe_decoder_feed(SerialFrameDecoder * fd, unsigned char byte) {
+  if(fd->n_bytes == SERIALFRAME_DECODER_BUF_SIZE) {
+    //Buffer full, this can only happen with garbage since a valid frame is much smaller than the buffer
+    decoder_consume(fd, 1);
+    fd->bytes_discarded++;
+  }
+
+  fd->buffer[(fd->head + fd->n_bytes) % SERIALFRAME_DECODER_BUF_SIZE] = byte;
+  fd->n_bytes++;
+}
+
+//Calculates the CRC-8 of n bytes of the decoder buffer starting at position start (they may wrap around)
+static unsigned char decoder_crc8(const SerialFrameDecoder * fd, unsigned int start, unsigned int n) {
+  unsigned int first = (fd->head + start) % SERIALFRAME_DECODER_BUF_SIZE;
+  if(first + n <= SERIALFRAME_DECODER_BUF_SIZE) {
+    return serialframe_crc8(fd->buffer + first, n);
+  }
+
+  //Wrapped, so continuing the calculation over the bytes at the beginning of the buffer
+  unsigned char data[SERIALFRAME_MAX_PAYLOAD + 2];
+  unsigned int i;
+  for(i = 0; i < n; i++) {
+    data[i] = decoder_at(fd, start + i);
+  }
+  return serialframe_crc8(data, n);
+}
+
+bool serialframe_decoder_next(SerialFrameDecoder * fd, SerialFrame * frame) {
+  while(fd->n_bytes > 0) {
+    //Hunting for a start byte, everything before it is garbage
+    if(decoder_at(fd, 0) != SERIALFRAME_START_BYTE) {
+      unsigned int skip = 1;
+      while(skip < fd->n_bytes && decoder_at(fd, skip) != SERIALFRAME_START_BYTE) {
+        skip++;
+      }
+      fd->bytes_discarded += skip;
+      decoder_consume(fd, skip);
+      continue;
+    }
+
+    //Need at least the length byte to know how big the frame is
+    if(fd->n_bytes < 2) {
+      return false;
+    }
+
+    unsigned int len = decoder_at(fd, 1);
+    if(len > SERIALFRAME_MAX_PAYLOAD) {
+      //Impossible length, so this start byte was not really the start of a frame. Resynchronizing on the next one
+      fd->bytes_discarded++;
+      decoder_consume(fd, 1);
+      continue;
+    }
+
+    if(fd->n_bytes < len + SERIALFRAME_OVERHEAD) {
+      //Frame not fully received yet
+      return false;
+    }
+
+    if(decoder_crc8(fd, 1, len + 2) != decoder_at(fd, 3 + len)) {
+      //Corrupted frame (or a false start), dropping only the start byte since a real frame may begin inside this one
+      fd->crc_errors++;
+      fd->bytes_discarded++;
+      decoder_consume(fd, 1);
+      continue;
+    }
+
+    //Valid frame, copying it out
+    frame->length = (unsigned char) len;
+    frame->opcode = decoder_at(fd, 2);
+    unsigned int i;
+    for(i = 0; i < len; i++) {
+      frame->payload[i] = decoder_at(fd, 3 + i);
+    }
+    decoder_consume(fd, len + SERIALFRAME_OVERHEAD);
+    fd->frames_decoded++;
+    return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,131 @@
+#ifndef __SERIALFRAME_H
+#define __SERIALFRAME_H
+
+#include <stdbool.h>
+
+/** @defgroup serialframe serialframe
+ * @{
+ *
+ * Binary framing for messages sent through the Serial Port: encoding, varint payloads, CRC checking and decoding with resynchronization
+ */
+
+/*
+ * Frame layout (all fields are single bytes except for the payload):
+ *
+ *   | START | LENGTH | OPCODE | PAYLOAD (LENGTH bytes) | CRC-8 |
+ *
+ * The CRC-8 (polynomial 0x07) covers LENGTH, OPCODE and PAYLOAD.
+ * The start byte can also show up inside the payload, so it is only used as a hint of where a frame may begin:
+ * a frame is only accepted if its length is valid and its CRC matches, otherwise the decoder drops that start byte and looks for the next one
+ */
+
+#define SERIALFRAME_START_BYTE        0x7E
+#define SERIALFRAME_MAX_PAYLOAD       64
+#define SERIALFRAME_OVERHEAD          4 /* START + LENGTH + OPCODE + CRC */
+#define SERIALFRAME_MAX_SIZE          (SERIALFRAME_MAX_PAYLOAD + SERIALFRAME_OVERHEAD)
+#define SERIALFRAME_DECODER_BUF_SIZE  (4 * SERIALFRAME_MAX_SIZE)
+//Maximum number of bytes that an unsigned long long varint can take (7 bits of value per byte)
+#define VARINT_MAX_SIZE               10
+
+//Opcode 0 is reserved for raw test payloads (uart tx/rx testing)
+#define SERIALFRAME_OP_RAW            0
+
+typedef struct {
+  unsigned char opcode;
+  unsigned char length;
+  unsigned char payload[SERIALFRAME_MAX_PAYLOAD];
+} SerialFrame;
+
+//Read only view of a frame kept somewhere else (the payload is not copied), valid only as long as that frame is
+typedef struct {
+  unsigned char opcode;
+  unsigned char length;
+  const unsigned char * payload;
+} SerialFrameView;
+
+typedef struct {
+  //Bytes received but not yet consumed as a frame (circular, starting at head), so that consuming them never moves the rest
+  unsigned char buffer[SERIALFRAME_DECODER_BUF_SIZE];
+  unsigned int head;
+  unsigned int n_bytes;
+  //Statistics about the received data
+  unsigned long frames_decoded;
+  unsigned long crc_errors;
+  unsigned long bytes_discarded;
+} SerialFrameDecoder;
+
+/**
+ * @brief Calculates the CRC-8 (polynomial 0x07) of the passed data
+ * @param  data Data to calculate the CRC of
+ * @param  len  Number of bytes of data
+ * @return      The calculated CRC-8
+ */
+unsigned char serialframe_crc8(const unsigned char * data, unsigned int len);
+
+/**
+ * @brief Encodes an unsigned value as a varint (7 bits per byte, least significant group first, MSB set if more bytes follow)
+ * @param  value Value to encode
+ * @param  out   Buffer to write to, must have space for at least VARINT_MAX_SIZE bytes
+ * @return       Number of bytes written
+ */
+unsigned int varint_encode(unsigned long long value, unsigned char * out);
+
+/**
+ * @brief Decodes a varint
+ * @param  in    Buffer to read from
+ * @param  len   Number of bytes available in the buffer
+ * @param  value Where to write the decoded value
+ * @return       Number of bytes read or -1 if the varint is truncated or too long
+ */
+int varint_decode(const unsigned char * in, unsigned int len, unsigned long long * value);
+
+/**
+ * @brief Encodes a frame with the passed opcode and payload
+ * @param  opcode  Opcode of the frame
+ * @param  payload Payload of the frame (can be NULL if len is 0)
+ * @param  len     Length of the payload, at most SERIALFRAME_MAX_PAYLOAD
+ * @param  out     Buffer to write the frame to, must have space for at least SERIALFRAME_MAX_SIZE bytes
+ * @return         Number of bytes written, 0 in case of error
+ */
+unsigned int serialframe_encode(unsigned char opcode, const unsigned char * payload, unsigned int len, unsigned char * out);
+
+/**
+ * @brief Reads a varint from the payload of a frame, advancing the passed offset
+ * @param  frame  View of the frame to read from
+ * @param  offset Offset into the payload at which to read, is updated to point after the read varint
+ * @param  value  Where to write the read value
+ * @return        0 if successful, not 0 otherwise
+ */
+int serialframe_read_varint(const SerialFrameView * frame, unsigned int * offset, unsigned long long * value);
+
+/**
+ * @brief Makes a view of a frame
+ * @param frame Frame to view
+ * @param view  Filled with the view, valid as long as the frame is
+ */
+void serialframe_view(const SerialFrame * frame, SerialFrameView * view);
+
+/**
+ * @brief Resets a frame decoder, discarding any partially received frame
+ * @param fd Decoder to reset
+ */
+void serialframe_decoder_reset(SerialFrameDecoder * fd);
+
+/**
+ * @brief Feeds a received byte to the decoder. If the decoder buffer is full the oldest byte is discarded
+ * @param fd   Decoder to feed
+ * @param byte Received byte
+ */
+void serialframe_decoder_feed(SerialFrameDecoder * fd, unsigned char byte);
+
+/**
+ * @brief Extracts the next complete and valid frame from the decoder, skipping over corrupted data. Only the frame extracted is copied, once
+ * @param  fd    Decoder to extract the frame from
+ * @param  frame Where to write the extracted frame
+ * @return       true if a frame was extracted, false if there is no complete frame available yet
+ */
+bool serialframe_decoder_next(SerialFrameDecoder * fd, SerialFrame * frame);
+
+/** @} */
+
+#endif /* __SERIALFRAME_H */
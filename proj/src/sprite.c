@@ -1,8 +1,13 @@
 #include <stdlib.h>
 #include "sprite.h"
 #include "bitmap.h"
+#include "governor.h"
 
 static void update_sprite(Sprite * s_ptr){
+  //Frozen when frames run over their budget
+  if(!governor_animates_sprites()) {
+    return;
+  }
 
   if(s_ptr->frames_left == 0){
     if (s_ptr->current_bitmap + 1 == s_ptr->n_bitmaps){
@@ -16,6 +21,39 @@ static void update_sprite(Sprite * s_ptr){
   }
 }
 
+Sprite * create_sprite_in_region(char** bmp_paths, int n_bmps, int frames_per_bitmap, Region * region) {
+  //Can't allocate if no bitmaps are passed
+  if(n_bmps <= 0) {
+    return NULL;
+  }
+
+  //Nothing has to be deallocated if something fails, the region has it all
+  Sprite * s_ptr = region_alloc(region, sizeof *s_ptr);
+  if(s_ptr == NULL) {
+    return NULL;
+  }
+
+  s_ptr->bmps = region_alloc(region, n_bmps * sizeof *(s_ptr->bmps));
+  if(s_ptr->bmps == NULL) {
+    return NULL;
+  }
+
+  int i;
+  for (i = 0; i < n_bmps; i++) {
+    s_ptr->bmps[i] = loadBitmapInRegion(bmp_paths[i], region);
+    if (s_ptr->bmps[i] == NULL) {
+      return NULL;
+    }
+  }
+
+  s_ptr->frames_per_bitmap = frames_per_bitmap;
+  s_ptr->frames_left = frames_per_bitmap;
+  s_ptr->n_bitmaps = n_bmps;
+  s_ptr->current_bitmap = 0;
+
+  return s_ptr;
+}
+
 Sprite * create_sprite(char** bmp_paths, int n_bmps, int frames_per_bitmap) {
   //Can't allocate if no bitmaps are passed
   if(n_bmps <= 0) {
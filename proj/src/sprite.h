@@ -26,6 +26,16 @@ typedef struct {
  */
 Sprite * create_sprite(char** bmp_paths, int n_bmps, int frames_per_bitmap);
 
+/**
+ * @brief Sprite Object Constructor, creating it and loading its bmps in a region (it is freed with the region, and not with destroy_sprite)
+ * @param  bmp_paths         The paths to the bmps to load
+ * @param  n_bmps            The number of bmps to load
+ * @param  frames_per_bitmap The number of frames to draw each bitmap
+ * @param  region            Region to create it in
+ * @return                   Returns a pointer to a valid Sprite or NULL in case of failure
+ */
+Sprite * create_sprite_in_region(char** bmp_paths, int n_bmps, int frames_per_bitmap, Region * region);
+
 /**
  * @brief Sprite Object Destructor
  * @param s_ptr Sprite Object to destroy
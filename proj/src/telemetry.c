@@ -0,0 +1,130 @@
+#include "telemetry.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include "font.h"
+#include "utilities.h"
+
+static Telemetry telemetry;
+static bool overlay_shown = false;
+//Counters at the start of the current second, to calculate the rates
+static unsigned long second_bytes_sent = 0;
+static unsigned long second_bytes_received = 0;
+static unsigned long second_interrupts = 0;
+
+//Gets the histogram bucket of a value, the last bucket has everything above the others
+static unsigned int get_bucket(unsigned long value, unsigned long bucket_size, unsigned int n_buckets) {
+  return MIN_VAL(value / bucket_size, n_buckets - 1);
+}
+
+void telemetry_frame_sent(unsigned int n_bytes) {
+  telemetry.frames_sent++;
+  telemetry.bytes_sent += n_bytes;
+  telemetry.frame_sizes_sent[get_bucket(n_bytes, TELEMETRY_SIZE_BUCKET_BYTES, TELEMETRY_SIZE_BUCKETS)]++;
+}
+
+void telemetry_bytes_received(unsigned int n_bytes) {
+  telemetry.bytes_received += n_bytes;
+}
+
+void telemetry_frame_received(unsigned int n_bytes) {
+  telemetry.frames_received++;
+  telemetry.frame_sizes_received[get_bucket(n_bytes, TELEMETRY_SIZE_BUCKET_BYTES, TELEMETRY_SIZE_BUCKETS)]++;
+}
+
+void telemetry_queue_depth(telemetry_queue_enum queue, unsigned int depth) {
+  telemetry.queue_high_water[queue] = MAX_VAL(telemetry.queue_high_water[queue], depth);
+}
+
+void telemetry_retransmit() {
+  telemetry.retransmits++;
+}
+
+void telemetry_rtt_sample(unsigned long rtt) {
+  telemetry.rtt_samples++;
+  telemetry.rtt_max = MAX_VAL(telemetry.rtt_max, rtt);
+  telemetry.rtt_histogram[get_bucket(rtt, TELEMETRY_RTT_BUCKET_TICKS, TELEMETRY_RTT_BUCKETS)]++;
+}
+
+void telemetry_line_error(telemetry_line_error_enum error) {
+  telemetry.line_errors[error]++;
+}
+
+void telemetry_interrupt() {
+  telemetry.interrupts++;
+}
+
+void telemetry_tick() {
+  telemetry.ticks++;
+  if(telemetry.ticks % TELEMETRY_TICKS_PER_SECOND != 0) {
+    return;
+  }
+
+  telemetry.bytes_sent_per_second = telemetry.bytes_sent - second_bytes_sent;
+  telemetry.bytes_received_per_second = telemetry.bytes_received - second_bytes_received;
+  telemetry.interrupts_per_second = telemetry.interrupts - second_interrupts;
+  telemetry.max_bytes_sent_per_second = MAX_VAL(telemetry.max_bytes_sent_per_second, telemetry.bytes_sent_per_second);
+  telemetry.max_bytes_received_per_second = MAX_VAL(telemetry.max_bytes_received_per_second, telemetry.bytes_received_per_second);
+  telemetry.max_interrupts_per_second = MAX_VAL(telemetry.max_interrupts_per_second, telemetry.interrupts_per_second);
+
+  second_bytes_sent = telemetry.bytes_sent;
+  second_bytes_received = telemetry.bytes_received;
+  second_interrupts = telemetry.interrupts;
+}
+
+const Telemetry * telemetry_get() {
+  return &telemetry;
+}
+
+void telemetry_toggle_overlay() {
+  overlay_shown = !overlay_shown;
+}
+
+void draw_telemetry_overlay() {
+  if(!overlay_shown) {
+    return;
+  }
+
+  //Bottom left corner, one line per group of counters
+  char line[64];
+  sprintf(line, "tx %lu b/s rx %lu b/s", telemetry.bytes_sent_per_second, telemetry.bytes_received_per_second);
+  string_to_screen(line, "monofonto-22", 10, 660);
+  sprintf(line, "rtt max %lu retx %lu", telemetry.rtt_max, telemetry.retransmits);
+  string_to_screen(line, "monofonto-22", 10, 690);
+  sprintf(line, "oe %lu pe %lu fe %lu int %lu/s", telemetry.line_errors[TELEMETRY_OVERRUN], telemetry.line_errors[TELEMETRY_PARITY], telemetry.line_errors[TELEMETRY_FRAMING], telemetry.interrupts_per_second);
+  string_to_screen(line, "monofonto-22", 10, 720);
+}
+
+//Writes a histogram as a line, each bucket as "first value: count"
+static void dump_histogram(FILE * fp, const char * name, const unsigned long * buckets, unsigned int n_buckets, unsigned long bucket_size) {
+  fprintf(fp, "%s:", name);
+  unsigned int i;
+  for(i = 0; i < n_buckets; i++) {
+    fprintf(fp, " %lu%s: %lu", i * bucket_size, i == n_buckets - 1 ? "+" : "", buckets[i]);
+  }
+  fprintf(fp, "\n");
+}
+
+int telemetry_dump(const char * path) {
+  FILE * fp = fopen(path, "w");
+  if(fp == NULL) {
+    printf("telemetry_dump::Could not open %s\n", path);
+    return -1;
+  }
+
+  fprintf(fp, "ticks: %lu\n", telemetry.ticks);
+  fprintf(fp, "bytes sent: %lu (last second %lu, max %lu per second)\n", telemetry.bytes_sent, telemetry.bytes_sent_per_second, telemetry.max_bytes_sent_per_second);
+  fprintf(fp, "bytes received: %lu (last second %lu, max %lu per second)\n", telemetry.bytes_received, telemetry.bytes_received_per_second, telemetry.max_bytes_received_per_second);
+  fprintf(fp, "frames sent: %lu\n", telemetry.frames_sent);
+  dump_histogram(fp, "frame sizes sent (bytes)", telemetry.frame_sizes_sent, TELEMETRY_SIZE_BUCKETS, TELEMETRY_SIZE_BUCKET_BYTES);
+  fprintf(fp, "frames received: %lu\n", telemetry.frames_received);
+  dump_histogram(fp, "frame sizes received (bytes)", telemetry.frame_sizes_received, TELEMETRY_SIZE_BUCKETS, TELEMETRY_SIZE_BUCKET_BYTES);
+  fprintf(fp, "queue high-water marks: uart tx %lu bytes, transport tx %lu messages, transport rx %lu frames\n", telemetry.queue_high_water[TELEMETRY_UART_TX_QUEUE], telemetry.queue_high_water[TELEMETRY_TRANSPORT_TX_QUEUE], telemetry.queue_high_water[TELEMETRY_TRANSPORT_RX_QUEUE]);
+  fprintf(fp, "retransmits: %lu\n", telemetry.retransmits);
+  fprintf(fp, "rtt samples: %lu (max %lu ticks)\n", telemetry.rtt_samples, telemetry.rtt_max);
+  dump_histogram(fp, "rtt (ticks)", telemetry.rtt_histogram, TELEMETRY_RTT_BUCKETS, TELEMETRY_RTT_BUCKET_TICKS);
+  fprintf(fp, "line errors: overrun %lu, parity %lu, framing %lu, break %lu\n", telemetry.line_errors[TELEMETRY_OVERRUN], telemetry.line_errors[TELEMETRY_PARITY], telemetry.line_errors[TELEMETRY_FRAMING], telemetry.line_errors[TELEMETRY_BREAK]);
+  fprintf(fp, "uart interrupts: %lu (last second %lu, max %lu per second)\n", telemetry.interrupts, telemetry.interrupts_per_second, telemetry.max_interrupts_per_second);
+
+  fclose(fp);
+  return 0;
+}
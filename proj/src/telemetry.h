@@ -0,0 +1,142 @@
+#ifndef __TELEMETRY_H
+#define __TELEMETRY_H
+
+#include <stdbool.h>
+
+/** @defgroup telemetry telemetry
+ * @{
+ *
+ * Counters and histograms about the health of the serial link, shown in an optional overlay and dumped to a file when exiting
+ */
+
+/*
+ * Every layer of the link reports here what happens in it: the UART (interrupts and line errors), the transport (bytes, frames and queues)
+ * and commlink (retransmits and RTT samples). The counters are kept for the whole run, and telemetry_tick turns them into rates once per second.
+ */
+
+#define TELEMETRY_TICKS_PER_SECOND    60
+#define TELEMETRY_RTT_BUCKETS         8
+#define TELEMETRY_RTT_BUCKET_TICKS    4 /* Each RTT bucket covers 4 ticks, the last one also everything above */
+#define TELEMETRY_SIZE_BUCKETS        5
+#define TELEMETRY_SIZE_BUCKET_BYTES   16 /* Each frame size bucket covers 16 bytes, the last one also everything above */
+#define TELEMETRY_OVERLAY_KEY         't' /* Shows or hides the overlay while in multiplayer */
+#define TELEMETRY_DUMP_LOCATION       "/home/Robinix/telemetry.txt"
+
+typedef enum {
+  TELEMETRY_OVERRUN = 0,
+  TELEMETRY_PARITY,
+  TELEMETRY_FRAMING,
+  TELEMETRY_BREAK,
+  TELEMETRY_N_LINE_ERRORS
+} telemetry_line_error_enum;
+
+typedef enum {
+  TELEMETRY_UART_TX_QUEUE = 0, /* Bytes waiting for the UART transmitter */
+  TELEMETRY_TRANSPORT_TX_QUEUE, /* Messages queued in a tick */
+  TELEMETRY_TRANSPORT_RX_QUEUE, /* Frames received and not yet handled */
+  TELEMETRY_N_QUEUES
+} telemetry_queue_enum;
+
+typedef struct {
+  unsigned long ticks;
+  unsigned long bytes_sent;
+  unsigned long bytes_received;
+  unsigned long frames_sent;
+  unsigned long frames_received;
+  //Frames by size (header and CRC included)
+  unsigned long frame_sizes_sent[TELEMETRY_SIZE_BUCKETS];
+  unsigned long frame_sizes_received[TELEMETRY_SIZE_BUCKETS];
+  unsigned long queue_high_water[TELEMETRY_N_QUEUES];
+  unsigned long retransmits;
+  unsigned long rtt_samples;
+  unsigned long rtt_max;
+  unsigned long rtt_histogram[TELEMETRY_RTT_BUCKETS];
+  unsigned long line_errors[TELEMETRY_N_LINE_ERRORS];
+  unsigned long interrupts;
+  //Rates over the last full second, and the highest ones seen
+  unsigned long bytes_sent_per_second;
+  unsigned long bytes_received_per_second;
+  unsigned long interrupts_per_second;
+  unsigned long max_bytes_sent_per_second;
+  unsigned long max_bytes_received_per_second;
+  unsigned long max_interrupts_per_second;
+} Telemetry;
+
+/**
+ * @brief Registers a frame sent
+ * @param n_bytes Size of the encoded frame
+ */
+void telemetry_frame_sent(unsigned int n_bytes);
+
+/**
+ * @brief Registers bytes received, before being decoded
+ * @param n_bytes Number of bytes
+ */
+void telemetry_bytes_received(unsigned int n_bytes);
+
+/**
+ * @brief Registers a valid frame received
+ * @param n_bytes Size of the encoded frame
+ */
+void telemetry_frame_received(unsigned int n_bytes);
+
+/**
+ * @brief Registers the current depth of a queue, to keep its high-water mark
+ * @param queue Queue
+ * @param depth Elements in the queue
+ */
+void telemetry_queue_depth(telemetry_queue_enum queue, unsigned int depth);
+
+/**
+ * @brief Registers a message retransmitted
+ */
+void telemetry_retransmit();
+
+/**
+ * @brief Registers a round trip time measured
+ * @param rtt Round trip time, in ticks
+ */
+void telemetry_rtt_sample(unsigned long rtt);
+
+/**
+ * @brief Registers an error reported by the line status of the UART
+ * @param error Error
+ */
+void telemetry_line_error(telemetry_line_error_enum error);
+
+/**
+ * @brief Registers a UART interrupt serviced
+ */
+void telemetry_interrupt();
+
+/**
+ * @brief Advances the telemetry clock by one tick, updating the rates once per second. To be called once per timer tick
+ */
+void telemetry_tick();
+
+/**
+ * @brief Gets the counters
+ * @return Pointer to the (read only) counters
+ */
+const Telemetry * telemetry_get();
+
+/**
+ * @brief Shows the overlay if hidden and hides it if shown
+ */
+void telemetry_toggle_overlay();
+
+/**
+ * @brief Draws the overlay with the current rates and counters if it is shown
+ */
+void draw_telemetry_overlay();
+
+/**
+ * @brief Writes every counter and histogram to a file, as text
+ * @param  path Path of the file (overwritten)
+ * @return      0 if successful, not 0 otherwise
+ */
+int telemetry_dump(const char * path);
+
+/** @} */
+
+#endif /* __TELEMETRY_H */
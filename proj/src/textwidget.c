@@ -0,0 +1,62 @@
+#include "textwidget.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "font.h"
+
+TextWidget * create_textwidget(const char * font, int x, int y) {
+  if(font == NULL || strlen(font) >= TEXTWIDGET_FONT_LENGTH) {
+    return NULL;
+  }
+
+  TextWidget * tw = calloc(1, sizeof *tw);
+  if(tw == NULL) {
+    return NULL;
+  }
+
+  strcpy(tw->font, font);
+  tw->x = x;
+  tw->y = y;
+  return tw;
+}
+
+void destroy_textwidget(TextWidget ** tw_ptr) {
+  if(*tw_ptr == NULL) {
+    return;
+  }
+
+  deleteBitmap((*tw_ptr)->bmp);
+  free(*tw_ptr);
+  *tw_ptr = NULL;
+}
+
+void textwidget_set_text(TextWidget * tw, const char * text) {
+  if(tw == NULL || text == NULL) {
+    return;
+  }
+
+  if(strncmp(tw->text, text, TEXTWIDGET_MAX_LENGTH - 1) == 0) {
+    return;
+  }
+
+  strncpy(tw->text, text, TEXTWIDGET_MAX_LENGTH - 1);
+  tw->text[TEXTWIDGET_MAX_LENGTH - 1] = '\0';
+}
+
+void textwidget_draw(TextWidget * tw, bool refresh) {
+  if(tw == NULL) {
+    return;
+  }
+
+  if((refresh || tw->bmp == NULL) && strcmp(tw->text, tw->rendered_text) != 0) {
+    deleteBitmap(tw->bmp);
+    tw->bmp = string_to_bitmap(tw->text, tw->font);
+    strcpy(tw->rendered_text, tw->text);
+    tw->renders++;
+  }
+
+  if(tw->bmp != NULL) {
+    drawBitmap(tw->bmp, tw->x, tw->y);
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef __TEXTWIDGET_H
+#define __TEXTWIDGET_H
+
+#include <stdbool.h>
+#include "bitmap.h"
+
+/** @defgroup textwidget textwidget
+ * @{
+ *
+ * Text that is drawn every frame but seldom changes (the HUD time and coins, the date in the menu), kept rendered in a bitmap
+ */
+
+/*
+ * A widget keeps the last text it was given and that text rendered (see string_to_bitmap), so drawing it is a single bitmap.
+ * Its text is set when the value it shows changes (a second of the game passing, a coin picked up, an RTC update interrupt), and setting the text
+ * it already has does nothing: only a different one is rendered again, the next time the widget is drawn.
+ */
+
+#define TEXTWIDGET_MAX_LENGTH   32 /* Characters of the text, with the null terminator (longer ones are cut short) */
+#define TEXTWIDGET_FONT_LENGTH  24
+
+typedef struct {
+  char text[TEXTWIDGET_MAX_LENGTH];
+  char font[TEXTWIDGET_FONT_LENGTH];
+  int x;
+  int y;
+  //Text rendered the last time, drawn until text is rendered, and its bitmap (NULL if it is empty)
+  char rendered_text[TEXTWIDGET_MAX_LENGTH];
+  Bitmap * bmp;
+  unsigned long renders;
+} TextWidget;
+
+/**
+ * @brief Creates a TextWidget with no text
+ * @param  font Font to render the text in
+ * @param  x    The x at which to draw the text
+ * @param  y    The y at which to draw the text
+ * @return      Pointer to a valid TextWidget or NULL in case of failure
+ */
+TextWidget * create_textwidget(const char * font, int x, int y);
+
+/**
+ * @brief Destroys the passed TextWidget, setting the passed pointer to NULL
+ * @param tw_ptr TextWidget to destroy
+ */
+void destroy_textwidget(TextWidget ** tw_ptr);
+
+/**
+ * @brief Sets the text of a widget, to be rendered the next time it is drawn if it is not the one it already has
+ * @param tw   TextWidget to set the text of
+ * @param text New text
+ */
+void textwidget_set_text(TextWidget * tw, const char * text);
+
+/**
+ * @brief Draws a widget, rendering its text first if it changed
+ * @param tw      TextWidget to draw
+ * @param refresh If false, the text rendered before is drawn even if it changed since (unless there is none)
+ */
+void textwidget_draw(TextWidget * tw, bool refresh);
+
+/** @} */
+
+#endif /* __TEXTWIDGET_H */
@@ -4,8 +4,8 @@
 #include "i8254.h"
 #include "game.h"
 #include "robinix.h"
-/* For swap_buffers() */
-#include "video_gr.h"
+#include "gameloop.h"
+#include "gameclock.h"
 
 unsigned int timer_interrupt_counter = 0;
 static int hookID = 0;
@@ -102,6 +102,11 @@ int timer_set_frequency(unsigned char timer, unsigned long freq) {
 		return 6;
 	}
 
+	//Timer 0 interrupts are what the game clock counts
+	if(timer == 0) {
+		gameclock_set_timer_rate(freq);
+	}
+
 	//Everything went as expected
 	return 0;
 }
@@ -142,22 +147,15 @@ int timer_unsubscribe_int() {
 }
 
 void timer_IH() {
+	gameclock_timer_interrupt();
 	Robinix * rob = get_rob();
 	//The int handler, when using the game object, serves to call drawing, updating and event handling functions
 	if(rob == NULL) {
 		//If the game object is NULL, we are not using Events, so we just increment the timer counter
 		timer_interrupt_counter++;
 	} else {
-		//Otherwise call respective update functions
-		//For each timer interrupt
-		//Drawing the game based on its state
-		game_draw(rob);
-		//Swapping the buffers since we are drawing in the back buffer (using double buffering)
-		swap_buffers();
-		//Updating game state
-		game_update(rob);
-		//Updating game events (to decide if done for every timer interrupt or less often)
-		game_process_events(rob);
+		//Otherwise the game loop decides how many simulation ticks and frames this interrupt is worth
+		gameloop_IH(rob);
 	}
 }
 
@@ -0,0 +1,98 @@
+#include "trace.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+static const char * cat_names[TRACE_N_CATS] = {"irq", "frame", "asset", "link"};
+
+static TraceEvent ring[TRACE_RING_SIZE];
+//Slot of the next event, and events in the ring
+static unsigned int ring_next = 0;
+static unsigned int ring_n = 0;
+//0 if not set, times are then exported in time stamp counter increments
+static unsigned long cycles_per_us = 0;
+
+unsigned long long trace_read_tsc() {
+  unsigned long lo, hi;
+  __asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((unsigned long long) hi << 32) | lo;
+}
+
+void trace_set_tsc_rate(unsigned long rate) {
+  cycles_per_us = rate;
+}
+
+static void record(const char * name, trace_cat_enum cat, char ph, unsigned long arg) {
+  TraceEvent * evt = &ring[ring_next];
+  evt->tsc = trace_read_tsc();
+  evt->name = name;
+  evt->arg = arg;
+  evt->cat = cat;
+  evt->ph = ph;
+
+  ring_next = (ring_next + 1) % TRACE_RING_SIZE;
+  if(ring_n < TRACE_RING_SIZE) {
+    ring_n++;
+  }
+}
+
+void trace_begin(const char * name, trace_cat_enum cat) {
+  record(name, cat, 'B', 0);
+}
+
+void trace_end(const char * name, trace_cat_enum cat) {
+  record(name, cat, 'E', 0);
+}
+
+void trace_instant(const char * name, trace_cat_enum cat, unsigned long arg) {
+  record(name, cat, 'i', arg);
+}
+
+unsigned long trace_link_arg(unsigned char opcode, unsigned int length) {
+  return ((unsigned long) opcode << 16) | (length & 0xFFFF);
+}
+
+void trace_clear() {
+  ring_next = 0;
+  ring_n = 0;
+}
+
+int trace_export(const char * path) {
+  FILE * fp = fopen(path, "w");
+  if(fp == NULL) {
+    printf("trace_export::Could not open %s\n", path);
+    return -1;
+  }
+
+  if(cycles_per_us == 0) {
+    printf("trace_export::Time stamp counter rate not set, times are in cycles\n");
+  }
+
+  fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  //Oldest first, with the times relative to it
+  unsigned int first = (ring_next + TRACE_RING_SIZE - ring_n) % TRACE_RING_SIZE;
+  unsigned long long start = ring[first].tsc;
+  unsigned int i;
+  for(i = 0; i < ring_n; i++) {
+    const TraceEvent * evt = &ring[(first + i) % TRACE_RING_SIZE];
+
+    //Since printf might not support floating point or long long values, the microseconds are printed in two parts
+    unsigned long long ns = cycles_per_us != 0 ? (evt->tsc - start) * 1000 / cycles_per_us : (evt->tsc - start) * 1000;
+    fprintf(fp, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%lu.%03lu,\"pid\":1,\"tid\":1", evt->name, cat_names[evt->cat], evt->ph, (unsigned long) (ns / 1000), (unsigned long) (ns % 1000));
+    if(evt->ph == 'i') {
+      //Instants are only shown on their thread
+      fprintf(fp, ",\"s\":\"t\"");
+      if(evt->cat == TRACE_CAT_LINK) {
+        fprintf(fp, ",\"args\":{\"opcode\":%lu,\"length\":%lu}", evt->arg >> 16, evt->arg & 0xFFFF);
+      } else {
+        fprintf(fp, ",\"args\":{\"value\":%lu}", evt->arg);
+      }
+    }
+    fprintf(fp, "}%s\n", i == ring_n - 1 ? "" : ",");
+  }
+
+  fprintf(fp, "]}\n");
+  fclose(fp);
+  printf("trace_export::%u events written to %s\n", ring_n, path);
+  return 0;
+}
@@ -0,0 +1,96 @@
+#ifndef __TRACE_H
+#define __TRACE_H
+
+/** @defgroup trace trace
+ * @{
+ *
+ * Trace recorder: timestamped events kept in a ring in memory, exported as Chrome trace JSON (chrome://tracing or Perfetto)
+ */
+
+/*
+ * Recording an event only reads the time stamp counter and writes it, with the name and category, to the next slot of a preallocated ring,
+ * so it can be done anywhere, interrupt handlers included. When the ring is full the oldest events are overwritten:
+ * it always holds the last TRACE_RING_SIZE events (a few seconds of game), which is what trace_export writes.
+ * Names must be strings that live for the whole run (literals or static tables), since only the pointer is kept.
+ * Events are recorded for the interrupts received and their handlers (game.c), the phases timed by the profiler,
+ * bitmap loads and the frames sent and received through the link.
+ */
+
+#define TRACE_RING_SIZE       16384
+#define TRACE_EXPORT_KEY      'j' /* Exports the ring while playing (except when writing the player name) */
+#define TRACE_DUMP_LOCATION   "/home/Robinix/trace.json"
+
+typedef enum {
+  TRACE_CAT_IRQ = 0, /* Interrupt notifications and handlers */
+  TRACE_CAT_FRAME, /* Phases of the game loop */
+  TRACE_CAT_ASSET, /* Loading resources */
+  TRACE_CAT_LINK, /* Frames through the link, the argument is the opcode and length (see trace_link_arg) */
+  TRACE_N_CATS
+} trace_cat_enum;
+
+typedef struct {
+  unsigned long long tsc;
+  const char * name;
+  unsigned long arg;
+  unsigned char cat;
+  //'B' (begin), 'E' (end) or 'i' (instant)
+  char ph;
+} TraceEvent;
+
+/**
+ * @brief Reads the CPU's time stamp counter
+ * @return Value of the time stamp counter
+ */
+unsigned long long trace_read_tsc();
+
+/**
+ * @brief Sets the rate of the time stamp counter, to convert it to microseconds when exporting (see profiler_init)
+ * @param cycles_per_us Increments of the time stamp counter per microsecond
+ */
+void trace_set_tsc_rate(unsigned long cycles_per_us);
+
+/**
+ * @brief Records the beginning of a duration
+ * @param name Name of what begins
+ * @param cat  Category
+ */
+void trace_begin(const char * name, trace_cat_enum cat);
+
+/**
+ * @brief Records the end of a duration, begun with trace_begin with the same name
+ * @param name Name of what ends
+ * @param cat  Category
+ */
+void trace_end(const char * name, trace_cat_enum cat);
+
+/**
+ * @brief Records an instant event
+ * @param name Name of the event
+ * @param cat  Category
+ * @param arg  Argument shown with the event
+ */
+void trace_instant(const char * name, trace_cat_enum cat, unsigned long arg);
+
+/**
+ * @brief Packs the opcode and length of a frame into the argument of a TRACE_CAT_LINK event
+ * @param  opcode Opcode of the frame
+ * @param  length Length of the payload
+ * @return        Argument for trace_instant
+ */
+unsigned long trace_link_arg(unsigned char opcode, unsigned int length);
+
+/**
+ * @brief Discards every event recorded
+ */
+void trace_clear();
+
+/**
+ * @brief Writes the events in the ring, oldest first, as Chrome trace JSON
+ * @param  path Path of the file to write
+ * @return      0 if successful, not 0 otherwise
+ */
+int trace_export(const char * path);
+
+/** @} */
+
+#endif /* __TRACE_H */
@@ -0,0 +1,262 @@
+#include "transport.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "telemetry.h"
+#include "trace.h"
+#include "uart.h"
+
+//Received bytes are fed here until they form complete frames
+static SerialFrameDecoder rx_decoder;
+//Frames received (circular)
+static SerialFrame rx_queue[TRANSPORT_RX_QUEUE_SIZE];
+static unsigned int rx_head = 0;
+static unsigned int rx_n_frames = 0;
+//Messages queued in the current tick, in the order they were queued
+static SerialFrame tx_queue[TRANSPORT_TX_QUEUE_SIZE];
+static unsigned int tx_n_messages = 0;
+//How the messages with each opcode are scheduled (opcodes never set use TRANSPORT_PRIORITY_GAME and are not coalesced)
+typedef struct {
+  bool set;
+  transport_priority_enum priority;
+  bool coalesce;
+} OpcodeClass;
+static OpcodeClass opcode_classes[256];
+static TransportStats stats;
+
+void transport_reset() {
+  memset(&rx_decoder, 0, sizeof rx_decoder);
+  rx_head = 0;
+  rx_n_frames = 0;
+  tx_n_messages = 0;
+  memset(&stats, 0, sizeof stats);
+}
+
+void transport_set_opcode_class(unsigned char opcode, transport_priority_enum priority, bool coalesce) {
+  opcode_classes[opcode].set = true;
+  opcode_classes[opcode].priority = priority;
+  opcode_classes[opcode].coalesce = coalesce;
+}
+
+static transport_priority_enum get_priority(unsigned char opcode) {
+  return opcode_classes[opcode].set ? opcode_classes[opcode].priority : TRANSPORT_PRIORITY_GAME;
+}
+
+//Encodes a frame and hands it to the UART
+static void send_encoded(unsigned char opcode, const unsigned char * payload, unsigned int len) {
+  unsigned char encoded[SERIALFRAME_MAX_SIZE];
+  unsigned int encoded_len = serialframe_encode(opcode, payload, len, encoded);
+  if(encoded_len == 0) {
+    printf("transport::Could not encode frame with opcode %u and length %u\n", opcode, len);
+    return;
+  }
+
+  stats.frames_sent++;
+  stats.bytes_sent += encoded_len;
+  telemetry_frame_sent(encoded_len);
+  trace_instant("frame sent", TRACE_CAT_LINK, trace_link_arg(opcode, len));
+
+  uart_send_bytes(encoded, encoded_len);
+}
+
+void transport_send_frame(unsigned char opcode, const unsigned char * payload, unsigned int len) {
+  if(len > SERIALFRAME_MAX_PAYLOAD || (payload == NULL && len != 0)) {
+    printf("transport_send_frame::Invalid message, opcode %u and length %u\n", opcode, len);
+    return;
+  }
+
+  stats.messages_queued++;
+
+  //A state message replaces the previous one (any other message is sent, even if the same one was already queued)
+  if(opcode_classes[opcode].coalesce) {
+    unsigned int i;
+    for(i = 0; i < tx_n_messages; i++) {
+      SerialFrame * queued = &tx_queue[i];
+      if(queued->opcode == opcode) {
+        stats.messages_coalesced++;
+        stats.bytes_saved += queued->length + SERIALFRAME_OVERHEAD;
+        queued->length = len;
+        if(len > 0) {
+          memcpy(queued->payload, payload, len);
+        }
+        return;
+      }
+    }
+  }
+
+  if(tx_n_messages == TRANSPORT_TX_QUEUE_SIZE) {
+    transport_flush();
+  }
+
+  SerialFrame * msg = &tx_queue[tx_n_messages++];
+  msg->opcode = opcode;
+  msg->length = len;
+  if(len > 0) {
+    memcpy(msg->payload, payload, len);
+  }
+  if(tx_n_messages > stats.max_queue_depth) {
+    stats.max_queue_depth = tx_n_messages;
+  }
+  telemetry_queue_depth(TELEMETRY_TRANSPORT_TX_QUEUE, tx_n_messages);
+}
+
+//Sends the batch being packed: as an ordinary frame if it has a single message
+static void send_batch(const unsigned char * batch, unsigned int batch_len, unsigned int batch_n) {
+  if(batch_n == 0) {
+    return;
+  }
+
+  if(batch_n == 1) {
+    send_encoded(batch[0], batch + TRANSPORT_BATCH_HEADER, batch[1]);
+    return;
+  }
+
+  send_encoded(TRANSPORT_OP_BATCH, batch, batch_len);
+  stats.batches_sent++;
+}
+
+void transport_flush() {
+  if(tx_n_messages == 0) {
+    return;
+  }
+
+  unsigned long bytes_before = stats.bytes_sent;
+  unsigned long bytes_unbatched = 0;
+  unsigned char batch[SERIALFRAME_MAX_PAYLOAD];
+  unsigned int batch_len = 0, batch_n = 0;
+
+  int priority;
+  for(priority = 0; priority < TRANSPORT_N_PRIORITIES; priority++) {
+    unsigned int i;
+    for(i = 0; i < tx_n_messages; i++) {
+      SerialFrame * msg = &tx_queue[i];
+      if(get_priority(msg->opcode) != (transport_priority_enum) priority) {
+        continue;
+      }
+      bytes_unbatched += msg->length + SERIALFRAME_OVERHEAD;
+
+      //Too big to share a frame
+      if(msg->length + TRANSPORT_BATCH_HEADER > SERIALFRAME_MAX_PAYLOAD) {
+        send_encoded(msg->opcode, msg->payload, msg->length);
+        continue;
+      }
+
+      if(batch_len + TRANSPORT_BATCH_HEADER + msg->length > SERIALFRAME_MAX_PAYLOAD) {
+        send_batch(batch, batch_len, batch_n);
+        batch_len = 0;
+        batch_n = 0;
+      }
+      batch[batch_len] = msg->opcode;
+      batch[batch_len + 1] = msg->length;
+      memcpy(batch + batch_len + TRANSPORT_BATCH_HEADER, msg->payload, msg->length);
+      batch_len += TRANSPORT_BATCH_HEADER + msg->length;
+      batch_n++;
+    }
+  }
+  send_batch(batch, batch_len, batch_n);
+
+  stats.bytes_saved += bytes_unbatched - (stats.bytes_sent - bytes_before);
+  tx_n_messages = 0;
+}
+
+unsigned int transport_get_queue_depth() {
+  return tx_n_messages;
+}
+
+//Gets the slot where the next frame received goes, NULL if the queue is full
+//(the game takes every frame once per tick, so it is only full if the game stops doing so)
+static SerialFrame * free_rx_slot() {
+  if(rx_n_frames == TRANSPORT_RX_QUEUE_SIZE) {
+    return NULL;
+  }
+  return &rx_queue[(rx_head + rx_n_frames) % TRANSPORT_RX_QUEUE_SIZE];
+}
+
+//Queues every message of a received batch, stopping at the first one that does not fit in the frame
+static void unpack_batch(const SerialFrame * frame) {
+  unsigned int pos = 0;
+  while(pos < frame->length) {
+    if(pos + TRANSPORT_BATCH_HEADER > frame->length || pos + TRANSPORT_BATCH_HEADER + frame->payload[pos + 1] > frame->length) {
+      stats.batch_errors++;
+      return;
+    }
+    unsigned char len = frame->payload[pos + 1];
+    SerialFrame * slot = free_rx_slot();
+    if(slot != NULL) {
+      slot->opcode = frame->payload[pos];
+      slot->length = len;
+      memcpy(slot->payload, frame->payload + pos + TRANSPORT_BATCH_HEADER, len);
+      rx_n_frames++;
+      telemetry_queue_depth(TELEMETRY_TRANSPORT_RX_QUEUE, rx_n_frames);
+    } else {
+      stats.rx_queue_drops++;
+    }
+    pos += TRANSPORT_BATCH_HEADER + len;
+  }
+}
+
+void transport_feed_bytes(const unsigned char * bytes, unsigned int n) {
+  telemetry_bytes_received(n);
+  unsigned int i;
+  for(i = 0; i < n; i++) {
+    serialframe_decoder_feed(&rx_decoder, bytes[i]);
+  }
+
+  //Frames are decoded straight into their slot of the queue, only batches (and frames with no slot) go elsewhere
+  SerialFrame scratch;
+  while(true) {
+    SerialFrame * slot = free_rx_slot();
+    SerialFrame * frame = slot != NULL ? slot : &scratch;
+    if(!serialframe_decoder_next(&rx_decoder, frame)) {
+      break;
+    }
+    stats.frames_received++;
+    telemetry_frame_received(frame->length + SERIALFRAME_OVERHEAD);
+    trace_instant("frame received", TRACE_CAT_LINK, trace_link_arg(frame->opcode, frame->length));
+
+    if(frame->opcode == TRANSPORT_OP_BATCH) {
+      //Its messages take the slots, starting with the one it was decoded into
+      if(frame != &scratch) {
+        scratch = *frame;
+      }
+      unpack_batch(&scratch);
+    } else if(slot != NULL) {
+      rx_n_frames++;
+      telemetry_queue_depth(TELEMETRY_TRANSPORT_RX_QUEUE, rx_n_frames);
+    } else {
+      stats.rx_queue_drops++;
+    }
+  }
+}
+
+void transport_line_error() {
+  serialframe_decoder_reset(&rx_decoder);
+}
+
+bool transport_peek_frame(SerialFrameView * view) {
+  if(rx_n_frames == 0) {
+    return false;
+  }
+
+  serialframe_view(&rx_queue[rx_head], view);
+  return true;
+}
+
+void transport_release_frame() {
+  if(rx_n_frames == 0) {
+    return;
+  }
+
+  rx_head = (rx_head + 1) % TRANSPORT_RX_QUEUE_SIZE;
+  rx_n_frames--;
+}
+
+const TransportStats * transport_get_stats() {
+  return &stats;
+}
+
+void transport_print_stats() {
+  printf("transport::%lu messages queued (at most %lu in a tick), %lu coalesced\n", stats.messages_queued, stats.max_queue_depth, stats.messages_coalesced);
+  printf("transport::%lu frames sent (%lu batches), %lu bytes, %lu bytes saved\n", stats.frames_sent, stats.batches_sent, stats.bytes_sent, stats.bytes_saved);
+  printf("transport::%lu frames received, %lu malformed batches, %lu dropped with the queue full\n", stats.frames_received, stats.batch_errors, stats.rx_queue_drops);
+}
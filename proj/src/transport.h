@@ -0,0 +1,125 @@
+#ifndef __TRANSPORT_H
+#define __TRANSPORT_H
+
+#include <stdbool.h>
+#include "serialframe.h"
+
+/** @defgroup transport transport
+ * @{
+ *
+ * Transport of frames between both players over the UART (COM1)
+ */
+
+/*
+ * Messages sent during a tick are only queued, and transport_flush (once per tick, at its end) encodes them and hands them to the UART as bytes.
+ * Bytes received by the UART (in its interrupt handler) are fed back here and decoded straight into a queue of frames, where the game handles them in place
+ * (once per tick, with transport_peek_frame and transport_release_frame), so receiving needs no allocation and each frame is copied only once.
+ */
+
+/*
+ * When flushing, the queued messages are sorted by the priority of their opcode and packed together in as few frames as possible,
+ * in TRANSPORT_OP_BATCH frames whose payload is every message one after the other:
+ *   | opcode | length | payload (length bytes) | opcode | length | payload | ...
+ * A message alone in its frame (or too big to share one) is sent as an ordinary frame. Batches are unpacked when received,
+ * so the game only ever sees the messages themselves.
+ * Opcodes registered as coalescing are state messages where only the latest matters (beacons, acks, inputs with everything not acknowledged):
+ * queuing one replaces the one already queued with the same opcode. Every other message is sent, even if an identical one was queued in the same tick.
+ */
+
+#define TRANSPORT_RX_QUEUE_SIZE 16 /* Frames received and not yet taken by the game */
+#define TRANSPORT_TX_QUEUE_SIZE 16 /* Messages queued in a tick, if more are queued the ones before are flushed straight away */
+#define TRANSPORT_OP_BATCH      0x7D /* Frame with several messages, not seen by the game */
+#define TRANSPORT_BATCH_HEADER  2 /* Opcode and length of each message in a batch */
+
+//Messages queued first are sent first, the lowest priorities are the ones delayed if a tick has more than fits in a frame
+typedef enum {
+  TRANSPORT_PRIORITY_CRITICAL = 0, /* Acks and what changes the state of the session */
+  TRANSPORT_PRIORITY_GAME, /* Default */
+  TRANSPORT_PRIORITY_BEACON, /* Periodic messages that are sent again anyway */
+  TRANSPORT_N_PRIORITIES
+} transport_priority_enum;
+
+typedef struct {
+  unsigned long messages_queued;
+  unsigned long messages_coalesced;
+  unsigned long max_queue_depth;
+  unsigned long frames_sent;
+  unsigned long batches_sent;
+  unsigned long bytes_sent;
+  //Bytes that sending every message queued in its own frame would have taken on top of bytes_sent
+  unsigned long bytes_saved;
+  unsigned long frames_received;
+  unsigned long batch_errors;
+  unsigned long rx_queue_drops;
+} TransportStats;
+
+/**
+ * @brief Discards every frame received and partially received and every message queued. To be called when starting to use the link
+ */
+void transport_reset();
+
+/**
+ * @brief Sets how the messages with an opcode are scheduled (by default they have TRANSPORT_PRIORITY_GAME and are not coalesced)
+ * @param opcode   Opcode of the messages
+ * @param priority Priority of the messages
+ * @param coalesce If a message queued replaces the one with the same opcode already queued in the tick
+ */
+void transport_set_opcode_class(unsigned char opcode, transport_priority_enum priority, bool coalesce);
+
+/**
+ * @brief Queues a message with the passed opcode and payload, to be sent on the next transport_flush
+ * @param opcode  Opcode of the message to send
+ * @param payload Payload of the message (can be NULL if len is 0)
+ * @param len     Length of the payload, at most SERIALFRAME_MAX_PAYLOAD
+ */
+void transport_send_frame(unsigned char opcode, const unsigned char * payload, unsigned int len);
+
+/**
+ * @brief Sends every message queued, by order of priority and packed in as few frames as possible. To be called once per tick, at its end
+ */
+void transport_flush();
+
+/**
+ * @brief Gets the number of messages queued and not yet flushed
+ * @return Number of messages queued
+ */
+unsigned int transport_get_queue_depth();
+
+/**
+ * @brief For the UART: feeds received bytes to the frame decoder
+ * @param bytes Bytes received
+ * @param n     Number of bytes
+ */
+void transport_feed_bytes(const unsigned char * bytes, unsigned int n);
+
+/**
+ * @brief For the UART: discards a partially received frame after a line error, so that the decoder resynchronizes on the next valid frame
+ */
+void transport_line_error();
+
+/**
+ * @brief Gets a view of the oldest frame received, which is not copied
+ * @param  view Filled with the view of the frame, valid until transport_release_frame is called
+ * @return      true if there was a frame, false otherwise
+ */
+bool transport_peek_frame(SerialFrameView * view);
+
+/**
+ * @brief Releases the oldest frame received, once handled, so that its slot can be used by the next frames received
+ */
+void transport_release_frame();
+
+/**
+ * @brief Gets the statistics of the transport
+ * @return Statistics since the last reset
+ */
+const TransportStats * transport_get_stats();
+
+/**
+ * @brief Prints the statistics of the transport (messages coalesced and batched and bytes saved by doing so)
+ */
+void transport_print_stats();
+
+/** @} */
+
+#endif /* __TRANSPORT_H */
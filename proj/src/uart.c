@@ -3,11 +3,12 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <minix/syslib.h>
 #include <minix/drivers.h>
 //
-#include "game.h"
-#include "robinix.h"
+#include "transport.h"
+#include "telemetry.h"
 
 uart_queue * create_uart_queue() {
 	uart_queue * uq = malloc(sizeof *uq);
@@ -19,7 +20,6 @@ uart_queue * create_uart_queue() {
 	uq->buffer = NULL;
 	uq->allocated_size = 0;
 	uq->n_elems = 0;
-	uq->seq_received = 0;
 
   return uq;
 }
@@ -62,17 +62,15 @@ void uart_queue_push(uart_queue * uq, char val) {
   uq->n_elems++;
 }
 
-void uart_queue_push_string(uart_queue * uq, char * string) {
-  if(uq == NULL || string == NULL || strlen(string) == 0) {
+void uart_queue_push_bytes(uart_queue * uq, const unsigned char * bytes, unsigned int n) {
+  if(uq == NULL || bytes == NULL) {
     return;
   }
 
-  uart_queue_push(uq, UART_SEQ_START);
-  int i;
-  for(i = 0; i < strlen(string); i++) {
-    uart_queue_push(uq, string[i]);
+  unsigned int i;
+  for(i = 0; i < n; i++) {
+    uart_queue_push(uq, (char) bytes[i]);
   }
-  uart_queue_push(uq, UART_SEQ_END);
 }
 
 char uart_queue_top(uart_queue * uq) {
@@ -117,75 +115,13 @@ void print_uart_queue(uart_queue * uq) {
     return;
   }
 
-  //+1 for \0
-  char * result = calloc((uq->n_elems + 1), sizeof *result);
-  if(result == NULL) {
-    printf("print_uart_queue::Could not allocate result string\n");
-    return;
-  }
-
+  //Contents are binary frames, so they are printed as hex bytes
+  printf("print_uart_queue::uart queue contents:");
   int i;
   for(i = 0; i < uq->n_elems; i++) {
-		//printf("DBG: Element %d : %c\n", i, uq->buffer[i]);
-    //Since strcat needs a null terminated string as an argument we create a temporary one to concatenate each character
-		strcat(result, (char[2]) {uq->buffer[i], '\0'});
+    printf(" %02X", (unsigned char) uq->buffer[i]);
   }
-
-  //There is no problem with having no \0 because when using strcat we are always appending it and we also used calloc to be safe
-  printf("print_uart_queue::uart queue contents: %s\n", result);
-  free(result);
-}
-
-bool uart_queue_has_sequence(uart_queue * uq) {
-	if(uq == NULL || uq->n_elems == 0) {
-		return false;
-	}
-
-	return uq->seq_received > 0;
-}
-
-char * uart_queue_get_top_sequence(uart_queue * uq) {
-	if(uq == NULL || uq->n_elems == 0 || uq->seq_received == 0) {
-		return NULL;
-	}
-
-	//At most the result is the size of the queue (+1 for \0)
-	//Using calloc to ensure \0s
-	//The string is not allocated for a very long time and the queues are emptied quickly so there is not that much unnecessary memory being allocated unnecessarily
-	char * result = calloc((uq->n_elems + 1), sizeof *result);
-	if(result == NULL) {
-		printf("Debug: uart_queue_get_top_sequence could not allocate result string\n");
-		return NULL;
-	}
-
-	//Getting the sequence
-	char topped_char = 0;
-	//While we don't get the last character
-	while((topped_char = uart_queue_top(uq)) != UART_SEQ_END) {
-		//printf("DBG: Topped_char in getting sequence: %c\n", topped_char);
-		if(topped_char != UART_SEQ_START) {
-			//If it is not the sequence start character then concatenate it to the result
-			//Since strcat must receive a null terminated string to concatenate, we generate a temporary one
-			strcat(result, (char[2]){topped_char, '\0'});
-		}
-		//printf("DBG: current result: %s\n\n", result);
-		uart_queue_pop(uq);
-		if(is_uart_queue_empty(uq)) {
-			printf("Debug: UART queue is empty! Cannot be popped anymore for creating sequence string!\n");
-			free(result);
-			return NULL;
-		}
-	}
-
-	//Popping the final character so that the sequence end is removed as well (otherwise we would get stuck here)
-	uart_queue_pop(uq);
-
-	//One sequence was successfully extracted and thus we can decrement the sequence received variable
-	uq->seq_received--;
-
-	//The elements inserted into the result string were already popped from the queue
-
-	return result;
+  printf("\n");
 }
 
 void destroy_uart_queue(uart_queue ** uq) {
@@ -210,19 +146,15 @@ void destroy_uart_queue(uart_queue ** uq) {
 
 static int uart_hookID = 4;
 static uart_queue * send_queue = NULL;
-static uart_queue * receive_queue = NULL;
 //If the UART rceived an interrupt but did not have data to send at the time, this bool is set so that when adding data to the buffer this can be operated on
 static bool can_send = false;
 
 int uart_subscribe_int() {
 
-  //Deallocating previous queues if they exist
+  //Deallocating previous queue if it exists
   if(send_queue != NULL) {
     destroy_uart_queue(&send_queue);
   }
-  if(receive_queue != NULL) {
-    destroy_uart_queue(&receive_queue);
-  }
 
   //Variable used for preserving uart_hookID value that will later be used
 	int temp = uart_hookID;
@@ -247,14 +179,12 @@ int uart_subscribe_int() {
     return -4;
   }
 
-  //Allocating queues
+  //Allocating the send queue and starting to receive frames from scratch
   send_queue = create_uart_queue();
-  receive_queue = create_uart_queue();
-  if(send_queue == NULL || receive_queue == NULL) {
-    destroy_uart_queue(&send_queue);
-    destroy_uart_queue(&receive_queue);
+  if(send_queue == NULL) {
     return -5;
   }
+  transport_reset();
 
 	//Everything went as expected, returning bitmask of the uart_hookID for interrupt handling
 	return BIT(temp);
@@ -423,8 +353,9 @@ int uart_unset_desired_interrupts() {
 }
 
 int uart_enable_FIFO() {
-  //Setting FCR configuration, FIFO enabled, clearing receive and transmit FIFOs, and using a trigger level of 4
-  unsigned long fcr = UART_FCR_EF | UART_FCR_CRF | UART_FCR_CTF | UART_FCR_ITL_4;
+  //Setting FCR configuration, FIFO enabled, clearing receive and transmit FIFOs, and using a trigger level of 1
+  //With a higher trigger level the last bytes of a frame would only be read on the character timeout (4 char times, around 2 ticks at 1200 baud), delaying every message and skewing the clock sync
+  unsigned long fcr = UART_FCR_EF | UART_FCR_CRF | UART_FCR_CTF | UART_FCR_ITL_1;
   if(sys_outb(UART_COM1_BASE_ADDR + UART_FCR_ADDR, fcr) != 0) {
     printf("uart_enable_FIFO::Error writing FIFO configuration!\n");
     return -1;
@@ -447,7 +378,7 @@ int uart_disable_FIFO() {
 int uart_unsubscribe_int() {
 
   destroy_uart_queue(&send_queue);
-  destroy_uart_queue(&receive_queue);
+  transport_line_error();
 
 	if(sys_irqdisable(&uart_hookID) != OK) {
 		printf("uart_unsubscribe_int::Error disabling interrupts on the IRQ line\n");
@@ -666,6 +597,8 @@ int uart_IH() {
     return 0;
   }
 
+  telemetry_interrupt();
+
   //Seeing which interrupt ocurred
   switch (iir & UART_IIR_IO_MASK) {
     case UART_IIR_IO_MS:
@@ -764,22 +697,15 @@ int uart_send() {
 	return 0;
 }
 
-void uart_send_string(char * string) {
-  if(string == NULL || strlen(string) == 0) {
-    return;
-  }
-	//printf("DBG: Pushing string\n");
-
-	//Pushes the string to the send queue with the correct start and end characters
-  uart_queue_push_string(send_queue, string);
-
-	//printf("DBG: New queue contents:\n");
-	//print_uart_queue(send_queue);
+void uart_send_bytes(const unsigned char * bytes, unsigned int n) {
+	//Pushes the bytes (an encoded frame) to the send queue
+	uart_queue_push_bytes(send_queue, bytes, n);
+	telemetry_queue_depth(TELEMETRY_UART_TX_QUEUE, send_queue->n_elems);
 
   if(can_send) {
     //If we received an interrupt previously about the buffer to send being empty we can attempt to send directly
     if(uart_send() != 0) {
-      printf("uart_send_string::Error in uart_send()\n");
+      printf("uart_send_bytes::Error in uart_send()\n");
       return;
     }
   } else {
@@ -787,7 +713,7 @@ void uart_send_string(char * string) {
 		//This should kickstart the remaining interrupts process
 		unsigned long lsr = 0;
 		if(sys_inb(UART_COM1_BASE_ADDR + UART_LSR_ADDR, &lsr) != 0) {
-			printf("uart_send_string::Error checking LSR\n");
+			printf("uart_send_bytes::Error checking LSR\n");
 			return;
 		}
 
@@ -815,12 +741,19 @@ int uart_error_handler() {
 
 	printf("uart_error_handler::LSR: %x\n", lsr);
 
+	if(lsr & (UART_LSR_OE | UART_LSR_PE | UART_LSR_FE | UART_LSR_BI | UART_LSR_FIFOE)) {
+		//Some received byte was lost or corrupted, so whatever partial frame we have can not be trusted
+		//Discarding it makes the decoder hunt for the start of the next valid frame
+		transport_line_error();
+	}
+
 	if(lsr & UART_LSR_RD) {
 		printf("uart_error_handler::There is data available for receiving\n");
 	}
 
 	if(lsr & UART_LSR_OE) {
 		printf("uart_error_handler::Overrun Error ocurred\n");
+		telemetry_line_error(TELEMETRY_OVERRUN);
 		//In case of an Overrun Error the correct behaviour is to clear the receiver buffer, for the data there is considered invalid
 		//Thus we read it until there is nothing in the buffer and "trash" the contents
 		if(uart_clear_receiver_buffer() != 0) {
@@ -830,14 +763,17 @@ int uart_error_handler() {
 
 	if(lsr & UART_LSR_PE) {
 		printf("uart_error_handler::Parity Error ocurred\n");
+		telemetry_line_error(TELEMETRY_PARITY);
 	}
 
 	if(lsr & UART_LSR_FE) {
 		printf("uart_error_handler::Framing Error ocurred\n");
+		telemetry_line_error(TELEMETRY_FRAMING);
 	}
 
 	if(lsr & UART_LSR_BI) {
 		printf("uart_error_handler::Break Interrupt ocurred\n");
+		telemetry_line_error(TELEMETRY_BREAK);
 	}
 
 	if(lsr & UART_LSR_THRE) {
@@ -916,15 +852,6 @@ int uart_receive() {
 
 	//Since we are using FIFO, we must read while Receiver Data in the LSR is active
 	while(lsr & UART_LSR_RD) {
-		////Pushing the received character into the queue
-		if(receive_queue == NULL) {
-			printf("uart_receive::Queue was NULL!\n");
-			return -3;
-		}
-
-		//printf("DBG:Queue contents before receiving character:\n");
-		//print_uart_queue(receive_queue);
-
 		unsigned long c_received = 0;
 		//Reading received character
 		if(sys_inb(UART_COM1_BASE_ADDR + UART_RBR_ADDR, &c_received) != 0) {
@@ -932,18 +859,11 @@ int uart_receive() {
 			return -4;
 		}
 
-		//printf("DBG: Received character %c\n", (char) c_received);
+		//printf("DBG: Received byte %02X\n", (unsigned char) c_received);
 
-		//Pushing the received character into the receiver queue
-		uart_queue_push(receive_queue, (char) c_received);
-
-		if((char)c_received == UART_SEQ_END) {
-			//If a sequence end was received, then the queue has a full sequence
-			receive_queue->seq_received++;
-		}
-
-		//printf("DBG:Queue contents after receiving character:\n");
-		//print_uart_queue(receive_queue);
+		//Feeding the received byte to the frame decoder of the transport (complete frames are queued for the game to take in its next tick)
+		unsigned char byte = (unsigned char) c_received;
+		transport_feed_bytes(&byte, 1);
 
 		//Updating the LSR to know if continuing
 		if(sys_inb(UART_COM1_BASE_ADDR + UART_LSR_ADDR, &lsr) != 0) {
@@ -952,32 +872,6 @@ int uart_receive() {
 		}
 	}
 
-
-	while(uart_queue_has_sequence(receive_queue)){
-		char * seq = uart_queue_get_top_sequence(receive_queue);
-		if(seq == NULL) {
-			printf("NULL sequence extracted from the uart queue\n");
-			continue;
-		}
-		//printf("DBG: Received string \"%s\" through UART\n", seq);
-
-		Robinix * rob = get_rob();
-
-		if(rob == NULL) {
-			//If rob is null the game is not running in play mode so we just print the string as debug and free it afterwards
-			printf("Testing: Received string \"%s\" through UART\n", seq);
-			free(seq);
-			continue;
-		}
-
-		//If rob is not null we are playing the game and thus we add the event to the queue
-		add_event_to_buffer(rob, create_event(RECEIVED_REMOTE_MESSAGE, 0, 0, '?', seq));
-
-		//printf("DBG: Queue contents after removing string:\n");
-		//print_uart_queue(receive_queue);
-	}
-
-
 	//No error ocurred, everything went as expected
 	return 0;
 }
@@ -2,6 +2,7 @@
 #define __UART_H
 
 #include "utilities.h"
+#include "serialframe.h"
 
 /** @defgroup uart uart
  * @{
@@ -87,9 +88,9 @@
 
 /* Other */
 #define UART_DIVISOR 115200
-//Our self defined start and end character for a sequence
-#define UART_SEQ_START  '#'
-#define UART_SEQ_END    '!'
+#define UART_GAME_RATE 1200 /* Bit rate used by the game */
+#define UART_BITS_PER_CHAR 11 /* Start bit, 8 data bits, parity and stop bit, as configured by the game */
+//Messages are sent as binary frames, see serialframe.h for the format and transport.h for how they get here
 
 ////END OF UART DEFINES
 
@@ -102,7 +103,6 @@ typedef struct {
 	char * buffer;
 	unsigned int allocated_size;
 	unsigned int n_elems;
-	unsigned int seq_received;
 } uart_queue;
 
 /**
@@ -119,11 +119,12 @@ uart_queue * create_uart_queue();
 void uart_queue_push(uart_queue * uq, char val);
 
 /**
- * @brief Pushes a string into a queue, complete with start and end characters (for use in sending messages with the UART)
- * @param uq     Queue to push the string into
- * @param string String to push into the queue
+ * @brief Pushes a sequence of bytes into a queue (for use in sending encoded frames with the UART)
+ * @param uq    Queue to push the bytes into
+ * @param bytes Bytes to push into the queue
+ * @param n     Number of bytes to push
  */
-void uart_queue_push_string(uart_queue * uq, char * string);
+void uart_queue_push_bytes(uart_queue * uq, const unsigned char * bytes, unsigned int n);
 
 /**
  * @brief Returns the top of the queue
@@ -151,20 +152,6 @@ bool is_uart_queue_empty(uart_queue * uq);
  */
 void print_uart_queue(uart_queue * uq);
 
-/**
- * @brief Checks if a uart_queue contains a sequence
- * @param  uq Queue to check
- * @return    Returns true if the queue has a sequence, false if not
- */
-bool uart_queue_has_sequence(uart_queue * uq);
-
-/**
- * @brief Gets the topmost sequence of the queue
- * @param  uq Queue to get the sequence off of
- * @return    A pointer to the topmost sequence without the sequence start and end characters or NULL in case of failure
- */
-char * uart_queue_get_top_sequence(uart_queue * uq);
-
 /**
  * @brief Destroys a uart_queue by deleting its elements and freeing all the memory used
  * @param uq Queue to destroy
@@ -254,13 +241,14 @@ int uart_IH();
 int uart_send();
 
 /**
- * @brief Sending interface to call externally from the UART functions. Sends the passed string, correctly encoded. If not possible to send straigh away, it is added to the queue.
- * @param string String to send
+ * @brief Sending interface of the UART backend of the transport (see transport_send_frame). Sends the passed bytes, adding them to the queue if not possible to send straight away
+ * @param bytes Bytes to send (an encoded frame)
+ * @param n     Number of bytes
  */
-void uart_send_string(char * string);
+void uart_send_bytes(const unsigned char * bytes, unsigned int n);
 
 /**
- * @brief Error handler to be called by the interrupt handler
+ * @brief Error handler to be called by the interrupt handler. Any partially received frame is discarded, so that the frame decoder resynchronizes on the next valid frame
  * @return 0 if successful, not 0 otherwise
  */
 int uart_error_handler();
@@ -272,7 +260,7 @@ int uart_error_handler();
 int uart_clear_receiver_buffer();
 
 /**
- * @brief Used by the interrupt handler to receive characters
+ * @brief Used by the interrupt handler to receive characters. Received bytes are fed to the transport, which queues every complete and valid frame
  * @return 0 if successful, not 0 otherwise
  */
 int uart_receive();
@@ -6,6 +6,7 @@
 #include <sys/types.h>
 
 #include <stdio.h>
+#include <stdbool.h>
 #include <math.h>
 #include "video_gr.h"
 #include "vbe.h"
@@ -19,6 +20,7 @@ static unsigned short *video_mem;		/* Process (virtual) address to which VRAM is
 static unsigned h_res;		/* Horizontal screen resolution in pixels */
 static unsigned v_res;		/* Vertical screen resolution in pixels */
 static unsigned bits_per_pixel; /* Number of VRAM bits per pixel */
+static bool headless = false; /* If only the secondary buffer exists (no video mode set and no VRAM mapped) */
 
 /* VBE call macros */
 #define VBE_CALL_SUPPORTED 0x4F
@@ -93,6 +95,43 @@ void *vg_init(unsigned short mode){
   return video_mem;
 }
 
+int vg_init_resolution(unsigned short mode) {
+  vbe_mode_info_t mode_info;
+
+  //Only asking for the mode info, the mode itself is not set
+  if(vbe_get_mode_info(mode, &mode_info) != 0) {
+    printf("vg_init_resolution::Error getting the mode info\n");
+    return 1;
+  }
+
+  h_res = mode_info.XResolution;
+  v_res = mode_info.YResolution;
+  bits_per_pixel = mode_info.BitsPerPixel;
+  return 0;
+}
+
+void *vg_init_headless(unsigned short mode) {
+  if(vg_init_resolution(mode) != 0) {
+    return NULL;
+  }
+
+  back_buffer = malloc(getVramSize());
+
+  if(back_buffer == NULL) {
+    printf("vg_init_headless::Secondary buffer could not be allocated\n");
+    return NULL;
+  }
+
+  headless = true;
+  return back_buffer;
+}
+
+void vg_exit_headless() {
+  free(back_buffer);
+  back_buffer = NULL;
+  headless = false;
+}
+
 int vg_draw_bitmap(char * bmplocation, int x, int y){
 
   //Create a bitmap
@@ -137,9 +176,41 @@ unsigned int getVramSize() {
 }
 
 void swap_buffers() {
+  //Nothing to show the frame on
+  if(headless) {
+    return;
+  }
+
   memcpy(video_mem, back_buffer, h_res*v_res*(bits_per_pixel/8));
 }
 
+int vg_dump_frame(const char * path) {
+  FILE * fp = fopen(path, "wb");
+
+  if(fp == NULL) {
+    printf("vg_dump_frame::Could not open %s\n", path);
+    return 1;
+  }
+
+  //Binary PPM: a small text header and then 8 bits per color component
+  fprintf(fp, "P6\n%u %u\n255\n", h_res, v_res);
+
+  unsigned int n_pixels = h_res * v_res;
+  unsigned int i;
+  for(i = 0; i < n_pixels; i++) {
+    int r;
+    int g;
+    int b;
+    pixel_to_rgb(back_buffer[i], &r, &g, &b);
+    fputc(r * 255 / MAX_RED, fp);
+    fputc(g * 255 / MAX_GREEN, fp);
+    fputc(b * 255 / MAX_BLUE, fp);
+  }
+
+  fclose(fp);
+  return 0;
+}
+
 unsigned short * snapshot_video_mem() {
   unsigned short * snapshot = malloc(h_res*v_res*(bits_per_pixel/8));
 
@@ -21,6 +21,32 @@
 void *vg_init(unsigned short mode);
 
  /**
+ * @brief Sets the resolution of the video module to the one of the passed mode, without setting the mode or allocating any buffer
+ *
+ * Enough for what only needs the size of the screen (like the collision checks) when nothing is drawn
+ *
+ * @param mode 16-bit VBE mode whose resolution to use
+ * @return 0 upon success, non-zero upon failure
+ */
+int vg_init_resolution(unsigned short mode);
+
+ /**
+ * @brief Initializes the video module without setting the graphics mode, for running the game headless
+ *
+ * Only the secondary buffer is allocated, with the resolution of the passed mode, so that frames can still be drawn
+ *  (and dumped with vg_dump_frame), while swap_buffers does nothing
+ *
+ * @param mode 16-bit VBE mode whose resolution to use
+ * @return Address of the secondary buffer. NULL, upon failure.
+ */
+void *vg_init_headless(unsigned short mode);
+
+/**
+ * @brief Frees the secondary buffer allocated by vg_init_headless
+ */
+void vg_exit_headless();
+
+/**
  * @brief Returns to default Minix 3 text mode (0x03: 25 x 80, 16 colors)
  *
  * @return 0 upon success, non-zero upon failure
@@ -77,6 +103,13 @@ unsigned short * getBackBuffer();
  */
 void swap_buffers();
 
+/**
+ * @brief Saves the contents of the secondary buffer to a file, as a binary PPM image
+ * @param  path Path of the file to write
+ * @return      0 if successful, not 0 otherwise
+ */
+int vg_dump_frame(const char * path);
+
 /**
  * @brief Returns a "snapshot" of the video_mem, resulting in a "print screen" buffer
  * @return The snapshotted buffer (copy of video mem) or NULL if the allocation failed